@@ -0,0 +1,859 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: bench.c
+ *
+ * Hosted throughput benchmark.
+ *
+ * A synthetic corpus of PostScript jobs, in the shape written by the RISC OS
+ * PostScript printer drivers, is generated and pushed through the whole of
+ * the conversion path: the jobs are ingested with convert_queue_ps_file(),
+ * each one having been added as a job through the control API so that
+ * parameter generation, the launch of gs, completion handling and the
+ * tidying of the queue all run as they would on RISC OS.
+ *
+ * A file found in the queue without a job waiting for it opens the Save PDF
+ * dialogue, so each job is added before its file is queued.  Up to -depth
+ * jobs are kept in the queue at once.  The time that jobs spend in each
+ * stage, including the queue, is taken from the conversion statistics.
+ * With -profile, the jobs are added using the named settings profile from
+ * the profiles file in the work directory.  With -budget, conversions are
+ * only started while their estimated memory fits in the given number of
+ * Kbytes.
+ *
+ *   ppdfbench [-work <dir>] [-messages <file>] [-jobs <n>] [-kinds <list>]
+ *             [-depth <n>] [-profile <name>] [-budget <k>] [-stub]
+ *             [-page-delay <cs>] [-start-delay <cs>] [-timeout <seconds>]
+ *             [-results <file>] [-keep]
+ *
+ * Without -stub, the first gs on the PATH is used.  With it, the stand-in
+ * built alongside the benchmark is used instead, with its latency set by
+ * -page-delay and -start-delay.  The result cache is disabled, so that
+ * every job is converted.
+ */
+
+/* ANSI C header files */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "hosted.h"
+
+#include "client.h"
+#include "convert.h"
+#include "stats.h"
+
+
+/**
+ * The maximum length of a filename used by the benchmark.
+ */
+
+#define BENCH_MAX_FILENAME 1024
+
+/**
+ * The number of bytes of image data written on each line of hex.
+ */
+
+#define BENCH_HEX_LINE 32
+
+/**
+ * The kinds of job in the corpus.
+ */
+
+enum bench_kind {
+	BENCH_KIND_TEXT = 0,				/**< A few pages of text in one font.			*/
+	BENCH_KIND_IMAGE = 1,				/**< Pages dominated by large colour images.		*/
+	BENCH_KIND_PAGES = 2,				/**< A long document with little on each page.		*/
+	BENCH_KIND_FONTS = 3,				/**< Pages of text using many different fonts.		*/
+	BENCH_KINDS = 4					/**< The number of kinds of job.			*/
+};
+
+/**
+ * The record of a job in the benchmark.
+ */
+
+struct bench_job {
+	enum bench_kind		kind;				/**< The kind of job.					*/
+	int			job;				/**< The control API's ID for the job.			*/
+	os_t			queued;				/**< The time at which the job was queued.		*/
+	os_t			ended;				/**< The time at which the job's outcome was reported.	*/
+	enum client_state	state;				/**< The outcome of the job.				*/
+	int			bytes_in;			/**< The size of the job's input.			*/
+	int			bytes_out;			/**< The size of the job's output.			*/
+};
+
+/**
+ * A summary of the latency of the successful jobs.
+ */
+
+struct bench_summary {
+	int			p50;				/**< The median value.					*/
+	int			p95;				/**< The 95th percentile value.				*/
+	int			p99;				/**< The 99th percentile value.				*/
+	int			max;				/**< The maximum value.					*/
+};
+
+
+/* Function Prototypes. */
+
+static osbool bench_write_corpus(char *directory);
+static void bench_write_prologue(FILE *out, char *title, int pages, char *fonts);
+static void bench_write_trailer(FILE *out, int pages);
+static void bench_write_text(FILE *out);
+static void bench_write_image(FILE *out);
+static void bench_write_pages(FILE *out);
+static void bench_write_fonts(FILE *out);
+static char *bench_corpus_file(char *buffer, char *directory, enum bench_kind kind);
+static char *bench_output_file(char *buffer, char *directory, int job);
+static void bench_end_job(struct bench_job *job, int number, char *directory, osbool keep);
+static int bench_file_size(char *filename);
+static osbool bench_parse_kinds(char *list, enum bench_kind *kinds, int *count);
+static void bench_summarise(struct bench_job *jobs, int count, struct bench_summary *summary);
+static int bench_compare_values(const void *a, const void *b);
+static osbool bench_write_results(char *filename, struct bench_job *jobs, int count, os_t elapsed, char *interpreter);
+static unsigned bench_random(void);
+
+
+/**
+ * The names of the kinds of job, as used on the command line.
+ */
+
+static char *bench_kind_names[BENCH_KINDS] = {
+	"text", "image", "pages", "fonts"
+};
+
+/**
+ * The functions which write the body of each kind of job.
+ */
+
+static void (*bench_kind_writers[BENCH_KINDS])(FILE *out) = {
+	bench_write_text, bench_write_image, bench_write_pages, bench_write_fonts
+};
+
+/**
+ * The names of the conversion stages, for the results.
+ */
+
+static char *bench_stage_names[STATS_STAGES] = {
+	"Queue", "Setup", "Launch", "Convert", "SplitWait"
+};
+
+/**
+ * The fonts used by the many-font jobs: the standard PostScript set.
+ */
+
+static char *bench_fonts[] = {
+	"Times-Roman", "Times-Italic", "Times-Bold", "Times-BoldItalic",
+	"Helvetica", "Helvetica-Oblique", "Helvetica-Bold", "Helvetica-BoldOblique",
+	"Helvetica-Narrow", "Helvetica-Narrow-Oblique", "Helvetica-Narrow-Bold", "Helvetica-Narrow-BoldOblique",
+	"Courier", "Courier-Oblique", "Courier-Bold", "Courier-BoldOblique",
+	"AvantGarde-Book", "AvantGarde-BookOblique", "AvantGarde-Demi", "AvantGarde-DemiOblique",
+	"Bookman-Light", "Bookman-LightItalic", "Bookman-Demi", "Bookman-DemiItalic",
+	"NewCenturySchlbk-Roman", "NewCenturySchlbk-Italic", "NewCenturySchlbk-Bold", "NewCenturySchlbk-BoldItalic",
+	"Palatino-Roman", "Palatino-Italic", "Palatino-Bold", "Palatino-BoldItalic",
+	"Symbol", "ZapfChancery-MediumItalic", "ZapfDingbats"
+};
+
+#define BENCH_FONTS ((int) (sizeof(bench_fonts) / sizeof(char *)))
+
+/**
+ * The words from which text is made up.
+ */
+
+static char *bench_words[] = {
+	"the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "printer", "driver",
+	"document", "page", "conversion", "queue", "Acorn", "desktop", "window", "icon", "sprite", "font"
+};
+
+#define BENCH_WORDS ((int) (sizeof(bench_words) / sizeof(char *)))
+
+/**
+ * The state of the generator used for the corpus, which is fixed so that
+ * the corpus is the same on every run.
+ */
+
+static unsigned bench_seed = 1;
+
+
+/**
+ * Run the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+	struct bench_job	*jobs;
+	enum bench_kind		kinds[BENCH_KINDS] = {BENCH_KIND_TEXT, BENCH_KIND_IMAGE, BENCH_KIND_PAGES, BENCH_KIND_FONTS};
+	char			*work = "/tmp/ppdfbench", *messages = NULL, *results = NULL, *profile = NULL, *slash;
+	char			corpus[BENCH_MAX_FILENAME], filename[BENCH_MAX_FILENAME], output[BENCH_MAX_FILENAME];
+	char			path[BENCH_MAX_FILENAME * 4];
+	osbool			stub = FALSE, keep = FALSE, stopped = FALSE;
+	int			i, count, kind_count = BENCH_KINDS, per_kind = 5, timeout = 120, failed = 0;
+	int			page_delay = 0, start_delay = 0, depth = 1, budget = 0, next, active, first;
+	os_t			start, elapsed, limit;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-work") == 0 && i + 1 < argc)
+			work = argv[++i];
+		else if (strcmp(argv[i], "-messages") == 0 && i + 1 < argc)
+			messages = argv[++i];
+		else if (strcmp(argv[i], "-jobs") == 0 && i + 1 < argc)
+			per_kind = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-kinds") == 0 && i + 1 < argc && bench_parse_kinds(argv[i + 1], kinds, &kind_count))
+			i++;
+		else if (strcmp(argv[i], "-depth") == 0 && i + 1 < argc)
+			depth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-profile") == 0 && i + 1 < argc)
+			profile = argv[++i];
+		else if (strcmp(argv[i], "-budget") == 0 && i + 1 < argc)
+			budget = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-stub") == 0)
+			stub = TRUE;
+		else if (strcmp(argv[i], "-page-delay") == 0 && i + 1 < argc)
+			page_delay = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-start-delay") == 0 && i + 1 < argc)
+			start_delay = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-timeout") == 0 && i + 1 < argc)
+			timeout = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-results") == 0 && i + 1 < argc)
+			results = argv[++i];
+		else if (strcmp(argv[i], "-keep") == 0)
+			keep = TRUE;
+		else
+			break;
+	}
+
+	if (i != argc || per_kind < 1 || depth < 1) {
+		fprintf(stderr, "Usage: ppdfbench [-work <dir>] [-messages <file>] [-jobs <n>] [-kinds <list>]\n"
+				"                 [-depth <n>] [-profile <name>] [-budget <k>] [-stub] [-page-delay <cs>]\n"
+				"                 [-start-delay <cs>] [-timeout <seconds>] [-results <file>] [-keep]\n");
+		return 2;
+	}
+
+	/* Point the PATH at the stand-in if required; it lives in bin beside the benchmark. */
+
+	if (stub) {
+		string_copy(filename, argv[0], BENCH_MAX_FILENAME);
+		slash = strrchr(filename, '/');
+		if (slash != NULL)
+			*slash = '\0';
+		else
+			string_copy(filename, ".", BENCH_MAX_FILENAME);
+
+		string_printf(path, sizeof(path), "%s/bin:%s", filename, (getenv("PATH") != NULL) ? getenv("PATH") : "");
+		setenv("PATH", path, 1);
+
+		string_printf(filename, BENCH_MAX_FILENAME, "%d", page_delay);
+		setenv("FAKEGS_DELAY", filename, 1);
+		string_printf(filename, BENCH_MAX_FILENAME, "%d", start_delay);
+		setenv("FAKEGS_START_DELAY", filename, 1);
+	}
+
+	if (!hosted_initialise(work, messages)) {
+		fprintf(stderr, "Unable to initialise in %s\n", work);
+		return 1;
+	}
+
+	config_int_set("CacheSize", 0);
+	config_int_set("MemoryBudget", budget);
+	client_initialise(FALSE);
+
+	string_printf(corpus, BENCH_MAX_FILENAME, "%s/corpus", work);
+	if (!bench_write_corpus(corpus)) {
+		fprintf(stderr, "Unable to write the corpus to %s\n", corpus);
+		hosted_terminate();
+		return 1;
+	}
+
+	count = per_kind * kind_count;
+	jobs = calloc(count, sizeof(struct bench_job));
+	if (jobs == NULL) {
+		hosted_terminate();
+		return 1;
+	}
+
+	for (i = 0; i < count; i++) {
+		jobs[i].kind = kinds[i % kind_count];
+		jobs[i].bytes_in = bench_file_size(bench_corpus_file(filename, corpus, jobs[i].kind));
+	}
+
+	/* Add each job and queue its file, keeping up to depth jobs in the queue, and collect the outcomes. */
+
+	start = os_read_monotonic_time();
+	next = 0;
+	active = 0;
+	first = 0;
+
+	while (active > 0 || (!stopped && next < count)) {
+		while (!stopped && next < count && active < depth) {
+			jobs[next].queued = os_read_monotonic_time();
+			jobs[next].state = CLIENT_WAITING;
+			jobs[next].job = client_add_job(bench_output_file(output, work, next), profile);
+
+			if (jobs[next].job == 0 || !convert_queue_ps_file(bench_corpus_file(filename, corpus, jobs[next].kind), FALSE)) {
+				jobs[next].state = CLIENT_FAILED;
+				jobs[next].ended = os_read_monotonic_time();
+				stopped = TRUE;
+			} else {
+				active++;
+			}
+
+			next++;
+		}
+
+		/* Wait until the oldest outstanding job's time runs out. */
+
+		while (first < next && jobs[first].state != CLIENT_WAITING)
+			first++;
+
+		if (active == 0)
+			continue;
+
+		limit = jobs[first].queued + timeout * 100;
+
+		if (!client_wait_for_jobs(limit) && os_read_monotonic_time() - limit >= 0) {
+			fprintf(stderr, "Job %d (%s) timed out while %s\n", first, bench_kind_names[jobs[first].kind],
+					(client_query_job(jobs[first].job) == CLIENT_JOB_QUEUED) ? "queued" : "converting");
+			jobs[first].state = CLIENT_TIMED_OUT;
+			jobs[first].ended = os_read_monotonic_time();
+			stopped = TRUE;
+			active--;
+		}
+
+		for (i = first; i < next; i++) {
+			if (jobs[i].state != CLIENT_WAITING)
+				continue;
+
+			jobs[i].state = client_get_job_state(jobs[i].job, NULL);
+
+			if (jobs[i].state != CLIENT_WAITING) {
+				jobs[i].ended = os_read_monotonic_time();
+				active--;
+			}
+		}
+	}
+
+	count = next;
+
+	for (i = 0; i < count; i++) {
+		bench_end_job(&(jobs[i]), i, work, keep);
+
+		if (jobs[i].state != CLIENT_SUCCEEDED)
+			failed++;
+	}
+
+	/* Jobs left waiting would pick up later print jobs. */
+
+	if (stopped)
+		client_clear_filename();
+
+	elapsed = os_read_monotonic_time() - start;
+
+	if (convert_pending_files_in_queue())
+		fprintf(stderr, "Jobs were left in the queue\n");
+
+	if (!bench_write_results(results, jobs, count, elapsed, (stub) ? "stub" : "gs"))
+		fprintf(stderr, "Unable to write the results to %s\n", results);
+
+	free(jobs);
+	hosted_terminate();
+
+	return (failed == 0) ? 0 : 1;
+}
+
+
+/**
+ * Write the corpus, with one file for each kind of job.
+ *
+ * \param *directory		The directory to write the corpus into.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool bench_write_corpus(char *directory)
+{
+	char	filename[BENCH_MAX_FILENAME];
+	FILE	*out;
+	int	kind;
+
+	if (mkdir(directory, 0777) != 0 && errno != EEXIST)
+		return FALSE;
+
+	for (kind = 0; kind < BENCH_KINDS; kind++) {
+		out = fopen(bench_corpus_file(filename, directory, kind), "w");
+		if (out == NULL)
+			return FALSE;
+
+		bench_kind_writers[kind](out);
+
+		if (fclose(out) != 0)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Write the header comments and prologue of a job, in the style of the
+ * PostScript printer driver.
+ *
+ * \param *out			The file to write to.
+ * \param *title		The title of the job.
+ * \param pages			The number of pages in the job.
+ * \param *fonts		The fonts used by the job, separated by spaces.
+ */
+
+static void bench_write_prologue(FILE *out, char *title, int pages, char *fonts)
+{
+	fprintf(out, "%%!PS-Adobe-3.0\n"
+			"%%%%Creator: PDriverPS 4.10\n"
+			"%%%%Title: %s\n"
+			"%%%%For: Benchmark\n"
+			"%%%%Pages: %d\n"
+			"%%%%PageOrder: Ascend\n"
+			"%%%%DocumentNeededResources: font %s\n"
+			"%%%%BoundingBox: 0 0 595 842\n"
+			"%%%%EndComments\n"
+			"%%%%BeginProlog\n"
+			"%%%%BeginResource: procset PDriver 4 10\n"
+			"/PDdict 64 dict def PDdict begin\n"
+			"/bd {bind def} bind def\n"
+			"/m {moveto} bd /l {lineto} bd /c {curveto} bd /cp {closepath} bd\n"
+			"/s {stroke} bd /f {fill} bd /rgb {setrgbcolor} bd /lw {setlinewidth} bd\n"
+			"/sf {findfont exch scalefont setfont} bd /t {show} bd\n"
+			"/ps {/PDsave save def} bd /pe {PDsave restore showpage} bd\n"
+			"end\n"
+			"%%%%EndResource\n"
+			"%%%%EndProlog\n"
+			"%%%%BeginSetup\n"
+			"PDdict begin\n"
+			"%%%%EndSetup\n", title, pages, fonts);
+}
+
+
+/**
+ * Write the trailer of a job.
+ *
+ * \param *out			The file to write to.
+ * \param pages			The number of pages in the job.
+ */
+
+static void bench_write_trailer(FILE *out, int pages)
+{
+	fprintf(out, "%%%%Trailer\nend\n%%%%Pages: %d\n%%%%EOF\n", pages);
+}
+
+
+/**
+ * Write a job made up of a few pages of text in a single font.
+ *
+ * \param *out			The file to write to.
+ */
+
+static void bench_write_text(FILE *out)
+{
+	int	page, line, word;
+
+	bench_write_prologue(out, "Text", 4, "Times-Roman");
+
+	for (page = 1; page <= 4; page++) {
+		fprintf(out, "%%%%Page: %d %d\nps\n10 /Times-Roman sf 0 0 0 rgb\n", page, page);
+
+		for (line = 0; line < 64; line++) {
+			fprintf(out, "56 %d m (", 800 - line * 12);
+			for (word = 0; word < 12; word++)
+				fprintf(out, "%s%s", (word > 0) ? " " : "", bench_words[bench_random() % BENCH_WORDS]);
+			fprintf(out, ") t\n");
+		}
+
+		fprintf(out, "pe\n");
+	}
+
+	bench_write_trailer(out, 4);
+}
+
+
+/**
+ * Write a job made up of pages dominated by large colour images.
+ *
+ * \param *out			The file to write to.
+ */
+
+static void bench_write_image(FILE *out)
+{
+	int	page, i, size = 256 * 256 * 3;
+
+	bench_write_prologue(out, "Images", 2, "Helvetica");
+
+	for (page = 1; page <= 2; page++) {
+		fprintf(out, "%%%%Page: %d %d\nps\n12 /Helvetica sf 56 800 m (Figure %d) t\n", page, page, page);
+		fprintf(out, "gsave 56 300 translate 480 480 scale\n"
+				"/picstr 768 string def\n"
+				"256 256 8 [256 0 0 -256 0 256] {currentfile picstr readhexstring pop} false 3 colorimage\n");
+
+		for (i = 0; i < size; i++)
+			fprintf(out, "%02x%s", bench_random() & 0xff, ((i + 1) % BENCH_HEX_LINE == 0) ? "\n" : "");
+
+		fprintf(out, "\ngrestore\npe\n");
+	}
+
+	bench_write_trailer(out, 2);
+}
+
+
+/**
+ * Write a long job with only a little on each page.
+ *
+ * \param *out			The file to write to.
+ */
+
+static void bench_write_pages(FILE *out)
+{
+	int	page;
+
+	bench_write_prologue(out, "Pages", 200, "Helvetica");
+
+	for (page = 1; page <= 200; page++) {
+		fprintf(out, "%%%%Page: %d %d\nps\n1 lw 0 0 0 rgb 56 56 m 539 56 l 539 786 l 56 786 l cp s\n"
+				"10 /Helvetica sf 280 40 m (Page %d) t\npe\n", page, page, page);
+	}
+
+	bench_write_trailer(out, 200);
+}
+
+
+/**
+ * Write a job made up of pages of text in many different fonts.
+ *
+ * \param *out			The file to write to.
+ */
+
+static void bench_write_fonts(FILE *out)
+{
+	char	fonts[BENCH_MAX_FILENAME] = "";
+	int	page, line, font;
+
+	for (font = 0; font < BENCH_FONTS; font++) {
+		strncat(fonts, bench_fonts[font], sizeof(fonts) - strlen(fonts) - 2);
+		strcat(fonts, " ");
+	}
+
+	bench_write_prologue(out, "Fonts", 8, fonts);
+
+	for (page = 1; page <= 8; page++) {
+		fprintf(out, "%%%%Page: %d %d\nps\n", page, page);
+
+		for (line = 0; line < 48; line++) {
+			font = (page * 48 + line) % BENCH_FONTS;
+			fprintf(out, "%d /%s sf 56 %d m (%s %s %s) t\n", 8 + line % 6, bench_fonts[font], 800 - line * 15,
+					bench_fonts[font], bench_words[bench_random() % BENCH_WORDS], bench_words[bench_random() % BENCH_WORDS]);
+		}
+
+		fprintf(out, "pe\n");
+	}
+
+	bench_write_trailer(out, 8);
+}
+
+
+/**
+ * Build the name of the corpus file for a kind of job.
+ *
+ * \param *buffer		The buffer to take the name, of BENCH_MAX_FILENAME.
+ * \param *directory		The directory holding the corpus.
+ * \param kind			The kind of job.
+ * \return			Pointer to the buffer.
+ */
+
+static char *bench_corpus_file(char *buffer, char *directory, enum bench_kind kind)
+{
+	string_printf(buffer, BENCH_MAX_FILENAME, "%s/%s.ps", directory, bench_kind_names[kind]);
+
+	return buffer;
+}
+
+
+/**
+ * Build the name of the output file for a job.
+ *
+ * \param *buffer		The buffer to take the name.
+ * \param *directory		The working directory.
+ * \param job			The number of the job.
+ * \return			Pointer to the buffer.
+ */
+
+static char *bench_output_file(char *buffer, char *directory, int job)
+{
+	string_printf(buffer, BENCH_MAX_FILENAME, "%s/out%d.pdf", directory, job);
+
+	return buffer;
+}
+
+
+/**
+ * Record the size of a job's output, and tidy it up.
+ *
+ * \param *job			The job to record.
+ * \param number		The number of the job.
+ * \param *directory		The working directory.
+ * \param keep			TRUE to keep the job's output; else FALSE.
+ */
+
+static void bench_end_job(struct bench_job *job, int number, char *directory, osbool keep)
+{
+	char	output[BENCH_MAX_FILENAME];
+
+	bench_output_file(output, directory, number);
+
+	if (job->state == CLIENT_SUCCEEDED)
+		job->bytes_out = bench_file_size(output);
+	else
+		fprintf(stderr, "Job %d (%s) failed\n", number, bench_kind_names[job->kind]);
+
+	if (!keep)
+		remove(output);
+}
+
+
+/**
+ * Return the size of a file.
+ *
+ * \param *filename		The file to size.
+ * \return			The size of the file, or 0 if it doesn't exist.
+ */
+
+static int bench_file_size(char *filename)
+{
+	struct stat	info;
+
+	return (stat(filename, &info) == 0) ? (int) info.st_size : 0;
+}
+
+
+/**
+ * Parse a comma-separated list of kinds of job.
+ *
+ * \param *list			The list to parse.
+ * \param *kinds		The array to take the kinds, of BENCH_KINDS entries.
+ * \param *count		Pointer to a variable to take the number of kinds.
+ * \return			TRUE if the list was valid; else FALSE.
+ */
+
+static osbool bench_parse_kinds(char *list, enum bench_kind *kinds, int *count)
+{
+	char	*start = list, *end;
+	int	kind, found = 0;
+	size_t	length;
+
+	while (*start != '\0' && found < BENCH_KINDS) {
+		end = strchr(start, ',');
+		length = (end != NULL) ? (size_t) (end - start) : strlen(start);
+
+		for (kind = 0; kind < BENCH_KINDS; kind++) {
+			if (strlen(bench_kind_names[kind]) == length && strncmp(bench_kind_names[kind], start, length) == 0)
+				break;
+		}
+
+		if (kind == BENCH_KINDS)
+			return FALSE;
+
+		kinds[found++] = kind;
+		start += length;
+		if (*start == ',')
+			start++;
+	}
+
+	if (found == 0 || *start != '\0')
+		return FALSE;
+
+	*count = found;
+
+	return TRUE;
+}
+
+
+/**
+ * Summarise the latency of the successful jobs.
+ *
+ * \param *jobs			The jobs to summarise.
+ * \param count			The number of jobs.
+ * \param *summary		Pointer to a block to take the summary.
+ */
+
+static void bench_summarise(struct bench_job *jobs, int count, struct bench_summary *summary)
+{
+	int	*values;
+	int	i, samples = 0;
+
+	summary->p50 = 0;
+	summary->p95 = 0;
+	summary->p99 = 0;
+	summary->max = 0;
+
+	values = malloc(count * sizeof(int));
+	if (values == NULL)
+		return;
+
+	for (i = 0; i < count; i++) {
+		if (jobs[i].state == CLIENT_SUCCEEDED)
+			values[samples++] = jobs[i].ended - jobs[i].queued;
+	}
+
+	/* Use the nearest rank for the percentiles, as stats.c does. */
+
+	if (samples > 0) {
+		qsort(values, samples, sizeof(int), bench_compare_values);
+
+		summary->p50 = values[(samples * 50 + 99) / 100 - 1];
+		summary->p95 = values[(samples * 95 + 99) / 100 - 1];
+		summary->p99 = values[(samples * 99 + 99) / 100 - 1];
+		summary->max = values[samples - 1];
+	}
+
+	free(values);
+}
+
+
+/**
+ * Compare two latency values, for qsort().
+ *
+ * \param *a			Pointer to the first value.
+ * \param *b			Pointer to the second value.
+ * \return			The result of the comparison.
+ */
+
+static int bench_compare_values(const void *a, const void *b)
+{
+	int	x = *((const int *) a), y = *((const int *) b);
+
+	return (x > y) - (x < y);
+}
+
+
+/**
+ * Report the results on stdout and, if required, write them to a file as
+ * tab-separated text in the style of the statistics dump.
+ *
+ * \param *filename		The file to write the results to, or NULL.
+ * \param *jobs			The jobs which were run.
+ * \param count			The number of jobs.
+ * \param elapsed		The time taken to run the jobs, in centiseconds.
+ * \param *interpreter		The name of the interpreter used.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool bench_write_results(char *filename, struct bench_job *jobs, int count, os_t elapsed, char *interpreter)
+{
+	struct bench_summary	latency;
+	struct stats_summary	stages[STATS_STAGES];
+	FILE			*file;
+	double			rate;
+	int			i, succeeded = 0, bytes_in = 0, bytes_out = 0;
+
+	for (i = 0; i < count; i++) {
+		if (jobs[i].state != CLIENT_SUCCEEDED)
+			continue;
+
+		succeeded++;
+		bytes_in += jobs[i].bytes_in;
+		bytes_out += jobs[i].bytes_out;
+	}
+
+	bench_summarise(jobs, count, &latency);
+
+	/* The stage metrics share their numbering with the stages. */
+
+	for (i = 0; i < STATS_STAGES; i++)
+		stats_get_summary(i, stages + i);
+
+	rate = (elapsed > 0) ? succeeded * 100.0 / elapsed : 0.0;
+
+	printf("%d jobs (%d failed) in %d.%02d seconds: %.2f jobs/sec, %d bytes in, %d bytes written\n",
+			count, count - succeeded, elapsed / 100, elapsed % 100, rate, bytes_in, bytes_out);
+	printf("Latency    p50 %5d cs  p95 %5d cs  p99 %5d cs  max %5d cs\n", latency.p50, latency.p95, latency.p99, latency.max);
+
+	for (i = 0; i < STATS_STAGES; i++)
+		printf("%-10s p50 %5d cs  p95 %5d cs  max %5d cs\n", bench_stage_names[i], stages[i].p50, stages[i].p95, stages[i].max);
+
+	if (filename == NULL)
+		return TRUE;
+
+	file = fopen(filename, "w");
+	if (file == NULL)
+		return FALSE;
+
+	fprintf(file, "# PrintPDF benchmark results\n");
+	fprintf(file, "# Interpreter %s, run at %ld\n", interpreter, (long) time(NULL));
+	fprintf(file, "# Times are in centiseconds, and sizes in bytes.  Stages cover the most recent conversions.\n\n");
+
+	fprintf(file, "Jobs\t%d\nFailed\t%d\nElapsed\t%d\nJobsPerSec\t%.3f\nBytesIn\t%d\nBytesOut\t%d\n\n",
+			count, count - succeeded, elapsed, rate, bytes_in, bytes_out);
+
+	fprintf(file, "Latency\tp50\tp95\tp99\tmax\n");
+	fprintf(file, "Total\t%d\t%d\t%d\t%d\n\n", latency.p50, latency.p95, latency.p99, latency.max);
+
+	fprintf(file, "Stage\tp50\tp95\tmax\n");
+
+	for (i = 0; i < STATS_STAGES; i++)
+		fprintf(file, "%s\t%d\t%d\t%d\n", bench_stage_names[i], stages[i].p50, stages[i].p95, stages[i].max);
+
+	fprintf(file, "\nJob\tKind\tResult\tLatency\tInput\tOutput\n");
+
+	for (i = 0; i < count; i++) {
+		fprintf(file, "%d\t%s\t%s\t%d\t%d\t%d\n", i, bench_kind_names[jobs[i].kind],
+				(jobs[i].state == CLIENT_SUCCEEDED) ? "OK" : "Failed",
+				jobs[i].ended - jobs[i].queued, jobs[i].bytes_in, jobs[i].bytes_out);
+	}
+
+	return (fclose(file) == 0) ? TRUE : FALSE;
+}
+
+
+/**
+ * Return the next value from the generator used for the corpus.
+ *
+ * \return			The next value.
+ */
+
+static unsigned bench_random(void)
+{
+	bench_seed = bench_seed * 1103515245u + 12345u;
+
+	return (bench_seed >> 16) & 0x7fff;
+}
+
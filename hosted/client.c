@@ -0,0 +1,503 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: client.c
+ *
+ * Hosted control API client implementation.
+ *
+ * The client talks to the conversion core through Message_PrintPDFControl,
+ * exactly as an external task would on RISC OS, so the messages are laid
+ * out as described in the manual rather than taken from api.c.
+ */
+
+/* ANSI C header files */
+
+#include <stdio.h>
+#include <string.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+#include "oslib/wimp.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "client.h"
+
+#include "hosted.h"
+
+
+/**
+ * The Wimp message number of Message_PrintPDFControl.
+ */
+
+#define CLIENT_MESSAGE_CONTROL 0x5A480
+
+/**
+ * The length of a control message with no data.
+ */
+
+#define CLIENT_BASIC_LENGTH 24
+
+/**
+ * The length of a job query.
+ */
+
+#define CLIENT_JOB_LENGTH 36
+
+/**
+ * The number of jobs which the client can track.
+ */
+
+#define CLIENT_MAX_JOBS 64
+
+/**
+ * The reason codes used by the client.
+ */
+
+enum client_reason {
+	CLIENT_SET_FILENAME = 0,
+	CLIENT_REPORT_SUCCESS = 1,
+	CLIENT_REPORT_FAILURE = 2,
+	CLIENT_CLEAR_FILENAME = 3,
+	CLIENT_REPORT_PROGRESS = 4,
+	CLIENT_ADD_JOB = 7,
+	CLIENT_REPORT_JOB_ADDED = 8,
+	CLIENT_QUERY_JOB = 9,
+	CLIENT_REPORT_JOB = 10,
+	CLIENT_REPORT_JOBS_ENDED = 11,
+	CLIENT_ADD_PROFILE_JOB = 12
+};
+
+/**
+ * The state of a job, as reported by PrintPDF.
+ */
+
+struct client_report {
+	int			job;
+	int			state;
+	int			failure;
+};
+
+/**
+ * Message_PrintPDFControl.
+ */
+
+typedef struct {
+	wimp_MESSAGE_HEADER_MEMBERS
+	int			reason;
+	union {
+		char		filename[232];
+		int		failure;
+		struct {
+			int	pages_done;
+			int	pages_total;
+			int	bytes_in;
+			int	bytes_total;
+			int	time_left;
+			int	job;
+		} progress;
+		struct client_report job;
+		struct {
+			char	profile[32];
+			char	filename[200];
+		} profile_job;
+		struct {
+			int	count;
+			struct client_report jobs[16];
+		} ended;
+	};
+} client_control;
+
+/**
+ * A job being tracked by the client.
+ */
+
+struct client_job {
+	int			job;				/**< The job ID, or 0 if the entry is free.		*/
+	enum client_state	state;				/**< The state of the job.				*/
+	int			failure;			/**< The failure code, if the job failed.		*/
+};
+
+
+/* Function Prototypes. */
+
+static void client_message_handler(wimp_event_no event, wimp_message *message, void *data);
+static void client_send(enum client_reason reason, char *filename, char *profile);
+static void client_end_job(struct client_report *report);
+
+
+/**
+ * The client's task handle.
+ */
+
+static wimp_t client_task = HOSTED_NO_TASK;
+
+/**
+ * The state of the client's conversion.
+ */
+
+static enum client_state client_state = CLIENT_IDLE;
+
+/**
+ * The failure code from the last conversion.
+ */
+
+static int client_failure = 0;
+
+/**
+ * TRUE if progress is to be reported.
+ */
+
+static osbool client_verbose = FALSE;
+
+/**
+ * The jobs being tracked.
+ */
+
+static struct client_job client_jobs[CLIENT_MAX_JOBS];
+
+/**
+ * The ID of the last job added, or 0 if it was refused.
+ */
+
+static int client_added_job = 0;
+
+/**
+ * The number of job reports received since the client last waited.
+ */
+
+static int client_reports = 0;
+
+/**
+ * The state of the last job queried.
+ */
+
+static enum client_job_state client_queried_state = CLIENT_JOB_UNKNOWN;
+
+
+/**
+ * Register the client with the hosted environment.
+ *
+ * \param verbose		TRUE to report progress on stdout; else FALSE.
+ */
+
+void client_initialise(osbool verbose)
+{
+	client_verbose = verbose;
+	client_task = hosted_register_task(client_message_handler, NULL);
+}
+
+
+/**
+ * Ask PrintPDF to save the next conversion to a file, without showing the
+ * Save PDF dialogue.
+ *
+ * \param *filename		The file to save the PDF to.
+ * \return			TRUE if PrintPDF accepted the filename; else FALSE.
+ */
+
+osbool client_set_filename(char *filename)
+{
+	client_state = CLIENT_WAITING;
+	client_failure = 0;
+
+	client_send(CLIENT_SET_FILENAME, filename, NULL);
+
+	/* A refusal comes back straight away. */
+
+	hosted_poll(0);
+
+	return (client_state == CLIENT_WAITING) ? TRUE : FALSE;
+}
+
+
+/**
+ * Ask PrintPDF to stop saving conversions to the client's file.
+ */
+
+void client_clear_filename(void)
+{
+	client_send(CLIENT_CLEAR_FILENAME, NULL, NULL);
+	hosted_poll(0);
+
+	client_state = CLIENT_IDLE;
+}
+
+
+/**
+ * Run the poll loop until PrintPDF reports the outcome of the conversion,
+ * or a time limit passes.
+ *
+ * \param limit			The time by which PrintPDF must report.
+ * \return			The state of the conversion.
+ */
+
+enum client_state client_wait(os_t limit)
+{
+	while (client_state == CLIENT_WAITING && os_read_monotonic_time() - limit < 0)
+		hosted_poll(limit - os_read_monotonic_time());
+
+	if (client_state == CLIENT_WAITING)
+		client_state = CLIENT_TIMED_OUT;
+
+	return client_state;
+}
+
+
+/**
+ * Ask PrintPDF to save a future conversion to a file, without showing the
+ * Save PDF dialogue.  Unlike client_set_filename(), any number of jobs can
+ * be outstanding at once.
+ *
+ * \param *filename		The file to save the PDF to.
+ * \param *profile		The settings profile to convert the job with,
+ *				or NULL to use PrintPDF's current settings.
+ * \return			The job ID, or 0 if PrintPDF refused the job.
+ */
+
+int client_add_job(char *filename, char *profile)
+{
+	int	i;
+
+	for (i = 0; i < CLIENT_MAX_JOBS && client_jobs[i].job != 0; i++);
+
+	if (i >= CLIENT_MAX_JOBS)
+		return 0;
+
+	client_added_job = 0;
+
+	client_send((profile != NULL) ? CLIENT_ADD_PROFILE_JOB : CLIENT_ADD_JOB, filename, profile);
+
+	/* The request is delivered by the first poll, and the job ID or a refusal by the second. */
+
+	hosted_poll(0);
+	hosted_poll(0);
+
+	if (client_added_job != 0) {
+		client_jobs[i].job = client_added_job;
+		client_jobs[i].state = CLIENT_WAITING;
+		client_jobs[i].failure = 0;
+	}
+
+	return client_added_job;
+}
+
+
+/**
+ * Run the poll loop until PrintPDF reports the end of one or more jobs, or
+ * a time limit passes.
+ *
+ * \param limit			The time by which PrintPDF must report.
+ * \return			TRUE if any jobs were reported; else FALSE.
+ */
+
+osbool client_wait_for_jobs(os_t limit)
+{
+	client_reports = 0;
+
+	while (client_reports == 0 && os_read_monotonic_time() - limit < 0)
+		hosted_poll(limit - os_read_monotonic_time());
+
+	return (client_reports > 0) ? TRUE : FALSE;
+}
+
+
+/**
+ * Return the state of a job added with client_add_job().  Once a job
+ * has ended, its state is returned once and then forgotten.
+ *
+ * \param job			The job ID.
+ * \param *failure		Pointer to a variable to take the failure code,
+ *				or NULL.
+ * \return			The state of the job.
+ */
+
+enum client_state client_get_job_state(int job, int *failure)
+{
+	enum client_state	state;
+	int			i;
+
+	for (i = 0; i < CLIENT_MAX_JOBS && (job == 0 || client_jobs[i].job != job); i++);
+
+	if (i >= CLIENT_MAX_JOBS)
+		return CLIENT_IDLE;
+
+	state = client_jobs[i].state;
+
+	if (failure != NULL)
+		*failure = client_jobs[i].failure;
+
+	if (state != CLIENT_WAITING)
+		client_jobs[i].job = 0;
+
+	return state;
+}
+
+
+/**
+ * Ask PrintPDF for the state of a job.
+ *
+ * \param job			The job ID.
+ * \return			The state of the job.
+ */
+
+enum client_job_state client_query_job(int job)
+{
+	client_control	control;
+
+	control.action = CLIENT_MESSAGE_CONTROL;
+	control.your_ref = 0;
+	control.reason = CLIENT_QUERY_JOB;
+	control.job.job = job;
+	control.job.state = 0;
+	control.job.failure = 0;
+
+	client_queried_state = CLIENT_JOB_UNKNOWN;
+
+	hosted_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, CLIENT_JOB_LENGTH, client_task, HOSTED_NO_TASK);
+	hosted_poll(0);
+	hosted_poll(0);
+
+	return client_queried_state;
+}
+
+
+/**
+ * Return the failure code reported by PrintPDF for the last conversion.
+ *
+ * \return			The failure code, or 0 if none was reported.
+ */
+
+int client_get_failure(void)
+{
+	return client_failure;
+}
+
+
+/**
+ * Handle messages sent to the client by PrintPDF.
+ *
+ * \param event			The Wimp event code for the message.
+ * \param *message		The message.
+ * \param *data			Unused.
+ */
+
+static void client_message_handler(wimp_event_no event, wimp_message *message, void *data)
+{
+	client_control	*control = (client_control *) message;
+	int		i;
+
+	if (message->action != CLIENT_MESSAGE_CONTROL || event == wimp_USER_MESSAGE_ACKNOWLEDGE)
+		return;
+
+	switch (control->reason) {
+	case CLIENT_REPORT_SUCCESS:
+		client_state = CLIENT_SUCCEEDED;
+		break;
+
+	case CLIENT_REPORT_FAILURE:
+		client_failure = control->failure;
+		client_state = CLIENT_FAILED;
+		break;
+
+	case CLIENT_REPORT_JOB_ADDED:
+		client_added_job = control->job.job;
+		break;
+
+	case CLIENT_REPORT_JOB:
+		client_queried_state = control->job.state;
+		break;
+
+	case CLIENT_REPORT_JOBS_ENDED:
+		for (i = 0; i < control->ended.count && i < 16; i++)
+			client_end_job(&(control->ended.jobs[i]));
+		break;
+
+	case CLIENT_REPORT_PROGRESS:
+		if (client_verbose)
+			printf("Job %d: page %d of %d, %d of %d bytes, %d cs left\n", control->progress.job,
+					control->progress.pages_done, control->progress.pages_total,
+					control->progress.bytes_in, control->progress.bytes_total, control->progress.time_left);
+		break;
+	}
+}
+
+
+/**
+ * Record the end of a job reported by PrintPDF.
+ *
+ * \param *report		The report of the job.
+ */
+
+static void client_end_job(struct client_report *report)
+{
+	int	i;
+
+	client_reports++;
+
+	for (i = 0; i < CLIENT_MAX_JOBS; i++) {
+		if (client_jobs[i].job != report->job)
+			continue;
+
+		client_jobs[i].state = (report->state == CLIENT_JOB_DONE) ? CLIENT_SUCCEEDED : CLIENT_FAILED;
+		client_jobs[i].failure = (report->state == CLIENT_JOB_DONE) ? 0 : report->failure;
+	}
+}
+
+
+/**
+ * Send a control message to PrintPDF.
+ *
+ * \param reason		The reason code to send.
+ * \param *filename		The filename to send, or NULL for none.
+ * \param *profile		The profile name to send before the filename,
+ *				or NULL for none.
+ */
+
+static void client_send(enum client_reason reason, char *filename, char *profile)
+{
+	client_control	control;
+	int		size = CLIENT_BASIC_LENGTH;
+
+	control.action = CLIENT_MESSAGE_CONTROL;
+	control.your_ref = 0;
+	control.reason = reason;
+
+	if (profile != NULL) {
+		string_copy(control.profile_job.profile, profile, sizeof(control.profile_job.profile));
+		string_copy(control.profile_job.filename, (filename != NULL) ? filename : "", sizeof(control.profile_job.filename));
+		size = (CLIENT_BASIC_LENGTH + sizeof(control.profile_job.profile) + strlen(control.profile_job.filename) + 4) & ~3;
+	} else if (filename != NULL) {
+		string_copy(control.filename, filename, sizeof(control.filename));
+		size = (CLIENT_BASIC_LENGTH + strlen(control.filename) + 4) & ~3;
+	}
+
+	hosted_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, size, client_task, HOSTED_NO_TASK);
+}
+
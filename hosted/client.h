@@ -0,0 +1,155 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: client.h
+ *
+ * Hosted control API client implementation.
+ */
+
+#ifndef PRINTPDF_CLIENT
+#define PRINTPDF_CLIENT
+
+#include "oslib/os.h"
+
+/**
+ * The states that a client's conversion can be in.
+ */
+
+enum client_state {
+	CLIENT_IDLE,					/**< No conversion has been requested.			*/
+	CLIENT_WAITING,					/**< Waiting for PrintPDF to report.			*/
+	CLIENT_SUCCEEDED,				/**< The conversion succeeded.				*/
+	CLIENT_FAILED,					/**< The conversion, or the request, failed.		*/
+	CLIENT_TIMED_OUT				/**< PrintPDF didn't report in time.			*/
+};
+
+/**
+ * The states of a job, as reported by PrintPDF.
+ */
+
+enum client_job_state {
+	CLIENT_JOB_UNKNOWN = 0,				/**< PrintPDF doesn't know the job.			*/
+	CLIENT_JOB_QUEUED = 1,				/**< The job is waiting for a print job.		*/
+	CLIENT_JOB_CONVERTING = 2,			/**< The job is being converted.			*/
+	CLIENT_JOB_DONE = 3,				/**< The job was converted.				*/
+	CLIENT_JOB_FAILED = 4				/**< The job's conversion failed.			*/
+};
+
+
+/**
+ * Register the client with the hosted environment.
+ *
+ * \param verbose		TRUE to report progress on stdout; else FALSE.
+ */
+
+void client_initialise(osbool verbose);
+
+
+/**
+ * Ask PrintPDF to save the next conversion to a file, without showing the
+ * Save PDF dialogue.
+ *
+ * \param *filename		The file to save the PDF to.
+ * \return			TRUE if PrintPDF accepted the filename; else FALSE.
+ */
+
+osbool client_set_filename(char *filename);
+
+
+/**
+ * Ask PrintPDF to stop saving conversions to the client's file.
+ */
+
+void client_clear_filename(void);
+
+
+/**
+ * Ask PrintPDF to save a future conversion to a file, without showing the
+ * Save PDF dialogue.  Unlike client_set_filename(), any number of jobs can
+ * be outstanding at once.
+ *
+ * \param *filename		The file to save the PDF to.
+ * \param *profile		The settings profile to convert the job with,
+ *				or NULL to use PrintPDF's current settings.
+ * \return			The job ID, or 0 if PrintPDF refused the job.
+ */
+
+int client_add_job(char *filename, char *profile);
+
+
+/**
+ * Run the poll loop until PrintPDF reports the end of one or more jobs, or
+ * a time limit passes.
+ *
+ * \param limit			The time by which PrintPDF must report.
+ * \return			TRUE if any jobs were reported; else FALSE.
+ */
+
+osbool client_wait_for_jobs(os_t limit);
+
+
+/**
+ * Return the state of a job added with client_add_job().  Once a job
+ * has ended, its state is returned once and then forgotten.
+ *
+ * \param job			The job ID.
+ * \param *failure		Pointer to a variable to take the failure code,
+ *				or NULL.
+ * \return			The state of the job.
+ */
+
+enum client_state client_get_job_state(int job, int *failure);
+
+
+/**
+ * Ask PrintPDF for the state of a job.
+ *
+ * \param job			The job ID.
+ * \return			The state of the job.
+ */
+
+enum client_job_state client_query_job(int job);
+
+
+/**
+ * Run the poll loop until PrintPDF reports the outcome of the conversion,
+ * or a time limit passes.
+ *
+ * \param limit			The time by which PrintPDF must report.
+ * \return			The state of the conversion.
+ */
+
+enum client_state client_wait(os_t limit);
+
+
+/**
+ * Return the failure code reported by PrintPDF for the last conversion.
+ *
+ * \return			The failure code, or 0 if none was reported.
+ */
+
+int client_get_failure(void);
+
+#endif
+
@@ -0,0 +1,364 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: fakegs.c
+ *
+ * A stand-in for gs, for exercising the hosted build without Ghostscript.
+ *
+ * The command line, including any \@file arguments, is read in the way that
+ * gs reads it.  Each input file is scanned for pages -- DSC page comments
+ * in PostScript, or page objects in PDF -- and if the PostScript passed
+ * with -c sets up PrintPDF's page hook, a page mark is written for each.
+ * A minimal, valid, PDF with the same number of pages is then written to
+ * the output file, before PrintPDF's completion mark is written if it was
+ * requested.
+ *
+ * Setting FAKEGS_DELAY to a number of centiseconds makes each page take
+ * that long to convert, and FAKEGS_START_DELAY adds a fixed delay before
+ * the first page as gs's start-up would.  An input containing a line
+ * starting with the FAKEGS_ERROR_MARK comment fails with a PostScript
+ * error.
+ */
+
+/* ANSI C header files */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/**
+ * The maximum number of arguments, after expanding \@files.
+ */
+
+#define FAKEGS_MAX_ARGS 1024
+
+/**
+ * The maximum length of an argument.
+ */
+
+#define FAKEGS_MAX_ARG 4096
+
+/**
+ * The mark written for each page, which matches PROGRESS_PAGE_MARK.
+ */
+
+#define FAKEGS_PAGE_MARK "PrintPDF:Page"
+
+/**
+ * The mark written on completion, which matches CONVERT_DONE_MARK.
+ */
+
+#define FAKEGS_DONE_MARK "PrintPDF:Done"
+
+/**
+ * The comment which causes an input to fail.
+ */
+
+#define FAKEGS_ERROR_MARK "%%FakeGSError"
+
+
+/* Function Prototypes. */
+
+static int fakegs_read_args(int argc, char *argv[]);
+static int fakegs_read_arg_file(char *filename);
+static int fakegs_add_arg(char *arg);
+static int fakegs_count_pages(char *filename);
+static int fakegs_write_pdf(char *filename, int pages);
+static void fakegs_delay(int centiseconds);
+
+
+/**
+ * The arguments, with any \@files expanded.
+ */
+
+static char *fakegs_args[FAKEGS_MAX_ARGS];
+
+/**
+ * The number of arguments.
+ */
+
+static int fakegs_arg_count = 0;
+
+
+/**
+ * Run the stand-in.
+ */
+
+int main(int argc, char *argv[])
+{
+	char	*output = NULL, *delay;
+	int	i, pages, total = 0, page_hook = 0, done_hook = 0, in_code = 0, page_delay = 0;
+
+	if (!fakegs_read_args(argc, argv))
+		return 1;
+
+	delay = getenv("FAKEGS_DELAY");
+	if (delay != NULL)
+		page_delay = atoi(delay);
+
+	delay = getenv("FAKEGS_START_DELAY");
+	if (delay != NULL)
+		fakegs_delay(atoi(delay));
+
+	for (i = 0; i < fakegs_arg_count; i++) {
+		if (strcmp(fakegs_args[i], "-c") == 0) {
+			in_code = 1;
+		} else if (strcmp(fakegs_args[i], "-f") == 0) {
+			in_code = 0;
+		} else if (in_code) {
+			if (strstr(fakegs_args[i], FAKEGS_PAGE_MARK) != NULL)
+				page_hook = 1;
+			else if (strstr(fakegs_args[i], FAKEGS_DONE_MARK) != NULL)
+				done_hook = 1;
+		} else if (strncmp(fakegs_args[i], "-sOutputFile=", 13) == 0) {
+			output = fakegs_args[i] + 13;
+		} else if (strcmp(fakegs_args[i], "-") == 0) {
+			printf("Error: reading from stdin is not supported\n");
+			return 1;
+		} else if (*fakegs_args[i] != '-') {
+			pages = fakegs_count_pages(fakegs_args[i]);
+
+			if (pages == -1) {
+				printf("Error: /undefinedfilename in (%s)\n", fakegs_args[i]);
+				return 1;
+			} else if (pages < 0) {
+				printf("Error: /syntaxerror in --execute--\n");
+				return 1;
+			}
+
+			while (pages-- > 0) {
+				fakegs_delay(page_delay);
+
+				if (page_hook)
+					printf("%s\n", FAKEGS_PAGE_MARK);
+
+				total++;
+			}
+
+			fflush(stdout);
+		}
+	}
+
+	if (output == NULL) {
+		printf("Error: no output file given\n");
+		return 1;
+	}
+
+	if (!fakegs_write_pdf(output, (total > 0) ? total : 1)) {
+		printf("Error: /invalidfileaccess in (%s)\n", output);
+		return 1;
+	}
+
+	if (done_hook)
+		printf("%s\n", FAKEGS_DONE_MARK);
+
+	return 0;
+}
+
+
+/**
+ * Read the command line, expanding any \@files.
+ *
+ * \param argc			The number of command line arguments.
+ * \param *argv[]		The command line arguments.
+ * \return			1 if successful; else 0.
+ */
+
+static int fakegs_read_args(int argc, char *argv[])
+{
+	int	i;
+
+	for (i = 1; i < argc; i++) {
+		if (*argv[i] == '@') {
+			if (!fakegs_read_arg_file(argv[i] + 1))
+				return 0;
+		} else if (!fakegs_add_arg(argv[i])) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+
+/**
+ * Read the arguments from an \@file, which are separated by white space.
+ *
+ * \param *filename		The file to read.
+ * \return			1 if successful; else 0.
+ */
+
+static int fakegs_read_arg_file(char *filename)
+{
+	FILE	*in;
+	char	arg[FAKEGS_MAX_ARG];
+	int	result = 1;
+
+	in = fopen(filename, "r");
+	if (in == NULL) {
+		printf("Error: unable to open @file %s\n", filename);
+		return 0;
+	}
+
+	while (result && fscanf(in, "%4095s", arg) == 1)
+		result = fakegs_add_arg(arg);
+
+	fclose(in);
+
+	return result;
+}
+
+
+/**
+ * Add an argument to the list.
+ *
+ * \param *arg			The argument to add.
+ * \return			1 if successful; else 0.
+ */
+
+static int fakegs_add_arg(char *arg)
+{
+	if (fakegs_arg_count >= FAKEGS_MAX_ARGS || (fakegs_args[fakegs_arg_count] = strdup(arg)) == NULL) {
+		printf("Error: too many arguments\n");
+		return 0;
+	}
+
+	fakegs_arg_count++;
+
+	return 1;
+}
+
+
+/**
+ * Count the pages in an input file.
+ *
+ * \param *filename		The file to scan.
+ * \return			The number of pages, -1 if the file can't be read, or
+ *				-2 if it contains the error mark.
+ */
+
+static int fakegs_count_pages(char *filename)
+{
+	FILE	*in;
+	char	line[1024];
+	int	pages = 0, showpages = 0;
+
+	in = fopen(filename, "r");
+	if (in == NULL)
+		return -1;
+
+	while (fgets(line, sizeof(line), in) != NULL) {
+		if (strncmp(line, FAKEGS_ERROR_MARK, strlen(FAKEGS_ERROR_MARK)) == 0) {
+			fclose(in);
+			return -2;
+		} else if (strncmp(line, "%%Page:", 7) == 0 || strstr(line, "/Type /Page ") != NULL) {
+			pages++;
+		}
+		else if (strstr(line, "showpage") != NULL)
+			showpages++;
+	}
+
+	fclose(in);
+
+	return (pages > 0) ? pages : showpages;
+}
+
+
+/**
+ * Write a minimal PDF, with a blank page for each page converted.
+ *
+ * \param *filename		The file to write.
+ * \param pages			The number of pages to write.
+ * \return			1 if successful; else 0.
+ */
+
+static int fakegs_write_pdf(char *filename, int pages)
+{
+	FILE	*out;
+	long	*offsets, xref;
+	int	i, objects;
+
+	/* Object 1 is the catalogue, 2 the page tree, and the pages follow. */
+
+	objects = pages + 3;
+
+	offsets = calloc(objects, sizeof(long));
+	if (offsets == NULL)
+		return 0;
+
+	out = fopen(filename, "wb");
+	if (out == NULL) {
+		free(offsets);
+		return 0;
+	}
+
+	fprintf(out, "%%PDF-1.4\n");
+
+	offsets[1] = ftell(out);
+	fprintf(out, "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+
+	offsets[2] = ftell(out);
+	fprintf(out, "2 0 obj\n<< /Type /Pages /Count %d /Kids [", pages);
+	for (i = 0; i < pages; i++)
+		fprintf(out, " %d 0 R", i + 3);
+	fprintf(out, " ] >>\nendobj\n");
+
+	for (i = 0; i < pages; i++) {
+		offsets[i + 3] = ftell(out);
+		fprintf(out, "%d 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 595 842] >>\nendobj\n", i + 3);
+	}
+
+	xref = ftell(out);
+	fprintf(out, "xref\n0 %d\n0000000000 65535 f \n", objects);
+	for (i = 1; i < objects; i++)
+		fprintf(out, "%010ld 00000 n \n", offsets[i]);
+
+	fprintf(out, "trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%ld\n%%%%EOF\n", objects, xref);
+
+	free(offsets);
+
+	return (fclose(out) == 0) ? 1 : 0;
+}
+
+
+/**
+ * Wait for a while, to simulate the time taken to convert a page.
+ *
+ * \param centiseconds		The time to wait.
+ */
+
+static void fakegs_delay(int centiseconds)
+{
+	struct timespec	delay;
+
+	if (centiseconds <= 0)
+		return;
+
+	delay.tv_sec = centiseconds / 100;
+	delay.tv_nsec = (centiseconds % 100) * 10000000L;
+
+	nanosleep(&delay, NULL);
+}
+
@@ -0,0 +1,566 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: hosted.c
+ *
+ * Hosted environment implementation.
+ *
+ * The hosted environment takes the place of the Wimp and of main.c when
+ * the conversion core is built for a POSIX system.  Tasks are just
+ * handles; messages sent between them are queued and delivered from
+ * hosted_poll(), so that -- as in the desktop -- a message handler never
+ * sees the replies to its own messages before it has returned.
+ *
+ * RISC OS filenames are used as they stand, so the working files in the
+ * hosted configuration end up with names like "/tmp/work/queue.Job": the
+ * '.' separators are simply part of the Unix leafnames.
+ */
+
+/* ANSI C header files */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+#include "oslib/osspriteop.h"
+#include "oslib/wimp.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/event.h"
+#include "sflib/msgs.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "hosted.h"
+
+#include "api.h"
+#include "cache.h"
+#include "choices.h"
+#include "convert.h"
+#include "encrypt.h"
+#include "main.h"
+#include "notify.h"
+#include "optimize.h"
+#include "paper.h"
+#include "pdfmark.h"
+#include "popup.h"
+#include "process.h"
+#include "server.h"
+#include "watcher.h"
+
+
+/**
+ * The number of messages which can be waiting for delivery.
+ */
+
+#define HOSTED_MAX_MESSAGES 256
+
+/**
+ * The size of the block used to hold a queued message.
+ */
+
+#define HOSTED_MESSAGE_BLOCK 512
+
+/**
+ * The size of a message header on RISC OS, which message sizes include.
+ */
+
+#define HOSTED_RISCOS_HEADER 20
+
+/**
+ * The number of client tasks which can be registered.
+ */
+
+#define HOSTED_MAX_TASKS 8
+
+/**
+ * The longest that the poll loop will wait, in centiseconds.
+ */
+
+#define HOSTED_MAX_WAIT 100
+
+/**
+ * The length of a work file name.
+ */
+
+#define HOSTED_MAX_FILENAME 1024
+
+
+/**
+ * A message waiting to be delivered.
+ */
+
+struct hosted_message {
+	wimp_event_no		event;				/**< The Wimp event code for the message.		*/
+	wimp_t			to;				/**< The destination task, or 0 to broadcast.		*/
+	union {
+		wimp_message	message;			/**< The message, as a Wimp message.			*/
+		byte		block[HOSTED_MESSAGE_BLOCK];	/**< The message, as a raw block.			*/
+	};
+};
+
+/**
+ * A registered client task.
+ */
+
+struct hosted_task {
+	wimp_t			handle;				/**< The task's handle.					*/
+	hosted_message_handler	handler;			/**< The task's message handler.			*/
+	void			*data;				/**< Data to pass to the handler.			*/
+};
+
+
+/* Function Prototypes. */
+
+static void hosted_initialise_config(char *work_dir);
+static char *hosted_work_file(char *work_dir, char *leaf);
+static void hosted_deliver_messages(void);
+static void hosted_deliver_message(struct hosted_message *message);
+
+
+/**
+ * PrintPDF's task handle, which is normally held by main.c.
+ */
+
+wimp_t main_task_handle = HOSTED_NO_TASK;
+
+/**
+ * PrintPDF's quit flag, which is normally held by main.c.
+ */
+
+int main_quit_flag = FALSE;
+
+/**
+ * PrintPDF's sprite area, which is normally held by main.c.  The hosted
+ * build has no sprites.
+ */
+
+osspriteop_area *main_wimp_sprites = NULL;
+
+/**
+ * The messages waiting to be delivered, as a ring.
+ */
+
+static struct hosted_message hosted_messages[HOSTED_MAX_MESSAGES];
+
+/**
+ * The index of the first message waiting in the ring.
+ */
+
+static int hosted_message_head = 0;
+
+/**
+ * The number of messages waiting in the ring.
+ */
+
+static int hosted_message_count = 0;
+
+/**
+ * The next my_ref to be given to a message.
+ */
+
+static int hosted_next_ref = 1;
+
+/**
+ * The registered client tasks.
+ */
+
+static struct hosted_task hosted_tasks[HOSTED_MAX_TASKS];
+
+/**
+ * The number of registered client tasks.
+ */
+
+static int hosted_task_count = 0;
+
+/**
+ * The next task handle to be allocated.
+ */
+
+static unsigned hosted_next_task = HOSTED_TASK_BASE;
+
+
+/**
+ * Initialise the hosted environment and PrintPDF's configuration, placing
+ * all of the working files in the given directory.
+ *
+ * \param *work_dir		The directory to hold the working files.
+ * \param *messages		The Messages file to use, or NULL for none.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+osbool hosted_initialise(char *work_dir, char *messages)
+{
+	if (work_dir == NULL || (mkdir(work_dir, 0777) != 0 && errno != EEXIST))
+		return FALSE;
+
+	if (messages != NULL)
+		msgs_initialise(messages);
+
+	main_task_handle = hosted_allocate_task();
+
+	config_initialise("PrintPDF", "PrintPDF", work_dir);
+	hosted_initialise_config(work_dir);
+
+	/* Initialise the modules which make up the conversion core, in the order used by main.c. */
+
+	popup_initialise();
+	encrypt_initialise();
+	optimize_initialise();
+	pdfmark_initialise();
+	paper_initialise();
+	cache_initialise();
+	convert_initialise();
+	watcher_initialise();
+
+	return TRUE;
+}
+
+
+/**
+ * Set up PrintPDF's configuration, with the defaults used by main.c except
+ * where they refer to RISC OS locations.
+ *
+ * Preprocessing and the job server both rely on PipeFS, so neither is
+ * available in the hosted build.
+ *
+ * \param *work_dir		The directory to hold the working files.
+ */
+
+static void hosted_initialise_config(char *work_dir)
+{
+	config_str_init("FileQueue", hosted_work_file(work_dir, "queue"));
+	config_str_init("ParamFile", hosted_work_file(work_dir, "params"));
+	config_str_init("PDFMarkFile", hosted_work_file(work_dir, "pdfmark"));
+	config_str_init("PreProcessFile", hosted_work_file(work_dir, "inter"));
+	config_str_init("FileName", hosted_work_file(work_dir, "PrintPDF.pdf"));
+	config_int_init("PollDelay", 500);
+	config_int_init("PollMinDelay", 10);
+	config_int_init("PDFMakerCheck", 3000);
+	config_opt_init("StreamSpool", FALSE);
+	config_str_init("StreamPipe", hosted_work_file(work_dir, "stream"));
+	config_int_init("StreamChunk", 1024);
+	config_int_init("StreamBuffer", 2048);
+	config_int_init("PopUpTime", 200);
+	config_int_init("TaskMemory", 8192);
+	config_int_init("MaxConversions", 4);
+	config_opt_init("AdaptiveMemory", TRUE);
+	config_int_init("TaskMemoryMin", 4096);
+	config_int_init("TaskMemoryMax", 32768);
+	config_int_init("MemoryBudget", 0);
+	config_int_init("JobTimeout", 0);
+	config_int_init("StallTimeout", 0);
+	config_int_init("JobRetries", 2);
+	config_int_init("RetryDelay", 1000);
+	config_int_init("SplitPages", 0);
+	config_int_init("ProgressReport", 50);
+	config_str_init("CacheDir", hosted_work_file(work_dir, "cache"));
+	config_int_init("CacheSize", 8192);
+	config_opt_init("ServerMode", FALSE);
+	config_str_init("ServerJobFile", hosted_work_file(work_dir, "job"));
+	config_int_init("ServerJobs", 50);
+	config_int_init("ServerData", 64);
+	config_str_init("ProfileDir", hosted_work_file(work_dir, "profiles"));
+	config_str_init("BatchReport", hosted_work_file(work_dir, "report"));
+	config_int_init("PDFVersion", 0);
+	config_int_init("Optimization", 0);
+	config_opt_init("DownsampleMono", FALSE);
+	config_int_init("DownsampleMonoType", 0);
+	config_int_init("DownsampleMonoResolution", 300);
+	config_int_init("DownsampleMonoThreshold", 15);
+	config_int_init("DownsampleMonoDepth", -1);
+	config_opt_init("DownsampleGrey", FALSE);
+	config_int_init("DownsampleGreyType", 0);
+	config_int_init("DownsampleGreyResolution", 72);
+	config_int_init("DownsampleGreyThreshold", 15);
+	config_int_init("DownsampleGreyDepth", -1);
+	config_opt_init("DownsampleColour", FALSE);
+	config_int_init("DownsampleColourType", 0);
+	config_int_init("DownsampleColourResolution", 72);
+	config_int_init("DownsampleColourThreshold", 15);
+	config_int_init("DownsampleColourDepth", -1);
+	config_opt_init("EncodeMono", TRUE);
+	config_int_init("EncodeMonoType", 2);
+	config_opt_init("EncodeGrey", TRUE);
+	config_int_init("EncodeGreyType", 0);
+	config_opt_init("EncodeColour", TRUE);
+	config_int_init("EncodeColourType", 0);
+	config_int_init("AutoPageRotation", 2);
+	config_opt_init("CompressPages", TRUE);
+	config_str_init("OwnerPasswd", "");
+	config_str_init("UserPasswd", "");
+	config_opt_init("AllowPrint", TRUE);
+	config_opt_init("AllowFullPrint", TRUE);
+	config_opt_init("AllowExtraction", TRUE);
+	config_opt_init("AllowFullExtraction", TRUE);
+	config_opt_init("AllowForms", TRUE);
+	config_opt_init("AllowAnnotation", TRUE);
+	config_opt_init("AllowModifications", TRUE);
+	config_opt_init("AllowAssembly", TRUE);
+	config_str_init("PDFMarkTitle", "");
+	config_str_init("PDFMarkAuthor", "");
+	config_str_init("PDFMarkSubject", "");
+	config_str_init("PDFMarkKeywords", "");
+	config_str_init("PDFMarkUserFile", "");
+	config_opt_init("PaperOverride", FALSE);
+	config_int_init("PaperPreset", -1);
+	config_int_init("PaperWidth", 29000);
+	config_int_init("PaperHeight", 21000);
+	config_int_init("PaperUnits", PAPER_UNITS_MM);
+	config_opt_init("PreProcess", FALSE);
+	config_opt_init("ResetParams", FALSE);
+	config_opt_init("IconBarIcon", FALSE);
+	config_opt_init("PopUpAfter", FALSE);
+}
+
+
+/**
+ * Build the name of a file in the work directory.  The name is returned
+ * in a shared buffer, so must be used before the next call.
+ *
+ * \param *work_dir		The work directory.
+ * \param *leaf			The leafname of the file.
+ * \return			Pointer to the filename.
+ */
+
+static char *hosted_work_file(char *work_dir, char *leaf)
+{
+	static char	filename[HOSTED_MAX_FILENAME];
+
+	string_printf(filename, HOSTED_MAX_FILENAME, "%s/%s", work_dir, leaf);
+
+	return filename;
+}
+
+
+/**
+ * Close the hosted environment down, stopping any child tasks.
+ */
+
+void hosted_terminate(void)
+{
+	server_terminate();
+	watcher_terminate();
+	process_terminate();
+}
+
+
+/**
+ * Register a client task, which can exchange messages with PrintPDF.
+ *
+ * \param *handler		The handler for messages sent to the task.
+ * \param *data			Data to pass to the handler.
+ * \return			The handle of the new task, or 0 on failure.
+ */
+
+wimp_t hosted_register_task(hosted_message_handler handler, void *data)
+{
+	struct hosted_task	*task;
+
+	if (hosted_task_count >= HOSTED_MAX_TASKS)
+		return HOSTED_NO_TASK;
+
+	task = &(hosted_tasks[hosted_task_count++]);
+
+	task->handle = hosted_allocate_task();
+	task->handler = handler;
+	task->data = data;
+
+	return task->handle;
+}
+
+
+/**
+ * Allocate a new task handle, without a message handler.
+ *
+ * \return			The new task handle.
+ */
+
+wimp_t hosted_allocate_task(void)
+{
+	return (wimp_t) (size_t) hosted_next_task++;
+}
+
+
+/**
+ * Queue a message for delivery, as if by Wimp_SendMessage.  The size,
+ * sender and my_ref fields are filled in.
+ *
+ * The message sizes used by the application are those of RISC OS, whose
+ * header is smaller than the one here, so the amount copied is adjusted
+ * to match.
+ *
+ * \param event			The Wimp event code for the message.
+ * \param *message		The message to send.
+ * \param size			The size of the message block.
+ * \param from			The task sending the message.
+ * \param to			The task to receive the message, or 0
+ *				to broadcast it.
+ * \return			The my_ref given to the message.
+ */
+
+int hosted_send_message(wimp_event_no event, wimp_message *message, int size, wimp_t from, wimp_t to)
+{
+	struct hosted_message	*queued;
+	size_t			length;
+
+	if (message == NULL || hosted_message_count >= HOSTED_MAX_MESSAGES)
+		return 0;
+
+	length = offsetof(wimp_message, data) + ((size > HOSTED_RISCOS_HEADER) ? size - HOSTED_RISCOS_HEADER : 0);
+	if (length > HOSTED_MESSAGE_BLOCK)
+		length = HOSTED_MESSAGE_BLOCK;
+
+	queued = &(hosted_messages[(hosted_message_head + hosted_message_count++) % HOSTED_MAX_MESSAGES]);
+
+	memset(queued->block, 0, HOSTED_MESSAGE_BLOCK);
+	memcpy(queued->block, message, length);
+
+	queued->event = event;
+	queued->to = to;
+	queued->message.size = size;
+	queued->message.sender = from;
+
+	/* Acknowledgements keep the reference of the message being acknowledged. */
+
+	if (event != wimp_USER_MESSAGE_ACKNOWLEDGE)
+		queued->message.my_ref = hosted_next_ref++;
+
+	message->my_ref = queued->message.my_ref;
+
+	return queued->message.my_ref;
+}
+
+
+/**
+ * Poll the hosted environment once: wait for child task activity until
+ * PrintPDF's next scheduled NULL event or the given limit, deliver any
+ * queued messages, and then run the NULL event processing.
+ *
+ * \param limit			The longest time to wait, in centiseconds.
+ */
+
+void hosted_poll(int limit)
+{
+	os_t	now, wait;
+	osbool	woken;
+
+	now = os_read_monotonic_time();
+	wait = watcher_next_poll_time() - now;
+
+	if (limit > HOSTED_MAX_WAIT)
+		limit = HOSTED_MAX_WAIT;
+
+	if (wait > limit)
+		wait = limit;
+
+	if (wait < 0 || hosted_message_count > 0)
+		wait = 0;
+
+	woken = process_poll(wait, notify_get_descriptor());
+
+	hosted_deliver_messages();
+
+	/* As in main_poll_loop(), NULL events only arrive once nothing else is waiting.  A change
+	 * reported by the spool watcher's backend brings the next one forward.
+	 */
+
+	now = os_read_monotonic_time();
+
+	if (hosted_message_count == 0 && (woken || now - watcher_next_poll_time() >= 0)) {
+		popup_test_and_close(now);
+		convert_pump_streams();
+		watcher_poll(now);
+		convert_check_for_pending_files();
+		convert_check_for_stalled_conversions();
+		api_send_notifications();
+	}
+}
+
+
+/**
+ * Deliver the messages which are waiting.  Any messages sent as a result
+ * are left for the next poll.
+ */
+
+static void hosted_deliver_messages(void)
+{
+	struct hosted_message	message;
+	int			count;
+
+	for (count = hosted_message_count; count > 0; count--) {
+		message = hosted_messages[hosted_message_head];
+
+		hosted_message_head = (hosted_message_head + 1) % HOSTED_MAX_MESSAGES;
+		hosted_message_count--;
+
+		hosted_deliver_message(&message);
+	}
+}
+
+
+/**
+ * Deliver a message to its destination: PrintPDF, a client task or a
+ * child task.  Broadcasts go to PrintPDF and every client.
+ *
+ * \param *message		The message to deliver.
+ */
+
+static void hosted_deliver_message(struct hosted_message *message)
+{
+	int	i;
+
+	if (message->to == HOSTED_NO_TASK || message->to == main_task_handle)
+		event_process_message(message->event, &(message->message));
+
+	for (i = 0; i < hosted_task_count; i++) {
+		if ((message->to == HOSTED_NO_TASK || message->to == hosted_tasks[i].handle) && hosted_tasks[i].handler != NULL)
+			hosted_tasks[i].handler(message->event, &(message->message), hosted_tasks[i].data);
+	}
+
+	if (message->to != HOSTED_NO_TASK && process_owns_task(message->to))
+		process_receive_message(&(message->message), message->to);
+}
+
+
+/**
+ * Report whether the Choices window is open, which it never is in the
+ * hosted build.
+ *
+ * \return			FALSE.
+ */
+
+osbool choices_window_is_open(void)
+{
+	return FALSE;
+}
+
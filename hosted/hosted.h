@@ -0,0 +1,126 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: hosted.h
+ *
+ * Hosted environment, standing in for the Wimp when the conversion core
+ * is built to run on a POSIX system.
+ */
+
+#ifndef PRINTPDF_HOSTED
+#define PRINTPDF_HOSTED
+
+#include "oslib/wimp.h"
+
+/**
+ * The handle of the first task created by the hosted environment.  Handles
+ * below this belong to nobody, so that messages sent to them vanish.
+ */
+
+#define HOSTED_TASK_BASE 0x100
+
+/**
+ * A task handle to be used for messages from the hosted environment itself.
+ */
+
+#define HOSTED_NO_TASK ((wimp_t) 0)
+
+
+/**
+ * A handler for messages delivered to a hosted client task.
+ *
+ * \param event			The Wimp event code for the message.
+ * \param *message		The message being delivered.
+ * \param *data			The data given when the task was registered.
+ */
+
+typedef void (*hosted_message_handler)(wimp_event_no event, wimp_message *message, void *data);
+
+
+/**
+ * Initialise the hosted environment and PrintPDF's configuration, placing
+ * all of the working files in the given directory.
+ *
+ * \param *work_dir		The directory to hold the working files.
+ * \param *messages		The Messages file to use, or NULL for none.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+osbool hosted_initialise(char *work_dir, char *messages);
+
+
+/**
+ * Close the hosted environment down, stopping any child tasks.
+ */
+
+void hosted_terminate(void);
+
+
+/**
+ * Register a client task, which can exchange messages with PrintPDF.
+ *
+ * \param *handler		The handler for messages sent to the task.
+ * \param *data			Data to pass to the handler.
+ * \return			The handle of the new task, or 0 on failure.
+ */
+
+wimp_t hosted_register_task(hosted_message_handler handler, void *data);
+
+
+/**
+ * Allocate a new task handle, without a message handler.
+ *
+ * \return			The new task handle.
+ */
+
+wimp_t hosted_allocate_task(void);
+
+
+/**
+ * Queue a message for delivery, as if by Wimp_SendMessage.  The size,
+ * sender and my_ref fields are filled in.
+ *
+ * \param event			The Wimp event code for the message.
+ * \param *message		The message to send.
+ * \param size			The size of the message block.
+ * \param from			The task sending the message.
+ * \param to			The task to receive the message, or 0
+ *				to broadcast it.
+ * \return			The my_ref given to the message.
+ */
+
+int hosted_send_message(wimp_event_no event, wimp_message *message, int size, wimp_t from, wimp_t to);
+
+
+/**
+ * Poll the hosted environment once: wait for child task activity until
+ * PrintPDF's next scheduled NULL event or the given limit, deliver any
+ * queued messages, and then run the NULL event processing.
+ *
+ * \param limit			The longest time to wait, in centiseconds.
+ */
+
+void hosted_poll(int limit);
+
+#endif
+
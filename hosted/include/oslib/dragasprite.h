@@ -0,0 +1,47 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: dragasprite.h
+ *
+ * Hosted shim for the OSLib DragASprite interface.
+ */
+
+#ifndef HOSTED_OSLIB_DRAGASPRITE
+#define HOSTED_OSLIB_DRAGASPRITE
+
+#include "oslib/osspriteop.h"
+
+typedef bits dragasprite_flags;
+
+#define dragasprite_HPOS_CENTRE		0x1
+#define dragasprite_VPOS_CENTRE		0x4
+#define dragasprite_NO_BOUND		0x0
+#define dragasprite_BOUND_POINTER	0x40
+#define dragasprite_DROP_SHADOW		0x80
+
+void dragasprite_start(dragasprite_flags flags, osspriteop_area const *area, char const *name, os_box const *box, os_box const *bbox);
+void dragasprite_stop(void);
+
+#endif
+
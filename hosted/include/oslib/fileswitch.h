@@ -0,0 +1,45 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: fileswitch.h
+ *
+ * Hosted shim for the OSLib FileSwitch definitions.
+ */
+
+#ifndef HOSTED_OSLIB_FILESWITCH
+#define HOSTED_OSLIB_FILESWITCH
+
+#include "oslib/types.h"
+
+typedef int fileswitch_object_type;
+
+#define fileswitch_NOT_FOUND	0
+#define fileswitch_IS_FILE	1
+#define fileswitch_IS_DIR	2
+#define fileswitch_IS_IMAGE	3
+
+typedef bits fileswitch_attr;
+
+#endif
+
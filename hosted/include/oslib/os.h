@@ -0,0 +1,75 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: os.h
+ *
+ * Hosted shim for the OSLib OS interface.
+ */
+
+#ifndef HOSTED_OSLIB_OS
+#define HOSTED_OSLIB_OS
+
+#include "oslib/types.h"
+
+/**
+ * An OS error block.
+ */
+
+typedef struct {
+	bits		errnum;
+	char		errmess[252];
+} os_error;
+
+typedef int os_t;
+typedef int os_fw;
+typedef unsigned int os_var_type;
+
+typedef struct {
+	int		x0;
+	int		y0;
+	int		x1;
+	int		y1;
+} os_box;
+
+typedef struct {
+	int		x;
+	int		y;
+} os_coord;
+
+typedef byte os_date_and_time[5];
+
+#define os_MOVE_TO		0x04
+#define os_PLOT_TO		0x05
+#define os_PLOT_RECTANGLE	0x60
+
+os_t os_read_monotonic_time(void);
+void os_read_var_val_size(char const *var, int context, os_var_type var_type, int *used, int *context_out);
+os_error *xos_read_var_val(char const *var, char *value, int size, int context, os_var_type var_type, int *used, int *context_out, os_var_type *var_type_out);
+os_error *xos_cli(char const *command);
+void os_cli(char const *command);
+os_error *xos_swi_number_from_string(char const *swi_name, int *swi_no);
+void os_plot(int plot_code, int x, int y);
+
+#endif
+
@@ -0,0 +1,39 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: osargs.h
+ *
+ * Hosted shim for the OSLib OS_Args interface.
+ */
+
+#ifndef HOSTED_OSLIB_OSARGS
+#define HOSTED_OSLIB_OSARGS
+
+#include "oslib/os.h"
+
+os_error *xosargs_read_extw(os_fw file, int *ext);
+os_error *xosargs_set_ptrw(os_fw file, int ptr);
+
+#endif
+
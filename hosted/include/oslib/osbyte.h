@@ -0,0 +1,45 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: osbyte.h
+ *
+ * Hosted shim for the OSLib OS_Byte interface.
+ */
+
+#ifndef HOSTED_OSLIB_OSBYTE
+#define HOSTED_OSLIB_OSBYTE
+
+#include "oslib/os.h"
+
+#define osbyte_ALPHABET_NUMBER			0x47
+#define osbyte_IN_KEY				0x81
+#define osbyte_READ_CMOS			0xa1
+#define osbyte_CONFIGURE_DRAG_ASPRITE		0x1c
+#define osbyte_CONFIGURE_DRAG_ASPRITE_MASK	0x02
+
+int osbyte1(int op, int r1, int r2);
+int osbyte2(int op, int r1, int r2);
+
+#endif
+
@@ -0,0 +1,54 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: osfile.h
+ *
+ * Hosted shim for the OSLib OS_File interface.
+ */
+
+#ifndef HOSTED_OSLIB_OSFILE
+#define HOSTED_OSLIB_OSFILE
+
+#include "oslib/os.h"
+#include "oslib/fileswitch.h"
+
+#define osfile_TYPE_DATA	0xffd
+#define osfile_TYPE_TEXT	0xfff
+#define osfile_TYPE_OBEY	0xfeb
+#define osfile_TYPE_TEMPLATE	0xfec
+#define osfile_TYPE_POSTSCRIPT	0xff5
+
+os_error *xosfile_create(char const *file_name, bits load_addr, bits exec_addr, int size);
+os_error *xosfile_create_dir(char const *dir_name, int entry_count);
+void osfile_create_dir(char const *dir_name, int entry_count);
+os_error *xosfile_delete(char const *file_name, fileswitch_object_type *obj_type, bits *load_addr, bits *exec_addr, int *size, fileswitch_attr *attr);
+os_error *xosfile_read_no_path(char const *file_name, fileswitch_object_type *obj_type, bits *load_addr, bits *exec_addr, int *size, fileswitch_attr *attr);
+os_error *xosfile_read_stamped_no_path(char const *file_name, fileswitch_object_type *obj_type, bits *load_addr, bits *exec_addr, int *size, fileswitch_attr *attr, bits *file_type);
+fileswitch_object_type osfile_read_stamped_no_path(char const *file_name, bits *load_addr, bits *exec_addr, int *size, fileswitch_attr *attr, bits *file_type);
+fileswitch_object_type osfile_read_stamped(char const *file_name, bits *load_addr, bits *exec_addr, int *size, fileswitch_attr *attr, bits *file_type);
+os_error *xosfile_set_type(char const *file_name, bits file_type);
+void osfile_set_type(char const *file_name, bits file_type);
+
+#endif
+
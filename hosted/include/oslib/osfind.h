@@ -0,0 +1,46 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: osfind.h
+ *
+ * Hosted shim for the OSLib OS_Find interface.
+ */
+
+#ifndef HOSTED_OSLIB_OSFIND
+#define HOSTED_OSLIB_OSFIND
+
+#include "oslib/os.h"
+
+typedef bits osfind_flags;
+
+#define osfind_NO_PATH		0x3
+
+os_error *xosfind_openinw(osfind_flags flags, char const *file_name, char const *path, os_fw *file);
+os_error *xosfind_openoutw(osfind_flags flags, char const *file_name, char const *path, os_fw *file);
+os_error *xosfind_openupw(osfind_flags flags, char const *file_name, char const *path, os_fw *file);
+os_error *xosfind_closew(os_fw file);
+void osfind_closew(os_fw file);
+
+#endif
+
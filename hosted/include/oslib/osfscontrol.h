@@ -0,0 +1,46 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: osfscontrol.h
+ *
+ * Hosted shim for the OSLib OS_FSControl interface.
+ */
+
+#ifndef HOSTED_OSLIB_OSFSCONTROL
+#define HOSTED_OSLIB_OSFSCONTROL
+
+#include "oslib/os.h"
+
+typedef bits osfscontrol_copy_flags;
+typedef struct osfscontrol_descriptor osfscontrol_descriptor;
+
+#define osfscontrol_COPY_RECURSE	0x1
+#define osfscontrol_COPY_FORCE		0x2
+
+os_error *xosfscontrol_canonicalise_path(char const *path_name, char *buffer, char const *var, char const *path, int size, int *spare);
+os_error *xosfscontrol_copy(char const *from, char const *to, osfscontrol_copy_flags flags, bits start_load, bits start_exec, bits end_load, bits end_exec, osfscontrol_descriptor const *descriptor);
+os_error *xosfscontrol_rename(char const *source, char const *destination);
+
+#endif
+
@@ -0,0 +1,45 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: osgbpb.h
+ *
+ * Hosted shim for the OSLib OS_GBPB interface.
+ */
+
+#ifndef HOSTED_OSLIB_OSGBPB
+#define HOSTED_OSLIB_OSGBPB
+
+#include "oslib/os.h"
+
+typedef struct {
+	char	names[1];
+} osgbpb_string_list;
+
+os_error *xosgbpb_readw(os_fw file, byte *buffer, int size, int *unread);
+os_error *xosgbpb_writew(os_fw file, byte const *data, int size, int *unwritten);
+os_error *xosgbpb_dir_entries(char const *dir_name, osgbpb_string_list *buffer, int count, int context, int size,
+		char const *file_name, int *read_count, int *context_out);
+
+#endif
+
@@ -0,0 +1,43 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: taskwindow.h
+ *
+ * Hosted shim for the OSLib TaskWindow definitions.
+ */
+
+#ifndef HOSTED_OSLIB_TASKWINDOW
+#define HOSTED_OSLIB_TASKWINDOW
+
+#define message_TASK_WINDOW_INPUT	0x808c0
+#define message_TASK_WINDOW_OUTPUT	0x808c1
+#define message_TASK_WINDOW_EGO		0x808c2
+#define message_TASK_WINDOW_MORIO	0x808c3
+#define message_TASK_WINDOW_MORITE	0x808c4
+#define message_TASK_WINDOW_NEW_TASK	0x808c5
+#define message_TASK_WINDOW_SUSPEND	0x808c6
+#define message_TASK_WINDOW_RESUME	0x808c7
+
+#endif
+
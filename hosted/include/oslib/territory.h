@@ -0,0 +1,42 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: territory.h
+ *
+ * Hosted shim for the OSLib Territory interface.
+ */
+
+#ifndef HOSTED_OSLIB_TERRITORY
+#define HOSTED_OSLIB_TERRITORY
+
+#include "oslib/os.h"
+
+typedef int territory_t;
+
+#define territory_CURRENT	(-1)
+
+char *territory_convert_standard_date_and_time(territory_t territory, os_date_and_time const *date_and_time, char *buffer, int size);
+
+#endif
+
@@ -0,0 +1,432 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: wimp.h
+ *
+ * Hosted shim for the OSLib Wimp interface.  The types follow OSLib, so
+ * that the application's window handling code compiles; the calls which
+ * act on windows do nothing, while those which pass messages between
+ * tasks are backed by the hosted event loop.
+ */
+
+#ifndef HOSTED_OSLIB_WIMP
+#define HOSTED_OSLIB_WIMP
+
+#include "oslib/os.h"
+#include "oslib/osspriteop.h"
+
+typedef struct wimp_w_ *wimp_w;
+typedef struct wimp_t_ *wimp_t;
+typedef int wimp_i;
+typedef bits wimp_icon_flags;
+typedef bits wimp_window_flags;
+typedef bits wimp_menu_flags;
+typedef bits wimp_mouse_state;
+typedef byte wimp_colour;
+typedef int wimp_key_no;
+typedef int wimp_event_no;
+typedef bits wimp_drag_type;
+typedef bits wimp_auto_scroll_flags;
+typedef bits wimp_error_box_selection;
+typedef bits wimp_message_list;
+
+#define wimp_TOP			((wimp_w) -1)
+#define wimp_BOTTOM			((wimp_w) -2)
+#define wimp_ICON_WINDOW		((wimp_i) -1)
+#define wimp_ICON_BAR			((wimp_w) -2)
+
+#define wimp_ICON_TEXT			0x00000001u
+#define wimp_ICON_SPRITE		0x00000002u
+#define wimp_ICON_BORDER		0x00000004u
+#define wimp_ICON_HCENTRED		0x00000008u
+#define wimp_ICON_VCENTRED		0x00000010u
+#define wimp_ICON_FILLED		0x00000020u
+#define wimp_ICON_INDIRECTED		0x00000100u
+#define wimp_ICON_SELECTED		0x00200000u
+#define wimp_ICON_SHADED		0x00400000u
+#define wimp_ICON_DELETED		0x00800000u
+#define wimp_ICON_FG_COLOUR_SHIFT	24
+#define wimp_ICON_BG_COLOUR_SHIFT	28
+
+#define wimp_WINDOW_OPEN		0x00010000u
+
+#define wimp_COLOUR_WHITE		0
+#define wimp_COLOUR_LIGHT_GREY		2
+#define wimp_COLOUR_VERY_DARK_GREY	5
+#define wimp_COLOUR_BLACK		7
+
+#define wimp_CLICK_ADJUST		0x001u
+#define wimp_CLICK_MENU			0x002u
+#define wimp_CLICK_SELECT		0x004u
+#define wimp_DRAG_ADJUST		0x010u
+#define wimp_DRAG_SELECT		0x040u
+
+#define wimp_DRAG_USER_FIXED		7
+
+#define wimp_AUTO_SCROLL_ENABLE_VERTICAL	0x2u
+
+#define wimp_MENU_TICKED		0x001u
+#define wimp_MENU_SEPARATE		0x002u
+#define wimp_MENU_WRITABLE		0x004u
+#define wimp_MENU_GIVE_WARNING		0x008u
+#define wimp_MENU_LAST			0x080u
+#define wimp_NO_SUB_MENU		((wimp_menu *) -1)
+
+#define wimp_KEY_BACKSPACE		0x008
+#define wimp_KEY_RETURN			0x00d
+#define wimp_KEY_ESCAPE			0x01b
+#define wimp_KEY_DELETE			0x07f
+#define wimp_KEY_SHIFT			0x010
+#define wimp_KEY_CONTROL		0x020
+#define wimp_KEY_F12			0x1cc
+#define wimp_KEY_TAB			0x18a
+#define wimp_KEY_DOWN			0x18e
+#define wimp_KEY_UP			0x18f
+
+#define wimp_SCROLL_PAGE_LEFT		(-2)
+#define wimp_SCROLL_COLUMN_LEFT		(-1)
+#define wimp_SCROLL_COLUMN_RIGHT	1
+#define wimp_SCROLL_PAGE_RIGHT		2
+#define wimp_SCROLL_PAGE_DOWN		(-2)
+#define wimp_SCROLL_LINE_DOWN		(-1)
+#define wimp_SCROLL_LINE_UP		1
+#define wimp_SCROLL_PAGE_UP		2
+
+#define wimp_ERROR_BOX_SELECTED_NOTHING	0
+
+#define wimp_USER_MESSAGE		17
+#define wimp_USER_MESSAGE_RECORDED	18
+#define wimp_USER_MESSAGE_ACKNOWLEDGE	19
+
+#define message_QUIT			0x0
+#define message_DATA_SAVE		0x1
+#define message_DATA_SAVE_ACK		0x2
+#define message_DATA_LOAD		0x3
+#define message_DATA_LOAD_ACK		0x4
+#define message_PRE_QUIT		0x8
+#define message_MENU_WARNING		0x400c0
+#define message_TASK_CLOSE_DOWN		0x400c3
+#define message_TASK_INITIALISE		0x400c2
+
+typedef struct {
+	char			*text;
+	char			*validation;
+	int			size;
+} wimp_icon_indirected_text;
+
+typedef struct {
+	osspriteop_id		id;
+	osspriteop_area const	*area;
+	int			size;
+} wimp_icon_indirected_sprite;
+
+typedef union {
+	char					text[12];
+	char					sprite[12];
+	wimp_icon_indirected_text		indirected_text;
+	wimp_icon_indirected_sprite		indirected_sprite;
+	wimp_icon_indirected_text		indirected_text_and_sprite;
+} wimp_icon_data;
+
+typedef struct {
+	os_box			extent;
+	wimp_icon_flags		flags;
+	wimp_icon_data		data;
+} wimp_icon;
+
+typedef struct {
+	wimp_w			w;
+	wimp_icon		icon;
+} wimp_icon_create;
+
+typedef struct {
+	os_box			visible;
+	int			xscroll;
+	int			yscroll;
+	wimp_w			next;
+	wimp_window_flags	flags;
+	wimp_colour		title_fg;
+	wimp_colour		title_bg;
+	wimp_colour		work_fg;
+	wimp_colour		work_bg;
+	wimp_colour		scroll_outer;
+	wimp_colour		scroll_inner;
+	wimp_colour		highlight_bg;
+	wimp_colour		extra_flags;
+	os_box			extent;
+	wimp_icon_flags		title_flags;
+	bits			work_flags;
+	osspriteop_area const	*sprite_area;
+	short			xmin;
+	short			ymin;
+	wimp_icon_data		title_data;
+	int			icon_count;
+	wimp_icon		icons[1];
+} wimp_window;
+
+typedef struct {
+	wimp_w			w;
+	os_box			visible;
+	int			xscroll;
+	int			yscroll;
+	wimp_w			next;
+	wimp_window_flags	flags;
+	wimp_colour		title_fg;
+	wimp_colour		title_bg;
+	wimp_colour		work_fg;
+	wimp_colour		work_bg;
+	wimp_colour		scroll_outer;
+	wimp_colour		scroll_inner;
+	wimp_colour		highlight_bg;
+	wimp_colour		extra_flags;
+	os_box			extent;
+	wimp_icon_flags		title_flags;
+	bits			work_flags;
+	osspriteop_area const	*sprite_area;
+	short			xmin;
+	short			ymin;
+	wimp_icon_data		title_data;
+	int			icon_count;
+	wimp_icon		icons[1];
+} wimp_window_info;
+
+typedef struct {
+	wimp_w			w;
+	os_box			visible;
+	int			xscroll;
+	int			yscroll;
+	wimp_w			next;
+	wimp_window_flags	flags;
+} wimp_window_state;
+
+typedef struct {
+	wimp_w			w;
+	os_box			visible;
+	int			xscroll;
+	int			yscroll;
+	wimp_w			next;
+} wimp_open;
+
+typedef struct {
+	wimp_w			w;
+} wimp_close;
+
+typedef struct {
+	wimp_w			w;
+	os_box			box;
+	int			xscroll;
+	int			yscroll;
+	os_box			clip;
+} wimp_draw;
+
+typedef struct {
+	os_coord		pos;
+	wimp_mouse_state	buttons;
+	wimp_w			w;
+	wimp_i			i;
+} wimp_pointer;
+
+typedef struct {
+	os_box			final;
+} wimp_dragged;
+
+typedef struct {
+	wimp_w			w;
+	wimp_drag_type		type;
+	os_box			initial;
+	os_box			bbox;
+	void			*handle;
+	void			*draw;
+	void			*undraw;
+	void			*redraw;
+} wimp_drag;
+
+typedef struct {
+	wimp_w			w;
+	wimp_i			i;
+	os_coord		pos;
+	int			height;
+	int			index;
+} wimp_caret;
+
+typedef struct {
+	wimp_w			w;
+	wimp_i			i;
+	os_coord		pos;
+	int			height;
+	int			index;
+	wimp_key_no		c;
+} wimp_key;
+
+typedef struct {
+	wimp_w			w;
+	os_box			visible;
+	int			xscroll;
+	int			yscroll;
+	wimp_w			next;
+	int			xmin;
+	int			ymin;
+} wimp_scroll;
+
+typedef struct {
+	int			items[9];
+} wimp_selection;
+
+typedef struct {
+	wimp_w			w;
+	os_box			pause_zone_sizes;
+	int			pause_duration;
+	void			*state_change;
+	void			*handle;
+} wimp_auto_scroll_info;
+
+typedef struct wimp_menu wimp_menu;
+
+typedef struct {
+	wimp_menu_flags		menu_flags;
+	wimp_menu		*sub_menu;
+	wimp_icon_flags		icon_flags;
+	wimp_icon_data		data;
+} wimp_menu_entry;
+
+typedef union {
+	char				text[12];
+	wimp_icon_indirected_text	indirected_text;
+} wimp_menu_data;
+
+struct wimp_menu {
+	wimp_menu_data		title_data;
+	wimp_colour		title_fg;
+	wimp_colour		title_bg;
+	wimp_colour		work_fg;
+	wimp_colour		work_bg;
+	int			width;
+	int			height;
+	int			gap;
+	wimp_menu_entry		entries[1];
+};
+
+typedef struct {
+	wimp_menu_data		title_data;
+	wimp_colour		title_fg;
+	wimp_colour		title_bg;
+	wimp_colour		work_fg;
+	wimp_colour		work_bg;
+	int			width;
+	int			height;
+	int			gap;
+} wimp_menu_base;
+
+#define wimp_MESSAGE_HEADER_MEMBERS \
+	int			size; \
+	wimp_t			sender; \
+	int			my_ref; \
+	int			your_ref; \
+	bits			action;
+
+typedef struct {
+	wimp_w			w;
+	wimp_i			i;
+	os_coord		pos;
+	int			est_size;
+	bits			file_type;
+	char			file_name[212];
+} wimp_message_data_xfer;
+
+typedef struct {
+	wimp_menu		*sub_menu;
+	os_coord		pos;
+	wimp_selection		selection;
+} wimp_message_menu_warning;
+
+typedef struct {
+	wimp_MESSAGE_HEADER_MEMBERS
+	union {
+		wimp_message_data_xfer		data_xfer;
+		wimp_message_menu_warning	menu_warning;
+		byte				reserved[236];
+	} data;
+} wimp_message;
+
+typedef struct {
+	wimp_MESSAGE_HEADER_MEMBERS
+	wimp_w			w;
+	wimp_i			i;
+	os_coord		pos;
+	int			est_size;
+	bits			file_type;
+	char			file_name[212];
+} wimp_full_message_data_xfer;
+
+/* The Current Active Object is held as a word, so that the message body
+ * has the same layout as on RISC OS after the header.
+ */
+
+typedef struct {
+	wimp_MESSAGE_HEADER_MEMBERS
+	bits			cao;
+	int			slot_size;
+	char			task_name[228];
+} wimp_full_message_task_initialise;
+
+/* Window handling, which does nothing in the hosted build. */
+
+wimp_w wimp_create_window(wimp_window const *window);
+void wimp_delete_window(wimp_w w);
+void wimp_open_window(wimp_open *open);
+os_error *xwimp_open_window(wimp_open *open);
+void wimp_close_window(wimp_w w);
+osbool wimp_redraw_window(wimp_draw *draw);
+osbool wimp_get_rectangle(wimp_draw *draw);
+void wimp_get_window_state(wimp_window_state *state);
+os_error *xwimp_get_window_state(wimp_window_state *state);
+os_error *xwimp_get_window_info_header_only(wimp_window_info *info);
+void wimp_set_extent(wimp_w w, os_box const *box);
+os_error *xwimp_set_extent(wimp_w w, os_box const *box);
+void wimp_force_redraw(wimp_w w, int x0, int y0, int x1, int y1);
+void wimp_block_copy(wimp_w w, int x0, int y0, int x1, int y1, int x, int y);
+os_error *xwimp_force_redraw_title(wimp_w w);
+os_error *xwimp_create_icon(wimp_icon_create const *icon, wimp_i *i);
+void wimp_delete_icon(wimp_w w, wimp_i i);
+void wimp_set_icon_state(wimp_w w, wimp_i i, wimp_icon_flags eor_bits, wimp_icon_flags clear_bits);
+void wimp_plot_icon(wimp_icon const *icon);
+void wimp_set_colour(wimp_colour colour);
+void wimp_set_caret_position(wimp_w w, wimp_i i, int x, int y, int height, int index);
+os_error *xwimp_get_caret_position(wimp_caret *caret);
+void wimp_get_pointer_info(wimp_pointer *pointer);
+os_error *xwimp_get_pointer_info(wimp_pointer *pointer);
+void wimp_drag_box(wimp_drag const *drag);
+void wimp_auto_scroll(wimp_auto_scroll_flags flags, wimp_auto_scroll_info const *scroll);
+void wimp_create_menu(wimp_menu *menu, int x, int y);
+void wimp_create_sub_menu(wimp_menu *sub_menu, int x, int y);
+os_error *xwimp_slot_size(int new_curr_slot, int new_next_slot, int *curr_slot, int *next_slot, int *free_slot);
+
+/* Tasks and messages, which are backed by the hosted event loop. */
+
+os_error *xwimp_start_task(char const *command, wimp_t *handle);
+void wimp_send_message(wimp_event_no event, wimp_message *message, wimp_t to);
+os_error *xwimp_send_message(wimp_event_no event, wimp_message *message, wimp_t to);
+
+#endif
+
@@ -0,0 +1,63 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: config.h
+ *
+ * Hosted shim for the SFLib configuration interface, holding the
+ * options in memory.
+ */
+
+#ifndef HOSTED_SFLIB_CONFIG
+#define HOSTED_SFLIB_CONFIG
+
+#include <stdio.h>
+
+#include "oslib/types.h"
+
+#define sf_MAX_CONFIG_FILE_BUFFER 1024
+
+enum config_read_status {
+	sf_CONFIG_READ_EOF = 0,
+	sf_CONFIG_READ_NEW_SECTION,
+	sf_CONFIG_READ_TOKEN
+};
+
+typedef enum config_read_status config_read_status;
+
+osbool config_initialise(char *app_name, char *app_dir, char *app_path);
+osbool config_opt_init(char *name, osbool value);
+osbool config_opt_set(char *name, osbool value);
+osbool config_opt_read(char *name);
+osbool config_int_init(char *name, int value);
+osbool config_int_set(char *name, int value);
+int config_int_read(char *name);
+osbool config_str_init(char *name, char *value);
+osbool config_str_set(char *name, char *value);
+char *config_str_read(char *name);
+osbool config_read_opt_string(char *str);
+char *config_return_opt_string(osbool opt);
+enum config_read_status config_read_token_pair(FILE *file, char *token, char *value, char *section);
+
+#endif
+
@@ -0,0 +1,43 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: dataxfer.h
+ *
+ * Hosted shim for the SFLib data transfer interface.  Drags and saves
+ * to other tasks are unsupported in the hosted build.
+ */
+
+#ifndef HOSTED_SFLIB_DATAXFER
+#define HOSTED_SFLIB_DATAXFER
+
+#include "oslib/wimp.h"
+
+#define dataxfer_TYPE_PDF 0xadf
+#define dataxfer_TYPE_PRINTPDF 0x1d8
+
+void dataxfer_save_window_drag(wimp_w w, wimp_i i, void (*drag_end_callback)(wimp_pointer *, void *), void *drag_end_data);
+osbool dataxfer_start_save(wimp_pointer *pointer, char *name, int size, bits type, int your_ref, osbool (*save_callback)(char *filename, void *data), void *data);
+
+#endif
+
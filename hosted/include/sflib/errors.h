@@ -0,0 +1,42 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: errors.h
+ *
+ * Hosted shim for the SFLib errors interface, reporting to stderr.
+ */
+
+#ifndef HOSTED_SFLIB_ERRORS
+#define HOSTED_SFLIB_ERRORS
+
+#include "oslib/wimp.h"
+
+wimp_error_box_selection error_msgs_report_error(char *token);
+wimp_error_box_selection error_msgs_param_report_error(char *token, char *a, char *b, char *c, char *d);
+wimp_error_box_selection error_msgs_report_info(char *token);
+wimp_error_box_selection error_msgs_param_report_info(char *token, char *a, char *b, char *c, char *d);
+wimp_error_box_selection error_msgs_report_question(char *token, char *buttons);
+
+#endif
+
@@ -0,0 +1,67 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: event.h
+ *
+ * Hosted shim for the SFLib event interface.  Window events are never
+ * delivered in the hosted build, while message handlers are called by
+ * the hosted poll loop.
+ */
+
+#ifndef HOSTED_SFLIB_EVENT
+#define HOSTED_SFLIB_EVENT
+
+#include "oslib/wimp.h"
+
+enum event_message_type {
+	EVENT_MESSAGE_INCOMING = 0,
+	EVENT_MESSAGE_ACKNOWLEDGE
+};
+
+osbool event_add_message_handler(unsigned message, enum event_message_type type, osbool (*message_action)(wimp_message *message));
+osbool event_process_message(wimp_event_no event, wimp_message *message);
+
+osbool event_add_window_user_data(wimp_w w, void *data);
+void *event_get_window_user_data(wimp_w w);
+void event_delete_window(wimp_w w);
+osbool event_add_window_close_event(wimp_w w, void (*callback)(wimp_close *close));
+osbool event_add_window_redraw_event(wimp_w w, void (*callback)(wimp_draw *draw));
+osbool event_add_window_mouse_event(wimp_w w, void (*callback)(wimp_pointer *pointer));
+osbool event_add_window_key_event(wimp_w w, osbool (*callback)(wimp_key *key));
+osbool event_add_window_scroll_event(wimp_w w, void (*callback)(wimp_scroll *scroll));
+osbool event_add_window_gain_caret_event(wimp_w w, void (*callback)(wimp_caret *caret));
+osbool event_add_window_lose_caret_event(wimp_w w, void (*callback)(wimp_caret *caret));
+osbool event_add_window_menu(wimp_w w, wimp_menu *menu);
+osbool event_add_window_menu_prepare(wimp_w w, void (*callback)(wimp_w w, wimp_menu *m, wimp_pointer *pointer));
+osbool event_add_window_menu_selection(wimp_w w, void (*callback)(wimp_w w, wimp_menu *m, wimp_selection *selection));
+osbool event_add_window_menu_warning(wimp_w w, void (*callback)(wimp_w w, wimp_menu *m, wimp_message_menu_warning *warning));
+osbool event_add_window_menu_close(wimp_w w, void (*callback)(wimp_w w, wimp_menu *m));
+osbool event_add_window_icon_click(wimp_w w, wimp_i i, osbool (*callback)(wimp_pointer *pointer));
+osbool event_add_window_icon_radio(wimp_w w, wimp_i i, osbool complete);
+osbool event_add_window_icon_popup(wimp_w w, wimp_i i, wimp_menu *menu, int field, char *token);
+osbool event_set_drag_handler(void (*drag_end)(wimp_dragged *dragged, void *data), void (*drag_null_poll)(void *data), void *data);
+void event_set_menu_block(wimp_menu *menu);
+
+#endif
+
@@ -0,0 +1,41 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: general.h
+ *
+ * Hosted shim for the SFLib general interface.
+ */
+
+#ifndef HOSTED_SFLIB_GENERAL
+#define HOSTED_SFLIB_GENERAL
+
+#include "oslib/types.h"
+
+#define sf_WINDOW_GADGET_HEIGHT 44
+
+int general_mode_width(void);
+int general_mode_height(void);
+
+#endif
+
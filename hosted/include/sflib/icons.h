@@ -0,0 +1,55 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: icons.h
+ *
+ * Hosted shim for the SFLib icons interface, which keeps the text of
+ * each icon so that dialogues behave as they would in the desktop.
+ */
+
+#ifndef HOSTED_SFLIB_ICONS
+#define HOSTED_SFLIB_ICONS
+
+#include <stddef.h>
+
+#include "oslib/wimp.h"
+
+char *icons_get_indirected_text_addr(wimp_w w, wimp_i i);
+int icons_get_indirected_text_length(wimp_w w, wimp_i i);
+char *icons_copy_text(wimp_w w, wimp_i i, char *buffer, size_t length);
+char *icons_strncpy(wimp_w w, wimp_i i, char *s);
+int icons_printf(wimp_w w, wimp_i i, char *cntrl_string, ...);
+char *icons_msgs_lookup(wimp_w w, wimp_i i, char *token);
+void icons_set_selected(wimp_w w, wimp_i i, osbool selected);
+osbool icons_get_selected(wimp_w w, wimp_i i);
+void icons_set_shaded(wimp_w w, wimp_i i, osbool shaded);
+void icons_set_group_shaded(wimp_w w, osbool shaded, int icons, ...);
+void icons_set_group_shaded_when_off(wimp_w w, wimp_i i, int icons, ...);
+void icons_set_radio_group_selected(wimp_w w, int selected, int icons, ...);
+int icons_get_radio_group_selected(wimp_w w, int icons, ...);
+void icons_put_caret_at_end(wimp_w w, wimp_i i);
+void icons_replace_caret_in_window(wimp_w w);
+
+#endif
+
@@ -0,0 +1,43 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: ihelp.h
+ *
+ * Hosted shim for the SFLib interactive help interface.
+ */
+
+#ifndef HOSTED_SFLIB_IHELP
+#define HOSTED_SFLIB_IHELP
+
+#include "oslib/wimp.h"
+
+#define IHELP_INAME_LEN 64
+
+void ihelp_add_window(wimp_w window, char* name, void (*decode)(char *, wimp_w, wimp_i, os_coord, wimp_mouse_state));
+void ihelp_remove_window(wimp_w window);
+void ihelp_add_menu(wimp_menu *menu, char* name);
+void ihelp_remove_menu(wimp_menu *menu);
+
+#endif
+
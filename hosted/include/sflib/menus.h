@@ -0,0 +1,41 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: menus.h
+ *
+ * Hosted shim for the SFLib menus interface.
+ */
+
+#ifndef HOSTED_SFLIB_MENUS
+#define HOSTED_SFLIB_MENUS
+
+#include "oslib/wimp.h"
+
+wimp_menu *menus_create_standard_menu(wimp_menu *menu, wimp_pointer *pointer);
+int menus_get_entries(wimp_menu *menu);
+void menus_tick_entry(wimp_menu *menu, int entry, osbool tick);
+void menus_shade_entry(wimp_menu *menu, int entry, osbool shade);
+
+#endif
+
@@ -0,0 +1,45 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: saveas.h
+ *
+ * Hosted shim for the SFLib save dialogue interface.
+ */
+
+#ifndef HOSTED_SFLIB_SAVEAS
+#define HOSTED_SFLIB_SAVEAS
+
+#include "oslib/wimp.h"
+
+struct saveas_block;
+
+typedef struct saveas_block saveas_block;
+
+struct saveas_block *saveas_create_dialogue(osbool selection, char *sprite, osbool (*save_callback)(char *filename, osbool selection, void *data));
+void saveas_initialise_dialogue(struct saveas_block *handle, char *filename, char *default_name, char *selection_name, osbool selection, osbool selected, void *data);
+void saveas_prepare_dialogue(struct saveas_block *handle);
+void saveas_open_dialogue(struct saveas_block *handle, wimp_pointer *pointer);
+
+#endif
+
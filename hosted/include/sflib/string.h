@@ -0,0 +1,49 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: string.h
+ *
+ * Hosted shim for the SFLib string interface.
+ */
+
+#ifndef HOSTED_SFLIB_STRING
+#define HOSTED_SFLIB_STRING
+
+#include <stddef.h>
+
+#include "oslib/types.h"
+
+char *string_copy(char *dest, char *src, size_t len);
+char *string_ctrl_copy(char *dest, char *src, size_t len);
+char *string_ctrl_zero_terminate(char *s, size_t len);
+int string_printf(char *s, size_t len, char *cntrl_string, ...);
+int string_nocase_strcmp(char *s1, char *s2);
+char *string_find_leafname(char *filename);
+char *string_find_pathname(char *filename);
+char *string_find_extension(char *filename);
+char *string_strip_extension(char *filename);
+int string_convert_version_number(char *string);
+
+#endif
+
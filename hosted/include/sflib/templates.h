@@ -0,0 +1,42 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: templates.h
+ *
+ * Hosted shim for the SFLib templates interface.  Every template is
+ * an empty window with a generous supply of writable icons.
+ */
+
+#ifndef HOSTED_SFLIB_TEMPLATES
+#define HOSTED_SFLIB_TEMPLATES
+
+#include "oslib/wimp.h"
+
+wimp_window *templates_load_window(char *name);
+wimp_w templates_create_window(char *name);
+wimp_menu *templates_get_menu(char *name);
+void templates_link_menu_dialogue(char *name, wimp_w dialogue);
+
+#endif
+
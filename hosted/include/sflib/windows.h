@@ -0,0 +1,47 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: windows.h
+ *
+ * Hosted shim for the SFLib windows interface.  Windows are never
+ * visible in the hosted build.
+ */
+
+#ifndef HOSTED_SFLIB_WINDOWS
+#define HOSTED_SFLIB_WINDOWS
+
+#include "oslib/wimp.h"
+
+osbool windows_get_open(wimp_w w);
+void windows_open(wimp_w w);
+void windows_open_centred_on_screen(wimp_w w);
+void windows_open_centred_at_pointer(wimp_w w, wimp_pointer *p);
+void windows_open_transient_centred_at_pointer(wimp_w w, wimp_pointer *p);
+void windows_open_with_pane_centred_at_pointer(wimp_w w, wimp_w pane, wimp_i icon, int offset, wimp_pointer *p);
+void windows_open_nested_as_toolbar(wimp_w w, wimp_w parent, int height, osbool shaded);
+void windows_place_as_toolbar(wimp_window *window, wimp_window *toolbar, int height);
+void windows_redraw(wimp_w w);
+
+#endif
+
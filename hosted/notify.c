@@ -0,0 +1,171 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: notify.c
+ *
+ * Hosted spool watcher backend, using inotify.
+ *
+ * The spool file is created alongside the queue's own files, so the
+ * directory containing them is watched for files being written, moved
+ * in or deleted.  Any such event means that the spool location may have
+ * changed, and should be checked.  Other locations, such as those on
+ * PDFMaker$Path, aren't watched, and are left to the watcher's checks
+ * every PollDelay.
+ */
+
+/* ANSI C header files */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/debug.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "notify.h"
+
+#include "convert.h"
+
+
+/**
+ * The size of the buffer used to read events.
+ */
+
+#define NOTIFY_BUFFER_SIZE 4096
+
+
+/* Function Prototypes. */
+
+static osbool notify_initialise(void);
+static osbool notify_changed(void);
+static void notify_terminate(void);
+
+
+/**
+ * The inotify spool watcher backend.
+ */
+
+struct watcher_backend notify_backend = {
+	"inotify",
+	notify_initialise,
+	notify_changed,
+	notify_terminate
+};
+
+/**
+ * The inotify instance, or -1 if not in use.
+ */
+
+static int notify_descriptor = -1;
+
+
+/**
+ * Initialise the backend, watching the directory which holds the spool
+ * file.
+ *
+ * \return			TRUE if the backend is available; else FALSE.
+ */
+
+static osbool notify_initialise(void)
+{
+	char	spool[CONVERT_MAX_FILENAME];
+
+	convert_build_queue_filename(spool, CONVERT_MAX_FILENAME, CONVERT_QUEUE_FILENAME);
+	string_find_pathname(spool);
+
+	notify_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notify_descriptor < 0)
+		return FALSE;
+
+	if (inotify_add_watch(notify_descriptor, (*spool != '\0') ? spool : ".",
+			IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0) {
+		close(notify_descriptor);
+		notify_descriptor = -1;
+		return FALSE;
+	}
+
+	#ifdef DEBUG
+	debug_printf("Watching %s with inotify", spool);
+	#endif
+
+	return TRUE;
+}
+
+
+/**
+ * Test whether the spool location may have changed since the last call,
+ * by reading any events which are waiting.
+ *
+ * \return			TRUE if the spool location should be checked.
+ */
+
+static osbool notify_changed(void)
+{
+	char	buffer[NOTIFY_BUFFER_SIZE];
+	ssize_t	bytes;
+	osbool	changed = FALSE;
+
+	while ((bytes = read(notify_descriptor, buffer, NOTIFY_BUFFER_SIZE)) > 0 || (bytes < 0 && errno == EINTR)) {
+		if (bytes > 0)
+			changed = TRUE;
+	}
+
+	return changed;
+}
+
+
+/**
+ * Close the backend down.
+ */
+
+static void notify_terminate(void)
+{
+	if (notify_descriptor >= 0)
+		close(notify_descriptor);
+
+	notify_descriptor = -1;
+}
+
+
+/**
+ * Return the descriptor which becomes readable when the spool locations
+ * change, so that the poll loop can wait on it.
+ *
+ * \return			The descriptor, or -1 if the backend isn't in use.
+ */
+
+int notify_get_descriptor(void)
+{
+	return notify_descriptor;
+}
+
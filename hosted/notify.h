@@ -0,0 +1,51 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: notify.h
+ *
+ * Hosted spool watcher backend, using inotify.
+ */
+
+#ifndef PRINTPDF_NOTIFY
+#define PRINTPDF_NOTIFY
+
+#include "watcher.h"
+
+/**
+ * The inotify spool watcher backend.
+ */
+
+extern struct watcher_backend notify_backend;
+
+
+/**
+ * Return the descriptor which becomes readable when the spool locations
+ * change, so that the poll loop can wait on it.
+ *
+ * \return			The descriptor, or -1 if the backend isn't in use.
+ */
+
+int notify_get_descriptor(void);
+
+#endif
+
@@ -0,0 +1,634 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: outline.c
+ *
+ * Hosted bookmark outline benchmark.
+ *
+ * A synthetic bookmark file is written and loaded into the bookmark editor,
+ * and the full recalculation which follows loading the file is then timed on
+ * it, followed by a series of random edits made as the window would make
+ * them and the writing of the PDFMark data for the result.  The outlines come
+ * in three shapes:
+ *
+ *   flat	- every entry at the top level.
+ *   index	- entries nested up to -levels deep, in the way that an
+ *		  outline generated from a database index would be.
+ *   deep	- runs of entries each one level below the one before,
+ *		  up to -levels deep.
+ *
+ * With -check, the result of each recalculation and edit is compared against
+ * a direct walk of the outline.
+ *
+ * With -fuzz, the outline file is then damaged at random that many times, and
+ * each copy is loaded and checked.  The copy which failed is left in the work
+ * directory as "fuzz".
+ *
+ *   ppdfoutline [-work <dir>] [-messages <file>] [-entries <n>] [-shape <name>]
+ *               [-levels <n>] [-rebuilds <n>] [-edits <n>] [-check] [-fuzz <n>]
+ */
+
+/* ANSI C header files */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "hosted.h"
+
+#include "bookmark.h"
+
+
+/**
+ * The maximum length of a filename used by the benchmark.
+ */
+
+#define OUTLINE_MAX_FILENAME 1024
+
+/**
+ * The one in how many entries with children which are written contracted.
+ */
+
+#define OUTLINE_CONTRACTED 8
+
+/**
+ * The one in how many entries whose titles need escaping in PDFMark data.
+ */
+
+#define OUTLINE_ESCAPED 16
+
+/**
+ * The one in how many edits which expand or contract the whole outline.
+ */
+
+#define OUTLINE_EXPANSIONS 256
+
+/**
+ * The most changes made to each fuzzed copy of the outline.
+ */
+
+#define OUTLINE_FUZZ_MUTATIONS 8
+
+/**
+ * The longest span of bytes deleted or duplicated by a change.
+ */
+
+#define OUTLINE_FUZZ_SPAN 64
+
+/**
+ * The longest run of bytes inserted by a change.
+ */
+
+#define OUTLINE_FUZZ_RUN 2048
+
+/**
+ * The shapes of outline.
+ */
+
+enum outline_shape {
+	OUTLINE_SHAPE_FLAT = 0,				/**< Every entry at the top level.			*/
+	OUTLINE_SHAPE_INDEX = 1,			/**< Entries nested as a database index.		*/
+	OUTLINE_SHAPE_DEEP = 2,				/**< Long runs of ever deeper entries.			*/
+	OUTLINE_SHAPES = 3				/**< The number of shapes.				*/
+};
+
+
+/* Function Prototypes. */
+
+static osbool outline_write_file(char *filename, int entries, enum outline_shape shape, int levels);
+static double outline_write_pdfmark(char *filename, bookmark_block *bm);
+static int outline_fuzz(char *source, char *work, int runs, int *damaged);
+static size_t outline_mutate(char *buffer, size_t size);
+static int outline_next_level(int level, enum outline_shape shape, int levels);
+static double outline_read_time(void);
+static int outline_random_row(int rows);
+static unsigned outline_random(void);
+
+
+/**
+ * The names of the shapes, as used on the command line.
+ */
+
+static char *outline_shape_names[OUTLINE_SHAPES] = {
+	"flat", "index", "deep"
+};
+
+/**
+ * The state of the generator used for the outline, which is fixed so that
+ * the outline is the same on every run.
+ */
+
+static unsigned outline_seed = 1;
+
+/**
+ * The bytes which mean something to the file parser, used when fuzzing.  The
+ * terminator is included, too.
+ */
+
+static char outline_fuzz_bytes[] = "\n\r\t :[]@#-+0123456789";
+
+
+/**
+ * Run the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+	bookmark_block		*bm;
+	enum outline_shape	shape = OUTLINE_SHAPE_INDEX;
+	char			*work = "/tmp/ppdfoutline", *messages = NULL;
+	char			filename[OUTLINE_MAX_FILENAME], pdfmarkname[OUTLINE_MAX_FILENAME];
+	osbool			check = FALSE, valid = TRUE;
+	enum bookmark_hosted_edit	edit;
+	int			i, entries = 10000, levels = 4, rebuilds = 100, edits = 1000, fuzz = 0, fuzzed = 0, damaged = 0, rows, memory;
+	double			start, load, rebuild, change, pdfmark;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-work") == 0 && i + 1 < argc) {
+			work = argv[++i];
+		} else if (strcmp(argv[i], "-messages") == 0 && i + 1 < argc) {
+			messages = argv[++i];
+		} else if (strcmp(argv[i], "-entries") == 0 && i + 1 < argc) {
+			entries = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "-levels") == 0 && i + 1 < argc) {
+			levels = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "-rebuilds") == 0 && i + 1 < argc) {
+			rebuilds = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "-edits") == 0 && i + 1 < argc) {
+			edits = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "-fuzz") == 0 && i + 1 < argc) {
+			fuzz = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "-check") == 0) {
+			check = TRUE;
+		} else if (strcmp(argv[i], "-shape") == 0 && i + 1 < argc) {
+			for (shape = 0; shape < OUTLINE_SHAPES && strcmp(argv[i + 1], outline_shape_names[shape]) != 0; shape++);
+			if (shape == OUTLINE_SHAPES)
+				break;
+			i++;
+		} else {
+			break;
+		}
+	}
+
+	if (i != argc || entries < 1 || levels < 1 || rebuilds < 1 || edits < 0 || fuzz < 0) {
+		fprintf(stderr, "Usage: ppdfoutline [-work <dir>] [-messages <file>] [-entries <n>] [-shape flat|index|deep]\n"
+				"                   [-levels <n>] [-rebuilds <n>] [-edits <n>] [-check] [-fuzz <n>]\n");
+		return 2;
+	}
+
+	if (!hosted_initialise(work, messages)) {
+		fprintf(stderr, "Unable to initialise in %s\n", work);
+		return 1;
+	}
+
+	bookmarks_initialise();
+
+	string_printf(filename, OUTLINE_MAX_FILENAME, "%s/outline", work);
+	if (!outline_write_file(filename, entries, shape, levels)) {
+		fprintf(stderr, "Unable to write the outline to %s\n", filename);
+		hosted_terminate();
+		return 1;
+	}
+
+	/* Load the outline, and then recalculate it as each edit would. */
+
+	start = outline_read_time();
+	bm = bookmarks_load_file(filename);
+	load = outline_read_time() - start;
+
+	if (bm == NULL) {
+		fprintf(stderr, "Unable to load the outline from %s\n", filename);
+		hosted_terminate();
+		return 1;
+	}
+
+	if (check)
+		valid = bookmark_hosted_check(bm);
+
+	rebuild = 0;
+
+	for (i = 0; i < rebuilds && valid; i++) {
+		start = outline_read_time();
+		bookmark_hosted_rebuild(bm);
+		rebuild += outline_read_time() - start;
+
+		if (check)
+			valid = bookmark_hosted_check(bm);
+	}
+
+	rows = bookmark_hosted_count_rows(bm);
+	memory = bookmark_hosted_count_memory(bm);
+
+	/* Make random edits to the outline, with the occasional change to
+	 * the expansion of the whole thing.
+	 */
+
+	change = 0;
+
+	for (i = 0; i < edits && valid; i++) {
+		if (outline_random() % OUTLINE_EXPANSIONS == 0)
+			edit = (outline_random() % 2 == 0) ? BOOKMARK_HOSTED_EXPAND_ALL : BOOKMARK_HOSTED_CONTRACT_ALL;
+		else
+			edit = outline_random() % BOOKMARK_HOSTED_EXPAND_ALL;
+
+		start = outline_read_time();
+		bookmark_hosted_edit(bm, edit, outline_random_row(bookmark_hosted_count_rows(bm)),
+				outline_random_row(bookmark_hosted_count_rows(bm) + 1));
+		change += outline_read_time() - start;
+
+		if (check)
+			valid = bookmark_hosted_check(bm);
+	}
+
+	/* Write the PDFMark data for the edited outline. */
+
+	string_printf(pdfmarkname, OUTLINE_MAX_FILENAME, "%s/pdfmark", work);
+	pdfmark = outline_write_pdfmark(pdfmarkname, bm);
+
+	if (pdfmark < 0) {
+		fprintf(stderr, "Unable to write the PDFMark data to %s\n", pdfmarkname);
+		valid = FALSE;
+	}
+
+	printf("Shape\tEntries\tLevels\tRows\tMemory (KB)\tLoad (ms)\tRebuild (ms)\tEdits\tEdit (ms)\tPDFMark (ms)\n");
+	printf("%s\t%d\t%d\t%d\t%d\t%.2f\t%.3f\t%d\t%.4f\t%.2f\n", outline_shape_names[shape], entries, levels,
+			rows, memory / 1024, load * 1000.0, rebuild * 1000.0 / rebuilds, i, (i > 0) ? change * 1000.0 / i : 0.0,
+			pdfmark * 1000.0);
+
+	if (!valid)
+		fprintf(stderr, "The outline was not rebuilt or edited correctly\n");
+
+	bookmarks_terminate();
+
+	/* Load damaged copies of the outline file. Copies which the loader
+	 * reports as containing unknown data are counted apart from those
+	 * which loaded cleanly, but both must leave a consistent outline.
+	 */
+
+	if (fuzz > 0 && valid) {
+		fuzzed = outline_fuzz(filename, work, fuzz, &damaged);
+
+		printf("Fuzzed\tLoaded\tDamaged\n%d\t%d\t%d\n", fuzz, fuzzed, damaged);
+
+		if (fuzzed + damaged != fuzz) {
+			fprintf(stderr, "A damaged copy of the outline was not loaded correctly\n");
+			valid = FALSE;
+		}
+	}
+
+	hosted_terminate();
+
+	return (valid) ? 0 : 1;
+}
+
+
+/**
+ * Write a synthetic bookmark file.
+ *
+ * \param *filename		The name of the file to write.
+ * \param entries		The number of entries to write.
+ * \param shape			The shape of the outline.
+ * \param levels		The deepest level to use.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool outline_write_file(char *filename, int entries, enum outline_shape shape, int levels)
+{
+	FILE	*out;
+	int	i, level, next;
+
+	out = fopen(filename, "w");
+	if (out == NULL)
+		return FALSE;
+
+	fprintf(out, "# PrintPDF File\n# Written by ppdfoutline\n\n");
+	fprintf(out, "Format: 1.00\n\n");
+	fprintf(out, "[Bookmarks]\n");
+	fprintf(out, "Name: %s outline of %d entries\n", outline_shape_names[shape], entries);
+
+	level = 1;
+
+	for (i = 0; i < entries; i++) {
+		next = (i + 1 < entries) ? outline_next_level(level, shape, levels) : 1;
+
+		if (outline_random() % OUTLINE_ESCAPED == 0)
+			fprintf(out, "@: Entry %d (Caf\351 \\ R\351sum\351)\n", i + 1);
+		else
+			fprintf(out, "@: Entry %d\n", i + 1);
+		fprintf(out, "Page: %d\n", i / 10 + 1);
+		if (level > 1)
+			fprintf(out, "Level: %d\n", level);
+		if (next > level && outline_random() % OUTLINE_CONTRACTED == 0)
+			fprintf(out, "Expanded: No\n");
+
+		level = next;
+	}
+
+	return (fclose(out) == 0) ? TRUE : FALSE;
+}
+
+
+/**
+ * Write the PDFMark data for an outline, in the way that a conversion would.
+ *
+ * \param *filename		The name of the file to write.
+ * \param *bm			The outline to write.
+ * \return			The time taken, in seconds, or -1 on failure.
+ */
+
+static double outline_write_pdfmark(char *filename, bookmark_block *bm)
+{
+	FILE		*out;
+	pdfmark_output	*output;
+	bookmark_params	params;
+	osbool		success;
+	double		start;
+
+	out = fopen(filename, "w");
+	if (out == NULL)
+		return -1;
+
+	params.bookmarks = bm;
+
+	start = outline_read_time();
+
+	output = pdfmark_open_output(out);
+	bookmarks_write_pdfmark(output, &params);
+	success = pdfmark_close_output(output);
+
+	start = outline_read_time() - start;
+
+	if (fclose(out) != 0 || !success)
+		return -1;
+
+	return start;
+}
+
+
+/**
+ * Load a series of randomly damaged copies of a bookmark file, checking
+ * each outline which results.
+ *
+ * \param *source		The name of the file to damage.
+ * \param *work			The directory in which to write the copies.
+ * \param runs			The number of copies to load.
+ * \param *damaged		Pointer to a variable to take the number of
+ *				copies which were reported as containing
+ *				unknown data, before the first failure.
+ * \return			The number of copies loaded cleanly, before
+ *				the first failure.
+ */
+
+static int outline_fuzz(char *source, char *work, int runs, int *damaged)
+{
+	FILE		*file;
+	bookmark_block	*bm;
+	char		filename[OUTLINE_MAX_FILENAME], *original = NULL, *buffer = NULL;
+	long		length = -1;
+	size_t		size;
+	int		i, mutations, loaded = 0;
+	osbool		valid;
+
+	*damaged = 0;
+
+	file = fopen(source, "rb");
+	if (file == NULL)
+		return 0;
+
+	if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+		original = malloc(length + 1);
+		buffer = malloc(length + OUTLINE_FUZZ_MUTATIONS * OUTLINE_FUZZ_RUN + 1);
+	}
+
+	if (original == NULL || buffer == NULL || fread(original, 1, length, file) != (size_t) length) {
+		fclose(file);
+		free(original);
+		free(buffer);
+		return 0;
+	}
+
+	fclose(file);
+
+	string_printf(filename, OUTLINE_MAX_FILENAME, "%s/fuzz", work);
+
+	for (i = 0; i < runs; i++) {
+		memcpy(buffer, original, length);
+		size = length;
+
+		for (mutations = 1 + outline_random() % OUTLINE_FUZZ_MUTATIONS; mutations > 0; mutations--)
+			size = outline_mutate(buffer, size);
+
+		file = fopen(filename, "wb");
+		if (file == NULL)
+			break;
+
+		valid = (fwrite(buffer, 1, size, file) == size) ? TRUE : FALSE;
+
+		if (fclose(file) != 0 || !valid)
+			break;
+
+		bm = bookmarks_load_file(filename);
+		valid = (bm != NULL && bookmark_hosted_check(bm)) ? TRUE : FALSE;
+
+		if (valid && bookmark_hosted_load_damaged())
+			(*damaged)++;
+		else if (valid)
+			loaded++;
+
+		bookmarks_terminate();
+
+		if (!valid)
+			break;
+	}
+
+	free(original);
+	free(buffer);
+
+	return loaded;
+}
+
+
+/**
+ * Make a random change to a copy of a file, which must have room after it
+ * for OUTLINE_FUZZ_RUN more bytes.
+ *
+ * \param *buffer		The copy of the file.
+ * \param size			The size of the copy, in bytes.
+ * \return			The new size of the copy, in bytes.
+ */
+
+static size_t outline_mutate(char *buffer, size_t size)
+{
+	size_t	position, span;
+	char	byte;
+
+	position = outline_random_row(size);
+	span = 1 + outline_random() % OUTLINE_FUZZ_SPAN;
+
+	if (span > size - position)
+		span = size - position;
+
+	switch (outline_random() % 6) {
+	case 0:
+		/* Change a byte to one which means something to the parser. */
+
+		if (position < size)
+			buffer[position] = outline_fuzz_bytes[outline_random() % sizeof(outline_fuzz_bytes)];
+		break;
+
+	case 1:
+		/* Change a byte to any value. */
+
+		if (position < size)
+			buffer[position] = outline_random() & 0xff;
+		break;
+
+	case 2:
+		/* Delete a span of bytes. */
+
+		memmove(buffer + position, buffer + position + span, size - position - span);
+		size -= span;
+		break;
+
+	case 3:
+		/* Duplicate a span of bytes. */
+
+		memmove(buffer + position + span, buffer + position, size - position);
+		size += span;
+		break;
+
+	case 4:
+		/* Insert a long run of the same byte. */
+
+		span = 1 + outline_random() % OUTLINE_FUZZ_RUN;
+		byte = (outline_random() % 2 == 0) ? 'x' : '9';
+
+		memmove(buffer + position + span, buffer + position, size - position);
+		memset(buffer + position, byte, span);
+		size += span;
+		break;
+
+	case 5:
+		/* Cut the file short. */
+
+		size = position;
+		break;
+	}
+
+	return size;
+}
+
+
+/**
+ * Choose the level of the next entry in an outline.
+ *
+ * \param level			The level of the current entry.
+ * \param shape			The shape of the outline.
+ * \param levels		The deepest level to use.
+ * \return			The level of the next entry.
+ */
+
+static int outline_next_level(int level, enum outline_shape shape, int levels)
+{
+	switch (shape) {
+	case OUTLINE_SHAPE_FLAT:
+		return 1;
+
+	case OUTLINE_SHAPE_INDEX:
+		/* Mostly siblings, with the occasional new branch or return. */
+
+		switch (outline_random() % 8) {
+		case 0:
+			return (level < levels) ? level + 1 : level;
+		case 1:
+			return 1 + outline_random() % level;
+		default:
+			return level;
+		}
+
+	case OUTLINE_SHAPE_DEEP:
+		return (level < levels) ? level + 1 : 1;
+
+	default:
+		return 1;
+	}
+}
+
+
+/**
+ * Read a monotonic clock.
+ *
+ * \return			The time, in seconds.
+ */
+
+static double outline_read_time(void)
+{
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * Choose a random row in an outline.
+ *
+ * \param rows			The number of rows to choose from.
+ * \return			The chosen row.
+ */
+
+static int outline_random_row(int rows)
+{
+	unsigned	value;
+
+	value = (outline_random() << 15) | outline_random();
+
+	return (rows > 0) ? value % rows : 0;
+}
+
+
+/**
+ * Return the next value from the generator used for the outline.
+ *
+ * \return			The next pseudo-random value.
+ */
+
+static unsigned outline_random(void)
+{
+	outline_seed = outline_seed * 1103515245u + 12345u;
+
+	return (outline_seed >> 16) & 0x7fff;
+}
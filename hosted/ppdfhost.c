@@ -0,0 +1,199 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: ppdfhost.c
+ *
+ * Hosted conversion driver.
+ *
+ * Converts a PostScript file to PDF using the hosted build of the
+ * conversion core.  The driver acts as a client of the external control
+ * API: it sets the output filename, drops the input into the spool
+ * location for the spool watcher to find, and then runs the poll loop
+ * until PrintPDF reports the outcome.
+ *
+ *   ppdfhost [-work <dir>] [-messages <file>] [-timeout <seconds>] <input> <output>
+ *
+ * Alternatively, a batch of files can be converted in the way that the
+ * application's -batch option does, with the exit code showing whether
+ * any of them failed:
+ *
+ *   ppdfhost [-work <dir>] [-messages <file>] -batch <source> [-profile <name>] [-output <dir>] [-report <file>]
+ *
+ * gs is found on the PATH, so the stand-in from the build can be used by
+ * putting its directory first.
+ */
+
+/* ANSI C header files */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+#include "oslib/osfscontrol.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "hosted.h"
+
+#include "batch.h"
+#include "client.h"
+#include "convert.h"
+#include "main.h"
+
+
+/* Function Prototypes. */
+
+static osbool ppdfhost_spool_file(char *filename);
+static int ppdfhost_run_batch(char *source, char *profile, char *output, char *report);
+
+
+/**
+ * Run the driver.
+ */
+
+int main(int argc, char *argv[])
+{
+	enum client_state	state;
+	char			*work = "/tmp/ppdfhost", *messages = NULL;
+	char			*batch = NULL, *profile = NULL, *output = NULL, *report = NULL;
+	os_t			start;
+	int			i, timeout = 60;
+
+	for (i = 1; i < argc - 1; i++) {
+		if (strcmp(argv[i], "-work") == 0)
+			work = argv[++i];
+		else if (strcmp(argv[i], "-messages") == 0)
+			messages = argv[++i];
+		else if (strcmp(argv[i], "-timeout") == 0)
+			timeout = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-batch") == 0)
+			batch = argv[++i];
+		else if (strcmp(argv[i], "-profile") == 0)
+			profile = argv[++i];
+		else if (strcmp(argv[i], "-output") == 0)
+			output = argv[++i];
+		else if (strcmp(argv[i], "-report") == 0)
+			report = argv[++i];
+		else
+			break;
+	}
+
+	if ((batch == NULL && i != argc - 2) || (batch != NULL && i != argc)) {
+		fprintf(stderr, "Usage: ppdfhost [-work <dir>] [-messages <file>] [-timeout <seconds>] <input> <output>\n");
+		fprintf(stderr, "       ppdfhost [-work <dir>] [-messages <file>] -batch <source> [-profile <name>] [-output <dir>] [-report <file>]\n");
+		return 2;
+	}
+
+	if (!hosted_initialise(work, messages)) {
+		fprintf(stderr, "Unable to initialise in %s\n", work);
+		return 1;
+	}
+
+	if (batch != NULL)
+		return ppdfhost_run_batch(batch, profile, output, report);
+
+	client_initialise(TRUE);
+
+	if (!client_set_filename(argv[argc - 1]) || !ppdfhost_spool_file(argv[argc - 2])) {
+		fprintf(stderr, "Unable to start the conversion of %s\n", argv[argc - 2]);
+		hosted_terminate();
+		return 1;
+	}
+
+	/* Run the poll loop until PrintPDF reports the outcome. */
+
+	start = os_read_monotonic_time();
+	state = client_wait(start + timeout * 100);
+
+	if (state == CLIENT_TIMED_OUT)
+		fprintf(stderr, "Timed out after %d seconds\n", timeout);
+	else if (state == CLIENT_FAILED)
+		fprintf(stderr, "Conversion failed with code %d\n", client_get_failure());
+	else
+		printf("Converted in %d.%02d seconds\n", (os_read_monotonic_time() - start) / 100, (os_read_monotonic_time() - start) % 100);
+
+	client_clear_filename();
+	hosted_terminate();
+
+	return (state == CLIENT_SUCCEEDED) ? 0 : 1;
+}
+
+
+/**
+ * Copy a file into the spool location.  The copy is made alongside and
+ * renamed into place, so that the watcher never sees a partial file.
+ *
+ * \param *filename		The file to spool.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool ppdfhost_spool_file(char *filename)
+{
+	char	spool[CONVERT_MAX_FILENAME], temp[CONVERT_MAX_FILENAME];
+
+	convert_build_queue_filename(spool, CONVERT_MAX_FILENAME, CONVERT_QUEUE_FILENAME);
+	string_printf(temp, CONVERT_MAX_FILENAME, "%s_new", spool);
+
+	if (xosfscontrol_copy(filename, temp, osfscontrol_COPY_FORCE, 0, 0, 0, 0, NULL) != NULL)
+		return FALSE;
+
+	return (xosfscontrol_rename(temp, spool) == NULL) ? TRUE : FALSE;
+}
+
+
+/**
+ * Convert a batch of files, running the poll loop until the batch has
+ * been dealt with and PrintPDF sets its quit flag.
+ *
+ * \param *source		The directory, file or list of files to convert.
+ * \param *profile		The settings profile to use, or NULL.
+ * \param *output		The directory to save the PDFs into, or NULL.
+ * \param *report		The file to write the report to, or NULL.
+ * \return			The exit code for the driver.
+ */
+
+static int ppdfhost_run_batch(char *source, char *profile, char *output, char *report)
+{
+	os_t	start;
+
+	start = os_read_monotonic_time();
+
+	batch_start(source, profile, output, report);
+
+	while (!main_quit_flag)
+		hosted_poll(10);
+
+	printf("Batch %s in %d.%02d seconds\n", (batch_failed()) ? "failed" : "converted",
+			(os_read_monotonic_time() - start) / 100, (os_read_monotonic_time() - start) % 100);
+
+	hosted_terminate();
+
+	return (batch_failed()) ? 1 : 0;
+}
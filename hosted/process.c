@@ -0,0 +1,564 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: process.c
+ *
+ * Hosted child process implementation.
+ *
+ * Child tasks are started by PrintPDF as TaskWindows with itself as the
+ * parent, and expect to hear about them through the TaskWindow messages.
+ * Here the command is run by the shell, with its output collected through
+ * a pipe and passed on in Message_TaskWindow_Output; Message_TaskWindow_Input
+ * is written to its standard input, and Message_TaskWindow_Morite kills it.
+ */
+
+/* ANSI C header files */
+
+#include <ctype.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+#include "oslib/taskwindow.h"
+#include "oslib/wimp.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/debug.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "process.h"
+
+#include "hosted.h"
+#include "main.h"
+
+
+/**
+ * The number of child tasks which can run at once.
+ */
+
+#define PROCESS_MAX_CHILDREN 16
+
+/**
+ * The length of a child task's command.
+ */
+
+#define PROCESS_MAX_COMMAND 1024
+
+/**
+ * The length of a child task's name.
+ */
+
+#define PROCESS_MAX_NAME 64
+
+/**
+ * The amount of output which fits in one Message_TaskWindow_Output.
+ */
+
+#define PROCESS_OUTPUT_LENGTH 232
+
+/**
+ * The size of a message header on RISC OS, which hosted_send_message()
+ * replaces with the hosted header when it copies a message.
+ */
+
+#define PROCESS_RISCOS_HEADER 20
+
+
+/**
+ * A child task.
+ */
+
+struct process_child {
+	wimp_t			task;				/**< The child's task handle, or 0 if the slot is free.	*/
+	pid_t			pid;				/**< The process running the child's command.		*/
+	int			output;				/**< The pipe from the process's output, or -1.		*/
+	int			input;				/**< The pipe to the process's input, or -1.		*/
+	int			txt;				/**< The TaskWindow handle given by the parent.		*/
+	int			slot;				/**< The slot size requested, in Kbytes.		*/
+	char			name[PROCESS_MAX_NAME];		/**< The name of the child task.			*/
+};
+
+/**
+ * A TaskWindow message.
+ */
+
+typedef struct {
+	wimp_MESSAGE_HEADER_MEMBERS
+	union {
+		struct {
+			int	size;
+			char	data[PROCESS_OUTPUT_LENGTH];
+		} io;
+		int		txt;
+	};
+} process_message;
+
+
+/* Function Prototypes. */
+
+static osbool process_parse_command(char *command, char *run, char *name, int *txt, int *slot);
+static char *process_read_argument(char *command, char *buffer, size_t length);
+static void process_read_output(struct process_child *child);
+static void process_reap(struct process_child *child);
+static void process_send(struct process_child *child, bits action, wimp_t to, process_message *message, int size);
+
+
+/**
+ * The child tasks.
+ */
+
+static struct process_child process_children[PROCESS_MAX_CHILDREN];
+
+
+/**
+ * Start a child task from a TaskWindow command, running the command in
+ * the shell and reporting on it with the messages that the TaskWindow
+ * module would send to its parent.
+ *
+ * \param *command		The TaskWindow command to run.
+ * \param *task			Pointer to a variable to take the task handle.
+ * \return			TRUE if the task was started; else FALSE.
+ */
+
+osbool process_start(char *command, wimp_t *task)
+{
+	struct process_child			*child = NULL;
+	wimp_full_message_task_initialise	initialise;
+	process_message				ego;
+	char					run[PROCESS_MAX_COMMAND];
+	int					i, output[2], input[2];
+
+	if (task != NULL)
+		*task = HOSTED_NO_TASK;
+
+	for (i = 0; i < PROCESS_MAX_CHILDREN && child == NULL; i++) {
+		if (process_children[i].task == HOSTED_NO_TASK)
+			child = &(process_children[i]);
+	}
+
+	if (child == NULL || !process_parse_command(command, run, child->name, &(child->txt), &(child->slot)))
+		return FALSE;
+
+	if (pipe(output) != 0)
+		return FALSE;
+
+	if (pipe(input) != 0) {
+		close(output[0]);
+		close(output[1]);
+		return FALSE;
+	}
+
+	child->pid = fork();
+
+	if (child->pid == 0) {
+		setpgid(0, 0);
+		dup2(input[0], STDIN_FILENO);
+		dup2(output[1], STDOUT_FILENO);
+		dup2(output[1], STDERR_FILENO);
+		close(input[0]);
+		close(input[1]);
+		close(output[0]);
+		close(output[1]);
+
+		execl("/bin/sh", "sh", "-c", run, (char *) NULL);
+		_exit(127);
+	}
+
+	close(input[0]);
+	close(output[1]);
+
+	if (child->pid < 0) {
+		close(input[1]);
+		close(output[0]);
+		return FALSE;
+	}
+
+	/* Keep the parent's ends of the pipes away from any other children. */
+
+	fcntl(input[1], F_SETFD, FD_CLOEXEC);
+	fcntl(output[0], F_SETFD, FD_CLOEXEC);
+
+	child->input = input[1];
+	child->output = output[0];
+	child->task = hosted_allocate_task();
+
+	#ifdef DEBUG
+	debug_printf("Started child task '%s' as process %d in %dK: %s", child->name, (int) child->pid, child->slot, run);
+	#endif
+
+	/* The child announces itself to everyone, and its TaskWindow tells the parent who it is. */
+
+	initialise.action = message_TASK_INITIALISE;
+	initialise.your_ref = 0;
+	initialise.cao = 0;
+	initialise.slot_size = child->slot * 1024;
+	string_copy(initialise.task_name, child->name, sizeof(initialise.task_name));
+	hosted_send_message(wimp_USER_MESSAGE, (wimp_message *) &initialise, (28 + strlen(initialise.task_name) + 4) & ~3,
+			child->task, HOSTED_NO_TASK);
+
+	ego.txt = child->txt;
+	process_send(child, message_TASK_WINDOW_EGO, main_task_handle, &ego, 24);
+
+	if (task != NULL)
+		*task = child->task;
+
+	return TRUE;
+}
+
+
+/**
+ * Pick the command, task name and TaskWindow handle out of a TaskWindow
+ * command of the form used by PrintPDF:
+ *
+ *   TaskWindow "<command>" <slot>k -name "<name>" -task &<parent> -txt &<txt> -quit
+ *
+ * \param *command		The TaskWindow command to parse.
+ * \param *run			Pointer to a buffer to take the command to run.
+ * \param *name			Pointer to a buffer to take the task name.
+ * \param *txt			Pointer to a variable to take the TaskWindow handle.
+ * \param *slot			Pointer to a variable to take the slot size.
+ * \return			TRUE if the command was parsed; else FALSE.
+ */
+
+static osbool process_parse_command(char *command, char *run, char *name, int *txt, int *slot)
+{
+	char	argument[PROCESS_MAX_COMMAND];
+
+	if (command == NULL || strncmp(command, "TaskWindow ", 11) != 0)
+		return FALSE;
+
+	command = process_read_argument(command + 11, run, PROCESS_MAX_COMMAND);
+
+	*name = '\0';
+	*txt = 0;
+	*slot = 0;
+
+	while (command != NULL && *command != '\0') {
+		command = process_read_argument(command, argument, PROCESS_MAX_COMMAND);
+
+		if (strcmp(argument, "-name") == 0)
+			command = process_read_argument(command, name, PROCESS_MAX_NAME);
+		else if (strcmp(argument, "-txt") == 0 && (command = process_read_argument(command, argument, PROCESS_MAX_COMMAND)) != NULL)
+			*txt = (int) strtoul((*argument == '&') ? argument + 1 : argument, NULL, 16);
+		else if (isdigit((unsigned char) *argument) && argument[strlen(argument) - 1] == 'k')
+			*slot = atoi(argument);
+	}
+
+	return (*run != '\0') ? TRUE : FALSE;
+}
+
+
+/**
+ * Read an argument from a command line, which may be in double quotes.
+ *
+ * \param *command		The command line to read from.
+ * \param *buffer		Pointer to a buffer to take the argument.
+ * \param length		The length of the buffer.
+ * \return			Pointer to the rest of the command line, or
+ *				NULL if there was no argument.
+ */
+
+static char *process_read_argument(char *command, char *buffer, size_t length)
+{
+	osbool	quoted = FALSE;
+	size_t	used = 0;
+
+	*buffer = '\0';
+
+	if (command == NULL)
+		return NULL;
+
+	while (*command == ' ')
+		command++;
+
+	if (*command == '\0')
+		return NULL;
+
+	if (*command == '"') {
+		quoted = TRUE;
+		command++;
+	}
+
+	while (*command != '\0' && (quoted ? *command != '"' : *command != ' ')) {
+		if (used < length - 1)
+			buffer[used++] = *command;
+		command++;
+	}
+
+	if (quoted && *command == '"')
+		command++;
+
+	buffer[used] = '\0';
+
+	return command;
+}
+
+
+/**
+ * Test whether a task handle belongs to a child task.
+ *
+ * \param task			The task handle to test.
+ * \return			TRUE if the task is a child task; else FALSE.
+ */
+
+osbool process_owns_task(wimp_t task)
+{
+	int	i;
+
+	for (i = 0; i < PROCESS_MAX_CHILDREN; i++) {
+		if (task != HOSTED_NO_TASK && process_children[i].task == task)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+
+/**
+ * Pass a message to a child task, as its TaskWindow would receive it.
+ *
+ * \param *message		The message to pass on.
+ * \param task			The child task to receive the message.
+ */
+
+void process_receive_message(wimp_message *message, wimp_t task)
+{
+	process_message		*io = (process_message *) message;
+	struct process_child	*child = NULL;
+	ssize_t			written;
+	int			i, done = 0;
+
+	for (i = 0; i < PROCESS_MAX_CHILDREN && child == NULL; i++) {
+		if (process_children[i].task == task)
+			child = &(process_children[i]);
+	}
+
+	if (child == NULL || message == NULL)
+		return;
+
+	switch (message->action) {
+	case message_TASK_WINDOW_INPUT:
+		while (child->input != -1 && done < io->io.size && done < PROCESS_OUTPUT_LENGTH) {
+			written = write(child->input, io->io.data + done, io->io.size - done);
+
+			if (written < 0 && errno == EINTR)
+				continue;
+
+			if (written <= 0)
+				break;
+
+			done += written;
+		}
+		break;
+
+	case message_TASK_WINDOW_MORITE:
+		kill(-(child->pid), SIGTERM);
+		break;
+	}
+}
+
+
+/**
+ * Wait for output from the child tasks, passing it on and reporting on any
+ * which have exited.  The wait also ends if another descriptor becomes
+ * readable.
+ *
+ * \param wait			The longest time to wait, in centiseconds.
+ * \param wake			A descriptor to wait on as well, or -1.
+ * \return			TRUE if the wake descriptor is readable; else FALSE.
+ */
+
+osbool process_poll(os_t wait, int wake)
+{
+	struct timeval	timeout;
+	fd_set		readable;
+	int		i, highest = wake;
+
+	FD_ZERO(&readable);
+
+	if (wake >= 0)
+		FD_SET(wake, &readable);
+
+	for (i = 0; i < PROCESS_MAX_CHILDREN; i++) {
+		if (process_children[i].task == HOSTED_NO_TASK)
+			continue;
+
+		if (process_children[i].output != -1) {
+			FD_SET(process_children[i].output, &readable);
+			if (process_children[i].output > highest)
+				highest = process_children[i].output;
+		} else if (wait > 1) {
+			/* A child which has closed its output will exit shortly, and there's nothing to wait on for that. */
+
+			wait = 1;
+		}
+	}
+
+	timeout.tv_sec = wait / 100;
+	timeout.tv_usec = (wait % 100) * 10000;
+
+	if (select(highest + 1, &readable, NULL, NULL, &timeout) < 0)
+		FD_ZERO(&readable);
+
+	for (i = 0; i < PROCESS_MAX_CHILDREN; i++) {
+		if (process_children[i].task == HOSTED_NO_TASK)
+			continue;
+
+		if (process_children[i].output != -1 && FD_ISSET(process_children[i].output, &readable))
+			process_read_output(&(process_children[i]));
+
+		if (process_children[i].output == -1)
+			process_reap(&(process_children[i]));
+	}
+
+	return (wake >= 0 && FD_ISSET(wake, &readable)) ? TRUE : FALSE;
+}
+
+
+/**
+ * Read the output waiting from a child task, passing it on to the parent.
+ * At the end of the output, the pipe is closed.
+ *
+ * \param *child		The child task to read from.
+ */
+
+static void process_read_output(struct process_child *child)
+{
+	process_message	output;
+	ssize_t		bytes;
+	size_t		length;
+
+	bytes = read(child->output, output.io.data, PROCESS_OUTPUT_LENGTH);
+
+	if (bytes < 0 && errno == EINTR)
+		return;
+
+	if (bytes <= 0) {
+		close(child->output);
+		child->output = -1;
+		return;
+	}
+
+	output.io.size = bytes;
+
+	/* Size the message so that the block copied out of it, which runs on
+	 * from the hosted header, stays within the output buffer.
+	 */
+
+	length = offsetof(process_message, io.data) + ((bytes + 3) & ~3);
+	if (length > sizeof(process_message))
+		length = sizeof(process_message);
+
+	process_send(child, message_TASK_WINDOW_OUTPUT, main_task_handle, &output,
+			PROCESS_RISCOS_HEADER + length - offsetof(wimp_message, data));
+}
+
+
+/**
+ * Check whether a child task whose output has ended has exited, and if it
+ * has, tell the parent and free its slot.
+ *
+ * \param *child		The child task to check.
+ */
+
+static void process_reap(struct process_child *child)
+{
+	process_message	message;
+	int		status;
+
+	if (waitpid(child->pid, &status, WNOHANG) != child->pid)
+		return;
+
+	#ifdef DEBUG
+	debug_printf("Child task '%s' exited with status %d", child->name, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+	#endif
+
+	if (child->input != -1)
+		close(child->input);
+
+	process_send(child, message_TASK_WINDOW_MORIO, main_task_handle, &message, 20);
+	process_send(child, message_TASK_CLOSE_DOWN, HOSTED_NO_TASK, &message, 20);
+
+	child->task = HOSTED_NO_TASK;
+	child->input = -1;
+}
+
+
+/**
+ * Send a message from a child task.
+ *
+ * \param *child		The child task sending the message.
+ * \param action		The message action.
+ * \param to			The task to receive the message.
+ * \param *message		The message block to send.
+ * \param size			The size of the message, as on RISC OS.
+ */
+
+static void process_send(struct process_child *child, bits action, wimp_t to, process_message *message, int size)
+{
+	message->action = action;
+	message->your_ref = 0;
+
+	hosted_send_message(wimp_USER_MESSAGE, (wimp_message *) message, size, child->task, to);
+}
+
+
+/**
+ * Stop all of the child tasks.
+ */
+
+void process_terminate(void)
+{
+	int	i;
+
+	for (i = 0; i < PROCESS_MAX_CHILDREN; i++) {
+		if (process_children[i].task == HOSTED_NO_TASK)
+			continue;
+
+		kill(-(process_children[i].pid), SIGTERM);
+		waitpid(process_children[i].pid, NULL, 0);
+
+		if (process_children[i].output != -1)
+			close(process_children[i].output);
+
+		if (process_children[i].input != -1)
+			close(process_children[i].input);
+
+		process_children[i].task = HOSTED_NO_TASK;
+	}
+}
+
@@ -0,0 +1,88 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: process.h
+ *
+ * Hosted child process implementation.
+ */
+
+#ifndef PRINTPDF_PROCESS
+#define PRINTPDF_PROCESS
+
+#include "oslib/wimp.h"
+
+
+/**
+ * Start a child task from a TaskWindow command, running the command in
+ * the shell and reporting on it with the messages that the TaskWindow
+ * module would send to its parent.
+ *
+ * \param *command		The TaskWindow command to run.
+ * \param *task			Pointer to a variable to take the task handle.
+ * \return			TRUE if the task was started; else FALSE.
+ */
+
+osbool process_start(char *command, wimp_t *task);
+
+
+/**
+ * Test whether a task handle belongs to a child task.
+ *
+ * \param task			The task handle to test.
+ * \return			TRUE if the task is a child task; else FALSE.
+ */
+
+osbool process_owns_task(wimp_t task);
+
+
+/**
+ * Pass a message to a child task, as its TaskWindow would receive it.
+ *
+ * \param *message		The message to pass on.
+ * \param task			The child task to receive the message.
+ */
+
+void process_receive_message(wimp_message *message, wimp_t task);
+
+
+/**
+ * Wait for output from the child tasks, passing it on and reporting on any
+ * which have exited.  The wait also ends if another descriptor becomes
+ * readable.
+ *
+ * \param wait			The longest time to wait, in centiseconds.
+ * \param wake			A descriptor to wait on as well, or -1.
+ * \return			TRUE if the wake descriptor is readable; else FALSE.
+ */
+
+osbool process_poll(os_t wait, int wake);
+
+
+/**
+ * Stop all of the child tasks.
+ */
+
+void process_terminate(void);
+
+#endif
+
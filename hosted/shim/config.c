@@ -0,0 +1,306 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: config.c
+ *
+ * Hosted SFLib implementation, for the configuration.
+ *
+ * The options are held in memory, and are never loaded or saved: the
+ * hosted environment sets them up when it starts, and the program using
+ * it can change them afterwards.
+ */
+
+/* ANSI C header files */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* OSLib header files */
+
+#include "oslib/types.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/string.h"
+
+
+/**
+ * The types of configuration option.
+ */
+
+enum config_type {
+	CONFIG_TYPE_OPT,					/**< A boolean option.					*/
+	CONFIG_TYPE_INT,					/**< An integer option.					*/
+	CONFIG_TYPE_STR						/**< A string option.					*/
+};
+
+/**
+ * A configuration option.
+ */
+
+struct config_option {
+	char			*name;				/**< The name of the option.				*/
+	enum config_type	type;				/**< The type of the option.				*/
+	int			value;				/**< The value of a boolean or integer option.		*/
+	char			*text;				/**< The value of a string option.			*/
+
+	struct config_option	*next;				/**< The next option in the list.			*/
+};
+
+
+/* Function Prototypes. */
+
+static struct config_option *config_find(char *name, enum config_type type, osbool create);
+static char *config_trim(char *text);
+
+
+/**
+ * The configuration options.
+ */
+
+static struct config_option *config_options = NULL;
+
+
+/**
+ * Find an option, creating it if required.  As in SFLib, options are only
+ * created when they are initialised.
+ *
+ * \param *name			The name of the option.
+ * \param type			The type of the option.
+ * \param create		TRUE to create the option if it doesn't exist.
+ * \return			Pointer to the option, or NULL.
+ */
+
+static struct config_option *config_find(char *name, enum config_type type, osbool create)
+{
+	struct config_option	*option;
+
+	for (option = config_options; option != NULL; option = option->next) {
+		if (option->type == type && string_nocase_strcmp(option->name, name) == 0)
+			return option;
+	}
+
+	if (!create)
+		return NULL;
+
+	option = calloc(1, sizeof(struct config_option));
+	if (option == NULL)
+		return NULL;
+
+	option->name = strdup(name);
+	option->type = type;
+	option->next = config_options;
+	config_options = option;
+
+	return option;
+}
+
+
+osbool config_initialise(char *app_name, char *app_dir, char *app_path)
+{
+	return TRUE;
+}
+
+
+osbool config_opt_init(char *name, osbool value)
+{
+	config_find(name, CONFIG_TYPE_OPT, TRUE);
+
+	return config_opt_set(name, value);
+}
+
+
+osbool config_opt_set(char *name, osbool value)
+{
+	struct config_option	*option = config_find(name, CONFIG_TYPE_OPT, FALSE);
+
+	if (option == NULL)
+		return FALSE;
+
+	option->value = (value) ? TRUE : FALSE;
+
+	return TRUE;
+}
+
+
+osbool config_opt_read(char *name)
+{
+	struct config_option	*option = config_find(name, CONFIG_TYPE_OPT, FALSE);
+
+	if (option == NULL)
+		fprintf(stderr, "Unknown configuration option %s\n", name);
+
+	return (option != NULL) ? option->value : FALSE;
+}
+
+
+osbool config_int_init(char *name, int value)
+{
+	config_find(name, CONFIG_TYPE_INT, TRUE);
+
+	return config_int_set(name, value);
+}
+
+
+osbool config_int_set(char *name, int value)
+{
+	struct config_option	*option = config_find(name, CONFIG_TYPE_INT, FALSE);
+
+	if (option == NULL)
+		return FALSE;
+
+	option->value = value;
+
+	return TRUE;
+}
+
+
+int config_int_read(char *name)
+{
+	struct config_option	*option = config_find(name, CONFIG_TYPE_INT, FALSE);
+
+	if (option == NULL)
+		fprintf(stderr, "Unknown configuration option %s\n", name);
+
+	return (option != NULL) ? option->value : 0;
+}
+
+
+osbool config_str_init(char *name, char *value)
+{
+	config_find(name, CONFIG_TYPE_STR, TRUE);
+
+	return config_str_set(name, value);
+}
+
+
+osbool config_str_set(char *name, char *value)
+{
+	struct config_option	*option = config_find(name, CONFIG_TYPE_STR, FALSE);
+	char			*text;
+
+	if (option == NULL || (text = strdup((value != NULL) ? value : "")) == NULL)
+		return FALSE;
+
+	free(option->text);
+	option->text = text;
+
+	return TRUE;
+}
+
+
+char *config_str_read(char *name)
+{
+	struct config_option	*option = config_find(name, CONFIG_TYPE_STR, FALSE);
+
+	if (option == NULL)
+		fprintf(stderr, "Unknown configuration option %s\n", name);
+
+	return (option != NULL) ? option->text : "";
+}
+
+
+osbool config_read_opt_string(char *str)
+{
+	return (string_nocase_strcmp(str, "yes") == 0 || string_nocase_strcmp(str, "true") == 0 ||
+			string_nocase_strcmp(str, "on") == 0) ? TRUE : FALSE;
+}
+
+
+char *config_return_opt_string(osbool opt)
+{
+	return (opt) ? "Yes" : "No";
+}
+
+
+/**
+ * Read the next token pair from a configuration file.  If a new section
+ * starts before the pair, its name is returned and the result flags it.
+ *
+ * \param *file			The file to read from.
+ * \param *token		Pointer to a buffer to take the token.
+ * \param *value		Pointer to a buffer to take the value.
+ * \param *section		Pointer to a buffer to take a new section name.
+ * \return			The result of the read.
+ */
+
+enum config_read_status config_read_token_pair(FILE *file, char *token, char *value, char *section)
+{
+	char			line[sf_MAX_CONFIG_FILE_BUFFER], *text, *separator, *end;
+	enum config_read_status	result = sf_CONFIG_READ_TOKEN;
+
+	while (fgets(line, sizeof(line), file) != NULL) {
+		text = config_trim(line);
+
+		if (*text == '\0' || *text == '#')
+			continue;
+
+		if (*text == '[' && (end = strchr(text, ']')) != NULL) {
+			*end = '\0';
+			if (section != NULL)
+				string_copy(section, text + 1, sf_MAX_CONFIG_FILE_BUFFER);
+			result = sf_CONFIG_READ_NEW_SECTION;
+			continue;
+		}
+
+		separator = strchr(text, ':');
+		if (separator == NULL)
+			continue;
+
+		*separator = '\0';
+
+		string_copy(token, config_trim(text), sf_MAX_CONFIG_FILE_BUFFER);
+		string_copy(value, config_trim(separator + 1), sf_MAX_CONFIG_FILE_BUFFER);
+
+		return result;
+	}
+
+	return sf_CONFIG_READ_EOF;
+}
+
+
+/**
+ * Trim leading and trailing whitespace from a piece of text.
+ *
+ * \param *text			The text to trim, which is updated.
+ * \return			Pointer to the start of the trimmed text.
+ */
+
+static char *config_trim(char *text)
+{
+	char	*end;
+
+	while (isspace((unsigned char) *text))
+		text++;
+
+	end = text + strlen(text);
+
+	while (end > text && isspace((unsigned char) *(end - 1)))
+		*--end = '\0';
+
+	return text;
+}
+
@@ -0,0 +1,434 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: desktop.c
+ *
+ * Hosted SFLib implementation, for the parts of the desktop interface
+ * which have nothing to do in the hosted build: windows, menus, help,
+ * data transfer and errors.  Templates are made up on demand, and errors
+ * and debug output go to stderr.
+ */
+
+/* ANSI C header files */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* OSLib header files */
+
+#include "oslib/wimp.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/dataxfer.h"
+#include "sflib/debug.h"
+#include "sflib/errors.h"
+#include "sflib/general.h"
+#include "sflib/ihelp.h"
+#include "sflib/menus.h"
+#include "sflib/msgs.h"
+#include "sflib/saveas.h"
+#include "sflib/templates.h"
+#include "sflib/windows.h"
+
+/* Application header files */
+
+#include "shim.h"
+
+
+/**
+ * The number of icons given to every window template.
+ */
+
+#define DESKTOP_TEMPLATE_ICONS 64
+
+/**
+ * The size of the text buffer given to every template icon.
+ */
+
+#define DESKTOP_TEMPLATE_TEXT 256
+
+/**
+ * The number of entries given to every menu.
+ */
+
+#define DESKTOP_MENU_ENTRIES 32
+
+/**
+ * The length of an error message.
+ */
+
+#define DESKTOP_ERROR_LENGTH 256
+
+
+/**
+ * A save dialogue.
+ */
+
+struct saveas_block {
+	void		*data;					/**< The data given to the dialogue.			*/
+};
+
+
+/* Function Prototypes. */
+
+static void desktop_open(wimp_w w);
+static wimp_error_box_selection desktop_report(char *token, char *a, char *b, char *c, char *d);
+
+
+/* Windows. */
+
+/**
+ * Mark a window as open.
+ *
+ * \param w			The window to open.
+ */
+
+static void desktop_open(wimp_w w)
+{
+	wimp_open	open;
+
+	open.w = w;
+	xwimp_open_window(&open);
+}
+
+
+osbool windows_get_open(wimp_w w)
+{
+	return shim_window_is_open(w);
+}
+
+
+void windows_open(wimp_w w)
+{
+	desktop_open(w);
+}
+
+
+void windows_open_centred_on_screen(wimp_w w)
+{
+	desktop_open(w);
+}
+
+
+void windows_open_centred_at_pointer(wimp_w w, wimp_pointer *p)
+{
+	desktop_open(w);
+}
+
+
+void windows_open_transient_centred_at_pointer(wimp_w w, wimp_pointer *p)
+{
+	desktop_open(w);
+}
+
+
+void windows_open_with_pane_centred_at_pointer(wimp_w w, wimp_w pane, wimp_i icon, int offset, wimp_pointer *p)
+{
+	desktop_open(w);
+	desktop_open(pane);
+}
+
+
+void windows_open_nested_as_toolbar(wimp_w w, wimp_w parent, int height, osbool shaded)
+{
+	desktop_open(w);
+}
+
+
+void windows_place_as_toolbar(wimp_window *window, wimp_window *toolbar, int height)
+{
+}
+
+
+void windows_redraw(wimp_w w)
+{
+}
+
+
+/* Templates. */
+
+wimp_window *templates_load_window(char *name)
+{
+	wimp_window	*window;
+	char		*text;
+	int		i;
+
+	window = calloc(1, offsetof(wimp_window, icons) + DESKTOP_TEMPLATE_ICONS * sizeof(wimp_icon));
+	text = calloc(DESKTOP_TEMPLATE_ICONS + 1, DESKTOP_TEMPLATE_TEXT);
+
+	if (window == NULL || text == NULL) {
+		free(window);
+		free(text);
+		return NULL;
+	}
+
+	window->extent.x1 = 1000;
+	window->extent.y0 = -1000;
+	window->title_flags = wimp_ICON_TEXT | wimp_ICON_INDIRECTED;
+	window->title_data.indirected_text.text = text;
+	window->title_data.indirected_text.validation = NULL;
+	window->title_data.indirected_text.size = DESKTOP_TEMPLATE_TEXT;
+	window->icon_count = DESKTOP_TEMPLATE_ICONS;
+
+	for (i = 0; i < DESKTOP_TEMPLATE_ICONS; i++) {
+		window->icons[i].flags = wimp_ICON_TEXT | wimp_ICON_INDIRECTED;
+		window->icons[i].data.indirected_text.text = text + (i + 1) * DESKTOP_TEMPLATE_TEXT;
+		window->icons[i].data.indirected_text.validation = NULL;
+		window->icons[i].data.indirected_text.size = DESKTOP_TEMPLATE_TEXT;
+	}
+
+	return window;
+}
+
+
+wimp_w templates_create_window(char *name)
+{
+	wimp_window	*window;
+	wimp_w		w;
+
+	window = templates_load_window(name);
+	if (window == NULL)
+		return NULL;
+
+	/* The icons are copied, but their indirected data is kept. */
+
+	w = wimp_create_window(window);
+	free(window);
+
+	return w;
+}
+
+
+wimp_menu *templates_get_menu(char *name)
+{
+	wimp_menu	*menu;
+	int		i;
+
+	menu = calloc(1, offsetof(wimp_menu, entries) + DESKTOP_MENU_ENTRIES * sizeof(wimp_menu_entry));
+	if (menu == NULL)
+		return NULL;
+
+	for (i = 0; i < DESKTOP_MENU_ENTRIES; i++) {
+		menu->entries[i].sub_menu = wimp_NO_SUB_MENU;
+		menu->entries[i].icon_flags = wimp_ICON_TEXT;
+	}
+
+	menu->entries[DESKTOP_MENU_ENTRIES - 1].menu_flags = wimp_MENU_LAST;
+
+	return menu;
+}
+
+
+void templates_link_menu_dialogue(char *name, wimp_w dialogue)
+{
+}
+
+
+/* Menus. */
+
+wimp_menu *menus_create_standard_menu(wimp_menu *menu, wimp_pointer *pointer)
+{
+	return menu;
+}
+
+
+int menus_get_entries(wimp_menu *menu)
+{
+	int	entries = 0;
+
+	if (menu == NULL || menu == wimp_NO_SUB_MENU)
+		return 0;
+
+	while (!(menu->entries[entries++].menu_flags & wimp_MENU_LAST));
+
+	return entries;
+}
+
+
+void menus_tick_entry(wimp_menu *menu, int entry, osbool tick)
+{
+	if (menu == NULL || menu == wimp_NO_SUB_MENU || entry < 0)
+		return;
+
+	if (tick)
+		menu->entries[entry].menu_flags |= wimp_MENU_TICKED;
+	else
+		menu->entries[entry].menu_flags &= ~wimp_MENU_TICKED;
+}
+
+
+void menus_shade_entry(wimp_menu *menu, int entry, osbool shade)
+{
+	if (menu == NULL || menu == wimp_NO_SUB_MENU || entry < 0)
+		return;
+
+	if (shade)
+		menu->entries[entry].icon_flags |= wimp_ICON_SHADED;
+	else
+		menu->entries[entry].icon_flags &= ~wimp_ICON_SHADED;
+}
+
+
+/* Interactive help. */
+
+void ihelp_add_window(wimp_w window, char* name, void (*decode)(char *, wimp_w, wimp_i, os_coord, wimp_mouse_state))
+{
+}
+
+
+void ihelp_remove_window(wimp_w window)
+{
+}
+
+
+void ihelp_add_menu(wimp_menu *menu, char* name)
+{
+}
+
+
+void ihelp_remove_menu(wimp_menu *menu)
+{
+}
+
+
+/* Data transfer and saving. */
+
+void dataxfer_save_window_drag(wimp_w w, wimp_i i, void (*drag_end_callback)(wimp_pointer *, void *), void *drag_end_data)
+{
+}
+
+
+osbool dataxfer_start_save(wimp_pointer *pointer, char *name, int size, bits type, int your_ref,
+		osbool (*save_callback)(char *filename, void *data), void *data)
+{
+	return FALSE;
+}
+
+
+struct saveas_block *saveas_create_dialogue(osbool selection, char *sprite, osbool (*save_callback)(char *filename, osbool selection, void *data))
+{
+	return calloc(1, sizeof(struct saveas_block));
+}
+
+
+void saveas_initialise_dialogue(struct saveas_block *handle, char *filename, char *default_name, char *selection_name,
+		osbool selection, osbool selected, void *data)
+{
+	if (handle != NULL)
+		handle->data = data;
+}
+
+
+void saveas_prepare_dialogue(struct saveas_block *handle)
+{
+}
+
+
+void saveas_open_dialogue(struct saveas_block *handle, wimp_pointer *pointer)
+{
+}
+
+
+/* Screen mode. */
+
+int general_mode_width(void)
+{
+	return 2560;
+}
+
+
+int general_mode_height(void)
+{
+	return 2048;
+}
+
+
+/* Errors and debugging. */
+
+/**
+ * Report an error from the Messages file on stderr.
+ *
+ * \param *token		The token of the error message.
+ * \param *a			The first parameter, or NULL.
+ * \param *b			The second parameter, or NULL.
+ * \param *c			The third parameter, or NULL.
+ * \param *d			The fourth parameter, or NULL.
+ * \return			The button selected, which is always none.
+ */
+
+static wimp_error_box_selection desktop_report(char *token, char *a, char *b, char *c, char *d)
+{
+	char	message[DESKTOP_ERROR_LENGTH];
+
+	msgs_param_lookup(token, message, DESKTOP_ERROR_LENGTH, a, b, c, d);
+	fprintf(stderr, "PrintPDF: %s\n", message);
+
+	return wimp_ERROR_BOX_SELECTED_NOTHING;
+}
+
+
+wimp_error_box_selection error_msgs_report_error(char *token)
+{
+	return desktop_report(token, NULL, NULL, NULL, NULL);
+}
+
+
+wimp_error_box_selection error_msgs_param_report_error(char *token, char *a, char *b, char *c, char *d)
+{
+	return desktop_report(token, a, b, c, d);
+}
+
+
+wimp_error_box_selection error_msgs_report_info(char *token)
+{
+	return desktop_report(token, NULL, NULL, NULL, NULL);
+}
+
+
+wimp_error_box_selection error_msgs_param_report_info(char *token, char *a, char *b, char *c, char *d)
+{
+	return desktop_report(token, a, b, c, d);
+}
+
+
+wimp_error_box_selection error_msgs_report_question(char *token, char *buttons)
+{
+	return desktop_report(token, NULL, NULL, NULL, NULL);
+}
+
+
+void debug_printf(char *cntrl_string, ...)
+{
+	va_list	ap;
+
+	va_start(ap, cntrl_string);
+	vfprintf(stderr, cntrl_string, ap);
+	va_end(ap);
+
+	fputc('\n', stderr);
+}
+
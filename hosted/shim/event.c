@@ -0,0 +1,274 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: event.c
+ *
+ * Hosted SFLib implementation, for the event dispatcher.
+ *
+ * User messages are passed to the registered handlers in turn, until one
+ * claims them.  Windows never receive events in the hosted build, so their
+ * handlers are accepted and ignored; only their user data is kept.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+
+/* OSLib header files */
+
+#include "oslib/wimp.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/event.h"
+
+
+/**
+ * A registered message handler.
+ */
+
+struct event_message_handler {
+	unsigned			message;		/**< The message number handled.			*/
+	enum event_message_type		type;			/**< The type of message handled.			*/
+	osbool				(*action)(wimp_message *message);	/**< The handler.			*/
+
+	struct event_message_handler	*next;			/**< The next handler in the list.			*/
+};
+
+/**
+ * The user data attached to a window.
+ */
+
+struct event_window_data {
+	wimp_w				w;			/**< The window.					*/
+	void				*data;			/**< The data attached to the window.			*/
+
+	struct event_window_data	*next;			/**< The next window in the list.			*/
+};
+
+
+/**
+ * The registered message handlers, in the order that they were added.
+ */
+
+static struct event_message_handler *event_message_handlers = NULL;
+
+/**
+ * The windows with user data attached.
+ */
+
+static struct event_window_data *event_windows = NULL;
+
+
+osbool event_add_message_handler(unsigned message, enum event_message_type type, osbool (*message_action)(wimp_message *message))
+{
+	struct event_message_handler	*handler, **end;
+
+	handler = malloc(sizeof(struct event_message_handler));
+	if (handler == NULL)
+		return FALSE;
+
+	handler->message = message;
+	handler->type = type;
+	handler->action = message_action;
+	handler->next = NULL;
+
+	for (end = &event_message_handlers; *end != NULL; end = &((*end)->next));
+
+	*end = handler;
+
+	return TRUE;
+}
+
+
+/**
+ * Pass a message to the handlers registered for it, until one claims it.
+ *
+ * \param event			The Wimp event code for the message.
+ * \param *message		The message to process.
+ * \return			TRUE if the message was claimed; else FALSE.
+ */
+
+osbool event_process_message(wimp_event_no event, wimp_message *message)
+{
+	struct event_message_handler	*handler;
+	enum event_message_type		type;
+
+	type = (event == wimp_USER_MESSAGE_ACKNOWLEDGE) ? EVENT_MESSAGE_ACKNOWLEDGE : EVENT_MESSAGE_INCOMING;
+
+	for (handler = event_message_handlers; handler != NULL; handler = handler->next) {
+		if (handler->message == message->action && handler->type == type && handler->action(message))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+
+osbool event_add_window_user_data(wimp_w w, void *data)
+{
+	struct event_window_data	*window;
+
+	for (window = event_windows; window != NULL && window->w != w; window = window->next);
+
+	if (window == NULL) {
+		window = malloc(sizeof(struct event_window_data));
+		if (window == NULL)
+			return FALSE;
+
+		window->w = w;
+		window->next = event_windows;
+		event_windows = window;
+	}
+
+	window->data = data;
+
+	return TRUE;
+}
+
+
+void *event_get_window_user_data(wimp_w w)
+{
+	struct event_window_data	*window;
+
+	for (window = event_windows; window != NULL && window->w != w; window = window->next);
+
+	return (window != NULL) ? window->data : NULL;
+}
+
+
+void event_delete_window(wimp_w w)
+{
+	struct event_window_data	**window, *found;
+
+	for (window = &event_windows; *window != NULL && (*window)->w != w; window = &((*window)->next));
+
+	if (*window == NULL)
+		return;
+
+	found = *window;
+	*window = found->next;
+	free(found);
+}
+
+
+osbool event_add_window_close_event(wimp_w w, void (*callback)(wimp_close *close))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_redraw_event(wimp_w w, void (*callback)(wimp_draw *draw))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_mouse_event(wimp_w w, void (*callback)(wimp_pointer *pointer))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_key_event(wimp_w w, osbool (*callback)(wimp_key *key))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_scroll_event(wimp_w w, void (*callback)(wimp_scroll *scroll))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_gain_caret_event(wimp_w w, void (*callback)(wimp_caret *caret))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_lose_caret_event(wimp_w w, void (*callback)(wimp_caret *caret))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_menu(wimp_w w, wimp_menu *menu)
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_menu_prepare(wimp_w w, void (*callback)(wimp_w w, wimp_menu *m, wimp_pointer *pointer))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_menu_selection(wimp_w w, void (*callback)(wimp_w w, wimp_menu *m, wimp_selection *selection))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_menu_warning(wimp_w w, void (*callback)(wimp_w w, wimp_menu *m, wimp_message_menu_warning *warning))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_menu_close(wimp_w w, void (*callback)(wimp_w w, wimp_menu *m))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_icon_click(wimp_w w, wimp_i i, osbool (*callback)(wimp_pointer *pointer))
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_icon_radio(wimp_w w, wimp_i i, osbool complete)
+{
+	return TRUE;
+}
+
+
+osbool event_add_window_icon_popup(wimp_w w, wimp_i i, wimp_menu *menu, int field, char *token)
+{
+	return TRUE;
+}
+
+
+osbool event_set_drag_handler(void (*drag_end)(wimp_dragged *dragged, void *data), void (*drag_null_poll)(void *data), void *data)
+{
+	return TRUE;
+}
+
+
+void event_set_menu_block(wimp_menu *menu)
+{
+}
+
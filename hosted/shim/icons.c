@@ -0,0 +1,206 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: icons.c
+ *
+ * Hosted SFLib implementation, for the icon handling.
+ *
+ * The icons are those remembered by the hosted Wimp, so the text set in
+ * them can be read back and their selected and shaded states tested.
+ */
+
+/* ANSI C header files */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/* OSLib header files */
+
+#include "oslib/wimp.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/icons.h"
+#include "sflib/msgs.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "shim.h"
+
+
+/**
+ * Text returned for icons which don't exist.
+ */
+
+static char icons_no_text[1];
+
+
+char *icons_get_indirected_text_addr(wimp_w w, wimp_i i)
+{
+	wimp_icon	*icon = shim_find_icon(w, i);
+
+	if (icon == NULL || !(icon->flags & wimp_ICON_INDIRECTED) || icon->data.indirected_text.text == NULL) {
+		*icons_no_text = '\0';
+		return icons_no_text;
+	}
+
+	return icon->data.indirected_text.text;
+}
+
+
+int icons_get_indirected_text_length(wimp_w w, wimp_i i)
+{
+	wimp_icon	*icon = shim_find_icon(w, i);
+
+	if (icon == NULL || !(icon->flags & wimp_ICON_INDIRECTED) || icon->data.indirected_text.text == NULL)
+		return sizeof(icons_no_text);
+
+	return icon->data.indirected_text.size;
+}
+
+
+char *icons_copy_text(wimp_w w, wimp_i i, char *buffer, size_t length)
+{
+	return string_ctrl_copy(buffer, icons_get_indirected_text_addr(w, i), length);
+}
+
+
+char *icons_strncpy(wimp_w w, wimp_i i, char *s)
+{
+	return string_copy(icons_get_indirected_text_addr(w, i), s, icons_get_indirected_text_length(w, i));
+}
+
+
+int icons_printf(wimp_w w, wimp_i i, char *cntrl_string, ...)
+{
+	va_list	ap;
+	int	result;
+
+	va_start(ap, cntrl_string);
+	result = vsnprintf(icons_get_indirected_text_addr(w, i), icons_get_indirected_text_length(w, i), cntrl_string, ap);
+	va_end(ap);
+
+	return result;
+}
+
+
+char *icons_msgs_lookup(wimp_w w, wimp_i i, char *token)
+{
+	return msgs_lookup(token, icons_get_indirected_text_addr(w, i), icons_get_indirected_text_length(w, i));
+}
+
+
+void icons_set_selected(wimp_w w, wimp_i i, osbool selected)
+{
+	wimp_set_icon_state(w, i, (selected) ? wimp_ICON_SELECTED : 0, wimp_ICON_SELECTED);
+}
+
+
+osbool icons_get_selected(wimp_w w, wimp_i i)
+{
+	wimp_icon	*icon = shim_find_icon(w, i);
+
+	return (icon != NULL && (icon->flags & wimp_ICON_SELECTED)) ? TRUE : FALSE;
+}
+
+
+void icons_set_shaded(wimp_w w, wimp_i i, osbool shaded)
+{
+	wimp_set_icon_state(w, i, (shaded) ? wimp_ICON_SHADED : 0, wimp_ICON_SHADED);
+}
+
+
+void icons_set_group_shaded(wimp_w w, osbool shaded, int icons, ...)
+{
+	va_list	ap;
+	int	n;
+
+	va_start(ap, icons);
+
+	for (n = 0; n < icons; n++)
+		icons_set_shaded(w, va_arg(ap, wimp_i), shaded);
+
+	va_end(ap);
+}
+
+
+void icons_set_group_shaded_when_off(wimp_w w, wimp_i i, int icons, ...)
+{
+	va_list	ap;
+	osbool	shaded;
+	int	n;
+
+	shaded = !icons_get_selected(w, i) || (shim_find_icon(w, i) != NULL && (shim_find_icon(w, i)->flags & wimp_ICON_SHADED));
+
+	va_start(ap, icons);
+
+	for (n = 0; n < icons; n++)
+		icons_set_shaded(w, va_arg(ap, wimp_i), shaded);
+
+	va_end(ap);
+}
+
+
+void icons_set_radio_group_selected(wimp_w w, int selected, int icons, ...)
+{
+	va_list	ap;
+	int	n;
+
+	va_start(ap, icons);
+
+	for (n = 0; n < icons; n++)
+		icons_set_selected(w, va_arg(ap, wimp_i), n == selected);
+
+	va_end(ap);
+}
+
+
+int icons_get_radio_group_selected(wimp_w w, int icons, ...)
+{
+	va_list	ap;
+	int	n, selected = -1;
+
+	va_start(ap, icons);
+
+	for (n = 0; n < icons; n++) {
+		if (icons_get_selected(w, va_arg(ap, wimp_i)) && selected == -1)
+			selected = n;
+	}
+
+	va_end(ap);
+
+	return selected;
+}
+
+
+void icons_put_caret_at_end(wimp_w w, wimp_i i)
+{
+}
+
+
+void icons_replace_caret_in_window(wimp_w w)
+{
+}
+
@@ -0,0 +1,149 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: msgs.c
+ *
+ * Hosted SFLib implementation, for the messages.
+ *
+ * A RISC OS Messages file is read in full, and tokens are looked up in it
+ * with the same parameter substitution as MessageTrans.  Tokens which
+ * can't be found are returned as they stand.
+ */
+
+/* ANSI C header files */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* OSLib header files */
+
+#include "oslib/types.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/msgs.h"
+#include "sflib/string.h"
+
+
+/**
+ * A message from the file.
+ */
+
+struct msgs_message {
+	char			*token;				/**< The message's token.				*/
+	char			*text;				/**< The message's text.				*/
+
+	struct msgs_message	*next;				/**< The next message in the list.			*/
+};
+
+
+/**
+ * The messages from the file.
+ */
+
+static struct msgs_message *msgs_messages = NULL;
+
+
+void msgs_initialise(char *file)
+{
+	struct msgs_message	*message;
+	FILE			*in;
+	char			line[1024], *colon, *end;
+
+	in = fopen(file, "r");
+	if (in == NULL) {
+		fprintf(stderr, "Unable to open messages file %s\n", file);
+		return;
+	}
+
+	while (fgets(line, sizeof(line), in) != NULL) {
+		end = line + strcspn(line, "\r\n");
+		*end = '\0';
+
+		if (*line == '#' || (colon = strchr(line, ':')) == NULL)
+			continue;
+
+		*colon = '\0';
+
+		message = malloc(sizeof(struct msgs_message));
+		if (message == NULL)
+			break;
+
+		message->token = strdup(line);
+		message->text = strdup(colon + 1);
+		message->next = msgs_messages;
+		msgs_messages = message;
+	}
+
+	fclose(in);
+}
+
+
+char *msgs_lookup(char *token, char *buffer, size_t buffer_size)
+{
+	return msgs_param_lookup(token, buffer, buffer_size, NULL, NULL, NULL, NULL);
+}
+
+
+char *msgs_param_lookup(char *token, char *buffer, size_t buffer_size, char *a, char *b, char *c, char *d)
+{
+	struct msgs_message	*message;
+	char			*text, *param[4];
+	size_t			used = 0;
+
+	if (buffer == NULL || buffer_size == 0)
+		return buffer;
+
+	param[0] = a;
+	param[1] = b;
+	param[2] = c;
+	param[3] = d;
+
+	text = token;
+
+	for (message = msgs_messages; message != NULL; message = message->next) {
+		if (strcmp(message->token, token) == 0) {
+			text = message->text;
+			break;
+		}
+	}
+
+	while (*text != '\0' && used < buffer_size - 1) {
+		if (*text == '%' && text[1] >= '0' && text[1] <= '3') {
+			if (param[text[1] - '0'] != NULL) {
+				string_copy(buffer + used, param[text[1] - '0'], buffer_size - used);
+				used += strlen(buffer + used);
+			}
+
+			text += 2;
+		} else {
+			buffer[used++] = *text++;
+		}
+	}
+
+	buffer[used] = '\0';
+
+	return buffer;
+}
+
@@ -0,0 +1,728 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: oslib.c
+ *
+ * Hosted OSLib implementation, for the kernel and filing system calls.
+ *
+ * Filenames are passed to the host as they stand.  Objects which aren't
+ * found are reported in the way that RISC OS reports them -- usually as
+ * an object type or handle of zero, rather than as an error.
+ */
+
+/* ANSI C header files */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+#include "oslib/dragasprite.h"
+#include "oslib/fileswitch.h"
+#include "oslib/hourglass.h"
+#include "oslib/osargs.h"
+#include "oslib/osbyte.h"
+#include "oslib/osfile.h"
+#include "oslib/osfind.h"
+#include "oslib/osfscontrol.h"
+#include "oslib/osgbpb.h"
+#include "oslib/territory.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/string.h"
+
+
+/**
+ * The size of the buffer used when copying files.
+ */
+
+#define OSLIB_COPY_BUFFER 65536
+
+/**
+ * The offset from the RISC OS epoch, in 1900, to the Unix epoch, in seconds.
+ */
+
+#define OSLIB_EPOCH_OFFSET 2208988800LL
+
+/**
+ * The file type reported for files, which don't have types on the host,
+ * unless their extension is one of those in oslib_extensions.
+ */
+
+#define OSLIB_FILE_TYPE osfile_TYPE_DATA
+
+/**
+ * The file type reported for directories.
+ */
+
+#define OSLIB_DIR_TYPE 0x1000
+
+
+/* Function Prototypes. */
+
+static os_error *oslib_error(char *message);
+static os_error *oslib_errno_error(char *name);
+static os_error *oslib_open(char const *file_name, int flags, os_fw *file);
+static void oslib_read_object(char const *file_name, fileswitch_object_type *obj_type, bits *load_addr, bits *exec_addr,
+		int *size, fileswitch_attr *attr, bits *file_type);
+static bits oslib_type_from_extension(char const *file_name);
+
+
+/**
+ * The filename extensions which map on to RISC OS file types.
+ */
+
+static struct {
+	char	*extension;
+	bits	file_type;
+} oslib_extensions[] = {
+	{".ps", osfile_TYPE_POSTSCRIPT},
+	{".pdf", 0xadf},
+	{".txt", osfile_TYPE_TEXT},
+	{NULL, 0}
+};
+
+
+/**
+ * The error block returned by the calls.
+ */
+
+static os_error oslib_error_block;
+
+
+/**
+ * Fill in the error block.
+ *
+ * \param *message		The error message.
+ * \return			Pointer to the error block.
+ */
+
+static os_error *oslib_error(char *message)
+{
+	oslib_error_block.errnum = 0;
+	string_copy(oslib_error_block.errmess, message, sizeof(oslib_error_block.errmess));
+
+	return &oslib_error_block;
+}
+
+
+/**
+ * Fill in the error block from errno.
+ *
+ * \param *name			The name of the object which caused the error.
+ * \return			Pointer to the error block.
+ */
+
+static os_error *oslib_errno_error(char *name)
+{
+	oslib_error_block.errnum = (bits) errno;
+	string_printf(oslib_error_block.errmess, sizeof(oslib_error_block.errmess), "%s: %s", name, strerror(errno));
+
+	return &oslib_error_block;
+}
+
+
+/* OS_ calls. */
+
+os_t os_read_monotonic_time(void)
+{
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (os_t) (now.tv_sec * 100 + now.tv_nsec / 10000000);
+}
+
+
+void os_read_var_val_size(char const *var, int context, os_var_type var_type, int *used, int *context_out)
+{
+	char	*value = getenv(var);
+
+	/* The size of a variable which exists is returned negated. */
+
+	if (used != NULL)
+		*used = (value == NULL) ? 0 : -((int) strlen(value) + 1);
+
+	if (context_out != NULL)
+		*context_out = 0;
+}
+
+
+os_error *xos_read_var_val(char const *var, char *value, int size, int context, os_var_type var_type, int *used,
+		int *context_out, os_var_type *var_type_out)
+{
+	char	*found = getenv(var);
+
+	if (found == NULL)
+		return oslib_error("System variable not found");
+
+	if (value != NULL && size > 0)
+		string_copy(value, found, size);
+
+	if (used != NULL)
+		*used = strlen(found);
+
+	if (context_out != NULL)
+		*context_out = 0;
+
+	if (var_type_out != NULL)
+		*var_type_out = 0;
+
+	return NULL;
+}
+
+
+os_error *xos_cli(char const *command)
+{
+	return oslib_error("Star commands are not supported by the hosted build");
+}
+
+
+void os_cli(char const *command)
+{
+}
+
+
+os_error *xos_swi_number_from_string(char const *swi_name, int *swi_no)
+{
+	return oslib_error("SWI name not known");
+}
+
+
+void os_plot(int plot_code, int x, int y)
+{
+}
+
+
+int osbyte1(int op, int r1, int r2)
+{
+	return 0;
+}
+
+
+int osbyte2(int op, int r1, int r2)
+{
+	return 0;
+}
+
+
+/* OS_File calls. */
+
+/**
+ * Read the details of a filing system object.
+ *
+ * \param *file_name		The object to read.
+ * \param *obj_type		Pointer to a variable to take the object type, or NULL.
+ * \param *load_addr		Pointer to a variable to take the load address, or NULL.
+ * \param *exec_addr		Pointer to a variable to take the exec address, or NULL.
+ * \param *size			Pointer to a variable to take the size, or NULL.
+ * \param *attr			Pointer to a variable to take the attributes, or NULL.
+ * \param *file_type		Pointer to a variable to take the file type, or NULL.
+ */
+
+static void oslib_read_object(char const *file_name, fileswitch_object_type *obj_type, bits *load_addr, bits *exec_addr,
+		int *size, fileswitch_attr *attr, bits *file_type)
+{
+	struct stat		info;
+	fileswitch_object_type	type = fileswitch_NOT_FOUND;
+	long long		stamp = 0;
+	bits			ftype = 0;
+
+	if (file_name != NULL && stat(file_name, &info) == 0) {
+		if (S_ISDIR(info.st_mode)) {
+			type = fileswitch_IS_DIR;
+			ftype = OSLIB_DIR_TYPE;
+		} else {
+			type = fileswitch_IS_FILE;
+			ftype = oslib_type_from_extension(file_name);
+		}
+
+		stamp = ((long long) info.st_mtime + OSLIB_EPOCH_OFFSET) * 100;
+	}
+
+	if (obj_type != NULL)
+		*obj_type = type;
+
+	if (load_addr != NULL)
+		*load_addr = (type == fileswitch_NOT_FOUND) ? 0 : 0xfff00000u | ((ftype & 0xfff) << 8) | (bits) ((stamp >> 32) & 0xff);
+
+	if (exec_addr != NULL)
+		*exec_addr = (bits) (stamp & 0xffffffffu);
+
+	if (size != NULL)
+		*size = (type == fileswitch_IS_FILE) ? (int) info.st_size : 0;
+
+	if (attr != NULL)
+		*attr = (type == fileswitch_NOT_FOUND) ? 0 : 0x03;
+
+	if (file_type != NULL)
+		*file_type = ftype;
+}
+
+
+/**
+ * Find the file type of a file from its filename extension.
+ *
+ * \param *file_name		The name of the file.
+ * \return			The file type.
+ */
+
+static bits oslib_type_from_extension(char const *file_name)
+{
+	char	*extension;
+	int	i;
+
+	extension = strrchr(file_name, '.');
+	if (extension == NULL || strchr(extension, '/') != NULL)
+		return OSLIB_FILE_TYPE;
+
+	for (i = 0; oslib_extensions[i].extension != NULL; i++) {
+		if (strcasecmp(extension, oslib_extensions[i].extension) == 0)
+			return oslib_extensions[i].file_type;
+	}
+
+	return OSLIB_FILE_TYPE;
+}
+
+
+os_error *xosfile_create(char const *file_name, bits load_addr, bits exec_addr, int size)
+{
+	int	file;
+
+	file = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (file < 0)
+		return oslib_errno_error((char *) file_name);
+
+	if (size > 0 && ftruncate(file, size) != 0) {
+		close(file);
+		return oslib_errno_error((char *) file_name);
+	}
+
+	close(file);
+
+	return NULL;
+}
+
+
+os_error *xosfile_create_dir(char const *dir_name, int entry_count)
+{
+	if (mkdir(dir_name, 0777) != 0 && errno != EEXIST)
+		return oslib_errno_error((char *) dir_name);
+
+	return NULL;
+}
+
+
+void osfile_create_dir(char const *dir_name, int entry_count)
+{
+	xosfile_create_dir(dir_name, entry_count);
+}
+
+
+os_error *xosfile_delete(char const *file_name, fileswitch_object_type *obj_type, bits *load_addr, bits *exec_addr,
+		int *size, fileswitch_attr *attr)
+{
+	fileswitch_object_type	type;
+
+	oslib_read_object(file_name, &type, load_addr, exec_addr, size, attr, NULL);
+
+	if (obj_type != NULL)
+		*obj_type = type;
+
+	if (type == fileswitch_IS_DIR && rmdir(file_name) != 0)
+		return oslib_errno_error((char *) file_name);
+	else if (type == fileswitch_IS_FILE && unlink(file_name) != 0)
+		return oslib_errno_error((char *) file_name);
+
+	return NULL;
+}
+
+
+os_error *xosfile_read_no_path(char const *file_name, fileswitch_object_type *obj_type, bits *load_addr, bits *exec_addr,
+		int *size, fileswitch_attr *attr)
+{
+	oslib_read_object(file_name, obj_type, load_addr, exec_addr, size, attr, NULL);
+
+	return NULL;
+}
+
+
+os_error *xosfile_read_stamped_no_path(char const *file_name, fileswitch_object_type *obj_type, bits *load_addr,
+		bits *exec_addr, int *size, fileswitch_attr *attr, bits *file_type)
+{
+	oslib_read_object(file_name, obj_type, load_addr, exec_addr, size, attr, file_type);
+
+	return NULL;
+}
+
+
+fileswitch_object_type osfile_read_stamped_no_path(char const *file_name, bits *load_addr, bits *exec_addr, int *size,
+		fileswitch_attr *attr, bits *file_type)
+{
+	fileswitch_object_type	type;
+
+	oslib_read_object(file_name, &type, load_addr, exec_addr, size, attr, file_type);
+
+	return type;
+}
+
+
+fileswitch_object_type osfile_read_stamped(char const *file_name, bits *load_addr, bits *exec_addr, int *size,
+		fileswitch_attr *attr, bits *file_type)
+{
+	return osfile_read_stamped_no_path(file_name, load_addr, exec_addr, size, attr, file_type);
+}
+
+
+os_error *xosfile_set_type(char const *file_name, bits file_type)
+{
+	return NULL;
+}
+
+
+void osfile_set_type(char const *file_name, bits file_type)
+{
+}
+
+
+/* OS_Find, OS_Args and OS_GBPB calls, which use the host's file descriptors as handles. */
+
+/**
+ * Open a file, returning a handle of zero if it can't be found.
+ *
+ * \param *file_name		The file to open.
+ * \param flags			The flags to pass to open().
+ * \param *file			Pointer to a variable to take the handle.
+ * \return			Pointer to an error block, or NULL.
+ */
+
+static os_error *oslib_open(char const *file_name, int flags, os_fw *file)
+{
+	int	handle;
+
+	*file = 0;
+
+	handle = open(file_name, flags, 0666);
+
+	if (handle < 0)
+		return (errno == ENOENT) ? NULL : oslib_errno_error((char *) file_name);
+
+	*file = handle;
+
+	return NULL;
+}
+
+
+os_error *xosfind_openinw(osfind_flags flags, char const *file_name, char const *path, os_fw *file)
+{
+	return oslib_open(file_name, O_RDONLY, file);
+}
+
+
+os_error *xosfind_openoutw(osfind_flags flags, char const *file_name, char const *path, os_fw *file)
+{
+	return oslib_open(file_name, O_WRONLY | O_CREAT | O_TRUNC, file);
+}
+
+
+os_error *xosfind_openupw(osfind_flags flags, char const *file_name, char const *path, os_fw *file)
+{
+	return oslib_open(file_name, O_RDWR, file);
+}
+
+
+os_error *xosfind_closew(os_fw file)
+{
+	if (close(file) != 0)
+		return oslib_errno_error("Close");
+
+	return NULL;
+}
+
+
+void osfind_closew(os_fw file)
+{
+	xosfind_closew(file);
+}
+
+
+os_error *xosargs_read_extw(os_fw file, int *ext)
+{
+	struct stat	info;
+
+	if (fstat(file, &info) != 0)
+		return oslib_errno_error("Read extent");
+
+	if (ext != NULL)
+		*ext = (int) info.st_size;
+
+	return NULL;
+}
+
+
+os_error *xosargs_set_ptrw(os_fw file, int ptr)
+{
+	if (lseek(file, ptr, SEEK_SET) < 0)
+		return oslib_errno_error("Set pointer");
+
+	return NULL;
+}
+
+
+os_error *xosgbpb_readw(os_fw file, byte *buffer, int size, int *unread)
+{
+	ssize_t	bytes;
+	int	done = 0;
+
+	while (done < size) {
+		bytes = read(file, buffer + done, size - done);
+
+		if (bytes < 0 && errno == EINTR)
+			continue;
+
+		if (bytes < 0)
+			return oslib_errno_error("Read");
+
+		if (bytes == 0)
+			break;
+
+		done += bytes;
+	}
+
+	if (unread != NULL)
+		*unread = size - done;
+
+	return NULL;
+}
+
+
+os_error *xosgbpb_writew(os_fw file, byte const *data, int size, int *unwritten)
+{
+	ssize_t	bytes;
+	int	done = 0;
+
+	while (done < size) {
+		bytes = write(file, data + done, size - done);
+
+		if (bytes < 0 && errno == EINTR)
+			continue;
+
+		if (bytes <= 0)
+			return oslib_errno_error("Write");
+
+		done += bytes;
+	}
+
+	if (unwritten != NULL)
+		*unwritten = size - done;
+
+	return NULL;
+}
+
+
+/* OS_FSControl calls. */
+
+os_error *xosfscontrol_canonicalise_path(char const *path_name, char *buffer, char const *var, char const *path,
+		int size, int *spare)
+{
+	char	cwd[1024];
+	int	length;
+
+	/* Names are made absolute, but otherwise used as given. */
+
+	if (*path_name == '/' || getcwd(cwd, sizeof(cwd)) == NULL)
+		*cwd = '\0';
+
+	length = strlen(path_name) + ((*cwd != '\0') ? strlen(cwd) + 1 : 0) + 1;
+
+	if (buffer != NULL && length <= size) {
+		if (*cwd != '\0')
+			string_printf(buffer, size, "%s/%s", cwd, path_name);
+		else
+			string_copy(buffer, (char *) path_name, size);
+	}
+
+	if (spare != NULL)
+		*spare = size - length;
+
+	return NULL;
+}
+
+
+os_error *xosfscontrol_copy(char const *from, char const *to, osfscontrol_copy_flags flags, bits start_load,
+		bits start_exec, bits end_load, bits end_exec, osfscontrol_descriptor const *descriptor)
+{
+	FILE	*in, *out;
+	char	*buffer;
+	size_t	bytes;
+	osbool	failed = FALSE;
+
+	buffer = malloc(OSLIB_COPY_BUFFER);
+	if (buffer == NULL)
+		return oslib_error("Not enough memory to copy");
+
+	in = fopen(from, "rb");
+	if (in == NULL) {
+		free(buffer);
+		return oslib_errno_error((char *) from);
+	}
+
+	out = fopen(to, "wb");
+	if (out == NULL) {
+		fclose(in);
+		free(buffer);
+		return oslib_errno_error((char *) to);
+	}
+
+	while (!failed && (bytes = fread(buffer, 1, OSLIB_COPY_BUFFER, in)) > 0) {
+		if (fwrite(buffer, 1, bytes, out) != bytes)
+			failed = TRUE;
+	}
+
+	if (ferror(in))
+		failed = TRUE;
+
+	fclose(in);
+
+	if (fclose(out) != 0)
+		failed = TRUE;
+
+	free(buffer);
+
+	return (failed) ? oslib_errno_error((char *) to) : NULL;
+}
+
+
+os_error *xosfscontrol_rename(char const *source, char const *destination)
+{
+	if (rename(source, destination) != 0)
+		return oslib_errno_error((char *) source);
+
+	return NULL;
+}
+
+
+/* Other modules. */
+
+void hourglass_on(void)
+{
+}
+
+
+void hourglass_off(void)
+{
+}
+
+
+void dragasprite_start(dragasprite_flags flags, osspriteop_area const *area, char const *name, os_box const *box,
+		os_box const *bbox)
+{
+}
+
+
+void dragasprite_stop(void)
+{
+}
+
+
+char *territory_convert_standard_date_and_time(territory_t territory, os_date_and_time const *date_and_time,
+		char *buffer, int size)
+{
+	long long	stamp = 0;
+	time_t		seconds;
+	struct tm	*local;
+	int		i;
+
+	for (i = 4; i >= 0; i--)
+		stamp = (stamp << 8) | (*date_and_time)[i];
+
+	seconds = (time_t) (stamp / 100 - OSLIB_EPOCH_OFFSET);
+	local = localtime(&seconds);
+
+	if (local == NULL || strftime(buffer, size, "%H:%M:%S %d-%b-%Y", local) == 0)
+		*buffer = '\0';
+
+	return buffer + strlen(buffer);
+}
+
+
+/* Directory enumeration, in which the context is the index of the next entry. */
+
+os_error *xosgbpb_dir_entries(char const *dir_name, osgbpb_string_list *buffer, int count, int context, int size,
+		char const *file_name, int *read_count, int *context_out)
+{
+	DIR		*dir;
+	struct dirent	*entry;
+	char		*out = (char *) buffer;
+	int		index = 0, found = 0, used = 0, length;
+
+	dir = opendir(dir_name);
+	if (dir == NULL)
+		return oslib_errno_error((char *) dir_name);
+
+	while ((entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+
+		if (index++ < context)
+			continue;
+
+		length = strlen(entry->d_name) + 1;
+
+		if (found >= count || used + length > size) {
+			closedir(dir);
+
+			if (read_count != NULL)
+				*read_count = found;
+
+			if (context_out != NULL)
+				*context_out = context + found;
+
+			return NULL;
+		}
+
+		memcpy(out + used, entry->d_name, length);
+		used += length;
+		found++;
+	}
+
+	closedir(dir);
+
+	if (read_count != NULL)
+		*read_count = found;
+
+	if (context_out != NULL)
+		*context_out = -1;
+
+	return NULL;
+}
@@ -0,0 +1,56 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: shim.h
+ *
+ * Hosted shim internals, shared between the OSLib and SFLib shims.
+ */
+
+#ifndef HOSTED_SHIM
+#define HOSTED_SHIM
+
+#include "oslib/wimp.h"
+
+
+/**
+ * Find an icon in a window.
+ *
+ * \param w			The window containing the icon.
+ * \param i			The icon to find.
+ * \return			Pointer to the icon, or NULL if not found.
+ */
+
+wimp_icon *shim_find_icon(wimp_w w, wimp_i i);
+
+
+/**
+ * Test whether a window is open.
+ *
+ * \param w			The window to test.
+ * \return			TRUE if the window is open; else FALSE.
+ */
+
+osbool shim_window_is_open(wimp_w w);
+
+#endif
+
@@ -0,0 +1,174 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: string.c
+ *
+ * Hosted SFLib implementation, for the string handling.
+ *
+ * The filename functions use the host's conventions: '/' separates the
+ * directories, and '.' starts an extension.
+ */
+
+/* ANSI C header files */
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/* OSLib header files */
+
+#include "oslib/types.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/string.h"
+
+
+char *string_copy(char *dest, char *src, size_t len)
+{
+	size_t	length;
+
+	if (dest == NULL || len == 0)
+		return dest;
+
+	if (src == NULL)
+		src = "";
+
+	/* The buffers may overlap, as they do when an icon is set from its
+	 * own text, so copy the string as SFLib does.
+	 */
+
+	length = strlen(src);
+	if (length >= len)
+		length = len - 1;
+
+	memmove(dest, src, length);
+	dest[length] = '\0';
+
+	return dest;
+}
+
+
+char *string_ctrl_copy(char *dest, char *src, size_t len)
+{
+	size_t	i;
+
+	if (dest == NULL || len == 0)
+		return dest;
+
+	for (i = 0; i < len - 1 && src != NULL && (unsigned char) src[i] >= ' '; i++)
+		dest[i] = src[i];
+
+	dest[i] = '\0';
+
+	return dest;
+}
+
+
+char *string_ctrl_zero_terminate(char *s, size_t len)
+{
+	size_t	i;
+
+	if (s == NULL)
+		return s;
+
+	for (i = 0; i < len && (unsigned char) s[i] >= ' '; i++);
+
+	if (i < len)
+		s[i] = '\0';
+
+	return s;
+}
+
+
+int string_printf(char *s, size_t len, char *cntrl_string, ...)
+{
+	va_list	ap;
+	int	result;
+
+	va_start(ap, cntrl_string);
+	result = vsnprintf(s, len, cntrl_string, ap);
+	va_end(ap);
+
+	return result;
+}
+
+
+int string_nocase_strcmp(char *s1, char *s2)
+{
+	return strcasecmp(s1, s2);
+}
+
+
+char *string_find_leafname(char *filename)
+{
+	char	*leaf = strrchr(filename, '/');
+
+	return (leaf != NULL) ? leaf + 1 : filename;
+}
+
+
+char *string_find_pathname(char *filename)
+{
+	char	*separator = strrchr(filename, '/');
+
+	if (separator != NULL)
+		*separator = '\0';
+
+	return filename;
+}
+
+
+char *string_find_extension(char *filename)
+{
+	char	*extension = strrchr(string_find_leafname(filename), '.');
+
+	return (extension != NULL) ? extension + 1 : "";
+}
+
+
+char *string_strip_extension(char *filename)
+{
+	char	*leaf = string_find_leafname(filename), *extension;
+
+	extension = strrchr(leaf, '.');
+	if (extension != NULL)
+		*extension = '\0';
+
+	return leaf;
+}
+
+
+int string_convert_version_number(char *string)
+{
+	int	major = 0, minor = 0;
+
+	if (string == NULL || sscanf(string, "%d.%d", &major, &minor) < 1)
+		return 0;
+
+	return major * 100 + minor;
+}
+
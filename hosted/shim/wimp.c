@@ -0,0 +1,411 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file: wimp.c
+ *
+ * Hosted OSLib implementation, for the Wimp calls.
+ *
+ * Windows are never shown, but are remembered along with their icons so
+ * that the text held in dialogues can be set and read back.  Messages are
+ * passed to the hosted environment for delivery, and tasks are started
+ * through the hosted process layer.
+ */
+
+/* ANSI C header files */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+#include "oslib/wimp.h"
+
+/* Application header files */
+
+#include "shim.h"
+
+#include "hosted.h"
+#include "main.h"
+#include "process.h"
+
+
+/**
+ * A window known to the Wimp.
+ */
+
+struct wimp_w_ {
+	osbool			open;				/**< TRUE if the window is open.			*/
+	os_box			extent;				/**< The window's work area extent.			*/
+	int			icon_count;			/**< The number of icons in the window.			*/
+	wimp_icon		*icons;				/**< The window's icons.				*/
+};
+
+
+/* Function Prototypes. */
+
+static os_error *wimp_shim_error(char *message);
+
+
+/**
+ * The error block returned by the calls.
+ */
+
+static os_error wimp_shim_error_block;
+
+
+/**
+ * Fill in the error block.
+ *
+ * \param *message		The error message.
+ * \return			Pointer to the error block.
+ */
+
+static os_error *wimp_shim_error(char *message)
+{
+	wimp_shim_error_block.errnum = 0;
+	strncpy(wimp_shim_error_block.errmess, message, sizeof(wimp_shim_error_block.errmess) - 1);
+
+	return &wimp_shim_error_block;
+}
+
+
+/**
+ * Find an icon in a window.
+ *
+ * \param w			The window containing the icon.
+ * \param i			The icon to find.
+ * \return			Pointer to the icon, or NULL if not found.
+ */
+
+wimp_icon *shim_find_icon(wimp_w w, wimp_i i)
+{
+	if (w == NULL || w == wimp_ICON_BAR || w == wimp_TOP || i < 0 || i >= w->icon_count)
+		return NULL;
+
+	return &(w->icons[i]);
+}
+
+
+/**
+ * Test whether a window is open.
+ *
+ * \param w			The window to test.
+ * \return			TRUE if the window is open; else FALSE.
+ */
+
+osbool shim_window_is_open(wimp_w w)
+{
+	return (w != NULL && w != wimp_ICON_BAR && w != wimp_TOP) ? w->open : FALSE;
+}
+
+
+/* Window handling. */
+
+wimp_w wimp_create_window(wimp_window const *window)
+{
+	wimp_w	w;
+
+	w = calloc(1, sizeof(struct wimp_w_));
+	if (w == NULL)
+		return NULL;
+
+	w->extent = window->extent;
+	w->icon_count = window->icon_count;
+
+	if (w->icon_count > 0) {
+		w->icons = malloc(w->icon_count * sizeof(wimp_icon));
+
+		if (w->icons == NULL)
+			w->icon_count = 0;
+		else
+			memcpy(w->icons, window->icons, w->icon_count * sizeof(wimp_icon));
+	}
+
+	return w;
+}
+
+
+void wimp_delete_window(wimp_w w)
+{
+	if (w == NULL)
+		return;
+
+	free(w->icons);
+	free(w);
+}
+
+
+void wimp_open_window(wimp_open *open)
+{
+	xwimp_open_window(open);
+}
+
+
+os_error *xwimp_open_window(wimp_open *open)
+{
+	if (open != NULL && open->w != NULL)
+		open->w->open = TRUE;
+
+	return NULL;
+}
+
+
+void wimp_close_window(wimp_w w)
+{
+	if (w != NULL)
+		w->open = FALSE;
+}
+
+
+osbool wimp_redraw_window(wimp_draw *draw)
+{
+	return FALSE;
+}
+
+
+osbool wimp_get_rectangle(wimp_draw *draw)
+{
+	return FALSE;
+}
+
+
+void wimp_get_window_state(wimp_window_state *state)
+{
+	xwimp_get_window_state(state);
+}
+
+
+os_error *xwimp_get_window_state(wimp_window_state *state)
+{
+	wimp_w	w = state->w;
+
+	memset(state, 0, sizeof(wimp_window_state));
+
+	state->w = w;
+	state->next = wimp_TOP;
+
+	if (w != NULL) {
+		state->visible = w->extent;
+		state->flags = (w->open) ? wimp_WINDOW_OPEN : 0;
+	}
+
+	return NULL;
+}
+
+
+os_error *xwimp_get_window_info_header_only(wimp_window_info *info)
+{
+	wimp_w	w = info->w;
+
+	memset(info, 0, offsetof(wimp_window_info, icons));
+
+	info->w = w;
+
+	if (w != NULL) {
+		info->extent = w->extent;
+		info->visible = w->extent;
+		info->icon_count = w->icon_count;
+	}
+
+	return NULL;
+}
+
+
+void wimp_set_extent(wimp_w w, os_box const *box)
+{
+	xwimp_set_extent(w, box);
+}
+
+
+os_error *xwimp_set_extent(wimp_w w, os_box const *box)
+{
+	if (w != NULL && box != NULL)
+		w->extent = *box;
+
+	return NULL;
+}
+
+
+void wimp_force_redraw(wimp_w w, int x0, int y0, int x1, int y1)
+{
+}
+
+
+void wimp_block_copy(wimp_w w, int x0, int y0, int x1, int y1, int x, int y)
+{
+}
+
+
+os_error *xwimp_force_redraw_title(wimp_w w)
+{
+	return NULL;
+}
+
+
+os_error *xwimp_create_icon(wimp_icon_create const *icon, wimp_i *i)
+{
+	wimp_icon	*icons;
+	wimp_w		w = icon->w;
+
+	if (w == NULL || w == wimp_ICON_BAR)
+		return wimp_shim_error("Icons can't be created here");
+
+	icons = realloc(w->icons, (w->icon_count + 1) * sizeof(wimp_icon));
+	if (icons == NULL)
+		return wimp_shim_error("Not enough memory for icon");
+
+	w->icons = icons;
+	w->icons[w->icon_count] = icon->icon;
+
+	if (i != NULL)
+		*i = w->icon_count;
+
+	w->icon_count++;
+
+	return NULL;
+}
+
+
+void wimp_delete_icon(wimp_w w, wimp_i i)
+{
+	wimp_icon	*icon = shim_find_icon(w, i);
+
+	if (icon != NULL)
+		icon->flags |= wimp_ICON_DELETED;
+}
+
+
+void wimp_set_icon_state(wimp_w w, wimp_i i, wimp_icon_flags eor_bits, wimp_icon_flags clear_bits)
+{
+	wimp_icon	*icon = shim_find_icon(w, i);
+
+	if (icon != NULL)
+		icon->flags = (icon->flags & ~clear_bits) ^ eor_bits;
+}
+
+
+void wimp_plot_icon(wimp_icon const *icon)
+{
+}
+
+
+void wimp_set_colour(wimp_colour colour)
+{
+}
+
+
+void wimp_set_caret_position(wimp_w w, wimp_i i, int x, int y, int height, int index)
+{
+}
+
+
+os_error *xwimp_get_caret_position(wimp_caret *caret)
+{
+	memset(caret, 0, sizeof(wimp_caret));
+	caret->w = wimp_TOP;
+	caret->i = wimp_ICON_WINDOW;
+
+	return NULL;
+}
+
+
+void wimp_get_pointer_info(wimp_pointer *pointer)
+{
+	xwimp_get_pointer_info(pointer);
+}
+
+
+os_error *xwimp_get_pointer_info(wimp_pointer *pointer)
+{
+	memset(pointer, 0, sizeof(wimp_pointer));
+	pointer->w = wimp_TOP;
+	pointer->i = wimp_ICON_WINDOW;
+
+	return NULL;
+}
+
+
+void wimp_drag_box(wimp_drag const *drag)
+{
+}
+
+
+void wimp_auto_scroll(wimp_auto_scroll_flags flags, wimp_auto_scroll_info const *scroll)
+{
+}
+
+
+void wimp_create_menu(wimp_menu *menu, int x, int y)
+{
+}
+
+
+void wimp_create_sub_menu(wimp_menu *sub_menu, int x, int y)
+{
+}
+
+
+os_error *xwimp_slot_size(int new_curr_slot, int new_next_slot, int *curr_slot, int *next_slot, int *free_slot)
+{
+	/* Child tasks have their own address spaces, so memory is never short. */
+
+	if (curr_slot != NULL)
+		*curr_slot = 0;
+
+	if (next_slot != NULL)
+		*next_slot = 0;
+
+	if (free_slot != NULL)
+		*free_slot = 0x7fffffff;
+
+	return NULL;
+}
+
+
+/* Tasks and messages. */
+
+os_error *xwimp_start_task(char const *command, wimp_t *handle)
+{
+	if (!process_start((char *) command, handle))
+		return wimp_shim_error("Unable to start task");
+
+	return NULL;
+}
+
+
+void wimp_send_message(wimp_event_no event, wimp_message *message, wimp_t to)
+{
+	xwimp_send_message(event, message, to);
+}
+
+
+os_error *xwimp_send_message(wimp_event_no event, wimp_message *message, wimp_t to)
+{
+	if (hosted_send_message(event, message, message->size, main_task_handle, to) == 0)
+		return wimp_shim_error("Message queue full");
+
+	return NULL;
+}
+
@@ -25,14 +25,25 @@
  * \file: api.c
  *
  * External control API implementation.
+ *
+ * Requests from client tasks are held in a table, so that several tasks
+ * can each have several conversions outstanding.  Each request is given a
+ * job ID, which the client can use to query its state, and is claimed by
+ * the next conversion to start.  Requests made with Set Filename are
+ * reported individually as before; those made with Add Job are reported
+ * in batches, gathering up all of the jobs which completed for a task
+ * since the last notifications were sent.
  */
 
 /* ANSI C header files */
 
+#include <string.h>
+
 /* Acorn C header files */
 
 /* OSLib header files */
 
+#include "oslib/os.h"
 #include "oslib/wimp.h"
 
 /* SF-Lib header files. */
@@ -45,7 +56,10 @@
 
 #include "api.h"
 
+#include "cache.h"
 #include "convert.h"
+#include "profile.h"
+#include "stats.h"
 
 
 /* Message for remote control operation. */
@@ -56,11 +70,46 @@ enum control_reason {
 	CONTROL_SET_FILENAME = 0,		/**< Set up filename to save to.	*/
 	CONTROL_REPORT_SUCCESS = 1,		/**< Conversion completed correctly.	*/
 	CONTROL_REPORT_FAILURE = 2,		/**< Conversion failed.			*/
-	CONTROL_CLEAR_FILENAME = 3		/**< Clear an already set filename.	*/
+	CONTROL_CLEAR_FILENAME = 3,		/**< Clear an already set filename.	*/
+	CONTROL_REPORT_PROGRESS = 4,		/**< Conversion progress report.	*/
+	CONTROL_QUERY_STATISTICS = 5,		/**< Request conversion statistics.	*/
+	CONTROL_REPORT_STATISTICS = 6,		/**< Conversion statistics report.	*/
+	CONTROL_ADD_JOB = 7,			/**< Add a job to the request table.	*/
+	CONTROL_REPORT_JOB_ADDED = 8,		/**< A job has been added.		*/
+	CONTROL_QUERY_JOB = 9,			/**< Request the state of a job.	*/
+	CONTROL_REPORT_JOB = 10,		/**< The state of a job.		*/
+	CONTROL_REPORT_JOBS_ENDED = 11,		/**< A batch of jobs have completed.	*/
+	CONTROL_ADD_PROFILE_JOB = 12		/**< Add a job using a named profile.	*/
 };
 
 #define CONTROL_COMMAND_BASIC_LENGTH 24
 #define CONTROL_COMMAND_FAILURE_LENGTH 28
+#define CONTROL_COMMAND_PROGRESS_LENGTH 48
+#define CONTROL_COMMAND_STATISTICS_LENGTH 140
+#define CONTROL_COMMAND_JOB_LENGTH 36
+#define CONTROL_COMMAND_JOBS_LENGTH(count) (28 + 12 * (count))
+
+/**
+ * The number of requests which can be held in the table.
+ */
+
+#define API_MAX_REQUESTS 32
+
+/**
+ * The number of job completions which can be reported in one message.
+ */
+
+#define API_MAX_NOTIFICATIONS 16
+
+/**
+ * The state of a job, as reported to a client.
+ */
+
+struct control_job {
+	int			job;
+	enum api_job_state	state;
+	enum api_failure	failure;
+};
 
 typedef struct {
 	wimp_MESSAGE_HEADER_MEMBERS
@@ -68,32 +117,79 @@ typedef struct {
 	union {
 		char			filename[232];
 		enum api_failure	failure;
+		struct {
+			int		pages_done;
+			int		pages_total;
+			int		bytes_in;
+			int		bytes_total;
+			int		time_left;
+			int		job;
+		} progress;
+		struct {
+			int		conversions;
+			int		failures;
+			int		cache_hits;
+			int		cache_misses;
+			int		metrics;
+			struct stats_summary summary[STATS_METRICS];
+		} statistics;
+		struct control_job	job;
+		struct {
+			char		profile[PROFILE_MAX_NAME];
+			char		filename[200];
+		} profile_job;
+		struct {
+			int		count;
+			struct control_job jobs[API_MAX_NOTIFICATIONS];
+		} ended;
 	};
 } control_message;
 
+/**
+ * A request in the table.
+ */
+
+struct api_request {
+	int			job;				/**< The job ID, or 0 if the entry is free.		*/
+	wimp_t			task;				/**< The client task, or NULL if it has quit.		*/
+	int			ref;				/**< The MyRef of the message making the request.	*/
+	osbool			batched;			/**< TRUE if completion is reported in batches.		*/
+	osbool			notify;				/**< TRUE if completion is still to be reported.	*/
+	enum api_job_state	state;				/**< The state of the job.				*/
+	enum api_failure	failure;			/**< The reason for failure, if the job failed.		*/
+	char			filename[CONVERT_MAX_FILENAME];	/**< The filename to save the PDF to.			*/
+	char			profile[PROFILE_MAX_NAME];	/**< The settings profile to use, or "" for none.	*/
+};
+
 /* Function Prototypes. */
 
 static osbool api_message_task_close_down_handler(wimp_message *message);
 static osbool api_message_printpdf_control_handler(wimp_message *message);
+static struct api_request *api_add_request(wimp_t task, int ref, char *filename, osbool batched, char *profile);
+static struct api_request *api_find_request(int job);
+static void api_end_request(struct api_request *request, enum api_job_state state, enum api_failure failure);
 static void api_send_conversion_failure(wimp_t task, int your_ref, enum api_failure failure);
+static void api_send_job(wimp_t task, int your_ref, enum control_reason reason, struct api_request *request, int job);
+static void api_send_statistics(wimp_t task, int your_ref);
 
 
 /**
- * The handle of the task which is currently in control of the API.
+ * The table of requests.
  */
-static wimp_t api_request_task = NULL;
+
+static struct api_request api_requests[API_MAX_REQUESTS];
 
 /**
- * The MyRef from the most recent API request message.
-*/
+ * The job ID to be given to the next request.
+ */
 
-static int api_request_ref = 0;
+static int api_next_job = 1;
 
 /**
- * The filename supplied through the API.
+ * TRUE if there are batched completions waiting to be reported.
  */
 
-static char api_request_filename[CONVERT_MAX_FILENAME];
+static osbool api_notifications_pending = FALSE;
 
 
 /**
@@ -102,30 +198,59 @@ static char api_request_filename[CONVERT_MAX_FILENAME];
 
 void api_initialise(void)
 {
+	int	i;
+
+	for (i = 0; i < API_MAX_REQUESTS; i++)
+		api_requests[i].job = 0;
+
 	event_add_message_handler(message_TASK_CLOSE_DOWN, EVENT_MESSAGE_INCOMING, api_message_task_close_down_handler);
 	event_add_message_handler(message_PRINTPDF_CONTROL, EVENT_MESSAGE_INCOMING, api_message_printpdf_control_handler);
 }
 
 
 /**
- * Test for a filename from the control API.
- * 
- * \return		A pointer to the filename, or NULL if none has
- *			been configured.
+ * Claim the oldest queued request from the control API, for a conversion
+ * which is about to start.
+ *
+ * \param **filename	Pointer to a variable to take a pointer to the
+ *			filename to save the PDF to.
+ * \param **profile	Pointer to a variable to take a pointer to the
+ *			name of the settings profile to use, or NULL if
+ *			the current settings are to be used.
+ * \return		The job ID of the request, or 0 if there are no
+ *			requests queued.
  */
 
-char *api_get_filename(void)
+int api_claim_job(char **filename, char **profile)
 {
-	if (api_request_task == NULL)
-		return NULL;
+	struct api_request	*oldest = NULL;
+	int			i;
+
+	for (i = 0; i < API_MAX_REQUESTS; i++) {
+		if (api_requests[i].job != 0 && api_requests[i].state == API_JOB_QUEUED &&
+				(oldest == NULL || api_requests[i].job - oldest->job < 0))
+			oldest = &(api_requests[i]);
+	}
+
+	if (oldest == NULL)
+		return 0;
+
+	oldest->state = API_JOB_CONVERTING;
 
-	return api_request_filename;
+	if (filename != NULL)
+		*filename = oldest->filename;
+
+	if (profile != NULL)
+		*profile = (*(oldest->profile) != '\0') ? oldest->profile : NULL;
+
+	return oldest->job;
 }
 
 
 /**
- * Process Message_TaskCloseDown, in case the current API client has
- * quit.
+ * Process Message_TaskCloseDown, in case an API client has quit.  Its
+ * queued requests are discarded, and any of its jobs which are being
+ * converted are allowed to finish without being reported.
  *
  * \param *message	The message data block.
  * \return		FALSE to allow other claimants to see the message.
@@ -133,9 +258,19 @@ char *api_get_filename(void)
 
 static osbool api_message_task_close_down_handler(wimp_message *message)
 {
-	if (message != NULL && api_request_task != NULL && message->sender == api_request_task) {
-		api_request_task = NULL;
-		api_request_ref = 0;
+	int	i;
+
+	if (message == NULL)
+		return FALSE;
+
+	for (i = 0; i < API_MAX_REQUESTS; i++) {
+		if (api_requests[i].job == 0 || api_requests[i].task != message->sender)
+			continue;
+
+		if (api_requests[i].state == API_JOB_CONVERTING)
+			api_requests[i].task = NULL;
+		else
+			api_requests[i].job = 0;
 	}
 
 	return FALSE;
@@ -152,43 +287,89 @@ static osbool api_message_task_close_down_handler(wimp_message *message)
 
 static osbool api_message_printpdf_control_handler(wimp_message *message)
 {
-	control_message *control = (control_message *) message;
+	control_message		*control = (control_message *) message;
+	struct api_request	*request;
+	int			i;
 
 	if (control == NULL)
 		return FALSE;
 	
 	switch (control->reason) {
 	case CONTROL_SET_FILENAME:
-		if (api_request_task == NULL) {
-			if (*(control->filename) != '\0') {
-				api_request_task = control->sender;
-				api_request_ref = control->my_ref;
-				string_copy(api_request_filename, control->filename, CONVERT_MAX_FILENAME);
-
-				control->your_ref = control->my_ref;
-				wimp_send_message(wimp_USER_MESSAGE_ACKNOWLEDGE, message, message->sender);
-
-			} else {
-				api_send_conversion_failure(message->sender, message->my_ref, API_FAILURE_NULL_FILENAME);
-			}
-		} else {
+	case CONTROL_ADD_JOB:
+		if (*(control->filename) == '\0') {
+			api_send_conversion_failure(message->sender, message->my_ref, API_FAILURE_NULL_FILENAME);
+			return TRUE;
+		}
+
+		request = api_add_request(message->sender, message->my_ref, control->filename, (control->reason == CONTROL_ADD_JOB) ? TRUE : FALSE, NULL);
+
+		if (request == NULL) {
 			api_send_conversion_failure(message->sender, message->my_ref, API_FAILURE_IN_USE);
+		} else if (control->reason == CONTROL_ADD_JOB) {
+			api_send_job(message->sender, message->my_ref, CONTROL_REPORT_JOB_ADDED, request, request->job);
+		} else {
+			control->your_ref = control->my_ref;
+			wimp_send_message(wimp_USER_MESSAGE_ACKNOWLEDGE, message, message->sender);
 		}
 
 		return TRUE;
 
+	case CONTROL_ADD_PROFILE_JOB:
+		/* The profile is compiled now, so that a client hears at once if it can't be used. */
+
+		if (*(control->profile_job.filename) == '\0') {
+			api_send_conversion_failure(message->sender, message->my_ref, API_FAILURE_NULL_FILENAME);
+			return TRUE;
+		}
+
+		if (profile_find(control->profile_job.profile) == NULL) {
+			api_send_conversion_failure(message->sender, message->my_ref, API_FAILURE_PROFILE);
+			return TRUE;
+		}
+
+		request = api_add_request(message->sender, message->my_ref, control->profile_job.filename, TRUE, control->profile_job.profile);
+
+		if (request == NULL)
+			api_send_conversion_failure(message->sender, message->my_ref, API_FAILURE_IN_USE);
+		else
+			api_send_job(message->sender, message->my_ref, CONTROL_REPORT_JOB_ADDED, request, request->job);
+
+		return TRUE;
+
 	case CONTROL_CLEAR_FILENAME:
-		if (api_request_task == NULL || api_request_task == control->sender) {
-			api_request_task = NULL;
-			api_request_ref = 0;
+		/* Only requests which have yet to be claimed can be cleared. */
 
-			control->your_ref = control->my_ref;
-			wimp_send_message(wimp_USER_MESSAGE_ACKNOWLEDGE, message, message->sender);
-		} else {
-			api_send_conversion_failure(message->sender, message->my_ref, API_FAILURE_NOT_OWNER);
+		for (i = 0; i < API_MAX_REQUESTS; i++) {
+			if (api_requests[i].job != 0 && api_requests[i].task == control->sender && api_requests[i].state == API_JOB_QUEUED)
+				api_requests[i].job = 0;
 		}
 
+		control->your_ref = control->my_ref;
+		wimp_send_message(wimp_USER_MESSAGE_ACKNOWLEDGE, message, message->sender);
+
 		return TRUE;
+
+	case CONTROL_QUERY_STATISTICS:
+		/* A filename is optional; if one is given, the full records are dumped into it. */
+
+		if (control->size > CONTROL_COMMAND_BASIC_LENGTH && *(control->filename) != '\0' && !stats_dump(control->filename)) {
+			api_send_conversion_failure(message->sender, message->my_ref, API_FAILURE_STATISTICS);
+			return TRUE;
+		}
+
+		api_send_statistics(message->sender, message->my_ref);
+
+		return TRUE;
+
+	case CONTROL_QUERY_JOB:
+		api_send_job(message->sender, message->my_ref, CONTROL_REPORT_JOB, api_find_request(control->job.job), control->job.job);
+
+		return TRUE;
+
+	default:
+		/* The reports are only ever sent by PrintPDF. */
+		break;
 	}
 
 	return FALSE;
@@ -196,47 +377,239 @@ static osbool api_message_printpdf_control_handler(wimp_message *message)
 
 
 /**
- * On a successful completion of a conversion, check if the API is in
- * use. If it is, notify the client task of the result.
- * 
- * \param success	TRUE if the conversion was successful;
- *			else FALSE.
+ * Add a request to the table.  If there are no free entries, the oldest
+ * of the completed requests which have been reported is replaced.
+ *
+ * \param task		The client task making the request.
+ * \param ref		The MyRef of the request message.
+ * \param *filename	The filename to save the PDF to.
+ * \param batched	TRUE to report the completion in batches; FALSE
+ *			to report it individually.
+ * \param *profile	The settings profile to use, or NULL for none.
+ * \return		Pointer to the new request, or NULL if the table
+ *			was full.
+ */
+
+static struct api_request *api_add_request(wimp_t task, int ref, char *filename, osbool batched, char *profile)
+{
+	struct api_request	*request = NULL;
+	int			i;
+
+	for (i = 0; i < API_MAX_REQUESTS; i++) {
+		if (api_requests[i].job == 0) {
+			request = &(api_requests[i]);
+			break;
+		}
+
+		if ((api_requests[i].state == API_JOB_DONE || api_requests[i].state == API_JOB_FAILED) &&
+				!api_requests[i].notify && (request == NULL || api_requests[i].job - request->job < 0))
+			request = &(api_requests[i]);
+	}
+
+	if (request == NULL)
+		return NULL;
+
+	request->job = api_next_job++;
+	if (api_next_job <= 0)
+		api_next_job = 1;
+
+	request->task = task;
+	request->ref = ref;
+	request->batched = batched;
+	request->notify = FALSE;
+	request->state = API_JOB_QUEUED;
+	request->failure = API_FAILURE_CONVERSION;
+	string_copy(request->filename, filename, CONVERT_MAX_FILENAME);
+	string_copy(request->profile, (profile != NULL) ? profile : "", PROFILE_MAX_NAME);
+
+	#ifdef DEBUG
+	debug_printf("API job %d added for task 0x%x: %s", request->job, (unsigned) task, request->filename);
+	#endif
+
+	return request;
+}
+
+
+/**
+ * Find a request in the table.
+ *
+ * \param job		The job ID of the request to find.
+ * \return		Pointer to the request, or NULL if not found.
  */
 
-void api_notify_conversion_success(void)
+static struct api_request *api_find_request(int job)
 {
-	if (api_request_task == NULL)
+	int	i;
+
+	if (job == 0)
+		return NULL;
+
+	for (i = 0; i < API_MAX_REQUESTS; i++) {
+		if (api_requests[i].job == job)
+			return &(api_requests[i]);
+	}
+
+	return NULL;
+}
+
+
+/**
+ * On a successful completion of a conversion, notify the client task
+ * which requested it of the result.
+ *
+ * \param job		The job ID of the conversion.
+ */
+
+void api_notify_conversion_success(int job)
+{
+	api_end_request(api_find_request(job), API_JOB_DONE, API_FAILURE_CONVERSION);
+}
+
+
+/**
+ * During a conversion, notify the client task which requested it of the
+ * conversion's progress.
+ *
+ * \param job		The job ID of the conversion.
+ * \param pages_done	The number of pages converted.
+ * \param pages_total	The number of pages expected, or 0 if unknown.
+ * \param bytes_in	The number of bytes of input consumed.
+ * \param bytes_total	The total number of bytes of input.
+ * \param time_left	The estimated time left in centiseconds, or -1
+ *			if unknown.
+ */
+
+void api_notify_conversion_progress(int job, int pages_done, int pages_total, int bytes_in, int bytes_total, int time_left)
+{
+	struct api_request	*request;
+	control_message		control;
+
+	request = api_find_request(job);
+	if (request == NULL || request->task == NULL)
 		return;
 
-	control_message control;
+	control.your_ref = request->ref;
+	control.action = message_PRINTPDF_CONTROL;
+	control.reason = CONTROL_REPORT_PROGRESS;
+	control.progress.pages_done = pages_done;
+	control.progress.pages_total = pages_total;
+	control.progress.bytes_in = bytes_in;
+	control.progress.bytes_total = bytes_total;
+	control.progress.time_left = time_left;
+	control.progress.job = job;
+	control.size = CONTROL_COMMAND_PROGRESS_LENGTH;
+
+	wimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, request->task);
+}
+
+
+/**
+ * On an unsuccessful completion of a conversion, notify the client task
+ * which requested it of the result.
+ *
+ * \param job		The job ID of the conversion.
+ * \param failure	The reason for failure to pass to the client.
+ */
+
+void api_notify_conversion_failure(int job, enum api_failure failure)
+{
+	api_end_request(api_find_request(job), API_JOB_FAILED, failure);
+}
+
+
+/**
+ * Record the end of a request's conversion.  Requests made with Set
+ * Filename are reported straight away; the rest are left for the next
+ * batch of notifications.
+ *
+ * \param *request	The request which has ended.
+ * \param state		The state in which the request ended.
+ * \param failure	The reason for failure, if the request failed.
+ */
 
-	control.your_ref = api_request_ref;
+static void api_end_request(struct api_request *request, enum api_job_state state, enum api_failure failure)
+{
+	control_message		control;
+
+	if (request == NULL)
+		return;
+
+	request->state = state;
+	request->failure = failure;
+
+	if (request->task == NULL)
+		return;
+
+	if (request->batched) {
+		request->notify = TRUE;
+		api_notifications_pending = TRUE;
+		return;
+	}
+
+	if (state == API_JOB_FAILED) {
+		api_send_conversion_failure(request->task, request->ref, failure);
+		return;
+	}
+
+	control.your_ref = request->ref;
 	control.action = message_PRINTPDF_CONTROL;
 	control.reason = CONTROL_REPORT_SUCCESS;
 	control.size = CONTROL_COMMAND_BASIC_LENGTH;
 
-	wimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, api_request_task);
-	api_request_task = NULL;
-	api_request_ref = 0;
+	wimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, request->task);
 }
 
 
 /**
- * On an unsuccessful completion of a conversion, check if the API is in
- * use. If it is, notify the client task of the result.
- * 
- * \param failure	The reason for failure to pass to the client.
+ * Send any outstanding job completion notifications, gathering those for
+ * each client task into as few messages as possible.
  */
 
-void api_notify_conversion_failure(enum api_failure failure)
+void api_send_notifications(void)
 {
-	if (api_request_task == NULL)
+	control_message		control;
+	wimp_t			task;
+	int			i, j;
+
+	if (!api_notifications_pending)
 		return;
 
-	api_send_conversion_failure(api_request_task, api_request_ref, failure);
+	api_notifications_pending = FALSE;
+
+	for (i = 0; i < API_MAX_REQUESTS; i++) {
+		if (api_requests[i].job == 0 || !api_requests[i].notify)
+			continue;
+
+		/* Collect this task's completions, starting with the one found. */
+
+		task = api_requests[i].task;
+		control.ended.count = 0;
+
+		for (j = i; j < API_MAX_REQUESTS && control.ended.count < API_MAX_NOTIFICATIONS; j++) {
+			if (api_requests[j].job == 0 || !api_requests[j].notify || api_requests[j].task != task)
+				continue;
+
+			control.ended.jobs[control.ended.count].job = api_requests[j].job;
+			control.ended.jobs[control.ended.count].state = api_requests[j].state;
+			control.ended.jobs[control.ended.count].failure = api_requests[j].failure;
+			control.ended.count++;
 
-	api_request_task = NULL;
-	api_request_ref = 0;
+			api_requests[j].notify = FALSE;
+		}
+
+		control.your_ref = 0;
+		control.action = message_PRINTPDF_CONTROL;
+		control.reason = CONTROL_REPORT_JOBS_ENDED;
+		control.size = CONTROL_COMMAND_JOBS_LENGTH(control.ended.count);
+
+		if (task != NULL)
+			wimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, task);
+
+		/* If the message filled up, come back to this entry for the rest. */
+
+		if (control.ended.count == API_MAX_NOTIFICATIONS)
+			i--;
+	}
 }
 
 
@@ -260,3 +633,57 @@ static void api_send_conversion_failure(wimp_t task, int your_ref, enum api_fail
 
 	wimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, task);
 }
+
+
+/**
+ * Send the state of a job to a client application.
+ *
+ * \param task		The task handle of the client.
+ * \param your_ref	The YourRef value for the message to be sent.
+ * \param reason	The reason code to send.
+ * \param *request	The request for the job, or NULL if it isn't known.
+ * \param job		The job ID being reported.
+ */
+
+static void api_send_job(wimp_t task, int your_ref, enum control_reason reason, struct api_request *request, int job)
+{
+	control_message control;
+
+	control.your_ref = your_ref;
+	control.action = message_PRINTPDF_CONTROL;
+	control.reason = reason;
+	control.job.job = job;
+	control.job.state = (request != NULL) ? request->state : API_JOB_UNKNOWN;
+	control.job.failure = (request != NULL && request->state == API_JOB_FAILED) ? request->failure : 0;
+	control.size = CONTROL_COMMAND_JOB_LENGTH;
+
+	wimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, task);
+}
+
+
+/**
+ * Send a summary of the conversion statistics to a client application.
+ *
+ * \param task		The task handle of the client.
+ * \param your_ref	The YourRef value for the message to be sent.
+ */
+
+static void api_send_statistics(wimp_t task, int your_ref)
+{
+	control_message control;
+	int		i;
+
+	control.your_ref = your_ref;
+	control.action = message_PRINTPDF_CONTROL;
+	control.reason = CONTROL_REPORT_STATISTICS;
+	control.statistics.conversions = stats_get_count(&(control.statistics.failures));
+	cache_get_counters(&(control.statistics.cache_hits), &(control.statistics.cache_misses));
+	control.statistics.metrics = STATS_METRICS;
+
+	for (i = 0; i < STATS_METRICS; i++)
+		stats_get_summary(i, &(control.statistics.summary[i]));
+
+	control.size = CONTROL_COMMAND_STATISTICS_LENGTH;
+
+	wimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &control, task);
+}
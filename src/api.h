@@ -37,10 +37,24 @@
  */
 
 enum api_failure {
-	API_FAILURE_IN_USE = 0,		/**< The API is already in use.			*/
+	API_FAILURE_IN_USE = 0,		/**< The request table is full.			*/
 	API_FAILURE_NULL_FILENAME = 1,	/**< The supplied filename was empty.		*/
 	API_FAILURE_CONVERSION = 2,	/**< The conversion failed.			*/
-	API_FAILURE_NOT_OWNER = 3	/**< Can't clear another task's filename.	*/
+	API_FAILURE_NOT_OWNER = 3,	/**< Can't clear another task's filename.	*/
+	API_FAILURE_STATISTICS = 4,	/**< The statistics could not be written.	*/
+	API_FAILURE_PROFILE = 5		/**< The settings profile could not be found.	*/
+};
+
+/**
+ * The states which a job submitted through the API can be in.
+ */
+
+enum api_job_state {
+	API_JOB_UNKNOWN = 0,		/**< The job isn't known.			*/
+	API_JOB_QUEUED = 1,		/**< The job is waiting for a print job.	*/
+	API_JOB_CONVERTING = 2,		/**< The job is being converted.		*/
+	API_JOB_DONE = 3,		/**< The job was converted successfully.	*/
+	API_JOB_FAILED = 4		/**< The job's conversion failed.		*/
 };
 
 /**
@@ -51,33 +65,63 @@ void api_initialise(void);
 
 
 /**
- * Test for a filename from the control API.
- * 
- * \return		A pointer to the filename, or NULL if none has
- *			been configured.
+ * Claim the oldest queued request from the control API, for a conversion
+ * which is about to start.
+ *
+ * \param **filename	Pointer to a variable to take a pointer to the
+ *			filename to save the PDF to.
+ * \param **profile	Pointer to a variable to take a pointer to the
+ *			name of the settings profile to use, or NULL if
+ *			the current settings are to be used.
+ * \return		The job ID of the request, or 0 if there are no
+ *			requests queued.
  */
 
-char *api_get_filename(void);
+int api_claim_job(char **filename, char **profile);
 
 
 /**
- * On a successful completion of a conversion, check if the API is in
- * use. If it is, notify the client task of the result.
- * 
- * \param success	TRUE if the conversion was successful;
- *			else FALSE.
+ * On a successful completion of a conversion, notify the client task
+ * which requested it of the result.
+ *
+ * \param job		The job ID of the conversion.
  */
 
-void api_notify_conversion_success(void);
+void api_notify_conversion_success(int job);
 
 
 /**
- * On an unsuccessful completion of a conversion, check if the API is in
- * use. If it is, notify the client task of the result.
- * 
+ * During a conversion, notify the client task which requested it of the
+ * conversion's progress.
+ *
+ * \param job		The job ID of the conversion.
+ * \param pages_done	The number of pages converted.
+ * \param pages_total	The number of pages expected, or 0 if unknown.
+ * \param bytes_in	The number of bytes of input consumed.
+ * \param bytes_total	The total number of bytes of input.
+ * \param time_left	The estimated time left in centiseconds, or -1
+ *			if unknown.
+ */
+
+void api_notify_conversion_progress(int job, int pages_done, int pages_total, int bytes_in, int bytes_total, int time_left);
+
+
+/**
+ * On an unsuccessful completion of a conversion, notify the client task
+ * which requested it of the result.
+ *
+ * \param job		The job ID of the conversion.
  * \param failure	The reason for failure to pass to the client.
  */
 
-void api_notify_conversion_failure(enum api_failure failure);
+void api_notify_conversion_failure(int job, enum api_failure failure);
+
+
+/**
+ * Send any outstanding job completion notifications, gathering those for
+ * each client task into as few messages as possible.
+ */
+
+void api_send_notifications(void);
 
 #endif
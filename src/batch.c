@@ -0,0 +1,526 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: batch.c
+ *
+ * Batch conversion implementation.
+ *
+ * A batch is a list of PostScript files which are converted without any
+ * user interaction, using the settings from the Choices or a named profile.
+ * The files are fed into the queue a few at a time, so that the queue never
+ * holds copies of more than the workers can be converting, and each is
+ * claimed by a worker in the same way as a file requested through the
+ * control API.  Once every file has been dealt with, a report giving the
+ * outcome of each is written and the application quits.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+#include "oslib/osfile.h"
+#include "oslib/osgbpb.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/debug.h"
+#include "sflib/msgs.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "batch.h"
+
+#include "convert.h"
+#include "main.h"
+#include "profile.h"
+
+
+/**
+ * The maximum length of an error recorded for a file.
+ */
+
+#define BATCH_MAX_ERROR 256
+
+/**
+ * The size of the buffer used to read directory entries.
+ */
+
+#define BATCH_DIR_BUFFER 1024
+
+/**
+ * The formats used to build a pathname from a directory and a leafname,
+ * and a PDF leafname from the leafname of its PostScript file.
+ */
+
+#ifdef HOSTED
+#define BATCH_PATH_FORMAT "%s/%s"
+#define BATCH_PDF_FORMAT "%s.pdf"
+#else
+#define BATCH_PATH_FORMAT "%s.%s"
+#define BATCH_PDF_FORMAT "%s/pdf"
+#endif
+
+/**
+ * The states that a file in a batch can be in.
+ */
+
+enum batch_state {
+	BATCH_WAITING,					/**< Waiting to be queued.				*/
+	BATCH_QUEUED,					/**< In the queue, or being converted.			*/
+	BATCH_DONE,					/**< Converted successfully.				*/
+	BATCH_FAILED					/**< Failed to convert.					*/
+};
+
+/**
+ * A file in a batch conversion.
+ */
+
+struct batch_job {
+	char			input[CONVERT_MAX_FILENAME];	/**< The PostScript file to be converted.		*/
+	char			output[CONVERT_MAX_FILENAME];	/**< The PDF file to be created.			*/
+	enum batch_state	state;				/**< The state of the file.				*/
+	os_t			queued;				/**< The time at which the file was queued.		*/
+	os_t			ended;				/**< The time at which the conversion ended.		*/
+	char			error[BATCH_MAX_ERROR];		/**< The reason for a failure, or "".			*/
+
+	struct batch_job	*next;				/**< The next file in the batch.			*/
+};
+
+
+/* Function Prototypes. */
+
+static osbool batch_add_directory(char *directory, char *output);
+static osbool batch_add_list(char *filename, char *output);
+static osbool batch_add_job(char *input, char *output);
+static void batch_queue_jobs(void);
+static void batch_finish(char *reason);
+
+
+/**
+ * The files in the batch, in the order that they are converted.
+ */
+
+static struct batch_job *batch_jobs = NULL;
+
+/**
+ * The link at the end of the list of files in the batch.
+ */
+
+static struct batch_job **batch_tail = &batch_jobs;
+
+/**
+ * The next file in the batch waiting to be queued, or NULL if none.
+ */
+
+static struct batch_job *batch_next_job = NULL;
+
+/**
+ * The number of files from the batch in the queue.
+ */
+
+static int batch_queued = 0;
+
+/**
+ * TRUE if a batch is running.
+ */
+
+static osbool batch_running = FALSE;
+
+/**
+ * TRUE if any of the batch has failed.
+ */
+
+static osbool batch_failures = FALSE;
+
+/**
+ * The name of the profile used by the batch, or "" for none.
+ */
+
+static char batch_profile[PROFILE_MAX_NAME];
+
+/**
+ * The file to write the report to.
+ */
+
+static char batch_report[CONVERT_MAX_FILENAME];
+
+
+/**
+ * Start a batch conversion of a list or directory of PostScript files.  The
+ * files are converted without any windows being opened, and once they have
+ * all been dealt with, a report is written and the application quits.
+ *
+ * \param *source		A directory of PostScript files, a single
+ *				PostScript file, or a text file listing one
+ *				file to convert on each line.
+ * \param *profile		The name of the settings profile to use, or
+ *				NULL to use the current Choices.
+ * \param *output		The directory to save the PDFs into, or NULL
+ *				to save each beside its PostScript file.
+ * \param *report		The file to write the report to, or NULL to
+ *				use the BatchReport file.
+ * \return			TRUE if the batch was started; else FALSE.
+ */
+
+osbool batch_start(char *source, char *profile, char *output, char *report)
+{
+	char			reason[BATCH_MAX_ERROR];
+	fileswitch_object_type	type;
+	bits			filetype;
+	osbool			added;
+
+	if (batch_running || source == NULL)
+		return FALSE;
+
+	string_copy(batch_report, (report != NULL) ? report : config_str_read("BatchReport"), CONVERT_MAX_FILENAME);
+	string_copy(batch_profile, (profile != NULL) ? profile : "", PROFILE_MAX_NAME);
+
+	batch_running = TRUE;
+
+	/* Another copy of PrintPDF would be sharing the queue directory. */
+
+	if (main_quit_flag) {
+		batch_finish(msgs_lookup("BatchRunning", reason, BATCH_MAX_ERROR));
+		return FALSE;
+	}
+
+	/* Compile the profile now, so that a missing one stops the whole batch. */
+
+	if (profile != NULL && profile_find(profile) == NULL) {
+		batch_finish(msgs_param_lookup("BatchNoProfile", reason, BATCH_MAX_ERROR, profile, NULL, NULL, NULL));
+		return FALSE;
+	}
+
+	/* Build the list of files to convert. */
+
+	if (xosfile_read_stamped_no_path(source, &type, NULL, NULL, NULL, NULL, &filetype) != NULL)
+		type = fileswitch_NOT_FOUND;
+
+	if (type == fileswitch_IS_DIR)
+		added = batch_add_directory(source, output);
+	else if (type == fileswitch_IS_FILE && filetype == osfile_TYPE_POSTSCRIPT)
+		added = batch_add_job(source, output);
+	else if (type == fileswitch_IS_FILE)
+		added = batch_add_list(source, output);
+	else
+		added = FALSE;
+
+	if (!added || batch_jobs == NULL) {
+		batch_finish(msgs_param_lookup("BatchNoFiles", reason, BATCH_MAX_ERROR, source, NULL, NULL, NULL));
+		return FALSE;
+	}
+
+	batch_next_job = batch_jobs;
+	batch_queue_jobs();
+
+	return TRUE;
+}
+
+
+/**
+ * Test whether a batch conversion is running.
+ *
+ * \return			TRUE if a batch is running; else FALSE.
+ */
+
+osbool batch_active(void)
+{
+	return batch_running;
+}
+
+
+/**
+ * Test whether a batch conversion has failed, either in part or because
+ * it could not be started.
+ *
+ * \return			TRUE if any of the batch failed; else FALSE.
+ */
+
+osbool batch_failed(void)
+{
+	return batch_failures;
+}
+
+
+/**
+ * Return the name of the PDF to be created for a file in a batch.
+ *
+ * \param *job			The batch file.
+ * \return			Pointer to the name of the PDF.
+ */
+
+char *batch_get_output_filename(struct batch_job *job)
+{
+	return (job != NULL) ? job->output : NULL;
+}
+
+
+/**
+ * Record the outcome of the conversion of a file in a batch, and queue
+ * more files for conversion if there are any left.
+ *
+ * \param *job			The batch file which has been converted.
+ * \param success		TRUE if the conversion succeeded; else FALSE.
+ * \param *error		The error reported by the conversion, or NULL.
+ */
+
+void batch_notify_conversion_end(struct batch_job *job, osbool success, char *error)
+{
+	if (job == NULL || job->state != BATCH_QUEUED)
+		return;
+
+	job->state = (success) ? BATCH_DONE : BATCH_FAILED;
+	job->ended = os_read_monotonic_time();
+
+	if (!success) {
+		if (error != NULL && *error != '\0')
+			string_copy(job->error, error, BATCH_MAX_ERROR);
+		else
+			msgs_lookup("BatchFailed", job->error, BATCH_MAX_ERROR);
+	}
+
+	batch_queued--;
+	batch_queue_jobs();
+}
+
+
+/**
+ * Add the PostScript files in a directory to the batch.
+ *
+ * \param *directory		The directory to scan.
+ * \param *output		The directory to save the PDFs into, or NULL.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool batch_add_directory(char *directory, char *output)
+{
+	char			buffer[BATCH_DIR_BUFFER], filename[CONVERT_MAX_FILENAME], *name;
+	int			context = 0, read, i;
+	bits			filetype;
+
+	while (context != -1) {
+		if (xosgbpb_dir_entries(directory, (osgbpb_string_list *) buffer, BATCH_DIR_BUFFER / 16, context,
+				BATCH_DIR_BUFFER, "*", &read, &context) != NULL)
+			return FALSE;
+
+		for (i = 0, name = buffer; i < read; i++, name += strlen(name) + 1) {
+			string_printf(filename, CONVERT_MAX_FILENAME, BATCH_PATH_FORMAT, directory, name);
+
+			if (osfile_read_stamped_no_path(filename, NULL, NULL, NULL, NULL, &filetype) == fileswitch_IS_FILE &&
+					filetype == osfile_TYPE_POSTSCRIPT && !batch_add_job(filename, output))
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Add the files named in a list to the batch.  Each line names one file;
+ * blank lines, and those starting with a #, are ignored.
+ *
+ * \param *filename		The list file to read.
+ * \param *output		The directory to save the PDFs into, or NULL.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool batch_add_list(char *filename, char *output)
+{
+	char			line[CONVERT_MAX_FILENAME], *start, *end;
+	FILE			*in;
+	osbool			success = TRUE;
+
+	in = fopen(filename, "r");
+	if (in == NULL)
+		return FALSE;
+
+	while (success && fgets(line, CONVERT_MAX_FILENAME, in) != NULL) {
+		for (start = line; *start == ' ' || *start == '\t'; start++);
+
+		for (end = start + strlen(start); end > start && (unsigned char) *(end - 1) <= ' '; end--);
+		*end = '\0';
+
+		if (*start != '\0' && *start != '#')
+			success = batch_add_job(start, output);
+	}
+
+	fclose(in);
+
+	return success;
+}
+
+
+/**
+ * Add a file to the end of the batch, working out the name of its PDF.
+ *
+ * \param *input		The PostScript file to convert.
+ * \param *output		The directory to save the PDF into, or NULL to
+ *				save it beside the PostScript file.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool batch_add_job(char *input, char *output)
+{
+	struct batch_job	*job;
+	char			path[CONVERT_MAX_FILENAME], leaf[CONVERT_MAX_FILENAME], *leafname;
+
+	job = malloc(sizeof(struct batch_job));
+	if (job == NULL)
+		return FALSE;
+
+	string_copy(job->input, input, CONVERT_MAX_FILENAME);
+	job->state = BATCH_WAITING;
+	job->queued = 0;
+	job->ended = 0;
+	*(job->error) = '\0';
+	job->next = NULL;
+
+	/* The PDF takes the PostScript file's leafname, without any extension. */
+
+	string_copy(path, input, CONVERT_MAX_FILENAME);
+	leafname = string_strip_extension(path);
+	string_printf(leaf, CONVERT_MAX_FILENAME, BATCH_PDF_FORMAT, leafname);
+
+	if (output != NULL) {
+		string_printf(job->output, CONVERT_MAX_FILENAME, BATCH_PATH_FORMAT, output, leaf);
+	} else if (leafname != path) {
+		string_find_pathname(path);
+		string_printf(job->output, CONVERT_MAX_FILENAME, BATCH_PATH_FORMAT, path, leaf);
+	} else {
+		string_copy(job->output, leaf, CONVERT_MAX_FILENAME);
+	}
+
+	*batch_tail = job;
+	batch_tail = &(job->next);
+
+	return TRUE;
+}
+
+
+/**
+ * Queue files from the batch, until there are enough queued to keep all of
+ * the workers busy.  If there are no files left to convert, the batch is
+ * finished.
+ */
+
+static void batch_queue_jobs(void)
+{
+	struct batch_job	*job;
+
+	while (batch_next_job != NULL && batch_queued <= config_int_read("MaxConversions")) {
+		job = batch_next_job;
+		batch_next_job = job->next;
+
+		job->queued = os_read_monotonic_time();
+
+		if (convert_queue_batch_file(job->input, job, (*batch_profile != '\0') ? batch_profile : NULL)) {
+			job->state = BATCH_QUEUED;
+			batch_queued++;
+		} else {
+			job->state = BATCH_FAILED;
+			job->ended = job->queued;
+			msgs_lookup("BatchQueueFailed", job->error, BATCH_MAX_ERROR);
+		}
+	}
+
+	if (batch_next_job == NULL && batch_queued == 0)
+		batch_finish(NULL);
+}
+
+
+/**
+ * Finish the batch, writing the report on its files and setting the
+ * application to quit.
+ *
+ * \param *reason		The reason that the batch could not be run, or
+ *				NULL if it ran.
+ */
+
+static void batch_finish(char *reason)
+{
+	struct batch_job	*job, *next;
+	FILE			*out;
+	int			total = 0, failed = 0;
+
+	if (!batch_running)
+		return;
+
+	batch_running = FALSE;
+	main_quit_flag = TRUE;
+
+	for (job = batch_jobs; job != NULL; job = job->next) {
+		total++;
+		if (job->state != BATCH_DONE)
+			failed++;
+	}
+
+	if (reason != NULL || failed > 0)
+		batch_failures = TRUE;
+
+	/* The report is tab-separated, like the statistics, so that it can be read by other tools. */
+
+	out = fopen(batch_report, "w");
+
+	if (out != NULL) {
+		fprintf(out, "# PrintPDF batch conversion report\n");
+		fprintf(out, "# Profile %s\n", (*batch_profile != '\0') ? batch_profile : "(Choices)");
+
+		if (reason != NULL)
+			fprintf(out, "# %s\n", reason);
+		else
+			fprintf(out, "# Files %d, converted %d, failed %d\n", total, total - failed, failed);
+
+		fprintf(out, "\nResult\tTime\tInput\tOutput\tError\n");
+
+		for (job = batch_jobs; job != NULL; job = job->next) {
+			fprintf(out, "%s\t%d\t%s\t%s\t%s\n", (job->state == BATCH_DONE) ? "OK" : "Failed",
+					job->ended - job->queued, job->input, job->output, job->error);
+		}
+
+		fclose(out);
+	}
+
+	#ifdef DEBUG
+	debug_printf("Batch finished: %d files, %d failed", total, failed);
+	#endif
+
+	for (job = batch_jobs; job != NULL; job = next) {
+		next = job->next;
+		free(job);
+	}
+
+	batch_jobs = NULL;
+	batch_tail = &batch_jobs;
+}
+
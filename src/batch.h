@@ -0,0 +1,103 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: batch.h
+ *
+ * Batch conversion implementation.
+ */
+
+#ifndef PRINTPDF_BATCH
+#define PRINTPDF_BATCH
+
+#include "oslib/types.h"
+
+/**
+ * A file in a batch conversion.
+ */
+
+struct batch_job;
+
+
+/**
+ * Start a batch conversion of a list or directory of PostScript files.  The
+ * files are converted without any windows being opened, and once they have
+ * all been dealt with, a report is written and the application quits.
+ *
+ * \param *source		A directory of PostScript files, a single
+ *				PostScript file, or a text file listing one
+ *				file to convert on each line.
+ * \param *profile		The name of the settings profile to use, or
+ *				NULL to use the current Choices.
+ * \param *output		The directory to save the PDFs into, or NULL
+ *				to save each beside its PostScript file.
+ * \param *report		The file to write the report to, or NULL to
+ *				use the BatchReport file.
+ * \return			TRUE if the batch was started; else FALSE.
+ */
+
+osbool batch_start(char *source, char *profile, char *output, char *report);
+
+
+/**
+ * Test whether a batch conversion is running.
+ *
+ * \return			TRUE if a batch is running; else FALSE.
+ */
+
+osbool batch_active(void);
+
+
+/**
+ * Test whether a batch conversion has failed, either in part or because
+ * it could not be started.
+ *
+ * \return			TRUE if any of the batch failed; else FALSE.
+ */
+
+osbool batch_failed(void);
+
+
+/**
+ * Return the name of the PDF to be created for a file in a batch.
+ *
+ * \param *job			The batch file.
+ * \return			Pointer to the name of the PDF.
+ */
+
+char *batch_get_output_filename(struct batch_job *job);
+
+
+/**
+ * Record the outcome of the conversion of a file in a batch, and queue
+ * more files for conversion if there are any left.
+ *
+ * \param *job			The batch file which has been converted.
+ * \param success		TRUE if the conversion succeeded; else FALSE.
+ * \param *error		The error reported by the conversion, or NULL.
+ */
+
+void batch_notify_conversion_end(struct batch_job *job, osbool success, char *error);
+
+#endif
+
@@ -31,7 +31,10 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <ctype.h>
+#include <limits.h>
 
 /* Acorn C header files */
 
@@ -71,22 +74,55 @@
 #include "pmenu.h"
 
 
+/* The nodes in a block are held in a linked list in outline order, and are
+ * also indexed by a treap keyed on their position in the list.  Each node in
+ * the treap carries the size of its subtree, the lowest level in it and the
+ * number of contracted nodes which hide each node, with changes to the latter
+ * being passed down lazily.  This allows rows and nodes to be found from each
+ * other, and nodes to be added, removed, moved and contracted, in logarithmic
+ * time.
+ */
+
 typedef struct bookmark_node {
-	char			title[MAX_BOOKMARK_LEN];
+	char			*title;		/*< The title, interned in the block's arena.	*/
 	int			page;		/*< Destination page number.		*/
 	int			yoffset;	/*< Destination Y offset (millipt from top).	*/
 	int			level;
-	int			count;
 
 	osbool			expanded;
 
 	struct bookmark_node	*next;
+
+	struct bookmark_node	*left;		/*< The node's left child in the index.			*/
+	struct bookmark_node	*right;		/*< The node's right child in the index.		*/
+	struct bookmark_node	*up;		/*< The node's parent in the index.			*/
+	struct bookmark_node	*touched;	/*< The next node in the list of contractions being edited.	*/
+	unsigned		priority;	/*< The node's priority in the index.			*/
+	int			size;		/*< The number of nodes in the subtree, or 0 if unindexed.	*/
+	int			lowest;		/*< The lowest level in the subtree.			*/
+	int			hidden;		/*< The number of contracted nodes hiding the node.	*/
+	int			hidden_add;	/*< A change to hidden still to be passed to the children.	*/
+	int			hidden_min;	/*< The smallest value of hidden in the subtree.	*/
+	int			hidden_count;	/*< The number of nodes in the subtree with that value.	*/
 } bookmark_node;
 
-typedef struct bookmark_redraw {
-	bookmark_node		*node;
-	int			selected;
-} bookmark_redraw;
+/* The nodes and titles of a block are allocated from an arena of chunks, each
+ * twice the size of the one before, so that the whole lot can be freed with
+ * the block in a handful of calls.  Titles are stored once for each distinct
+ * text, and looked up by a hash table.
+ */
+
+typedef struct bookmark_chunk {
+	struct bookmark_chunk	*next;		/*< The next (smaller) chunk in the arena.		*/
+	size_t			size;		/*< The size of the chunk's data, in bytes.		*/
+	size_t			used;		/*< The number of bytes of data in use.			*/
+} bookmark_chunk;
+
+typedef struct bookmark_title {
+	struct bookmark_title	*next;		/*< The next title in the same hash bucket.		*/
+	unsigned		hash;		/*< The hash of the title text.				*/
+	char			text[1];	/*< The title text, which runs on past the struct.	*/
+} bookmark_title;
 
 /* Not a typedef, as that is done in the header file. */
 
@@ -102,7 +138,7 @@ struct bookmark_block {
 	wimp_w			toolbar;
 	wimp_i			edit_icon;
 
-	bookmark_redraw		*redraw;
+	bookmark_node		*index;
 	int			lines;
 
 	int			column_pos[BOOKMARK_WINDOW_COLUMNS];
@@ -116,11 +152,40 @@ struct bookmark_block {
 	bookmark_node		*root;
 	int			nodes;
 
+	int			expandable;
+	int			contractable;
+
+	bookmark_chunk		*arena;
+	bookmark_node		*spare;
+	bookmark_title		**titles;
+	int			title_buckets;
+	int			title_count;
+
 	osbool			drag_complete;
 
 	struct bookmark_block	*next;
 };
 
+/* The keys recognised in bookmark files, which are found from a perfect hash
+ * of their length and first and last characters.
+ */
+
+enum bookmark_file_key {
+	BOOKMARK_FILE_KEY_NONE = 0,			/**< A key which isn't recognised.			*/
+	BOOKMARK_FILE_KEY_NAME,				/**< The name of the bookmark block.			*/
+	BOOKMARK_FILE_KEY_TITLE,			/**< The title of a new bookmark.			*/
+	BOOKMARK_FILE_KEY_PAGE,				/**< The destination page of the bookmark.		*/
+	BOOKMARK_FILE_KEY_YOFFSET,			/**< The destination Y offset of the bookmark.		*/
+	BOOKMARK_FILE_KEY_LEVEL,			/**< The level of the bookmark.				*/
+	BOOKMARK_FILE_KEY_EXPANDED,			/**< The expansion state of the bookmark.		*/
+	BOOKMARK_FILE_KEY_FORMAT			/**< The format version of the file.			*/
+};
+
+struct bookmark_file_key_slot {
+	char			*name;		/*< The key, as it appears in the file.			*/
+	enum bookmark_file_key	key;		/*< The key's identity.					*/
+};
+
 
 /* ****************************************************************************
  * Function prototypes
@@ -133,9 +198,17 @@ struct bookmark_block {
 static bookmark_block	*bookmark_create_block(void);
 static void		bookmark_delete_block(bookmark_block *bookmark);
 static bookmark_node	*bookmark_insert_node(bookmark_block *bm, bookmark_node *before);
-static void		bookmark_delete_node(bookmark_block *bm, bookmark_node *node);
+static void		bookmark_unlink_node(bookmark_block *bm, bookmark_node *node);
 static void		bookmark_set_unsaved_state(bookmark_block *bm, osbool unsaved);
 
+static bookmark_node	*bookmark_arena_new_node(bookmark_block *bm);
+static void		bookmark_arena_free_node(bookmark_block *bm, bookmark_node *node);
+static char		*bookmark_arena_intern_title(bookmark_block *bm, char *text);
+static osbool		bookmark_arena_grow_titles(bookmark_block *bm);
+static void		*bookmark_arena_allocate(bookmark_block *bm, size_t size);
+static bookmark_chunk	*bookmark_arena_add_chunk(bookmark_block *bm, size_t size);
+static void		bookmark_arena_free(bookmark_block *bm);
+
 static bookmark_block	*bookmark_find_window(wimp_w window);
 static bookmark_block	*bookmark_find_toolbar(wimp_w window);
 static bookmark_block	*bookmark_find_name(char *name);
@@ -157,6 +230,8 @@ static void		bookmark_insert_edit_row_from_keypress(bookmark_block *bm, wimp_car
 static int		bookmark_insert_edit_row(bookmark_block *bm, bookmark_node *node, int direction);
 static void		bookmark_delete_edit_row(bookmark_block *bm, bookmark_node *node);
 static void		bookmark_change_edit_row_indentation(bookmark_block *bm, bookmark_node *node, int action);
+static void		bookmark_toggle_edit_row(bookmark_block *bm, bookmark_node *node);
+static void		bookmark_move_edit_row(bookmark_block *bm, bookmark_node *node, bookmark_node *target);
 static void		bookmark_toolbar_set_expansion_icons(bookmark_block *bm, int *expand, int *contract);
 static void		bookmark_tree_node_expansion(bookmark_block *bm, osbool expand);
 static int		bookmark_place_edit_icon(bookmark_block *bm, int row, int col);
@@ -198,6 +273,54 @@ static void		bookmark_start_direct_menu_save(bookmark_block *bm);
 
 static osbool		bookmarks_save_file(char *filename, osbool selection, void *data);
 static void		bookmark_rebuild_data(bookmark_block *bm);
+static int		*bookmark_count_all_descendants(bookmark_block *bm);
+
+/* Bookmark File Parser */
+
+static osbool		bookmark_parse_file(bookmark_block *bm, char *buffer, size_t length, int *bad_line);
+static enum bookmark_file_key	bookmark_parse_key(char *key);
+static char		*bookmark_parse_trim(char *start, char *end);
+static osbool		bookmark_parse_number(char *text, int *value);
+
+/* Bookmark Outline Index */
+
+static void		bookmark_start_edit(bookmark_block *bm, int row, bookmark_node *after);
+static void		bookmark_end_edit(bookmark_block *bm);
+static void		bookmark_hold_edit_icon(bookmark_block *bm);
+static void		bookmark_restore_edit_icon(bookmark_block *bm);
+static void		bookmark_index_build(bookmark_block *bm);
+static void		bookmark_index_start_edit(bookmark_block *bm, bookmark_node *before, bookmark_node *after);
+static void		bookmark_index_end_edit(bookmark_block *bm, bookmark_node *before, bookmark_node *after);
+static void		bookmark_index_touch_node(bookmark_block *bm, bookmark_node *node, osbool show);
+static void		bookmark_index_count_node(bookmark_block *bm, bookmark_node *node, int change);
+static void		bookmark_index_hide_contents(bookmark_block *bm, bookmark_node *node, int change);
+static void		bookmark_index_refresh(bookmark_block *bm, int position, int count);
+static void		bookmark_index_insert(bookmark_block *bm, bookmark_node *node, bookmark_node *before);
+static void		bookmark_index_remove(bookmark_block *bm, bookmark_node *node);
+static int		bookmark_index_find_position(bookmark_node *node);
+static bookmark_node	*bookmark_index_find_node(bookmark_block *bm, int position);
+static bookmark_node	*bookmark_index_find_row(bookmark_block *bm, int row);
+static int		bookmark_index_find_node_row(bookmark_node *node, osbool *visible);
+static bookmark_node	*bookmark_index_find_previous(bookmark_block *bm, bookmark_node *node);
+static bookmark_node	*bookmark_index_find_parent(bookmark_block *bm, bookmark_node *node);
+static int		bookmark_index_find_end(bookmark_block *bm, bookmark_node *node);
+static int		bookmark_index_count_descendants(bookmark_block *bm, bookmark_node *node);
+static int		bookmark_index_find_level(bookmark_node *node, int start, int level);
+static int		bookmark_index_find_level_before(bookmark_node *node, int end, int level);
+static void		bookmark_index_split(bookmark_node *node, int count, bookmark_node **first, bookmark_node **second);
+static bookmark_node	*bookmark_index_join(bookmark_node *first, bookmark_node *second);
+static void		bookmark_index_recalculate(bookmark_node *node);
+static void		bookmark_index_update(bookmark_node *node);
+static void		bookmark_index_hide(bookmark_node *node, int change);
+static void		bookmark_index_push(bookmark_node *node);
+static int		bookmark_index_size(bookmark_node *node);
+static int		bookmark_index_visible(bookmark_node *node, int pending);
+static unsigned		bookmark_index_random(void);
+static osbool		bookmark_node_has_children(bookmark_node *node);
+
+#ifdef HOSTED
+static osbool		bookmark_hosted_check_node(bookmark_node *node, int pending, bookmark_node ***cursor, int *hidden, bookmark_node **list);
+#endif
 
 /* ****************************************************************************
  * Macros
@@ -209,6 +332,17 @@ static void		bookmark_rebuild_data(bookmark_block *bm);
 #define LINE_Y0(x) (LINE_BASE(x) + BOOKMARK_LINE_OFFSET)
 #define LINE_Y1(x) (LINE_BASE(x) + BOOKMARK_LINE_OFFSET + BOOKMARK_ICON_HEIGHT)
 
+/* Arena allocation sizes. */
+
+#define ARENA_ROUND(x) (((x) + BOOKMARK_ARENA_ALIGN - 1) & ~((size_t) BOOKMARK_ARENA_ALIGN - 1))
+#define ARENA_CHUNK_HEADER ARENA_ROUND(sizeof(bookmark_chunk))
+
+/* Bookmark file key hashing, on the key's length and its first and last
+ * characters in lower case.
+ */
+
+#define FILE_KEY_HASH(length, first, last) (((length) + (first) + ((last) << 1)) & (BOOKMARK_FILE_KEYS - 1))
+
 /* ****************************************************************************
  * Global variables
  * ****************************************************************************/
@@ -221,6 +355,23 @@ static int			untitled_number = 1;
 static bookmark_block		*bookmarks_edit = NULL;
 static char			*bookmarks_edit_buffer = NULL;
 
+/* The title shared by all of the nodes without one. */
+
+static char			bookmarks_empty_title[] = "";
+
+/* The keys recognised in bookmark files, in the slots given by FILE_KEY_HASH(). */
+
+static struct bookmark_file_key_slot bookmark_file_keys[BOOKMARK_FILE_KEYS] = {
+	{NULL, BOOKMARK_FILE_KEY_NONE},		{"@", BOOKMARK_FILE_KEY_TITLE},
+	{NULL, BOOKMARK_FILE_KEY_NONE},		{NULL, BOOKMARK_FILE_KEY_NONE},
+	{"Format", BOOKMARK_FILE_KEY_FORMAT},	{"Expanded", BOOKMARK_FILE_KEY_EXPANDED},
+	{NULL, BOOKMARK_FILE_KEY_NONE},		{NULL, BOOKMARK_FILE_KEY_NONE},
+	{"YOffset", BOOKMARK_FILE_KEY_YOFFSET},	{"Level", BOOKMARK_FILE_KEY_LEVEL},
+	{NULL, BOOKMARK_FILE_KEY_NONE},		{NULL, BOOKMARK_FILE_KEY_NONE},
+	{"Name", BOOKMARK_FILE_KEY_NAME},	{NULL, BOOKMARK_FILE_KEY_NONE},
+	{"Page", BOOKMARK_FILE_KEY_PAGE},	{NULL, BOOKMARK_FILE_KEY_NONE}
+};
+
 static wimp_menu		*bookmarks_list_menu = NULL;
 static bookmark_block		**bookmarks_list_menu_links = NULL;
 static int			bookmarks_list_menu_size = 0;
@@ -237,6 +388,34 @@ static wimp_menu		*bookmark_menu_insert = NULL;
 static wimp_menu		*bookmark_menu_level = NULL;
 static wimp_menu		*bookmark_menu_view = NULL;
 
+/* The state of an edit to a bookmark window, between bookmark_start_edit()
+ * and bookmark_end_edit().
+ */
+
+static int			bookmarks_edit_first_row = 0;
+static int			bookmarks_edit_end_row = 0;
+static int			bookmarks_edit_lines = 0;
+static bookmark_node		*bookmarks_edit_after = NULL;
+static bookmark_node		*bookmarks_edit_node = NULL;
+static int			bookmarks_edit_col = -1;
+static wimp_caret		bookmarks_edit_caret;
+
+/* The contracted nodes whose contents are being edited, between
+ * bookmark_index_start_edit() and bookmark_index_end_edit().
+ */
+
+static bookmark_node		*bookmarks_edit_touched = NULL;
+
+#ifdef HOSTED
+/* Whether the last file loaded contained data which could not be read. */
+
+static osbool			bookmarks_hosted_damaged = FALSE;
+#endif
+
+/* The generator used for the priorities of nodes in the index. */
+
+static unsigned			bookmarks_index_seed = 2463534242u;
+
 
 /* ****************************************************************************
  * Bookmarks System Initialisation and Termination
@@ -540,10 +719,17 @@ static bookmark_block *bookmark_create_block(void)
 		new->unsaved = FALSE;
 		new->window = NULL;
 		new->toolbar = NULL;
-		new->redraw = NULL;
+		new->index = NULL;
 		new->root = NULL;
 		new->lines = 0;
 		new->nodes = 0;
+		new->expandable = 0;
+		new->contractable = 0;
+		new->arena = NULL;
+		new->spare = NULL;
+		new->titles = NULL;
+		new->title_buckets = 0;
+		new->title_count = 0;
 		new->caret_row = -1;
 		new->caret_col = -1;
 		new->edit_icon = wimp_ICON_WINDOW;
@@ -571,7 +757,6 @@ static bookmark_block *bookmark_create_block(void)
 static void bookmark_delete_block(bookmark_block *bookmark)
 {
 	bookmark_block		**bm, *f;
-	bookmark_node		*n, *nf;
 
 	bm = &bookmarks_list;
 
@@ -582,15 +767,10 @@ static void bookmark_delete_block(bookmark_block *bookmark)
 		f = *bm;
 		*bm = (*bm)->next;
 
-		n = f->root;
-		while (n != NULL) {
-			nf = n;
-			n = n->next;
-			free(nf);
-		}
+		if (bookmarks_edit == f)
+			bookmarks_edit = NULL;
 
-		if (f->redraw != NULL)
-			free(f->redraw);
+		bookmark_arena_free(f);
 
 		free(f);
 
@@ -605,7 +785,10 @@ static void bookmark_delete_block(bookmark_block *bookmark)
 
 /**
  * Insert a new node into the list.  If before is not NULL, the node is inserted
- * beofre that node in the list; otherwise, it is inserted at the end.
+ * beofre that node in the list; otherwise, it is inserted at the end.  The
+ * node is added to the block's index, but the caller must bracket the change
+ * with bookmark_index_start_edit() and bookmark_index_end_edit() if the
+ * block has already been indexed.
  *
  * \param  *bm			The bookmark block to insert into.
  * \param  *before		The node to insert before (NULL for list end).
@@ -614,73 +797,69 @@ static void bookmark_delete_block(bookmark_block *bookmark)
 
 static bookmark_node *bookmark_insert_node(bookmark_block *bm, bookmark_node *before)
 {
-	bookmark_node		**node, *new = NULL;
+	bookmark_node		*previous, *new = NULL;
 
 	if (bm == NULL)
 		return new;
 
-	node = &(bm->root);
-	if (node == NULL)
-		return new;
-
-	while (*node != before && *node != NULL)
-		node = &((*node)->next);
-
-	new = (bookmark_node *) malloc(sizeof(bookmark_node));
+	new = bookmark_arena_new_node(bm);
 
 	if (new == NULL)
 		return new;
 
-	string_copy(new->title, "", MAX_BOOKMARK_LEN);
+	new->title = bookmarks_empty_title;
 
 	new->page = 0;
 	new->yoffset = -1;
 	new->expanded = TRUE;
 	new->level = 1;
-	new->count = 0;
-	new->next = NULL;
 
-	new->next = *node;
-	*node = new;
+	previous = bookmark_index_find_previous(bm, before);
+
+	if (previous != NULL) {
+		new->next = previous->next;
+		previous->next = new;
+	} else {
+		new->next = bm->root;
+		bm->root = new;
+	}
+
+	bookmark_index_insert(bm, new, before);
 
 	return new;
 }
 
 
 /**
- * Delete a bookmark node from a block.
+ * Unlink a bookmark node from a block, without freeing it.  The caller must
+ * bracket the change with bookmark_index_start_edit() and
+ * bookmark_index_end_edit().
  *
  * \param  *bm			The bookmark block.
- * \param  *node		The node to delete.
+ * \param  *node		The node to unlink.
  */
 
-static void bookmark_delete_node(bookmark_block *bm, bookmark_node *node)
+static void bookmark_unlink_node(bookmark_block *bm, bookmark_node *node)
 {
-	bookmark_node		*parent = NULL;
+	bookmark_node		*parent;
 
-	if (bm == NULL || node == NULL || bm->root == NULL)
+	if (bm == NULL || node == NULL || node->size == 0)
 		return;
 
-	/* Find the parent node; if parent == NULL then either the node is at
-	 * the head of the list or it wasn't in the list.
+	/* Find the parent node; if parent == NULL then the node is at the
+	 * head of the list.
 	 */
 
-	if (bm->root != node)
-		for (parent = bm->root; parent != NULL && parent->next != node; parent = parent->next);
-
-	/* At this point, give up if the supplied node wasn't in the list. */
-
-	if (parent == NULL && bm->root != node)
-		return;
-
-	/* Unlink the node and free its memory. */
+	parent = bookmark_index_find_previous(bm, node);
 
 	if (parent != NULL)
 		parent->next = node->next;
 	else
 		bm->root = node->next;
 
-	free(node);
+	node->next = NULL;
+
+	bookmark_index_remove(bm, node);
 }
 
 
@@ -700,6 +879,238 @@ static void bookmark_set_unsaved_state(bookmark_block *bm, osbool unsaved)
 }
 
 
+/**
+ * Allocate a new node from a block's arena, re-using a node which has been
+ * freed if there is one.  The node's contents are not initialised.
+ *
+ * \param  *bm			The bookmark block to allocate from.
+ * \return			The new node; NULL indicates a failure.
+ */
+
+static bookmark_node *bookmark_arena_new_node(bookmark_block *bm)
+{
+	bookmark_node		*node;
+
+	if (bm->spare == NULL)
+		return (bookmark_node *) bookmark_arena_allocate(bm, sizeof(bookmark_node));
+
+	node = bm->spare;
+	bm->spare = node->next;
+
+	return node;
+}
+
+
+/**
+ * Return a node to a block's arena, for re-use.  The node must already have
+ * been unlinked from the block.
+ *
+ * \param  *bm			The bookmark block holding the node.
+ * \param  *node		The node to free.
+ */
+
+static void bookmark_arena_free_node(bookmark_block *bm, bookmark_node *node)
+{
+	node->next = bm->spare;
+	bm->spare = node;
+}
+
+
+/**
+ * Find a copy of a title in a block's arena, adding one if there isn't one
+ * already.  Titles are cut short at MAX_BOOKMARK_LEN - 1 bytes.
+ *
+ * \param  *bm			The bookmark block to store the title in.
+ * \param  *text		The title text.
+ * \return			The stored title; NULL indicates a failure.
+ */
+
+static char *bookmark_arena_intern_title(bookmark_block *bm, char *text)
+{
+	bookmark_title		*title;
+	unsigned		hash;
+	size_t			length;
+
+	if (text == NULL || *text == '\0')
+		return bookmarks_empty_title;
+
+	/* Take an FNV-1a hash of the text. */
+
+	hash = 2166136261u;
+
+	for (length = 0; text[length] != '\0' && length < MAX_BOOKMARK_LEN - 1; length++)
+		hash = (hash ^ (unsigned char) text[length]) * 16777619u;
+
+	if (bm->title_count >= bm->title_buckets * 2 && !bookmark_arena_grow_titles(bm) && bm->titles == NULL)
+		return NULL;
+
+	for (title = bm->titles[hash % bm->title_buckets]; title != NULL; title = title->next) {
+		if (title->hash == hash && strncmp(title->text, text, length) == 0 && title->text[length] == '\0')
+			return title->text;
+	}
+
+	title = (bookmark_title *) bookmark_arena_allocate(bm, offsetof(bookmark_title, text) + length + 1);
+	if (title == NULL)
+		return NULL;
+
+	memcpy(title->text, text, length);
+	title->text[length] = '\0';
+	title->hash = hash;
+
+	title->next = bm->titles[hash % bm->title_buckets];
+	bm->titles[hash % bm->title_buckets] = title;
+	bm->title_count++;
+
+	return title->text;
+}
+
+
+/**
+ * Double the number of buckets in a block's title hash table.
+ *
+ * \param  *bm			The bookmark block to update.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool bookmark_arena_grow_titles(bookmark_block *bm)
+{
+	bookmark_title		**titles, *title;
+	int			i, buckets;
+
+	buckets = (bm->title_buckets > 0) ? bm->title_buckets * 2 : BOOKMARK_TITLE_BUCKETS;
+
+	titles = (bookmark_title **) malloc(buckets * sizeof(bookmark_title *));
+	if (titles == NULL)
+		return FALSE;
+
+	for (i = 0; i < buckets; i++)
+		titles[i] = NULL;
+
+	for (i = 0; i < bm->title_buckets; i++) {
+		while (bm->titles[i] != NULL) {
+			title = bm->titles[i];
+			bm->titles[i] = title->next;
+
+			title->next = titles[title->hash % buckets];
+			titles[title->hash % buckets] = title;
+		}
+	}
+
+	if (bm->titles != NULL)
+		free(bm->titles);
+
+	bm->titles = titles;
+	bm->title_buckets = buckets;
+
+	return TRUE;
+}
+
+
+/**
+ * Allocate memory from a block's arena, adding a new chunk if the current one
+ * is full.  Allocations too big for the next chunk are given a chunk of their
+ * own, which is kept behind the current one so that it carries on filling.
+ *
+ * \param  *bm			The bookmark block to allocate from.
+ * \param  size			The number of bytes required.
+ * \return			Pointer to the memory; NULL indicates a failure.
+ */
+
+static void *bookmark_arena_allocate(bookmark_block *bm, size_t size)
+{
+	bookmark_chunk		*chunk, *large;
+	size_t			chunk_size;
+	char			*memory;
+
+	size = ARENA_ROUND(size);
+	chunk = bm->arena;
+
+	if (chunk == NULL || chunk->used + size > chunk->size) {
+		chunk_size = (chunk != NULL) ? chunk->size * 2 : BOOKMARK_ARENA_CHUNK;
+
+		if (size > chunk_size) {
+			if (chunk == NULL && (chunk = bookmark_arena_add_chunk(bm, chunk_size)) == NULL)
+				return NULL;
+
+			large = (bookmark_chunk *) malloc(ARENA_CHUNK_HEADER + size);
+			if (large == NULL)
+				return NULL;
+
+			large->next = chunk->next;
+			large->size = size;
+			large->used = size;
+
+			chunk->next = large;
+
+			return (char *) large + ARENA_CHUNK_HEADER;
+		}
+
+		chunk = bookmark_arena_add_chunk(bm, chunk_size);
+		if (chunk == NULL)
+			return NULL;
+	}
+
+	memory = (char *) chunk + ARENA_CHUNK_HEADER + chunk->used;
+	chunk->used += size;
+
+	return memory;
+}
+
+
+/**
+ * Add a new, empty chunk to the front of a block's arena.
+ *
+ * \param  *bm			The bookmark block to add the chunk to.
+ * \param  size			The size of the chunk's data, in bytes.
+ * \return			The new chunk; NULL indicates a failure.
+ */
+
+static bookmark_chunk *bookmark_arena_add_chunk(bookmark_block *bm, size_t size)
+{
+	bookmark_chunk		*chunk;
+
+	chunk = (bookmark_chunk *) malloc(ARENA_CHUNK_HEADER + size);
+	if (chunk == NULL)
+		return NULL;
+
+	chunk->next = bm->arena;
+	chunk->size = size;
+	chunk->used = 0;
+
+	bm->arena = chunk;
+
+	return chunk;
+}
+
+
+/**
+ * Free a block's arena, along with all of the nodes and titles in it.
+ *
+ * \param  *bm			The bookmark block to free the arena of.
+ */
+
+static void bookmark_arena_free(bookmark_block *bm)
+{
+	bookmark_chunk		*chunk;
+
+	while (bm->arena != NULL) {
+		chunk = bm->arena;
+		bm->arena = chunk->next;
+		free(chunk);
+	}
+
+	if (bm->titles != NULL)
+		free(bm->titles);
+
+	bm->titles = NULL;
+	bm->title_buckets = 0;
+	bm->title_count = 0;
+	bm->spare = NULL;
+	bm->root = NULL;
+	bm->index = NULL;
+}
+
+
 /**
  * Find a bookmark block by its window handle.
  *
@@ -1017,9 +1428,6 @@ static void bookmark_close_window(wimp_close *close)
 	ihelp_remove_window(bm->window);
 	ihelp_remove_window(bm->toolbar);
 
-	if (bookmarks_edit == bm)
-		bookmarks_edit = NULL;
-
 	bookmark_delete_block(bm);
 
 }
@@ -1066,7 +1474,7 @@ static void bookmark_window_decode_help(char *buffer, wimp_w w, wimp_i i, os_coo
 
 static void bookmark_redraw_window(wimp_draw *redraw)
 {
-	int			ox, oy, top, bottom, y;
+	int			oy, top, bottom, y;
 	osbool			more;
 	bookmark_node		*node;
 	wimp_icon		*icon;
@@ -1081,7 +1489,6 @@ static void bookmark_redraw_window(wimp_draw *redraw)
 
 	more = wimp_redraw_window(redraw);
 
-	ox = redraw->box.x0 - redraw->xscroll;
 	oy = redraw->box.y1 - redraw->yscroll;
 
 	icon = bookmark_window_def->icons;
@@ -1098,7 +1505,9 @@ static void bookmark_redraw_window(wimp_draw *redraw)
 
 		for (y = top; y < bottom; y++) {
 			bookmark_calculate_window_row_start(bm, y);
-			node = bm->redraw[y].node;
+			node = bookmark_index_find_row(bm, y);
+			if (node == NULL)
+				continue;
 
 			/* Plot the menu highlight. */
 
@@ -1137,10 +1546,10 @@ static void bookmark_redraw_window(wimp_draw *redraw)
 			icon[BOOKMARK_ICON_EXPAND].data.indirected_sprite.size = 6;
 
 			/* Plot the expansion arrow for node heads, which show up
-			 * as entries whose count is non-zero.
+			 * as entries followed by one at a deeper level.
 			 */
 
-			if (node->count > 0)
+			if (bookmark_node_has_children(node))
 				wimp_plot_icon(&(icon[BOOKMARK_ICON_EXPAND]));
 
 			/* Plot the column icons, if they aren't replaced by a real
@@ -1188,16 +1597,13 @@ static void bookmark_click_handler(wimp_pointer *pointer)
 	y = pointer->pos.y - state.visible.y1 + state.yscroll;
 
 	if (row != -1 && col != -1) {
-		node = bm->redraw[row].node;
+		node = bookmark_index_find_row(bm, row);
 
 		if (col == BOOKMARK_ICON_EXPAND && pointer->buttons == wimp_CLICK_SELECT &&
-				node->count > 0) {
+				bookmark_node_has_children(node)) {
 			/* Handle expandion arrow clicks. */
 
-			node->expanded = !node->expanded;
-			bookmark_rebuild_data(bm);
-			bookmark_force_window_redraw(bm, row, -1);
-			bookmark_set_unsaved_state(bm, TRUE);
+			bookmark_toggle_edit_row(bm, node);
 		} else if (col >= BOOKMARK_ICON_TITLE && pointer->buttons == wimp_CLICK_SELECT) {
 			if (bm->drag_complete) {
 				bm->drag_complete = FALSE;
@@ -1236,8 +1642,8 @@ static osbool bookmark_key_handler(wimp_key *key)
 		case wimp_KEY_BACKSPACE:
 			bookmark_resync_edit_with_file();
 			if (bm->caret_col == BOOKMARK_ICON_TITLE && bm->caret_row > 0 &&
-					 strlen(bm->redraw[bm->caret_row].node->title) == 0) {
-				bookmark_delete_edit_row(bm, bm->redraw[bm->caret_row].node);
+					 strlen(bookmark_index_find_row(bm, bm->caret_row)->title) == 0) {
+				bookmark_delete_edit_row(bm, bookmark_index_find_row(bm, bm->caret_row));
 				icons_put_caret_at_end(bm->window, bm->edit_icon);
 			}
 			break;
@@ -1329,8 +1735,8 @@ static void bookmark_gain_caret_handler(wimp_caret *caret)
 		return;
 
 	if (bm->caret_row != -1) {
-		node = bm->redraw[bm->caret_row].node;
-		for (parent = bm->root; parent != NULL && parent->next != node; parent = parent->next);
+		node = bookmark_index_find_row(bm, bm->caret_row);
+		parent = (node != NULL) ? bookmark_index_find_previous(bm, node) : NULL;
 	} else {
 		node = NULL;
 		parent = NULL;
@@ -1469,12 +1875,12 @@ static void bookmark_insert_edit_row_from_keypress(bookmark_block *bm, wimp_care
 	if (caret->w != bm->window || bm->caret_row == -1 || bm->caret_col == -1)
 		return;
 
+	node = bookmark_index_find_row(bm, bm->caret_row);
+
 	direction = (caret->index == 0 && bm->caret_col == 1 &&
-			strlen(bm->redraw[bm->caret_row].node->title) > 0) ?
+			strlen(node->title) > 0) ?
 			BOOKMARK_ABOVE : BOOKMARK_BELOW;
 
-	node = bm->redraw[bm->caret_row].node;
-
 	bookmark_insert_edit_row(bm, node, direction);
 
 	if (direction == BOOKMARK_BELOW) {
@@ -1496,34 +1902,45 @@ static void bookmark_insert_edit_row_from_keypress(bookmark_block *bm, wimp_care
 
 static int bookmark_insert_edit_row(bookmark_block *bm, bookmark_node *node, int direction)
 {
-	bookmark_node		*new;
+	bookmark_node		*new, *previous, *after;
+	osbool			visible;
 	int			line, status = 1;
 
-	if (bm == NULL || node == NULL)
+	if (bm == NULL || node == NULL || node->size == 0)
 		return status;
 
-	for (line = -1; line < bm->lines && bm->redraw[line].node != node; line++);
-	if (line == -1 || bm->redraw[line].node != node)
+	line = bookmark_index_find_node_row(node, &visible);
+	if (!visible)
 		return status;
 
+	/* The new node goes in before the node in the following row, or at
+	 * the end if there isn't one.
+	 */
+
 	if (direction == BOOKMARK_ABOVE) {
-		new = bookmark_insert_node(bm, node);
-		if (new != NULL) {
-			new->level = node->level;
-			bookmark_rebuild_data(bm);
-			bookmark_force_window_redraw(bm, line, -1);
-			bookmark_set_unsaved_state(bm, TRUE);
-			status = 0;
-		}
+		after = node;
 	} else if (direction == BOOKMARK_BELOW) {
-		new = bookmark_insert_node(bm, ((line+1) < bm->lines) ? bm->redraw[line+1].node : NULL);
-		if (new != NULL) {
-			new->level = bm->redraw[line].node->level;
-			bookmark_rebuild_data(bm);
-			bookmark_force_window_redraw(bm, line + 1, -1);
-			bookmark_set_unsaved_state(bm, TRUE);
-			status = 0;
-		}
+		after = bookmark_index_find_row(bm, line + 1);
+		line++;
+	} else {
+		return status;
+	}
+
+	previous = bookmark_index_find_previous(bm, after);
+
+	bookmark_start_edit(bm, line - 1, after);
+	bookmark_index_start_edit(bm, previous, after);
+
+	new = bookmark_insert_node(bm, after);
+	if (new != NULL)
+		new->level = node->level;
+
+	bookmark_index_end_edit(bm, previous, after);
+	bookmark_end_edit(bm);
+
+	if (new != NULL) {
+		bookmark_set_unsaved_state(bm, TRUE);
+		status = 0;
 	}
 
 	return status;
@@ -1539,11 +1956,12 @@ static int bookmark_insert_edit_row(bookmark_block *bm, bookmark_node *node, int
 
 static void bookmark_delete_edit_row(bookmark_block *bm, bookmark_node *node)
 {
-	int			i, line;
-	bookmark_node		*n;
+	int			line;
+	osbool			visible;
+	bookmark_node		*n, *previous, *after;
 	wimp_caret		caret;
 
-	if (bm == NULL || node == NULL)
+	if (bm == NULL || node == NULL || node->size == 0)
 		return;
 
 	/* If there's only one node, it can't be deleted. */
@@ -1553,23 +1971,10 @@ static void bookmark_delete_edit_row(bookmark_block *bm, bookmark_node *node)
 
 	/* Find the line in the bookmark window. */
 
-	for (line = -1; line < bm->lines && bm->redraw[line].node != node; line++);
-	if (line == -1 || bm->redraw[line].node != node)
+	line = bookmark_index_find_node_row(node, &visible);
+	if (!visible)
 		return;
 
-	/* If the node was a parent, then drop all the children down a level
-	 * to compensate for its deletion.
-	 */
-
-	n = node->next;
-	i = node->count;
-
-	while (n != NULL && i > 0) {
-		n->level--;
-		n = n->next;
-		i--;
-	}
-
 	/* Move the edit line if it is in the line to be deleted. */
 
 	if (bm->caret_row == line) {
@@ -1582,11 +1987,28 @@ static void bookmark_delete_edit_row(bookmark_block *bm, bookmark_node *node)
 			bookmark_change_edit_row(bm, BOOKMARK_BELOW, &caret);
 	}
 
+	previous = bookmark_index_find_previous(bm, node);
+	after = bookmark_index_find_node(bm, bookmark_index_find_end(bm, node));
+
+	bookmark_start_edit(bm, line - 1, after);
+	bookmark_index_start_edit(bm, previous, after);
+
+	/* If the node was a parent, then drop all the children down a level
+	 * to compensate for its deletion.
+	 */
+
+	for (n = node->next; n != after; n = n->next)
+		n->level--;
+
 	/* Delete the line and tidy up. */
 
-	bookmark_delete_node(bm, node);
-	bookmark_rebuild_data(bm);
-	bookmark_force_window_redraw(bm, line, -1);
+	bookmark_unlink_node(bm, node);
+
+	bookmark_index_end_edit(bm, previous, after);
+	bookmark_end_edit(bm);
+
+	bookmark_arena_free_node(bm, node);
+
 	bookmark_set_unsaved_state(bm, TRUE);
 }
 
@@ -1601,119 +2023,249 @@ static void bookmark_delete_edit_row(bookmark_block *bm, bookmark_node *node)
 
 static void bookmark_change_edit_row_indentation(bookmark_block *bm, bookmark_node *node, int action)
 {
-	bookmark_node		*parent;
-	int			redraw_from, redraw_to, base, line;
+	bookmark_node		*parent, *last, *after, *n;
+	osbool			visible;
+	int			line, end;
 
-	if (bm == NULL)
+	if (bm == NULL || node == NULL || node->size == 0)
 		return;
 
 	/* Find the parent node.  At the end, parent points to the parent node,
-	 * or is NULL if the node is the root or isn't found.
+	 * or is NULL if the node is the root.
 	 */
 
-	for (parent = bm->root; parent != NULL && parent->next != node; parent = parent->next);
+	parent = bookmark_index_find_previous(bm, node);
 
-	/* If there is no parent, then either we have the root node (which can never have
-	 * any level other than 1) or the list is broken.  Either way, get out now.
+	/* If there is no parent, then we have the root node (which can never
+	 * have any level other than 1).  Either way, get out now.
 	 */
 
 	if (parent == NULL)
 		return;
 
-	for (line = 0; line < bm->lines && bm->redraw[line].node != node; line++);
-	if (line == 0 || bm->redraw[line].node != node)
+	line = bookmark_index_find_node_row(node, &visible);
+	if (line == 0 || !visible)
 		return;
 
-	redraw_from = -1;
-	redraw_to   = -1;
+	/* Work out which nodes will change level (up to, but not including,
+	 * last), and which rows might change as a result (up to, but not
+	 * including, after).  Changing the level of a single node leaves any
+	 * children where they are, but can change which nodes are hidden.
+	 */
 
 	switch (action) {
 	case BOOKMARK_TB_PROMOTE:
-		if (node->level <= parent->level) {
-			node->level++;
-			redraw_from = line-1;
-			redraw_to = line;
-		}
-		break;
-	case BOOKMARK_TB_PROMOTEG:
-		if (node->level <= parent->level) {
-			for (base = node->level; node != NULL && node->level >= base; node = node->next)
-				node->level++;
-			redraw_from = line-1;
-		}
+		if (node->level > parent->level)
+			return;
+		last = node->next;
+		end = bookmark_index_find_end(bm, node);
 		break;
 	case BOOKMARK_TB_DEMOTE:
-		if (node->level > 1) {
-			node->level--;
-			while (node->next != NULL && node->next->level > (node->level + 1)) {
-				node = node->next;
-				node->level--;
-			}
-			redraw_from = line-1;
-		}
+		if (node->level <= 1)
+			return;
+		last = bookmark_index_find_node(bm, bookmark_index_find_end(bm, node));
+		end = bookmark_index_find_level(bm->index, bookmark_index_find_position(node) + 1, node->level - 1);
+		break;
+	case BOOKMARK_TB_PROMOTEG:
+		if (node->level > parent->level)
+			return;
+		end = bookmark_index_find_level(bm->index, bookmark_index_find_position(node) + 1, node->level - 1);
+		last = bookmark_index_find_node(bm, end);
 		break;
 	case BOOKMARK_TB_DEMOTEG:
-		if (node->level > 1) {
-			for (base = node->level; node != NULL && node->level >= base; node = node->next)
-				node->level--;
-			redraw_from = line-1;
-		}
+		if (node->level <= 1)
+			return;
+		end = bookmark_index_find_level(bm->index, bookmark_index_find_position(node) + 1, node->level - 1);
+		last = bookmark_index_find_node(bm, end);
 		break;
+	default:
+		return;
 	}
 
-	/* If the redraw limits have been set, assume an update had happened
-	 * and perform the recalculation and tidying up.
-	 */
+	after = bookmark_index_find_node(bm, end);
 
-	if (redraw_from != -1 || redraw_to != -1) {
-		bookmark_rebuild_data(bm);
-		bookmark_set_unsaved_state(bm, TRUE);
-		bookmark_force_window_redraw(bm, redraw_from, redraw_to);
+	bookmark_start_edit(bm, line - 1, after);
+	bookmark_index_start_edit(bm, parent, last);
+
+	switch (action) {
+	case BOOKMARK_TB_PROMOTE:
+		node->level++;
+		break;
+	case BOOKMARK_TB_PROMOTEG:
+		for (n = node; n != last; n = n->next)
+			n->level++;
+		break;
+	case BOOKMARK_TB_DEMOTE:
+	case BOOKMARK_TB_DEMOTEG:
+		for (n = node; n != last; n = n->next)
+			n->level--;
+		break;
 	}
+
+	bookmark_index_end_edit(bm, parent, last);
+	bookmark_end_edit(bm);
+
+	bookmark_set_unsaved_state(bm, TRUE);
 }
 
 
 /**
- * Shade or unshade the expansion and contraction icons in the toolbar if
- * expand == NULL and contract == NULL, orreturn the settings for the two actions.
+ * Expand or contract a node in a bookmark window.
  *
- * \param  *bm			The bookmark window to act on.
- * \param  *expand		A variable to return the expand setting in, or NULL.
- * \param  *contract		A variable to return the contract setting in, or NULL.
+ * \param  *bm			The bookmark window concerned.
+ * \param  *node		The bookmark node to expand or contract.
  */
 
-static void bookmark_toolbar_set_expansion_icons(bookmark_block *bm, int *expand, int *contract)
+static void bookmark_toggle_edit_row(bookmark_block *bm, bookmark_node *node)
 {
-	bookmark_node		*node;
-	int			e=0, c=0;
+	osbool			visible;
+	int			line;
 
-	if (bm == NULL || bm->toolbar == NULL)
+	if (bm == NULL || node == NULL || !bookmark_node_has_children(node))
 		return;
 
-	for (node = bm->root; node != NULL; node = node->next) {
-		if (node->count > 0 && node->expanded == FALSE)
-			e = 1;
+	line = bookmark_index_find_node_row(node, &visible);
+	if (!visible)
+		return;
 
-		if (node->count > 0 && node->expanded == TRUE)
-			c = 1;
-	}
+	bookmark_start_edit(bm, line, bookmark_index_find_node(bm, bookmark_index_find_end(bm, node)));
 
-	if (expand != NULL || contract != NULL) {
-		if (expand != NULL)
-			*expand = e;
-		if (contract != NULL)
-			*contract = c;
-	} else {
-		icons_set_shaded(bm->toolbar, BOOKMARK_TB_EXPAND, !e);
-		icons_set_shaded(bm->toolbar, BOOKMARK_TB_CONTRACT, !c);
-	}
-}
+	bookmark_index_count_node(bm, node, -1);
+	bookmark_index_hide_contents(bm, node, (node->expanded) ? 1 : -1);
+	node->expanded = !node->expanded;
+	bookmark_index_count_node(bm, node, 1);
 
+	bm->lines = bookmark_index_visible(bm->index, 0);
 
+	bookmark_end_edit(bm);
 
-/**
- * Expand or contract all the nodes in a window.
- *
+	bookmark_set_unsaved_state(bm, TRUE);
+}
+
+
+/**
+ * Move a line in the bookmark window to sit before another line.  Any
+ * children of the moved node are left behind, and dropped down a level to
+ * compensate.
+ *
+ * \param  *bm			The bookmark window concerned.
+ * \param  *node		The bookmark node to move.
+ * \param  *target		The node to move it before, or NULL to move it
+ *				to the end.
+ */
+
+static void bookmark_move_edit_row(bookmark_block *bm, bookmark_node *node, bookmark_node *target)
+{
+	bookmark_node		*previous, *after, *n;
+	osbool			visible;
+	int			line, row, end;
+
+	if (bm == NULL || node == NULL || node == target || node->size == 0)
+		return;
+
+	line = bookmark_index_find_node_row(node, &visible);
+	if (!visible)
+		return;
+
+	/* The rows which might change run from above the higher of the node
+	 * and the target, to the lower of the target and the end of the
+	 * node's children.
+	 */
+
+	end = bookmark_index_find_end(bm, node);
+	after = bookmark_index_find_node(bm, end);
+	row = line;
+
+	if (target != NULL && target->size > 0) {
+		if (bookmark_index_find_position(target) > end)
+			after = target;
+		else
+			row = bookmark_index_find_node_row(target, NULL);
+	} else {
+		after = NULL;
+	}
+
+	bookmark_start_edit(bm, ((row < line) ? row : line) - 1, after);
+
+	/* Remove the node, dropping its children down a level. */
+
+	previous = bookmark_index_find_previous(bm, node);
+	after = bookmark_index_find_node(bm, end);
+
+	bookmark_index_start_edit(bm, previous, after);
+
+	for (n = node->next; n != after; n = n->next)
+		n->level--;
+
+	bookmark_unlink_node(bm, node);
+
+	bookmark_index_end_edit(bm, previous, after);
+
+	/* Link the node back in its new home.  At the end of the list, take
+	 * the previous node's level, otherwise take the following node's.
+	 */
+
+	previous = bookmark_index_find_previous(bm, target);
+
+	bookmark_index_start_edit(bm, previous, target);
+
+	if (previous != NULL) {
+		node->next = previous->next;
+		previous->next = node;
+	} else {
+		node->next = bm->root;
+		bm->root = node;
+	}
+
+	if (target != NULL)
+		node->level = target->level;
+	else if (previous != NULL)
+		node->level = previous->level;
+
+	bookmark_index_insert(bm, node, target);
+	bookmark_index_end_edit(bm, previous, target);
+
+	bookmark_end_edit(bm);
+
+	bookmark_set_unsaved_state(bm, TRUE);
+}
+
+
+/**
+ * Shade or unshade the expansion and contraction icons in the toolbar if
+ * expand == NULL and contract == NULL, orreturn the settings for the two actions.
+ *
+ * \param  *bm			The bookmark window to act on.
+ * \param  *expand		A variable to return the expand setting in, or NULL.
+ * \param  *contract		A variable to return the contract setting in, or NULL.
+ */
+
+static void bookmark_toolbar_set_expansion_icons(bookmark_block *bm, int *expand, int *contract)
+{
+	int			e, c;
+
+	if (bm == NULL)
+		return;
+
+	e = (bm->expandable > 0) ? 1 : 0;
+	c = (bm->contractable > 0) ? 1 : 0;
+
+	if (expand != NULL || contract != NULL) {
+		if (expand != NULL)
+			*expand = e;
+		if (contract != NULL)
+			*contract = c;
+	} else if (bm->toolbar != NULL) {
+		icons_set_shaded(bm->toolbar, BOOKMARK_TB_EXPAND, !e);
+		icons_set_shaded(bm->toolbar, BOOKMARK_TB_CONTRACT, !c);
+	}
+}
+
+
+
+/**
+ * Expand or contract all the nodes in a window.
+ *
  * \param  *bm			The bookmark window to alter.
  * \param  expand		TRUE to expand the tree; FALSE to contract.
  */
@@ -1728,7 +2280,7 @@ static void bookmark_tree_node_expansion(bookmark_block *bm, osbool expanded)
 	node = bm->root;
 
 	while (node != NULL) {
-		if (node->count > 0)
+		if (bookmark_node_has_children(node))
 			node->expanded = expanded;
 
 		node = node->next;
@@ -1755,6 +2307,7 @@ static int bookmark_place_edit_icon(bookmark_block *bm, int row, int col)
 	wimp_window_state		state;
 	size_t				buf_len;
 	wimp_icon_create		icon;
+	bookmark_node			*node;
 
 	if (bm == NULL || (bm == bookmarks_edit && bm->caret_row == row && bm->caret_col == col) ||
 			row < 0 || row >= bm->lines ||
@@ -1780,13 +2333,15 @@ static int bookmark_place_edit_icon(bookmark_block *bm, int row, int col)
 	icon.icon.data.indirected_text.text = bookmarks_edit_buffer;
 	icon.icon.data.indirected_text.size = buf_len;
 
+	node = bookmark_index_find_row(bm, row);
+
 	switch (col) {
 	case BOOKMARK_ICON_TITLE:
-		string_copy(bookmarks_edit_buffer, bm->redraw[row].node->title, buf_len);
+		string_copy(bookmarks_edit_buffer, node->title, buf_len);
 		break;
 	case BOOKMARK_ICON_PAGE:
-		if (bm->redraw[row].node->page > 0)
-			string_printf(bookmarks_edit_buffer, buf_len, "%d", bm->redraw[row].node->page);
+		if (node->page > 0)
+			string_printf(bookmarks_edit_buffer, buf_len, "%d", node->page);
 		else
 			*bookmarks_edit_buffer = '\0';
 		break;
@@ -1857,23 +2412,31 @@ static void bookmark_remove_edit_icon(void)
 static void bookmark_resync_edit_with_file(void)
 {
 	int		page;
+	char		*title;
+	bookmark_node	*node;
 
 	if (bookmarks_edit == NULL ||
 			bookmarks_edit->edit_icon == wimp_ICON_WINDOW)
 		return;
 
+	node = bookmark_index_find_row(bookmarks_edit, bookmarks_edit->caret_row);
+	if (node == NULL)
+		return;
+
 	switch (bookmarks_edit->caret_col) {
 	case BOOKMARK_ICON_TITLE:
-		if (strcmp(bookmarks_edit->redraw[bookmarks_edit->caret_row].node->title, bookmarks_edit_buffer) != 0) {
-			string_copy(bookmarks_edit->redraw[bookmarks_edit->caret_row].node->title, bookmarks_edit_buffer, MAX_BOOKMARK_LEN);
+		if (strcmp(node->title, bookmarks_edit_buffer) != 0) {
+			title = bookmark_arena_intern_title(bookmarks_edit, bookmarks_edit_buffer);
+			if (title != NULL)
+				node->title = title;
 			bookmark_set_unsaved_state(bookmarks_edit, TRUE);
 		}
 		break;
 	case BOOKMARK_ICON_PAGE:
 		page = atoi(bookmarks_edit_buffer);
 
-		if (page != bookmarks_edit->redraw[bookmarks_edit->caret_row].node->page) {
-			bookmarks_edit->redraw[bookmarks_edit->caret_row].node->page = page;
+		if (page != node->page) {
+			node->page = page;
 			bookmark_set_unsaved_state(bookmarks_edit, TRUE);
 		}
 		break;
@@ -2068,7 +2631,9 @@ static void bookmark_calculate_window_row_start(bookmark_block *bm, int row)
 	if (bm == NULL || row >= bm->lines)
 		return;
 
-	node = bm->redraw[row].node;
+	node = bookmark_index_find_row(bm, row);
+	if (node == NULL)
+		return;
 
 	bm->column_pos[BOOKMARK_ICON_EXPAND] = BOOKMARK_WINDOW_MARGIN + (node->level - 1) * BOOKMARK_LINE_HEIGHT;
 	bm->column_pos[BOOKMARK_ICON_TITLE] = BOOKMARK_WINDOW_MARGIN + node->level * BOOKMARK_LINE_HEIGHT;
@@ -2142,7 +2707,7 @@ static int bookmark_calculate_window_click_column(bookmark_block *bm, os_coord *
 	 * if we're over that area.
 	 */
 
-	if (col == BOOKMARK_ICON_EXPAND && bm->redraw[row].node->count == 0)
+	if (col == BOOKMARK_ICON_EXPAND && !bookmark_node_has_children(bookmark_index_find_row(bm, row)))
 		col = -1;
 
 	return col;
@@ -2230,10 +2795,9 @@ static void bookmark_line_drag(bookmark_block *bm, int line)
 static void bookmark_terminate_line_drag(wimp_dragged *drag, void *data)
 {
 	bookmark_block		*bm;
-	bookmark_node		*node, *target, *n;
 	wimp_pointer		pointer;
 	wimp_window_state	state;
-	int			row, i;
+	int			row;
 
 	/* Terminate the drag and end the autoscroll. */
 
@@ -2270,62 +2834,7 @@ static void bookmark_terminate_line_drag(wimp_dragged *drag, void *data)
 	/* If there is a move to do, carry it out. */
 
 	if (row != bm->drag_row && row != bm->drag_row + 1) {
-		node = bm->redraw[bm->drag_row].node;
-
-		if (row < bm->lines)
-			target = bm->redraw[row].node;
-		else
-			target = NULL;
-
-		/* If the node was a parent, then drop all the children down a level
-		 * to compensate for its deletion.
-		 */
-
-		n = node->next;
-		i = node->count;
-
-		while (n != NULL && i > 0) {
-			n->level--;
-			n = n->next;
-			i--;
-		}
-
-		/* Unlink the node. */
-
-		if (bm->root == node) {
-			bm->root = node->next;
-		} else {
-			for (n = bm->root; n != NULL && n->next != node; n = n->next);
-			if (n != NULL)
-				n->next = node->next;
-		}
-
-		/* Link the node back in its new home. */
-
-		if (bm->root == target) {
-			node->next = bm->root;
-			bm->root = node;
-		} else {
-			for (n = bm->root; n != NULL && n->next != target; n = n->next);
-			if (n != NULL) {
-				node->next = n->next;
-				n->next = node;
-			}
-		}
-
-		/* Fix the indentation.  At the end of the list, take the previous node's
-		 * level, otherwise take the following node's.
-		 */
-
-		if (target == NULL)
-			node->level = n->level;
-		else
-			node->level = target->level;
-
-		bookmark_rebuild_data(bm);
-		bookmark_set_unsaved_state(bm, TRUE);
-
-		bookmark_force_window_redraw(bm, (row < bm->drag_row) ? row-1 : bm->drag_row-1, -1);
+		bookmark_move_edit_row(bm, bookmark_index_find_row(bm, bm->drag_row), bookmark_index_find_row(bm, row));
 	} else {
 		bookmark_force_window_redraw(bm, bm->drag_row, bm->drag_row);
 	}
@@ -2365,7 +2874,7 @@ static void bookmark_toolbar_click_handler(wimp_pointer *pointer)
 	case BOOKMARK_TB_PROMOTEG:
 	case BOOKMARK_TB_DEMOTE:
 	case BOOKMARK_TB_DEMOTEG:
-		bookmark_change_edit_row_indentation(bm, bm->redraw[bm->caret_row].node, (int) pointer->i);
+		bookmark_change_edit_row_indentation(bm, bookmark_index_find_row(bm, bm->caret_row), (int) pointer->i);
 		break;
 	case BOOKMARK_TB_EXPAND:
 		bookmark_tree_node_expansion(bm, TRUE);
@@ -2458,8 +2967,8 @@ static void bookmark_menu_prepare(wimp_w w, wimp_menu *menu, wimp_pointer *point
 	 */
 
 	if (row != -1) {
-		node = bm->redraw[row].node;
-		for (parent = bm->root; parent != NULL && parent->next != node; parent = parent->next);
+		node = bookmark_index_find_row(bm, row);
+		parent = bookmark_index_find_previous(bm, node);
 
 		bm->menu_row = row;
 		bookmark_force_window_redraw(bm, bm->menu_row, bm->menu_row);
@@ -2566,32 +3075,32 @@ static void bookmark_menu_selection(wimp_w w, wimp_menu *menu, wimp_selection *s
 	case BOOKMARK_MENU_LEVEL:
 		switch (selection->items[1]) {
 		case BOOKMARK_MENU_LEVEL_PROMOTE:
-			bookmark_change_edit_row_indentation(bm, bm->redraw[bm->menu_row].node, BOOKMARK_TB_PROMOTE);
+			bookmark_change_edit_row_indentation(bm, bookmark_index_find_row(bm, bm->menu_row), BOOKMARK_TB_PROMOTE);
 			break;
 		case BOOKMARK_MENU_LEVEL_PROMOTEG:
-			bookmark_change_edit_row_indentation(bm, bm->redraw[bm->menu_row].node, BOOKMARK_TB_PROMOTEG);
+			bookmark_change_edit_row_indentation(bm, bookmark_index_find_row(bm, bm->menu_row), BOOKMARK_TB_PROMOTEG);
 			break;
 		case BOOKMARK_MENU_LEVEL_DEMOTE:
-			bookmark_change_edit_row_indentation(bm, bm->redraw[bm->menu_row].node, BOOKMARK_TB_DEMOTE);
+			bookmark_change_edit_row_indentation(bm, bookmark_index_find_row(bm, bm->menu_row), BOOKMARK_TB_DEMOTE);
 			break;
 		case BOOKMARK_MENU_LEVEL_DEMOTEG:
-			bookmark_change_edit_row_indentation(bm, bm->redraw[bm->menu_row].node, BOOKMARK_TB_DEMOTEG);
+			bookmark_change_edit_row_indentation(bm, bookmark_index_find_row(bm, bm->menu_row), BOOKMARK_TB_DEMOTEG);
 			break;
 		}
 		break;
 	case BOOKMARK_MENU_INSERT:
 		switch (selection->items[1]) {
 		case BOOKMARK_MENU_INSERT_ABOVE:
-			if (!bookmark_insert_edit_row(bm, bm->redraw[bm->menu_row].node, BOOKMARK_ABOVE))
+			if (!bookmark_insert_edit_row(bm, bookmark_index_find_row(bm, bm->menu_row), BOOKMARK_ABOVE))
 				bm->menu_row++;
 			break;
 		case BOOKMARK_MENU_INSERT_BELOW:
-			bookmark_insert_edit_row(bm, bm->redraw[bm->menu_row].node, BOOKMARK_BELOW);
+			bookmark_insert_edit_row(bm, bookmark_index_find_row(bm, bm->menu_row), BOOKMARK_BELOW);
 			break;
 		}
 		break;
 	case BOOKMARK_MENU_DELETE:
-		bookmark_delete_edit_row(bm, bm->redraw[bm->menu_row].node);
+		bookmark_delete_edit_row(bm, bookmark_index_find_row(bm, bm->menu_row));
 	}
 }
 
@@ -2774,11 +3283,11 @@ bookmark_block *bookmarks_load_file(char *filename)
 {
 	FILE			*in;
 	bookmark_block		*block;
-	bookmark_node		*current, *new;
-	int			bookmarks = 0, unknown_data = 0, unknown_format = 0, version = 100;
-	char			section[BOOKMARK_FILE_LINE_LEN], token[BOOKMARK_FILE_LINE_LEN], value[BOOKMARK_FILE_LINE_LEN];
+	char			*buffer, line[BOOKMARK_LINE_NUMBER_LEN];
+	long			length;
+	int			bad_line;
+	osbool			known_format;
 	bits			load, exec;
-	enum config_read_status	result;
 
 
 	block = bookmark_create_block();
@@ -2795,7 +3304,7 @@ bookmark_block *bookmarks_load_file(char *filename)
 	block->datestamp[3] = (exec & 0xff000000) >> 24;
 	block->datestamp[4] = load & 0xff;
 
-	in = fopen(filename, "r");
+	in = fopen(filename, "rb");
 
 	if (in == NULL) {
 		// \TODO -- Add an error report here.
@@ -2808,76 +3317,44 @@ bookmark_block *bookmarks_load_file(char *filename)
 	string_copy(block->filename, filename, MAX_BOOKMARK_FILENAME);
 	bookmark_update_window_title(block);
 
-	/* Read the nodes into a linear linked list, ignoring for the time
-	 * being any levels.
-	 */
-
-	current = NULL;
+	/* Read the whole file into a buffer, with room for a terminator. */
 
-	while ((result = config_read_token_pair(in, token, value, section)) != sf_CONFIG_READ_EOF) {
-		if (result == sf_CONFIG_READ_NEW_SECTION)
-			bookmarks = (string_nocase_strcmp(section, "Bookmarks") == 0);
+	buffer = NULL;
 
-		if (bookmarks) {
-			if (string_nocase_strcmp(token, "Name") == 0) {
-				string_copy(block->name, value, MAX_BOOKMARK_BLOCK_NAME);
-			} else if (string_nocase_strcmp(token, "@") == 0) {
-				new = (bookmark_node *) malloc(sizeof(bookmark_node));
+	if (fseek(in, 0, SEEK_END) == 0 && (length = ftell(in)) >= 0 && fseek(in, 0, SEEK_SET) == 0)
+		buffer = malloc(length + 1);
 
-				if (new != NULL) {
-					string_copy(new->title, value, MAX_BOOKMARK_LEN);
-
-					new->page = 0;
-					new->yoffset = -1;
-					new->expanded = TRUE;
-					new->level = 1;
-					new->count = 0;
+	if (buffer != NULL && fread(buffer, 1, length, in) != (size_t) length) {
+		free(buffer);
+		buffer = NULL;
+	}
 
-					new->next = NULL;
+	fclose(in);
 
-					if (current == NULL)
-						block->root = new;
-					else
-						current->next = new;
+	if (buffer == NULL) {
+		hourglass_off();
+		// \TODO -- Add an error report here.
+		bookmark_delete_block(block);
+		return NULL;
+	}
 
-					current = new;
-				}
+	known_format = bookmark_parse_file(block, buffer, length, &bad_line);
 
-			} else if (string_nocase_strcmp(token, "Page") == 0) {
-				if (current != NULL)
-					current->page = atoi(value);
-			} else if (string_nocase_strcmp(token, "YOffset") == 0) {
-				if (current != NULL && version > 100) /* Version 1.00 files probably have buggy YOffets that we can't use anyway. */
-					current->yoffset = atoi(value);
-			} else if (string_nocase_strcmp(token, "Level") == 0) {
-				if (current != NULL)
-					current->level = atoi(value);
-			} else if (string_nocase_strcmp(token, "Expanded") == 0) {
-				if (current != NULL)
-					current->expanded = config_read_opt_string(value);
-			} else {
-				unknown_data = 1;
-			}
-		} else {
-			if (string_nocase_strcmp(token, "Format") == 0) {
-				version = string_convert_version_number(value);
-				if (version != 100)
-					unknown_format = 1;
-			} else {
-				unknown_data = 1;
-			}
-		}
-	}
+	free(buffer);
 
 	hourglass_off();
 
-	fclose (in);
+	if (bad_line > 0) {
+		string_printf(line, BOOKMARK_LINE_NUMBER_LEN, "%d", bad_line);
+		error_msgs_param_report_info("UnknownFileData", line, NULL, NULL, NULL);
+	}
 
-	if (unknown_data)
-		error_msgs_report_info ("UnknownFileData");
+	if (!known_format)
+		error_msgs_report_info("UnknownFileFormat");
 
-	if (unknown_format)
-		error_msgs_report_info ("UnknownFileFormat");
+#ifdef HOSTED
+	bookmarks_hosted_damaged = (bad_line > 0 || !known_format) ? TRUE : FALSE;
+#endif
 
 	bookmark_rebuild_data(block);
 	bookmark_open_window(block);
@@ -2887,144 +3364,1675 @@ bookmark_block *bookmarks_load_file(char *filename)
 
 
 /**
- * Recalculate the details of a bookmark block.
+ * Recalculate the details of a bookmark block from scratch, following a
+ * change to the whole of its outline.
  *
  * \param *bm		Pointer to the block to recalculate.
  */
 
 static void bookmark_rebuild_data(bookmark_block *bm)
 {
-	bookmark_node		*node, *n, *edit_node, *edit_parent;;
-	int			count, i, edit_col;
-	wimp_caret		caret;
-
 	if (bm == NULL)
 		return;
 
-	/* If there is an edit icon in the window, find its node and position
-	 * before deleting it.
-	 */
+	bookmark_hold_edit_icon(bm);
 
-	if (bm == bookmarks_edit) {
-		if (xwimp_get_caret_position(&caret) == NULL) {
-			edit_node = bm->redraw[bm->caret_row].node;
-			edit_col = bm->caret_col;
-		} else {
-			edit_node = NULL;
-			edit_col = -1;
+	bookmark_index_build(bm);
+
+	bookmark_set_window_extent(bm);
+	bookmark_toolbar_set_expansion_icons(bm, NULL, NULL);
+
+	bookmark_restore_edit_icon(bm);
+}
+
+
+/**
+ * Output PDFMark data related to the associated bookmarks parameters file.
+ *
+ * \param  *output		The output stream to write to.
+ * \param  *params		The parameter block to use.
+ */
+
+void bookmarks_write_pdfmark(pdfmark_output *output, bookmark_params *params)
+{
+	bookmark_node		*node;
+	int			count, position, *counts;
+
+	params->bookmarks = bookmark_find_block(params->bookmarks);
+
+	if (output == NULL || !bookmark_data_available(params))
+		return;
+
+	counts = bookmark_count_all_descendants(params->bookmarks);
+
+	for (node = params->bookmarks->root, position = 0; node != NULL; node = node->next, position++) {
+		if (*(node->title) != '\0' && node->page > 0) {
+			pdfmark_output_text(output, "[");
+
+			if (counts != NULL)
+				count = counts[position];
+			else
+				count = bookmark_index_count_descendants(params->bookmarks, node);
+
+			if (count > 0) {
+				pdfmark_output_text(output, " /Count ");
+				pdfmark_output_number(output, (node->expanded) ? count : -count);
+			}
+
+			pdfmark_output_text(output, " /Page ");
+			pdfmark_output_number(output, node->page);
+
+			if (node->yoffset >= 0)
+				pdfmark_output_printf(output, " /View [/XYZ 0 %.4f null]", ((double) node->yoffset / 1000));
+
+			pdfmark_output_text(output, " /Title ");
+			pdfmark_output_string(output, node->title);
+			pdfmark_output_text(output, " /OUT pdfmark\n");
 		}
-		bookmark_remove_edit_icon();
-	} else {
-		edit_node = NULL;
-		edit_col = -1;
 	}
 
-	/* Find the number of entries in the block list, and reallocate the
-	 * redraw array if it has changed.
-	 */
+	if (counts != NULL)
+		free(counts);
+}
 
-	count = 0;
-	for (node = bm->root; node != NULL; node = node->next)
-		count++;
 
-	if (count != bm->nodes) {
-		if (bm->redraw != NULL)
-			free(bm->redraw);
+/**
+ * Count the descendants of every node in a block in a single pass, keeping
+ * the nodes whose descendants are still being counted on a stack.
+ *
+ * \param  *bm			The bookmark block to count.
+ * \return			An array of counts in outline order, to be freed
+ *				after use; NULL on failure.
+ */
+
+static int *bookmark_count_all_descendants(bookmark_block *bm)
+{
+	bookmark_node		*node;
+	int			*counts, *stack, *levels, nodes, position, depth = 0;
+
+	nodes = bookmark_index_size(bm->index);
+
+	counts = malloc(3 * ((nodes > 0) ? nodes : 1) * sizeof(int));
+	if (counts == NULL)
+		return NULL;
+
+	stack = counts + nodes;
+	levels = stack + nodes;
+
+	/* Each node closes any open nodes at the same level or deeper. */
+
+	for (node = bm->root, position = 0; node != NULL && position < nodes; node = node->next, position++) {
+		while (depth > 0 && levels[depth - 1] >= node->level) {
+			depth--;
+			counts[stack[depth]] = position - stack[depth] - 1;
+		}
+
+		stack[depth] = position;
+		levels[depth] = node->level;
+		depth++;
+	}
 
-		bm->redraw = (bookmark_redraw *) malloc(count * sizeof(bookmark_redraw));
-		bm->nodes = count;
+	while (depth > 0) {
+		depth--;
+		counts[stack[depth]] = position - stack[depth] - 1;
 	}
 
-	/* Scan through the list, building up the tree blocks. */
+	return counts;
+}
 
-	for (node = bm->root; node != NULL; node = node->next) {
-		count = 0;
 
-		for (n = node->next; (n != NULL) && (n->level > node->level); n = n->next)
-			count++;
+/* ****************************************************************************
+ * Bookmark File Parser
+ * ****************************************************************************/
+
+/**
+ * Parse the contents of a bookmark file into an empty bookmark block.  The
+ * file is tokenised in place, and the nodes for its entries are allocated
+ * together from the block's arena.
+ *
+ * \param  *bm			The bookmark block to take the data.
+ * \param  *buffer		The contents of the file, with room for a
+ *				terminator after the last byte.
+ * \param  length		The length of the file, in bytes.
+ * \param  *bad_line		Pointer to a variable to take the number of the
+ *				first line which could not be used, or 0.
+ * \return			TRUE if the format of the file was known; else
+ *				FALSE.
+ */
+
+static osbool bookmark_parse_file(bookmark_block *bm, char *buffer, size_t length, int *bad_line)
+{
+	bookmark_node		*current = NULL, *nodes = NULL, *node;
+	char			*line, *next, *end, *limit, *key, *value, *separator;
+	int			line_number = 0, available = 0, version = 100, number;
+	osbool			bookmarks = FALSE, known_format = TRUE, valid;
+	enum bookmark_file_key	found;
+
+	*bad_line = 0;
+
+	limit = buffer + length;
+	*limit = '\0';
+
+	/* Count the entries, so that all of their nodes can be allocated in
+	 * one go.  Any which aren't used are passed on for re-use.
+	 */
+
+	for (line = buffer; line < limit; line = next) {
+		next = memchr(line, '\n', limit - line);
+		next = (next != NULL) ? next + 1 : limit;
+
+		while (line < next && (*line == ' ' || *line == '\t'))
+			line++;
 
-		node->count = count;
+		if (line < next && *line == '@')
+			available++;
 	}
 
-	edit_parent = NULL;
+	if (available > 0)
+		nodes = (bookmark_node *) bookmark_arena_allocate(bm, available * sizeof(bookmark_node));
+
+	if (nodes == NULL)
+		available = 0;
+
+	/* Tokenise each line in turn, terminating the key and the value in
+	 * place, and dispatch on the key.
+	 */
+
+	for (line = buffer; line < limit; line = next) {
+		line_number++;
+
+		end = memchr(line, '\n', limit - line);
+		if (end == NULL)
+			end = limit;
+
+		next = (end < limit) ? end + 1 : limit;
 
-	if (bm->redraw != NULL) {
-		count = 0;
+		line = bookmark_parse_trim(line, end);
 
-		for (node = bm->root; node != NULL; node = node->next) {
-			bm->redraw[count].node = node;
-			bm->redraw[count].selected = 0;
+		if (*line == '\0' || *line == '#')
+			continue;
+
+		valid = TRUE;
+
+		if (*line == '[') {
+			separator = strchr(line, ']');
+
+			if (separator != NULL) {
+				*separator = '\0';
+				bookmarks = (string_nocase_strcmp(line + 1, "Bookmarks") == 0);
+			} else {
+				valid = FALSE;
+			}
+		} else if ((separator = strchr(line, ':')) == NULL) {
+			valid = FALSE;
+		} else {
+			key = bookmark_parse_trim(line, separator);
+			value = bookmark_parse_trim(separator + 1, separator + 1 + strlen(separator + 1));
 
-			/* Skip past any contracted lines and identify if the
-			 * edited node is one of them.
+			/* The format belongs outside the Bookmarks section, and
+			 * everything else inside it.
 			 */
 
-			if (!node->expanded) {
-				n = node;
+			found = bookmark_parse_key(key);
+			if (bookmarks != (found != BOOKMARK_FILE_KEY_FORMAT))
+				found = BOOKMARK_FILE_KEY_NONE;
+
+			switch (found) {
+			case BOOKMARK_FILE_KEY_NAME:
+				string_copy(bm->name, value, MAX_BOOKMARK_BLOCK_NAME);
+				break;
 
-				for (i = node->count; node != NULL && i > 0; node = node->next) {
-					i--;
-					if (node->next == edit_node)
-						edit_parent = n;
+			case BOOKMARK_FILE_KEY_TITLE:
+				if (available > 0) {
+					available--;
+					node = nodes++;
+				} else {
+					node = bookmark_arena_new_node(bm);
 				}
-			}
 
-			count++;
-		}
+				if (node == NULL)
+					break;
 
-		bm->lines = count;
-	}
+				node->title = bookmark_arena_intern_title(bm, value);
+				if (node->title == NULL)
+					node->title = bookmarks_empty_title;
 
-	bookmark_set_window_extent(bm);
-	bookmark_toolbar_set_expansion_icons(bm, NULL, NULL);
+				node->page = 0;
+				node->yoffset = -1;
+				node->expanded = TRUE;
+				node->level = 1;
+
+				node->next = NULL;
+
+				if (current == NULL)
+					bm->root = node;
+				else
+					current->next = node;
+
+				current = node;
+				break;
+
+			case BOOKMARK_FILE_KEY_PAGE:
+				if (current != NULL && bookmark_parse_number(value, &number))
+					current->page = number;
+				else if (current != NULL)
+					valid = FALSE;
+				break;
+
+			case BOOKMARK_FILE_KEY_YOFFSET:
+				/* Version 1.00 files probably have buggy YOffets that we can't use anyway. */
+				if (current != NULL && version > 100 && bookmark_parse_number(value, &number))
+					current->yoffset = number;
+				else if (current != NULL && version > 100)
+					valid = FALSE;
+				break;
 
-	/* If there was an edit icon, find its new home and restore it. */
+			case BOOKMARK_FILE_KEY_LEVEL:
+				if (current != NULL && bookmark_parse_number(value, &number) && number >= 1)
+					current->level = number;
+				else if (current != NULL)
+					valid = FALSE;
+				break;
 
-	if (edit_node != NULL) {
-		if (edit_parent != NULL)
-			edit_node = edit_parent;
+			case BOOKMARK_FILE_KEY_EXPANDED:
+				if (current != NULL)
+					current->expanded = config_read_opt_string(value);
+				break;
 
-		for (i = 0; i < bm->lines && bm->redraw[i].node != edit_node; i++);
+			case BOOKMARK_FILE_KEY_FORMAT:
+				version = string_convert_version_number(value);
+				if (version != 100)
+					known_format = FALSE;
+				break;
 
-		if (i < bm->lines) {
-			bookmark_place_edit_icon(bm, i, edit_col);
-			wimp_set_caret_position(bm->window, bm->edit_icon, caret.pos.x,
-			(-(i+1) * BOOKMARK_LINE_HEIGHT + BOOKMARK_LINE_OFFSET + 4 - BOOKMARK_TOOLBAR_HEIGHT), -1, -1);
+			default:
+				valid = FALSE;
+				break;
+			}
 		}
+
+		if (!valid && *bad_line == 0)
+			*bad_line = line_number;
 	}
+
+	while (available-- > 0)
+		bookmark_arena_free_node(bm, nodes++);
+
+	return known_format;
 }
 
 
 /**
- * Output PDFMark data related to the associated bookmarks parameters file.
+ * Look up a key from a bookmark file.
  *
- * \param  *pdfmark_file	The file to write to.
- * \param  *params		The parameter block to use.
+ * \param  *key			The key to look up.
+ * \return			The key's identity, or BOOKMARK_FILE_KEY_NONE.
  */
 
-void bookmarks_write_pdfmark_out_file(FILE *pdfmark_file, bookmark_params *params)
+static enum bookmark_file_key bookmark_parse_key(char *key)
 {
-	bookmark_node		*node;
-	char			buffer[MAX_BOOKMARK_LEN * 4];
+	struct bookmark_file_key_slot	*slot;
+	size_t				length;
 
-	params->bookmarks = bookmark_find_block(params->bookmarks);
+	length = strlen(key);
+	if (length == 0)
+		return BOOKMARK_FILE_KEY_NONE;
 
-	if (pdfmark_file != NULL && bookmark_data_available(params))
-		for (node = params->bookmarks->root; node != NULL; node = node->next) {
-			if (strlen(node->title) > 0 && node->page > 0) {
-				fprintf(pdfmark_file, "[");
+	slot = &(bookmark_file_keys[FILE_KEY_HASH(length, tolower((unsigned char) key[0]), tolower((unsigned char) key[length - 1]))]);
 
-				if (node->count > 0)
-					fprintf(pdfmark_file, " /Count %d", (node->expanded) ? node->count : -node->count);
+	if (slot->name == NULL || string_nocase_strcmp(slot->name, key) != 0)
+		return BOOKMARK_FILE_KEY_NONE;
 
-				fprintf(pdfmark_file, " /Page %d", node->page);
+	return slot->key;
+}
 
-				if (node->yoffset >= 0)
-					fprintf(pdfmark_file, " /View [/XYZ 0 %.4f null]", ((double) node->yoffset / 1000));
 
-				fprintf(pdfmark_file, " /Title (%s) /OUT pdfmark\n",
-						convert_to_pdf_doc_encoding(buffer, node->title, MAX_BOOKMARK_LEN * 4));
-			}
-		}
+/**
+ * Trim the whitespace from both ends of a piece of text in a buffer,
+ * terminating it in place.
+ *
+ * \param  *start		The start of the text.
+ * \param  *end			The end of the text, which will be overwritten
+ *				by the terminator.
+ * \return			The start of the trimmed text.
+ */
+
+static char *bookmark_parse_trim(char *start, char *end)
+{
+	while (start < end && isspace((unsigned char) *start))
+		start++;
+
+	while (end > start && isspace((unsigned char) *(end - 1)))
+		end--;
+
+	*end = '\0';
+
+	return start;
+}
+
+
+/**
+ * Read a decimal number from a bookmark file.
+ *
+ * \param  *text		The text to read.
+ * \param  *value		Pointer to a variable to take the number.
+ * \return			TRUE if the text was a valid number; else FALSE.
+ */
+
+static osbool bookmark_parse_number(char *text, int *value)
+{
+	char		*end;
+	long		number;
+
+	number = strtol(text, &end, 10);
+
+	if (end == text || *end != '\0' || number < INT_MIN || number > INT_MAX)
+		return FALSE;
+
+	*value = (int) number;
+
+	return TRUE;
+}
+
+
+/* ****************************************************************************
+ * Bookmark Outline Index
+ * ****************************************************************************/
+
+/**
+ * Start an edit to a bookmark window, holding on to the edit icon and noting
+ * the rows which might change.  The edit must be ended with
+ * bookmark_end_edit().
+ *
+ * \param *bm		The block being edited.
+ * \param row		The first row which might change.
+ * \param *after	The first node after those which might change, or
+ *			NULL to run to the end of the outline.
+ */
+
+static void bookmark_start_edit(bookmark_block *bm, int row, bookmark_node *after)
+{
+	bookmark_hold_edit_icon(bm);
+
+	bookmarks_edit_first_row = (row < 0) ? 0 : row;
+	bookmarks_edit_lines = bm->lines;
+	bookmarks_edit_after = after;
+	bookmarks_edit_end_row = (after == NULL) ? bm->lines : bookmark_index_find_node_row(after, NULL);
+}
+
+
+/**
+ * End an edit to a bookmark window, updating the window to match.  Rows
+ * below those which have changed are moved in the window, rather than being
+ * redrawn.
+ *
+ * \param *bm		The block which has been edited.
+ */
+
+static void bookmark_end_edit(bookmark_block *bm)
+{
+	int			end_row, y0, y1;
+	wimp_window_info	info;
+
+	end_row = (bookmarks_edit_after == NULL) ? bm->lines : bookmark_index_find_node_row(bookmarks_edit_after, NULL);
+
+	/* Grow the window before moving rows down, or shrink it after moving
+	 * them up, so that they always stay within the work area.
+	 */
+
+	if (bm->lines > bookmarks_edit_lines)
+		bookmark_set_window_extent(bm);
+
+	info.w = bm->window;
+	if (bm->window != NULL && xwimp_get_window_info_header_only(&info) == NULL) {
+		if (end_row != bookmarks_edit_end_row && bookmarks_edit_end_row < bookmarks_edit_lines) {
+			y0 = LINE_BASE(bookmarks_edit_lines - 1);
+			y1 = LINE_BASE(bookmarks_edit_end_row - 1);
+
+			wimp_block_copy(bm->window, info.extent.x0, y0, info.extent.x1, y1, info.extent.x0,
+					y0 + (bookmarks_edit_end_row - end_row) * BOOKMARK_LINE_HEIGHT);
+		}
+
+		if (end_row > bookmarks_edit_first_row)
+			bookmark_force_window_redraw(bm, bookmarks_edit_first_row, end_row - 1);
+
+		if (bm->lines < bookmarks_edit_lines)
+			bookmark_force_window_redraw(bm, bm->lines, bookmarks_edit_lines - 1);
+	}
+
+	if (bm->lines <= bookmarks_edit_lines)
+		bookmark_set_window_extent(bm);
+
+	bookmark_toolbar_set_expansion_icons(bm, NULL, NULL);
+
+	bookmark_restore_edit_icon(bm);
+}
+
+
+/**
+ * If a bookmark window holds the edit icon, remove it and remember the node
+ * and column that it was in, so that it can be put back after an edit.
+ *
+ * \param *bm		The block being edited.
+ */
+
+static void bookmark_hold_edit_icon(bookmark_block *bm)
+{
+	bookmarks_edit_node = NULL;
+	bookmarks_edit_col = -1;
+
+	if (bm != bookmarks_edit)
+		return;
+
+	if (xwimp_get_caret_position(&bookmarks_edit_caret) == NULL) {
+		bookmarks_edit_node = bookmark_index_find_row(bm, bm->caret_row);
+		bookmarks_edit_col = bm->caret_col;
+	}
+
+	bookmark_remove_edit_icon();
+}
+
+
+/**
+ * Put the edit icon back into a bookmark window after an edit, in the row
+ * now holding the node that it was in; if that node is hidden, the row of
+ * the contracted node which hides it is used instead.
+ *
+ * \param *bm		The block which has been edited.
+ */
+
+static void bookmark_restore_edit_icon(bookmark_block *bm)
+{
+	osbool			visible;
+	int			row;
+
+	if (bookmarks_edit_node == NULL || bookmarks_edit_node->size == 0)
+		return;
+
+	row = bookmark_index_find_node_row(bookmarks_edit_node, &visible);
+	if (!visible)
+		row--;
+
+	bookmarks_edit_node = NULL;
+
+	if (row >= 0 && row < bm->lines) {
+		bookmark_place_edit_icon(bm, row, bookmarks_edit_col);
+		wimp_set_caret_position(bm->window, bm->edit_icon, bookmarks_edit_caret.pos.x,
+				(-(row+1) * BOOKMARK_LINE_HEIGHT + BOOKMARK_LINE_OFFSET + 4 - BOOKMARK_TOOLBAR_HEIGHT), -1, -1);
+	}
+}
+
+
+/**
+ * Build the outline index for a block from its list of nodes.
+ *
+ * \param *bm		The block to index.
+ */
+
+static void bookmark_index_build(bookmark_block *bm)
+{
+	bookmark_node		*node, *last, *child;
+
+	/* Add the nodes down the right-hand spine of the treap, which is
+	 * followed back up from the last node added.
+	 */
+
+	bm->index = NULL;
+	last = NULL;
+
+	for (node = bm->root; node != NULL; node = node->next) {
+		node->priority = bookmark_index_random();
+		node->right = NULL;
+		node->touched = NULL;
+		node->hidden = 0;
+		node->hidden_add = 0;
+
+		child = NULL;
+
+		while (last != NULL && last->priority < node->priority) {
+			child = last;
+			last = last->up;
+		}
+
+		node->left = child;
+		if (child != NULL)
+			child->up = node;
+
+		node->up = last;
+		if (last != NULL)
+			last->right = node;
+		else
+			bm->index = node;
+
+		last = node;
+	}
+
+	bookmark_index_recalculate(bm->index);
+
+	/* Hide the contents of the contracted nodes, and count the nodes
+	 * which the toolbar can expand or contract.
+	 */
+
+	bm->expandable = 0;
+	bm->contractable = 0;
+
+	for (node = bm->root; node != NULL; node = node->next) {
+		if (!node->expanded)
+			bookmark_index_hide_contents(bm, node, 1);
+
+		bookmark_index_count_node(bm, node, 1);
+	}
+
+	bm->nodes = bookmark_index_size(bm->index);
+	bm->lines = bookmark_index_visible(bm->index, 0);
+}
+
+
+/**
+ * Start an edit to the nodes in a block's list between two nodes.  Nodes
+ * may be added, removed or have their levels and expansion changed between
+ * the two, but the two must themselves be left alone.  The edit must be
+ * ended with bookmark_index_end_edit().
+ *
+ * Any contracted node whose contents might change has them shown for the
+ * duration of the edit: these are the contracted nodes being edited, and
+ * those containing the node before them.
+ *
+ * \param *bm		The block being edited.
+ * \param *before	The node before those being edited, or NULL for
+ *			the start of the list.
+ * \param *after	The node after those being edited, or NULL for the
+ *			end of the list.
+ */
+
+static void bookmark_index_start_edit(bookmark_block *bm, bookmark_node *before, bookmark_node *after)
+{
+	bookmark_node		*node;
+
+	bookmarks_edit_touched = NULL;
+
+	if (before != NULL)
+		bookmark_index_count_node(bm, before, -1);
+
+	for (node = (before != NULL) ? before->next : bm->root; node != NULL && node != after; node = node->next) {
+		bookmark_index_count_node(bm, node, -1);
+		bookmark_index_touch_node(bm, node, TRUE);
+	}
+
+	for (node = before; node != NULL; node = bookmark_index_find_parent(bm, node))
+		bookmark_index_touch_node(bm, node, TRUE);
+}
+
+
+/**
+ * End an edit to the nodes in a block's list between two nodes, which must
+ * be the same as those passed to bookmark_index_start_edit().
+ *
+ * \param *bm		The block being edited.
+ * \param *before	The node before those being edited, or NULL for
+ *			the start of the list.
+ * \param *after	The node after those being edited, or NULL for the
+ *			end of the list.
+ */
+
+static void bookmark_index_end_edit(bookmark_block *bm, bookmark_node *before, bookmark_node *after)
+{
+	bookmark_node		*node, *first, *last;
+	int			count;
+
+	first = (before != NULL) ? before->next : bm->root;
+
+	/* Bring the index up to date with any changes to the levels. */
+
+	count = 0;
+
+	for (node = first; node != NULL && node != after; node = node->next)
+		count++;
+
+	if (count > 0)
+		bookmark_index_refresh(bm, bookmark_index_find_position(first), count);
+
+	/* Count the nodes which the toolbar can act on, and pick up any
+	 * nodes which were contracted during the edit.
+	 */
+
+	if (before != NULL)
+		bookmark_index_count_node(bm, before, 1);
+
+	for (node = first; node != NULL && node != after; node = node->next) {
+		bookmark_index_count_node(bm, node, 1);
+		bookmark_index_touch_node(bm, node, FALSE);
+	}
+
+	/* Hide the new contents of the contracted nodes. */
+
+	node = bookmarks_edit_touched;
+
+	while (node != NULL) {
+		last = node;
+		node = (last->touched == last) ? NULL : last->touched;
+		last->touched = NULL;
+
+		if (!last->expanded && last->size > 0)
+			bookmark_index_hide_contents(bm, last, 1);
+	}
+
+	bookmarks_edit_touched = NULL;
+
+	bm->nodes = bookmark_index_size(bm->index);
+	bm->lines = bookmark_index_visible(bm->index, 0);
+}
+
+
+/**
+ * Add a contracted node to the list of those whose contents are being
+ * edited, if it is not already there.
+ *
+ * \param *bm		The block being edited.
+ * \param *node		The node to add.
+ * \param show		TRUE to show the node's contents for the edit;
+ *			FALSE if they are already showing.
+ */
+
+static void bookmark_index_touch_node(bookmark_block *bm, bookmark_node *node, osbool show)
+{
+	if (node->expanded || node->touched != NULL)
+		return;
+
+	if (show)
+		bookmark_index_hide_contents(bm, node, -1);
+
+	/* The last node in the list points to itself. */
+
+	node->touched = (bookmarks_edit_touched != NULL) ? bookmarks_edit_touched : node;
+	bookmarks_edit_touched = node;
+}
+
+
+/**
+ * Add to or subtract from a block's counts of the nodes which can be
+ * expanded or contracted from the toolbar.
+ *
+ * \param *bm		The block to update.
+ * \param *node		The node to count.
+ * \param change	The change to make to the count.
+ */
+
+static void bookmark_index_count_node(bookmark_block *bm, bookmark_node *node, int change)
+{
+	if (!bookmark_node_has_children(node))
+		return;
+
+	if (node->expanded)
+		bm->contractable += change;
+	else
+		bm->expandable += change;
+}
+
+
+/**
+ * Change the number of contracted nodes hiding each of the descendants of a
+ * node.
+ *
+ * \param *bm		The block holding the node.
+ * \param *node		The node whose descendants are to be changed.
+ * \param change	The change to make.
+ */
+
+static void bookmark_index_hide_contents(bookmark_block *bm, bookmark_node *node, int change)
+{
+	bookmark_node		*before, *contents, *after;
+	int			position, count;
+
+	position = bookmark_index_find_position(node) + 1;
+	count = bookmark_index_find_end(bm, node) - position;
+
+	if (count <= 0)
+		return;
+
+	bookmark_index_split(bm->index, position, &before, &contents);
+	bookmark_index_split(contents, count, &contents, &after);
+
+	bookmark_index_hide(contents, change);
+
+	bm->index = bookmark_index_join(bookmark_index_join(before, contents), after);
+}
+
+
+/**
+ * Recalculate the details of a range of nodes in a block's index, following
+ * changes to their levels.
+ *
+ * \param *bm		The block holding the nodes.
+ * \param position	The position of the first node.
+ * \param count		The number of nodes.
+ */
+
+static void bookmark_index_refresh(bookmark_block *bm, int position, int count)
+{
+	bookmark_node		*before, *nodes, *after;
+
+	bookmark_index_split(bm->index, position, &before, &nodes);
+	bookmark_index_split(nodes, count, &nodes, &after);
+
+	bookmark_index_recalculate(nodes);
+
+	bm->index = bookmark_index_join(bookmark_index_join(before, nodes), after);
+}
+
+
+/**
+ * Add a node to a block's index, before another node.  The node must already
+ * have been linked into the list.
+ *
+ * \param *bm		The block to add the node to.
+ * \param *node		The node to add.
+ * \param *before	The node to add it before, or NULL to add it at
+ *			the end.
+ */
+
+static void bookmark_index_insert(bookmark_block *bm, bookmark_node *node, bookmark_node *before)
+{
+	bookmark_node		*head, *tail;
+
+	node->left = NULL;
+	node->right = NULL;
+	node->up = NULL;
+	node->touched = NULL;
+	node->priority = bookmark_index_random();
+	node->hidden = 0;
+	node->hidden_add = 0;
+
+	bookmark_index_update(node);
+
+	if (before != NULL)
+		bookmark_index_split(bm->index, bookmark_index_find_position(before), &head, &tail);
+	else
+		bookmark_index_split(bm->index, bookmark_index_size(bm->index), &head, &tail);
+
+	bm->index = bookmark_index_join(bookmark_index_join(head, node), tail);
+}
+
+
+/**
+ * Remove a node from a block's index.  The node is left with a size of
+ * zero, to show that it is no longer indexed.
+ *
+ * \param *bm		The block to remove the node from.
+ * \param *node		The node to remove.
+ */
+
+static void bookmark_index_remove(bookmark_block *bm, bookmark_node *node)
+{
+	bookmark_node		*head, *middle, *tail;
+
+	bookmark_index_split(bm->index, bookmark_index_find_position(node), &head, &middle);
+	bookmark_index_split(middle, 1, &middle, &tail);
+
+	bm->index = bookmark_index_join(head, tail);
+
+	node->left = NULL;
+	node->right = NULL;
+	node->up = NULL;
+	node->size = 0;
+}
+
+
+/**
+ * Find the position of a node in its block's list.
+ *
+ * \param *node		The node to locate.
+ * \return		The node's position, from 0.
+ */
+
+static int bookmark_index_find_position(bookmark_node *node)
+{
+	int			position;
+
+	position = bookmark_index_size(node->left);
+
+	for (; node->up != NULL; node = node->up) {
+		if (node == node->up->right)
+			position += bookmark_index_size(node->up->left) + 1;
+	}
+
+	return position;
+}
+
+
+/**
+ * Find the node at a position in a block's list.
+ *
+ * \param *bm		The block to search.
+ * \param position	The position to find, from 0.
+ * \return		The node at the position, or NULL.
+ */
+
+static bookmark_node *bookmark_index_find_node(bookmark_block *bm, int position)
+{
+	bookmark_node		*node;
+	int			left;
+
+	node = (position >= 0) ? bm->index : NULL;
+
+	while (node != NULL) {
+		left = bookmark_index_size(node->left);
+
+		if (position == left)
+			return node;
+
+		if (position < left) {
+			node = node->left;
+		} else {
+			position -= left + 1;
+			node = node->right;
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Find the node shown in a row of a bookmark window.
+ *
+ * \param *bm		The block to search.
+ * \param row		The row to find, from 0.
+ * \return		The node in the row, or NULL.
+ */
+
+static bookmark_node *bookmark_index_find_row(bookmark_block *bm, int row)
+{
+	bookmark_node		*node;
+	int			pending, visible;
+
+	if (bm == NULL || row < 0 || row >= bm->lines)
+		return NULL;
+
+	node = bm->index;
+	pending = 0;
+
+	while (node != NULL) {
+		visible = bookmark_index_visible(node->left, pending + node->hidden_add);
+
+		if (row < visible) {
+			pending += node->hidden_add;
+			node = node->left;
+			continue;
+		}
+
+		row -= visible;
+
+		if (node->hidden + pending == 0) {
+			if (row == 0)
+				return node;
+
+			row--;
+		}
+
+		pending += node->hidden_add;
+		node = node->right;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Find the row of a bookmark window in which a node is shown.  If the node
+ * is hidden, this is the row which the next visible node is shown in.
+ *
+ * \param *node		The node to locate.
+ * \param *visible	Pointer to a variable to take TRUE if the node is
+ *			visible, or FALSE if it is hidden; or NULL.
+ * \return		The node's row, from 0.
+ */
+
+static int bookmark_index_find_node_row(bookmark_node *node, osbool *visible)
+{
+	bookmark_node		*up;
+	int			pending, row;
+
+	/* Collect the changes still to be passed down to the node. */
+
+	pending = 0;
+
+	for (up = node->up; up != NULL; up = up->up)
+		pending += up->hidden_add;
+
+	if (visible != NULL)
+		*visible = (node->hidden + pending == 0) ? TRUE : FALSE;
+
+	/* Count the visible nodes before it, working back up the index. */
+
+	row = bookmark_index_visible(node->left, pending + node->hidden_add);
+
+	for (; node->up != NULL; node = up) {
+		up = node->up;
+		pending -= up->hidden_add;
+
+		if (node == up->right) {
+			row += bookmark_index_visible(up->left, pending + up->hidden_add);
+
+			if (up->hidden + pending == 0)
+				row++;
+		}
+	}
+
+	return row;
+}
+
+
+/**
+ * Find the node before another in a block's list.
+ *
+ * \param *bm		The block holding the node.
+ * \param *node		The node to start from, or NULL to find the last
+ *			node in the list.
+ * \return		The previous node, or NULL if there is none.
+ */
+
+static bookmark_node *bookmark_index_find_previous(bookmark_block *bm, bookmark_node *node)
+{
+	bookmark_node		*previous;
+
+	if (node == NULL) {
+		previous = bm->index;
+
+		while (previous != NULL && previous->right != NULL)
+			previous = previous->right;
+
+		return previous;
+	}
+
+	if (node->left != NULL) {
+		for (previous = node->left; previous->right != NULL; previous = previous->right);
+		return previous;
+	}
+
+	while (node->up != NULL && node == node->up->left)
+		node = node->up;
+
+	return node->up;
+}
+
+
+/**
+ * Find the parent of a node in the outline: the last node before it which
+ * has a lower level.
+ *
+ * \param *bm		The block holding the node.
+ * \param *node		The node whose parent is to be found.
+ * \return		The parent node, or NULL if there is none.
+ */
+
+static bookmark_node *bookmark_index_find_parent(bookmark_block *bm, bookmark_node *node)
+{
+	int			position;
+
+	position = bookmark_index_find_level_before(bm->index, bookmark_index_find_position(node), node->level - 1);
+
+	return (position == -1) ? NULL : bookmark_index_find_node(bm, position);
+}
+
+
+/**
+ * Find the position in a block's list of the first node after the
+ * descendants of a node.
+ *
+ * \param *bm		The block holding the node.
+ * \param *node		The node whose descendants are to be skipped.
+ * \return		The position after the descendants, which will be
+ *			the number of nodes if they run to the end.
+ */
+
+static int bookmark_index_find_end(bookmark_block *bm, bookmark_node *node)
+{
+	int			position;
+
+	position = bookmark_index_find_level(bm->index, bookmark_index_find_position(node) + 1, node->level);
+
+	return (position == -1) ? bookmark_index_size(bm->index) : position;
+}
+
+
+/**
+ * Count the descendants of a node in the outline.
+ *
+ * \param *bm		The block holding the node.
+ * \param *node		The node whose descendants are to be counted.
+ * \return		The number of descendants.
+ */
+
+static int bookmark_index_count_descendants(bookmark_block *bm, bookmark_node *node)
+{
+	return bookmark_index_find_end(bm, node) - bookmark_index_find_position(node) - 1;
+}
+
+
+/**
+ * Find the first node in a subtree of the index, at or after a position,
+ * whose level is no higher than a given level.
+ *
+ * \param *node		The subtree to search.
+ * \param start		The position to search from, within the subtree.
+ * \param level		The level to search for.
+ * \return		The position of the node within the subtree, or -1.
+ */
+
+static int bookmark_index_find_level(bookmark_node *node, int start, int level)
+{
+	int			left, found;
+
+	if (node == NULL || node->lowest > level)
+		return -1;
+
+	left = bookmark_index_size(node->left);
+
+	if (start < left) {
+		found = bookmark_index_find_level(node->left, start, level);
+		if (found != -1)
+			return found;
+	}
+
+	if (start <= left && node->level <= level)
+		return left;
+
+	found = bookmark_index_find_level(node->right, (start > left + 1) ? start - left - 1 : 0, level);
+
+	return (found == -1) ? -1 : left + 1 + found;
+}
+
+
+/**
+ * Find the last node in a subtree of the index, before a position, whose
+ * level is no higher than a given level.
+ *
+ * \param *node		The subtree to search.
+ * \param end		The position to search back from, within the subtree.
+ * \param level		The level to search for.
+ * \return		The position of the node within the subtree, or -1.
+ */
+
+static int bookmark_index_find_level_before(bookmark_node *node, int end, int level)
+{
+	int			left, found;
+
+	if (node == NULL || end <= 0 || node->lowest > level)
+		return -1;
+
+	left = bookmark_index_size(node->left);
+
+	if (end > left + 1) {
+		found = bookmark_index_find_level_before(node->right, end - left - 1, level);
+		if (found != -1)
+			return left + 1 + found;
+	}
+
+	if (end > left && node->level <= level)
+		return left;
+
+	return bookmark_index_find_level_before(node->left, (end < left) ? end : left, level);
+}
+
+
+/**
+ * Split a subtree of the index in two.
+ *
+ * \param *node		The subtree to split.
+ * \param count		The number of nodes to put in the first part.
+ * \param **first	Pointer to a variable to take the first part.
+ * \param **second	Pointer to a variable to take the second part.
+ */
+
+static void bookmark_index_split(bookmark_node *node, int count, bookmark_node **first, bookmark_node **second)
+{
+	if (node == NULL) {
+		*first = NULL;
+		*second = NULL;
+		return;
+	}
+
+	bookmark_index_push(node);
+
+	if (count <= bookmark_index_size(node->left)) {
+		bookmark_index_split(node->left, count, first, &(node->left));
+		if (node->left != NULL)
+			node->left->up = node;
+		*second = node;
+	} else {
+		bookmark_index_split(node->right, count - bookmark_index_size(node->left) - 1, &(node->right), second);
+		if (node->right != NULL)
+			node->right->up = node;
+		*first = node;
+	}
+
+	node->up = NULL;
+	bookmark_index_update(node);
+}
+
+
+/**
+ * Join two subtrees of the index, with all of the nodes in the first coming
+ * before those in the second.
+ *
+ * \param *first	The first subtree, or NULL.
+ * \param *second	The second subtree, or NULL.
+ * \return		The joined subtree.
+ */
+
+static bookmark_node *bookmark_index_join(bookmark_node *first, bookmark_node *second)
+{
+	if (first == NULL || second == NULL)
+		return (first != NULL) ? first : second;
+
+	if (first->priority > second->priority) {
+		bookmark_index_push(first);
+		first->right = bookmark_index_join(first->right, second);
+		first->right->up = first;
+		first->up = NULL;
+		bookmark_index_update(first);
+		return first;
+	}
+
+	bookmark_index_push(second);
+	second->left = bookmark_index_join(first, second->left);
+	second->left->up = second;
+	second->up = NULL;
+	bookmark_index_update(second);
+	return second;
+}
+
+
+/**
+ * Recalculate the details held for every node in a subtree of the index.
+ *
+ * \param *node		The subtree to recalculate.
+ */
+
+static void bookmark_index_recalculate(bookmark_node *node)
+{
+	if (node == NULL)
+		return;
+
+	bookmark_index_recalculate(node->left);
+	bookmark_index_recalculate(node->right);
+	bookmark_index_update(node);
+}
+
+
+/**
+ * Recalculate the details held for a node in the index from those of its
+ * children.
+ *
+ * \param *node		The node to update.
+ */
+
+static void bookmark_index_update(bookmark_node *node)
+{
+	bookmark_node		*child[2];
+	int			i, hidden;
+
+	node->size = 1;
+	node->lowest = node->level;
+	node->hidden_min = node->hidden;
+	node->hidden_count = 1;
+
+	child[0] = node->left;
+	child[1] = node->right;
+
+	for (i = 0; i < 2; i++) {
+		if (child[i] == NULL)
+			continue;
+
+		node->size += child[i]->size;
+
+		if (child[i]->lowest < node->lowest)
+			node->lowest = child[i]->lowest;
+
+		hidden = child[i]->hidden_min + node->hidden_add;
+
+		if (hidden < node->hidden_min) {
+			node->hidden_min = hidden;
+			node->hidden_count = child[i]->hidden_count;
+		} else if (hidden == node->hidden_min) {
+			node->hidden_count += child[i]->hidden_count;
+		}
+	}
+}
+
+
+/**
+ * Change the number of contracted nodes hiding every node in a subtree of
+ * the index.  The change to the node's children is passed down later.
+ *
+ * \param *node		The subtree to change, or NULL.
+ * \param change	The change to make.
+ */
+
+static void bookmark_index_hide(bookmark_node *node, int change)
+{
+	if (node == NULL)
+		return;
+
+	node->hidden += change;
+	node->hidden_add += change;
+	node->hidden_min += change;
+}
+
+
+/**
+ * Pass any outstanding change to the number of contracted nodes hiding a
+ * node down to its children.
+ *
+ * \param *node		The node to update.
+ */
+
+static void bookmark_index_push(bookmark_node *node)
+{
+	if (node->hidden_add == 0)
+		return;
+
+	bookmark_index_hide(node->left, node->hidden_add);
+	bookmark_index_hide(node->right, node->hidden_add);
+
+	node->hidden_add = 0;
+}
+
+
+/**
+ * Return the number of nodes in a subtree of the index.
+ *
+ * \param *node		The subtree, or NULL.
+ * \return		The number of nodes.
+ */
+
+static int bookmark_index_size(bookmark_node *node)
+{
+	return (node == NULL) ? 0 : node->size;
+}
+
+
+/**
+ * Return the number of visible nodes in a subtree of the index.
+ *
+ * \param *node		The subtree, or NULL.
+ * \param pending	The change still to be passed down to the subtree.
+ * \return		The number of visible nodes.
+ */
+
+static int bookmark_index_visible(bookmark_node *node, int pending)
+{
+	return (node != NULL && node->hidden_min + pending == 0) ? node->hidden_count : 0;
+}
+
+
+/**
+ * Return a new priority for a node in the index.
+ *
+ * \return		The priority.
+ */
+
+static unsigned bookmark_index_random(void)
+{
+	bookmarks_index_seed ^= bookmarks_index_seed << 13;
+	bookmarks_index_seed ^= bookmarks_index_seed >> 17;
+	bookmarks_index_seed ^= bookmarks_index_seed << 5;
+
+	return bookmarks_index_seed;
+}
+
+
+/**
+ * Test whether a node has any children in the outline.
+ *
+ * \param *node		The node to test.
+ * \return		TRUE if the node has children; else FALSE.
+ */
+
+static osbool bookmark_node_has_children(bookmark_node *node)
+{
+	return (node != NULL && node->next != NULL && node->next->level > node->level) ? TRUE : FALSE;
+}
+
+
+#ifdef HOSTED
+
+/* ****************************************************************************
+ * Hosted Build Interface
+ * ****************************************************************************/
+
+/**
+ * Recalculate the details of a bookmark block from scratch, as loading a
+ * file does, so that the hosted tools can time it.
+ *
+ * \param *bm		Pointer to the block to recalculate.
+ */
+
+void bookmark_hosted_rebuild(bookmark_block *bm)
+{
+	bookmark_rebuild_data(bm);
+}
+
+
+/**
+ * Report whether the last file loaded contained unknown data or was in an
+ * unknown format, so that the hosted tools can tell damaged loads apart.
+ *
+ * \return		TRUE if the last file loaded was damaged; else FALSE.
+ */
+
+osbool bookmark_hosted_load_damaged(void)
+{
+	return bookmarks_hosted_damaged;
+}
+
+
+/**
+ * Return the number of rows visible in a bookmark block.
+ *
+ * \param *bm		Pointer to the block to query.
+ * \return		The number of visible rows.
+ */
+
+int bookmark_hosted_count_rows(bookmark_block *bm)
+{
+	return (bm == NULL) ? 0 : bm->lines;
+}
+
+
+/**
+ * Return the amount of memory used by the nodes and titles of a bookmark
+ * block.
+ *
+ * \param *bm		Pointer to the block to query.
+ * \return		The number of bytes allocated.
+ */
+
+int bookmark_hosted_count_memory(bookmark_block *bm)
+{
+	bookmark_chunk		*chunk;
+	int			bytes;
+
+	if (bm == NULL)
+		return 0;
+
+	bytes = bm->title_buckets * sizeof(bookmark_title *);
+
+	for (chunk = bm->arena; chunk != NULL; chunk = chunk->next)
+		bytes += ARENA_CHUNK_HEADER + chunk->size;
+
+	return bytes;
+}
+
+
+/**
+ * Carry out an edit on a bookmark block, as the window would, so that the
+ * hosted tools can time and test it.
+ *
+ * \param *bm		Pointer to the block to edit.
+ * \param edit		The edit to carry out.
+ * \param row		The row to apply the edit to.
+ * \param target	The row to move to, for BOOKMARK_HOSTED_MOVE.
+ * \return		TRUE if the rows were valid; else FALSE.
+ */
+
+osbool bookmark_hosted_edit(bookmark_block *bm, enum bookmark_hosted_edit edit, int row, int target)
+{
+	bookmark_node		*node;
+
+	if (bm == NULL)
+		return FALSE;
+
+	node = bookmark_index_find_row(bm, row);
+	if (node == NULL && edit != BOOKMARK_HOSTED_EXPAND_ALL && edit != BOOKMARK_HOSTED_CONTRACT_ALL)
+		return FALSE;
+
+	switch (edit) {
+	case BOOKMARK_HOSTED_INSERT_ABOVE:
+		bookmark_insert_edit_row(bm, node, BOOKMARK_ABOVE);
+		break;
+	case BOOKMARK_HOSTED_INSERT_BELOW:
+		bookmark_insert_edit_row(bm, node, BOOKMARK_BELOW);
+		break;
+	case BOOKMARK_HOSTED_DELETE:
+		bookmark_delete_edit_row(bm, node);
+		break;
+	case BOOKMARK_HOSTED_PROMOTE:
+		bookmark_change_edit_row_indentation(bm, node, BOOKMARK_TB_PROMOTE);
+		break;
+	case BOOKMARK_HOSTED_PROMOTEG:
+		bookmark_change_edit_row_indentation(bm, node, BOOKMARK_TB_PROMOTEG);
+		break;
+	case BOOKMARK_HOSTED_DEMOTE:
+		bookmark_change_edit_row_indentation(bm, node, BOOKMARK_TB_DEMOTE);
+		break;
+	case BOOKMARK_HOSTED_DEMOTEG:
+		bookmark_change_edit_row_indentation(bm, node, BOOKMARK_TB_DEMOTEG);
+		break;
+	case BOOKMARK_HOSTED_TOGGLE:
+		bookmark_toggle_edit_row(bm, node);
+		break;
+	case BOOKMARK_HOSTED_MOVE:
+		if (target < 0 || target > bm->lines)
+			return FALSE;
+		if (target != row && target != row + 1)
+			bookmark_move_edit_row(bm, node, bookmark_index_find_row(bm, target));
+		break;
+	case BOOKMARK_HOSTED_EXPAND_ALL:
+		bookmark_tree_node_expansion(bm, TRUE);
+		break;
+	case BOOKMARK_HOSTED_CONTRACT_ALL:
+		bookmark_tree_node_expansion(bm, FALSE);
+		break;
+	default:
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Check the details of a bookmark block against a direct walk of its nodes,
+ * so that the hosted tools can test the index.
+ *
+ * \param *bm		Pointer to the block to check.
+ * \return		TRUE if the details are consistent; else FALSE.
+ */
+
+osbool bookmark_hosted_check(bookmark_block *bm)
+{
+	bookmark_node		*node, **parents, **stack, **cursor;
+	int			*hidden, *ends, count, depth, contracted, position, row, expandable, contractable;
+	osbool			valid, visible;
+
+	if (bm == NULL)
+		return FALSE;
+
+	count = 0;
+	for (node = bm->root; node != NULL; node = node->next)
+		count++;
+
+	if (count != bm->nodes || count != bookmark_index_size(bm->index) || (bm->index != NULL && bm->index->up != NULL))
+		return FALSE;
+
+	hidden = malloc((count + 1) * sizeof(int));
+	ends = malloc((count + 1) * sizeof(int));
+	parents = malloc((count + 1) * sizeof(bookmark_node *));
+	stack = malloc((count + 1) * sizeof(bookmark_node *));
+
+	if (hidden == NULL || ends == NULL || parents == NULL || stack == NULL) {
+		free(hidden);
+		free(ends);
+		free(parents);
+		free(stack);
+		return FALSE;
+	}
+
+	/* Walk the list, keeping a stack of the open ancestors of each node,
+	 * to find how many contracted nodes hide it, its parent and the end
+	 * of its descendants.
+	 */
+
+	depth = 0;
+	contracted = 0;
+	position = 0;
+	expandable = 0;
+	contractable = 0;
+
+	for (node = bm->root; node != NULL; node = node->next) {
+		while (depth > 0 && stack[depth - 1]->level >= node->level) {
+			depth--;
+			ends[bookmark_index_find_position(stack[depth])] = position;
+			if (!stack[depth]->expanded)
+				contracted--;
+		}
+
+		hidden[position] = contracted;
+		parents[position] = NULL;
+		for (row = depth - 1; row >= 0 && parents[position] == NULL; row--) {
+			if (stack[row]->level < node->level)
+				parents[position] = stack[row];
+		}
+
+		if (bookmark_node_has_children(node)) {
+			if (node->expanded)
+				contractable++;
+			else
+				expandable++;
+		}
+
+		stack[depth++] = node;
+		if (!node->expanded)
+			contracted++;
+
+		position++;
+	}
+
+	while (depth > 0) {
+		depth--;
+		ends[bookmark_index_find_position(stack[depth])] = position;
+	}
+
+	/* Check the index against the list. */
+
+	cursor = stack;
+	for (node = bm->root; node != NULL; node = node->next)
+		*cursor++ = node;
+
+	cursor = stack;
+	valid = bookmark_hosted_check_node(bm->index, 0, &cursor, hidden, stack);
+
+	valid = valid && expandable == bm->expandable && contractable == bm->contractable;
+
+	/* Check the rows and outline relationships of each node. */
+
+	row = 0;
+	position = 0;
+
+	for (node = bm->root; node != NULL && valid; node = node->next) {
+		if (bookmark_index_find_node(bm, position) != node || bookmark_index_find_position(node) != position)
+			valid = FALSE;
+
+		if (bookmark_index_find_node_row(node, &visible) != row || visible != (hidden[position] == 0))
+			valid = FALSE;
+
+		if (visible && bookmark_index_find_row(bm, row++) != node)
+			valid = FALSE;
+
+		if (bookmark_index_find_end(bm, node) != ends[position] || bookmark_index_find_parent(bm, node) != parents[position])
+			valid = FALSE;
+
+		position++;
+	}
+
+	valid = valid && row == bm->lines;
+
+	free(hidden);
+	free(ends);
+	free(parents);
+	free(stack);
+
+	return valid;
+}
+
+
+/**
+ * Check a subtree of a block's index, including its nodes' positions in the
+ * list, the details held for each node and the number of contracted nodes
+ * hiding them.
+ *
+ * \param *node		The subtree to check.
+ * \param pending	The change still to be passed down to the subtree.
+ * \param ***cursor	Pointer to the next entry in the list of nodes, which
+ *			is updated.
+ * \param *hidden	The number of contracted nodes hiding each node.
+ * \param **list	The list of nodes, in order.
+ * \return		TRUE if the subtree is consistent; else FALSE.
+ */
+
+static osbool bookmark_hosted_check_node(bookmark_node *node, int pending, bookmark_node ***cursor, int *hidden, bookmark_node **list)
+{
+	bookmark_node		*child[2];
+	int			i, lowest, position, least, least_count, value;
+
+	if (node == NULL)
+		return TRUE;
+
+	child[0] = node->left;
+	child[1] = node->right;
+
+	lowest = node->level;
+
+	for (i = 0; i < 2; i++) {
+		if (child[i] == NULL)
+			continue;
+
+		if (child[i]->up != node || child[i]->priority > node->priority)
+			return FALSE;
+
+		if (child[i]->lowest < lowest)
+			lowest = child[i]->lowest;
+	}
+
+	if (node->size != 1 + bookmark_index_size(node->left) + bookmark_index_size(node->right) || node->lowest != lowest)
+		return FALSE;
+
+	/* Work through the subtree in order, matching it to the list. */
+
+	if (!bookmark_hosted_check_node(node->left, pending + node->hidden_add, cursor, hidden, list))
+		return FALSE;
+
+	position = *cursor - list;
+
+	if (**cursor != node || node->hidden + pending != hidden[position])
+		return FALSE;
+
+	(*cursor)++;
+
+	if (!bookmark_hosted_check_node(node->right, pending + node->hidden_add, cursor, hidden, list))
+		return FALSE;
+
+	/* Check the lowest number of contracted nodes hiding any node in the
+	 * subtree, and how many nodes have it.
+	 */
+
+	least = hidden[position];
+	least_count = 0;
+
+	for (i = position - bookmark_index_size(node->left); i <= position + bookmark_index_size(node->right); i++) {
+		value = hidden[i];
+
+		if (value < least) {
+			least = value;
+			least_count = 1;
+		} else if (value == least) {
+			least_count++;
+		}
+	}
+
+	return (node->hidden_min + pending == least && node->hidden_count == least_count) ? TRUE : FALSE;
 }
 
+#endif
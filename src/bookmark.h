@@ -33,11 +33,13 @@
 #include <stdio.h>
 #include "sflib/config.h"
 
+#include "pdfmark.h"
+
 /* ==================================================================================================================
  * Static constants
  */
 
-#define MAX_BOOKMARK_LEN 64  /* The real maximum is 256, but Adobe recommend 32 max for practicality. */
+#define MAX_BOOKMARK_LEN 257  /* The real maximum is 256, plus a terminator, but Adobe recommend 32 max for practicality. */
 #define MAX_BOOKMARK_NUM_LEN 10
 #define MAX_BOOKMARK_BLOCK_NAME 64
 #define MAX_BOOKMARK_FIELD_LEN 20
@@ -57,7 +59,12 @@
 #define BOOKMARK_WINDOW_STANDOFF 400
 #define BOOKMARK_WINDOW_OPENSTEP 100
 
-#define BOOKMARK_FILE_LINE_LEN (sf_MAX_CONFIG_FILE_BUFFER)
+#define BOOKMARK_FILE_KEYS 16
+#define BOOKMARK_LINE_NUMBER_LEN 16
+
+#define BOOKMARK_ARENA_CHUNK 4096
+#define BOOKMARK_ARENA_ALIGN 8
+#define BOOKMARK_TITLE_BUCKETS 256
 
 #define BOOKMARK_ABOVE 1
 #define BOOKMARK_BELOW 2
@@ -260,14 +267,103 @@ bookmark_block *bookmarks_load_file(char *filename);
 
 
 /**
- * Write document info to a PSDMark file, reflecting the data in the supplied
- * PDFMark parameter block.
+ * Output PDFMark data related to the associated bookmarks parameters file.
+ *
+ * \param  *output		The output stream to write to.
+ * \param  *params		The parameter block to use.
+ */
+
+void bookmarks_write_pdfmark(pdfmark_output *output, bookmark_params *params);
+
+
+#ifdef HOSTED
+
+/**
+ * The edits which the hosted tools can carry out on a bookmark block.
+ */
+
+enum bookmark_hosted_edit {
+	BOOKMARK_HOSTED_INSERT_ABOVE = 0,	/**< Insert a row above the row.		*/
+	BOOKMARK_HOSTED_INSERT_BELOW = 1,	/**< Insert a row below the row.		*/
+	BOOKMARK_HOSTED_DELETE = 2,		/**< Delete the row.				*/
+	BOOKMARK_HOSTED_PROMOTE = 3,		/**< Promote the row.				*/
+	BOOKMARK_HOSTED_PROMOTEG = 4,		/**< Promote the row and its group.		*/
+	BOOKMARK_HOSTED_DEMOTE = 5,		/**< Demote the row.				*/
+	BOOKMARK_HOSTED_DEMOTEG = 6,		/**< Demote the row and its group.		*/
+	BOOKMARK_HOSTED_TOGGLE = 7,		/**< Expand or contract the row.		*/
+	BOOKMARK_HOSTED_MOVE = 8,		/**< Drag the row to before the target row.	*/
+	BOOKMARK_HOSTED_EXPAND_ALL = 9,		/**< Expand every row.				*/
+	BOOKMARK_HOSTED_CONTRACT_ALL = 10,	/**< Contract every row.			*/
+	BOOKMARK_HOSTED_EDITS = 11		/**< The number of edits.			*/
+};
+
+
+/**
+ * Recalculate the details of a bookmark block from scratch, as loading a
+ * file does, so that the hosted tools can time it.
+ *
+ * \param *bm		Pointer to the block to recalculate.
+ */
+
+void bookmark_hosted_rebuild(bookmark_block *bm);
+
+
+/**
+ * Report whether the last file loaded contained unknown data or was in an
+ * unknown format, so that the hosted tools can tell damaged loads apart.
+ *
+ * \return		TRUE if the last file loaded was damaged; else FALSE.
+ */
+
+osbool bookmark_hosted_load_damaged(void);
+
+
+/**
+ * Return the number of rows visible in a bookmark block.
+ *
+ * \param *bm		Pointer to the block to query.
+ * \return		The number of visible rows.
+ */
+
+int bookmark_hosted_count_rows(bookmark_block *bm);
+
+
+/**
+ * Return the amount of memory used by the nodes and titles of a bookmark
+ * block.
  *
- * \param *file			The file handle to write to.
- * \param *params		The PRDMark parameter block to translate.
+ * \param *bm		Pointer to the block to query.
+ * \return		The number of bytes allocated.
  */
 
-void bookmarks_write_pdfmark_out_file(FILE *pdfmark_file, bookmark_params *params);
+int bookmark_hosted_count_memory(bookmark_block *bm);
+
+
+/**
+ * Carry out an edit on a bookmark block, as the window would, so that the
+ * hosted tools can time and test it.
+ *
+ * \param *bm		Pointer to the block to edit.
+ * \param edit		The edit to carry out.
+ * \param row		The row to apply the edit to.
+ * \param target	The row to move to, for BOOKMARK_HOSTED_MOVE.
+ * \return		TRUE if the rows were valid; else FALSE.
+ */
+
+osbool bookmark_hosted_edit(bookmark_block *bm, enum bookmark_hosted_edit edit, int row, int target);
+
+
+/**
+ * Check the details of a bookmark block against a direct walk of its nodes,
+ * so that the hosted tools can test the index.
+ *
+ * \param *bm		Pointer to the block to check.
+ * \return		TRUE if the details are consistent; else FALSE.
+ */
+
+osbool bookmark_hosted_check(bookmark_block *bm);
+
+#endif
 
 #endif
 
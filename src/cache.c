@@ -0,0 +1,618 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: cache.c
+ *
+ * Conversion result cache implementation.
+ *
+ * Each conversion is keyed on a 64-bit FNV-1a hash of the PostScript being
+ * converted and of everything else which affects the output: the gs
+ * switches built from the settings, the PDFMark data and any user PDFMark
+ * file.  The PDFs are held in numbered files in the cache directory, with
+ * an index file recording the key, size and last use of each:
+ *
+ *   PrintPDF Cache 1 <clock> <next>
+ *   <hash> <length> <size> <used> <number>
+ *
+ * The total size of the PDFs is kept below CacheSize kilobytes by
+ * discarding the least recently used results.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/fileswitch.h"
+#include "oslib/osfile.h"
+#include "oslib/osfscontrol.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/debug.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "cache.h"
+
+
+/**
+ * The maximum length of a filename in the cache.
+ */
+
+#define CACHE_MAX_FILENAME 256
+
+/**
+ * The maximum length of a line in the index.
+ */
+
+#define CACHE_LINE_LENGTH 128
+
+/**
+ * The size of the buffer used when hashing files.
+ */
+
+#define CACHE_BUFFER_SIZE 4096
+
+/**
+ * The FNV-1a offset basis and prime, for 64-bit hashes.
+ */
+
+#define CACHE_FNV_BASIS 0xcbf29ce484222325ULL
+#define CACHE_FNV_PRIME 0x100000001b3ULL
+
+/**
+ * A result held in the cache.
+ */
+
+struct cache_entry {
+	struct cache_key	key;				/**< The key of the conversion.				*/
+	int			size;				/**< The size of the cached PDF.			*/
+	unsigned int		used;				/**< The clock value when the result was last used.	*/
+	int			number;				/**< The number of the file holding the PDF.		*/
+
+	struct cache_entry	*next;				/**< The next entry in the cache.			*/
+};
+
+/* Function Prototypes. */
+
+static void cache_add_bytes(struct cache_key *key, char *data, size_t length);
+static struct cache_entry *cache_find(struct cache_key *key);
+static void cache_discard(struct cache_entry *entry);
+static void cache_trim(int limit);
+static void cache_load_index(void);
+static void cache_write_index(void);
+static char *cache_build_filename(char *buffer, size_t len, char *leaf);
+
+
+/**
+ * The results in the cache.
+ */
+
+static struct cache_entry *cache_entries = NULL;
+
+/**
+ * The total size of the results in the cache.
+ */
+
+static int cache_total_size = 0;
+
+/**
+ * The clock used to order the results by their last use.
+ */
+
+static unsigned int cache_clock = 0;
+
+/**
+ * The number to be given to the next file stored in the cache.
+ */
+
+static int cache_next_number = 0;
+
+/**
+ * TRUE if the cache directory is available.
+ */
+
+static osbool cache_available = FALSE;
+
+/**
+ * The number of lookups which found a result.
+ */
+
+static int cache_hits = 0;
+
+/**
+ * The number of lookups which didn't find a result.
+ */
+
+static int cache_misses = 0;
+
+/**
+ * The buffer used when hashing files.
+ */
+
+static char cache_buffer[CACHE_BUFFER_SIZE];
+
+
+/**
+ * Initialise the result cache, creating its directory if required and
+ * loading its index.
+ */
+
+void cache_initialise(void)
+{
+	char			*cache_dir;
+	fileswitch_object_type	type;
+
+	cache_dir = config_str_read("CacheDir");
+
+	if (xosfile_read_no_path(cache_dir, &type, NULL, NULL, NULL, NULL) != NULL)
+		return;
+
+	if (type == fileswitch_NOT_FOUND && xosfile_create_dir(cache_dir, 0) == NULL)
+		type = fileswitch_IS_DIR;
+
+	if (type != fileswitch_IS_DIR)
+		return;
+
+	cache_available = TRUE;
+
+	cache_load_index();
+}
+
+
+/**
+ * Test whether the result cache is in use.
+ *
+ * \return			TRUE if results are being cached; else FALSE.
+ */
+
+osbool cache_enabled(void)
+{
+	return (cache_available && config_int_read("CacheSize") > 0) ? TRUE : FALSE;
+}
+
+
+/**
+ * Start building a new cache key.
+ *
+ * \param *key			The key to start.
+ */
+
+void cache_start_key(struct cache_key *key)
+{
+	if (key == NULL)
+		return;
+
+	key->hash[0] = (unsigned int) (CACHE_FNV_BASIS >> 32);
+	key->hash[1] = (unsigned int) (CACHE_FNV_BASIS & 0xffffffffu);
+	key->length = 0;
+}
+
+
+/**
+ * Add a piece of text to a cache key, including its terminator so that
+ * consecutive pieces can't run together.
+ *
+ * \param *key			The key to update.
+ * \param *text			The text to add.
+ */
+
+void cache_add_text(struct cache_key *key, char *text)
+{
+	if (key == NULL || text == NULL)
+		return;
+
+	cache_add_bytes(key, text, strlen(text) + 1);
+}
+
+
+/**
+ * Add the remaining contents of an open file to a cache key.
+ *
+ * \param *key			The key to update.
+ * \param *file			The file to add.
+ * \return			TRUE if the file was read; else FALSE.
+ */
+
+osbool cache_add_stream(struct cache_key *key, FILE *file)
+{
+	size_t		read;
+
+	if (key == NULL || file == NULL)
+		return FALSE;
+
+	while ((read = fread(cache_buffer, 1, CACHE_BUFFER_SIZE, file)) > 0)
+		cache_add_bytes(key, cache_buffer, read);
+
+	/* Mark the end of the file, so that the boundaries between files form part of the key. */
+
+	cache_add_bytes(key, "", 1);
+
+	return (ferror(file)) ? FALSE : TRUE;
+}
+
+
+/**
+ * Add the contents of a file to a cache key.
+ *
+ * \param *key			The key to update.
+ * \param *filename		The name of the file to add.
+ * \return			TRUE if the file was read; else FALSE.
+ */
+
+osbool cache_add_file(struct cache_key *key, char *filename)
+{
+	FILE		*file;
+	osbool		success;
+
+	if (key == NULL || filename == NULL)
+		return FALSE;
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+		return FALSE;
+
+	success = cache_add_stream(key, file);
+
+	fclose(file);
+
+	return success;
+}
+
+
+/**
+ * Look a conversion up in the cache and, if it is found, copy the cached
+ * PDF to the output file.
+ *
+ * \param *key			The key of the conversion.
+ * \param *output_file		The file to copy the PDF to.
+ * \return			TRUE if the PDF was copied from the cache; else FALSE.
+ */
+
+osbool cache_fetch(struct cache_key *key, char *output_file)
+{
+	char			leaf[16], filename[CACHE_MAX_FILENAME];
+	struct cache_entry	*entry;
+
+	if (!cache_enabled() || key == NULL || output_file == NULL)
+		return FALSE;
+
+	entry = cache_find(key);
+
+	if (entry != NULL) {
+		string_printf(leaf, sizeof(leaf), "R%d", entry->number);
+		cache_build_filename(filename, CACHE_MAX_FILENAME, leaf);
+
+		/* RISC OS filing systems don't support links, so the PDF has to be copied out. */
+
+		if (xosfscontrol_copy(filename, output_file, osfscontrol_COPY_FORCE, 0, 0, 0, 0, NULL) == NULL) {
+			entry->used = ++cache_clock;
+			cache_write_index();
+			cache_hits++;
+
+			#ifdef DEBUG
+			debug_printf("Cache hit on R%d (%d hits, %d misses)", entry->number, cache_hits, cache_misses);
+			#endif
+
+			return TRUE;
+		}
+
+		/* The file has gone astray, so the entry is of no further use. */
+
+		cache_discard(entry);
+		cache_write_index();
+	}
+
+	cache_misses++;
+
+	#ifdef DEBUG
+	debug_printf("Cache miss (%d hits, %d misses)", cache_hits, cache_misses);
+	#endif
+
+	return FALSE;
+}
+
+
+/**
+ * Store the PDF from a successful conversion in the cache, discarding the
+ * least recently used results to make space for it if required.
+ *
+ * \param *key			The key of the conversion.
+ * \param *output_file		The PDF to be stored.
+ */
+
+void cache_store(struct cache_key *key, char *output_file)
+{
+	char			leaf[16], filename[CACHE_MAX_FILENAME];
+	struct cache_entry	*entry;
+	fileswitch_object_type	type;
+	int			size, limit;
+
+	if (!cache_enabled() || key == NULL || output_file == NULL || cache_find(key) != NULL)
+		return;
+
+	if (xosfile_read_no_path(output_file, &type, NULL, NULL, &size, NULL) != NULL || type != fileswitch_IS_FILE)
+		return;
+
+	/* A result which would fill the cache on its own isn't worth keeping. */
+
+	limit = config_int_read("CacheSize") * 1024;
+
+	if (size > limit / 2)
+		return;
+
+	entry = malloc(sizeof(struct cache_entry));
+	if (entry == NULL)
+		return;
+
+	cache_trim(limit - size);
+
+	entry->key = *key;
+	entry->size = size;
+	entry->used = ++cache_clock;
+	entry->number = cache_next_number++;
+
+	string_printf(leaf, sizeof(leaf), "R%d", entry->number);
+	cache_build_filename(filename, CACHE_MAX_FILENAME, leaf);
+
+	if (xosfscontrol_copy(output_file, filename, osfscontrol_COPY_FORCE, 0, 0, 0, 0, NULL) != NULL) {
+		xosfile_delete(filename, NULL, NULL, NULL, NULL, NULL);
+		free(entry);
+		return;
+	}
+
+	entry->next = cache_entries;
+	cache_entries = entry;
+	cache_total_size += size;
+
+	cache_write_index();
+}
+
+
+/**
+ * Read the cache's hit and miss counters.
+ *
+ * \param *hits			Pointer to a variable to take the number of
+ *				hits, or NULL.
+ * \param *misses		Pointer to a variable to take the number of
+ *				misses, or NULL.
+ */
+
+void cache_get_counters(int *hits, int *misses)
+{
+	if (hits != NULL)
+		*hits = cache_hits;
+
+	if (misses != NULL)
+		*misses = cache_misses;
+}
+
+
+/**
+ * Add a block of bytes to a cache key.
+ *
+ * \param *key			The key to update.
+ * \param *data			The bytes to add.
+ * \param length		The number of bytes to add.
+ */
+
+static void cache_add_bytes(struct cache_key *key, char *data, size_t length)
+{
+	unsigned long long	hash;
+	size_t			i;
+
+	hash = ((unsigned long long) key->hash[0] << 32) | key->hash[1];
+
+	for (i = 0; i < length; i++) {
+		hash ^= (unsigned char) data[i];
+		hash *= CACHE_FNV_PRIME;
+	}
+
+	key->hash[0] = (unsigned int) (hash >> 32);
+	key->hash[1] = (unsigned int) (hash & 0xffffffffu);
+	key->length += length;
+}
+
+
+/**
+ * Find the cache entry for a key.
+ *
+ * \param *key			The key to find.
+ * \return			Pointer to the entry, or NULL if none.
+ */
+
+static struct cache_entry *cache_find(struct cache_key *key)
+{
+	struct cache_entry	*entry;
+
+	for (entry = cache_entries; entry != NULL; entry = entry->next) {
+		if (entry->key.hash[0] == key->hash[0] && entry->key.hash[1] == key->hash[1] && entry->key.length == key->length)
+			return entry;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Remove an entry from the cache, deleting its file.  The index is not
+ * updated.
+ *
+ * \param *entry		The entry to remove.
+ */
+
+static void cache_discard(struct cache_entry *entry)
+{
+	char			leaf[16], filename[CACHE_MAX_FILENAME];
+	struct cache_entry	**list;
+
+	for (list = &cache_entries; *list != NULL && *list != entry; list = &((*list)->next));
+
+	if (*list == NULL)
+		return;
+
+	*list = entry->next;
+
+	string_printf(leaf, sizeof(leaf), "R%d", entry->number);
+	xosfile_delete(cache_build_filename(filename, CACHE_MAX_FILENAME, leaf), NULL, NULL, NULL, NULL, NULL);
+
+	cache_total_size -= entry->size;
+
+	free(entry);
+}
+
+
+/**
+ * Discard the least recently used results from the cache until their
+ * total size falls to a given limit.  The index is not updated.
+ *
+ * \param limit			The size, in bytes, to trim the cache to.
+ */
+
+static void cache_trim(int limit)
+{
+	struct cache_entry	*entry, *oldest;
+
+	while (cache_total_size > limit && cache_entries != NULL) {
+		oldest = cache_entries;
+
+		for (entry = cache_entries->next; entry != NULL; entry = entry->next) {
+			if (entry->used < oldest->used)
+				oldest = entry;
+		}
+
+		#ifdef DEBUG
+		debug_printf("Cache discarding R%d", oldest->number);
+		#endif
+
+		cache_discard(oldest);
+	}
+}
+
+
+/**
+ * Load the index of the cache from disc, dropping any entries whose files
+ * have gone astray.
+ */
+
+static void cache_load_index(void)
+{
+	char			line[CACHE_LINE_LENGTH], leaf[16], filename[CACHE_MAX_FILENAME];
+	struct cache_entry	*entry;
+	fileswitch_object_type	type;
+	FILE			*file;
+	int			version, size;
+
+	file = fopen(cache_build_filename(filename, CACHE_MAX_FILENAME, "Index"), "r");
+	if (file == NULL)
+		return;
+
+	if (fgets(line, CACHE_LINE_LENGTH, file) == NULL ||
+			sscanf(line, "PrintPDF Cache %d %u %d", &version, &cache_clock, &cache_next_number) != 3 || version != 1) {
+		fclose(file);
+		return;
+	}
+
+	while (fgets(line, CACHE_LINE_LENGTH, file) != NULL) {
+		entry = malloc(sizeof(struct cache_entry));
+		if (entry == NULL)
+			break;
+
+		if (sscanf(line, "%8x%8x %u %d %u %d", &(entry->key.hash[0]), &(entry->key.hash[1]), &(entry->key.length),
+				&(entry->size), &(entry->used), &(entry->number)) != 6) {
+			free(entry);
+			continue;
+		}
+
+		string_printf(leaf, sizeof(leaf), "R%d", entry->number);
+		cache_build_filename(filename, CACHE_MAX_FILENAME, leaf);
+
+		if (xosfile_read_no_path(filename, &type, NULL, NULL, &size, NULL) != NULL || type != fileswitch_IS_FILE ||
+				size != entry->size) {
+			free(entry);
+			continue;
+		}
+
+		entry->next = cache_entries;
+		cache_entries = entry;
+		cache_total_size += entry->size;
+	}
+
+	fclose(file);
+
+	/* The size limit may have changed since the cache was last used. */
+
+	cache_trim(config_int_read("CacheSize") * 1024);
+	cache_write_index();
+}
+
+
+/**
+ * Write the index of the cache out to disc.
+ */
+
+static void cache_write_index(void)
+{
+	char			filename[CACHE_MAX_FILENAME];
+	struct cache_entry	*entry;
+	FILE			*file;
+
+	file = fopen(cache_build_filename(filename, CACHE_MAX_FILENAME, "Index"), "w");
+	if (file == NULL)
+		return;
+
+	fprintf(file, "PrintPDF Cache 1 %u %d\n", cache_clock, cache_next_number);
+
+	for (entry = cache_entries; entry != NULL; entry = entry->next)
+		fprintf(file, "%08X%08X %u %d %u %d\n", entry->key.hash[0], entry->key.hash[1], entry->key.length,
+				entry->size, entry->used, entry->number);
+
+	fclose(file);
+}
+
+
+/**
+ * Build the full pathname of a file in the cache directory.
+ *
+ * \param *buffer		Pointer to the buffer to hold the pathname.
+ * \param len			The size of the supplied buffer.
+ * \param *leaf			The leafname of the file.
+ * \return			Pointer to the pathname in the buffer.
+ */
+
+static char *cache_build_filename(char *buffer, size_t len, char *leaf)
+{
+	string_printf(buffer, len, "%s.%s", config_str_read("CacheDir"), leaf);
+
+	return buffer;
+}
+
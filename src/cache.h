@@ -0,0 +1,142 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: cache.h
+ *
+ * Conversion result cache implementation.
+ */
+
+#ifndef PRINTPDF_CACHE
+#define PRINTPDF_CACHE
+
+#include <stdio.h>
+
+#include "oslib/types.h"
+
+/**
+ * The key identifying a conversion in the cache: a hash of everything
+ * which went into it, along with the number of bytes hashed.
+ */
+
+struct cache_key {
+	unsigned int	hash[2];				/**< The high and low words of the hash.		*/
+	unsigned int	length;					/**< The number of bytes hashed.			*/
+};
+
+
+/**
+ * Initialise the result cache, creating its directory if required and
+ * loading its index.
+ */
+
+void cache_initialise(void);
+
+
+/**
+ * Test whether the result cache is in use.
+ *
+ * \return			TRUE if results are being cached; else FALSE.
+ */
+
+osbool cache_enabled(void);
+
+
+/**
+ * Start building a new cache key.
+ *
+ * \param *key			The key to start.
+ */
+
+void cache_start_key(struct cache_key *key);
+
+
+/**
+ * Add a piece of text to a cache key, including its terminator so that
+ * consecutive pieces can't run together.
+ *
+ * \param *key			The key to update.
+ * \param *text			The text to add.
+ */
+
+void cache_add_text(struct cache_key *key, char *text);
+
+
+/**
+ * Add the remaining contents of an open file to a cache key.
+ *
+ * \param *key			The key to update.
+ * \param *file			The file to add.
+ * \return			TRUE if the file was read; else FALSE.
+ */
+
+osbool cache_add_stream(struct cache_key *key, FILE *file);
+
+
+/**
+ * Add the contents of a file to a cache key.
+ *
+ * \param *key			The key to update.
+ * \param *filename		The name of the file to add.
+ * \return			TRUE if the file was read; else FALSE.
+ */
+
+osbool cache_add_file(struct cache_key *key, char *filename);
+
+
+/**
+ * Look a conversion up in the cache and, if it is found, copy the cached
+ * PDF to the output file.
+ *
+ * \param *key			The key of the conversion.
+ * \param *output_file		The file to copy the PDF to.
+ * \return			TRUE if the PDF was copied from the cache; else FALSE.
+ */
+
+osbool cache_fetch(struct cache_key *key, char *output_file);
+
+
+/**
+ * Store the PDF from a successful conversion in the cache, discarding the
+ * least recently used results to make space for it if required.
+ *
+ * \param *key			The key of the conversion.
+ * \param *output_file		The PDF to be stored.
+ */
+
+void cache_store(struct cache_key *key, char *output_file);
+
+
+/**
+ * Read the cache's hit and miss counters.
+ *
+ * \param *hits			Pointer to a variable to take the number of
+ *				hits, or NULL.
+ * \param *misses		Pointer to a variable to take the number of
+ *				misses, or NULL.
+ */
+
+void cache_get_counters(int *hits, int *misses);
+
+#endif
+
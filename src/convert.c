@@ -47,6 +47,7 @@
 #include "oslib/dragasprite.h"
 #include "oslib/wimpspriteop.h"
 #include "oslib/osspriteop.h"
+#include "oslib/taskwindow.h"
 
 /* SF-Lib header files. */
 
@@ -68,16 +69,28 @@
 #include "convert.h"
 
 #include "api.h"
+#include "batch.h"
 #include "bookmark.h"
+#include "cache.h"
 #include "choices.h"
+#include "dsc.h"
 #include "encrypt.h"
+#include "journal.h"
 #include "main.h"
 #include "optimize.h"
 #include "paper.h"
 #include "pdfmark.h"
 #include "pmenu.h"
 #include "popup.h"
+#include "profile.h"
+#include "progress.h"
+#include "server.h"
+#include "slot.h"
+#include "stats.h"
+#include "stream.h"
+#include "validate.h"
 #include "version.h"
+#include "watcher.h"
 
 
 #define MAX_QUEUE_NAME 32
@@ -87,6 +100,39 @@
 
 #define CONVERT_COMMAND_LENGTH 1024
 
+#define MAX_TASK_NAME 32
+
+/* The length of the buffer used to assemble lines of output from child tasks. */
+
+#define CONVERT_OUTPUT_LINE 64
+
+/* The text output by gs once it has processed all of its input without error, and the PostScript to output it. */
+
+#define CONVERT_DONE_MARK "PrintPDF:Done"
+#define CONVERT_DONE_HOOK "(" CONVERT_DONE_MARK ") = flush"
+
+/* The text output after each page by ps2ps, to show that it is still working, and the PostScript to output it. */
+
+#define CONVERT_PREPROCESS_MARK "PrintPDF:PrePage"
+#define CONVERT_PREPROCESS_HOOK "<< /EndPage { exch pop dup 2 ne { (" CONVERT_PREPROCESS_MARK ") = flush } if 2 ne } >> setpagedevice"
+
+/* The length of the buffer used to describe the progress of a conversion. */
+
+#define CONVERT_PROGRESS_LENGTH 128
+
+#define CONVERT_JOURNAL_LEAF "Journal"
+
+/* The leafname, within the queue directory, of the chunks of split documents. */
+
+#define CONVERT_CHUNK_LEAF "Chunk"
+
+/**
+ * The maximum number of conversion workers which can be configured to
+ * run concurrently.
+ */
+
+#define CONVERT_MAX_WORKERS 8
+
 
 /* Save PDF Window icons. */
 
@@ -125,10 +171,13 @@
 enum conversion_state {
 	CONVERSION_STOPPED,		/**< No Conversion in action.		*/
 	CONVERSION_STARTING,		/**< Conversion ready to start.		*/
-	CONVERSION_PS2PS_PENDING,	/**< *ps2ps process is starting.	*/
-	CONVERSION_PS2PS,		/**< *ps2ps process is running.		*/
+	CONVERSION_PS2PS_PENDING,	/**< *ps2ps process for a preprocessed conversion is starting.		*/
 	CONVERSION_PS2PDF_PENDING,	/**< *ps2pdf process is starting.	*/
-	CONVERSION_PS2PDF		/**< *ps2pdf process is running.	*/
+	CONVERSION_PS2PDF,		/**< *ps2pdf process is running.	*/
+	CONVERSION_CHUNK_PENDING,	/**< *ps2pdf process for a chunk of a split document is starting.	*/
+	CONVERSION_CHUNK,		/**< *ps2pdf process for a chunk of a split document is running.	*/
+	CONVERSION_SPLIT_WAIT,		/**< Waiting for the other chunks of a split document.			*/
+	CONVERSION_RETRY_WAIT		/**< Waiting to try a conversion again after it timed out.		*/
 };
 
 /* Queue entry types. */
@@ -141,11 +190,83 @@ enum queue_type {
 	DELETED
 };
 
+/* Conversion workers. */
+
+typedef struct conversion_worker {
+	int			number;					/**< The index of the worker in the pool.			*/
+	enum conversion_state	state;					/**< The worker's progress through its conversion.		*/
+	wimp_t			task;					/**< The handle of the worker's child task, or 0 if none.	*/
+	int			api_job;				/**< The API job being converted, or 0.				*/
+	struct batch_job	*batch_job;				/**< The batch file being converted, or NULL.			*/
+
+	struct progress_tracker	progress;				/**< The progress of the worker's conversion.			*/
+	struct stats_job	stats;					/**< The timings of the worker's conversion.			*/
+	char			output_line[CONVERT_OUTPUT_LINE];	/**< The line of child task output being assembled.		*/
+	int			output_length;				/**< The length of the line of output being assembled.		*/
+	osbool			output_done;				/**< TRUE if gs has reported processing all of its input.	*/
+	char			error_text[CONVERT_OUTPUT_LINE];	/**< The first error reported by the child task, or "".		*/
+	osbool			failed;					/**< TRUE if the conversion has failed.				*/
+	int			memory;					/**< The memory given to the conversion, in Kbytes.		*/
+
+	os_t			attempt_started;			/**< The time at which the current child task was started.	*/
+	os_t			last_output;				/**< The time of the child task's most recent output.		*/
+	osbool			timed_out;				/**< TRUE if the watchdog has stopped the child task.		*/
+	osbool			retry_pending;				/**< TRUE if the conversion is to be retried when it ends.	*/
+	int			retries;				/**< The number of times the conversion has been retried.	*/
+	osbool			server_job;				/**< TRUE if the conversion is being run by the resident server.	*/
+	os_t			retry_time;				/**< The time at which a timed out conversion is retried.	*/
+
+	char			task_name[MAX_TASK_NAME];		/**< The name given to the worker's child tasks.		*/
+	wimp_t			preprocess_task;			/**< The handle of the worker's ps2ps child task, or 0 if none.	*/
+	char			preprocess_task_name[MAX_TASK_NAME];	/**< The name given to the worker's ps2ps child tasks.		*/
+	char			preprocess_line[CONVERT_OUTPUT_LINE];	/**< The line of ps2ps output being assembled.			*/
+	int			preprocess_length;			/**< The length of the line of ps2ps output being assembled.	*/
+	osbool			preprocess_done;			/**< TRUE if ps2ps has reported processing all of its input.	*/
+	char			param_file[CONVERT_MAX_FILENAME];	/**< The worker's gs parameters file.				*/
+	char			pdfmark_file[CONVERT_MAX_FILENAME];	/**< The worker's generated PDFMark file.			*/
+	char			preprocess_file[CONVERT_MAX_FILENAME];	/**< The worker's gs parameters file for ps2ps.			*/
+	char			intermediate_file[CONVERT_MAX_FILENAME];/**< The pipe passing ps2ps output on to ps2pdf.		*/
+
+	char			output_file[CONVERT_MAX_FILENAME];	/**< The PDF file being created.				*/
+	char			pdfmark_userfile[CONVERT_MAX_FILENAME];	/**< The user-supplied PDFMark file, or "" for none.		*/
+	int			preprocess_in_ps2ps;			/**< TRUE if the files are to be passed through ps2ps first.	*/
+	osbool			pdfmark_written;			/**< TRUE if the worker's PDFMark file was generated.		*/
+	struct cache_key	cache_key;				/**< The key of the conversion in the result cache.		*/
+	osbool			cache_keyed;				/**< TRUE if the conversion's result can be cached.		*/
+
+	struct profile_settings	settings;				/**< The settings, and gs switches, for the conversion.		*/
+
+	struct conversion_worker *split_owner;				/**< The worker whose document is being converted, for a helper.	*/
+	osbool			split_helper;				/**< TRUE if the worker is converting a chunk for another worker.	*/
+	int			split_chunk;				/**< The chunk of a split document being converted.		*/
+	int			split_chunks;				/**< The number of chunks the document was split into, or 0.	*/
+	int			split_pending;				/**< The number of chunks still being converted.		*/
+	osbool			split_failed;				/**< TRUE if any of the chunks failed to convert.		*/
+} conversion_worker;
+
+/**
+ * A TaskWindow output message, passing on text output by a child task.
+ */
+
+typedef struct {
+	wimp_MESSAGE_HEADER_MEMBERS
+	int			bytes;					/**< The number of bytes of output.				*/
+	char			data[232];				/**< The output.						*/
+} convert_output_message;
+
 typedef struct queued_file {
 	char			filename[MAX_QUEUE_NAME];
 	char			display_name[MAX_DISPLAY_NAME];
 	enum queue_type		object_type;
 	int			include;
+	conversion_worker	*worker;
+	struct stream_pump	*stream;
+	struct dsc_index	*dsc;
+	osbool			dsc_failed;
+	osbool			failed;
+	os_t			queued;
+	struct batch_job	*batch_job;
+	char			profile[PROFILE_MAX_NAME];
 
 	struct queued_file	*next;
 } queued_file;
@@ -154,6 +275,7 @@ typedef struct conversion_params {
 	char			input_filename[CONVERT_MAX_FILENAME];
 	char			output_filename[CONVERT_MAX_FILENAME];
 	char			pdfmark_userfile[CONVERT_MAX_FILENAME];
+	char			*profile;
 
 	int			preprocess_in_ps2ps;
 } conversion_params;
@@ -165,14 +287,41 @@ typedef struct conversion_params {
 
 static void		convert_start_held_conversion(void);
 static void		convert_open_save_dialogue(void);
-static void		convert_save_dialogue_end(char *output_file);
+static void		convert_save_dialogue_end(char *output_file, char *profile);
 static void		convert_save_dialogue_queue(void);
 
 static osbool		convert_handle_save_icon_drop(wimp_message *message);
 
-static osbool		convert_progress(conversion_params *params);
-static osbool		convert_launch_ps2ps(char *file_out);
-static osbool		convert_launch_ps2pdf(char *file_out, char *user_pdfmark_file);
+static conversion_worker	*convert_find_free_worker(int memory);
+static int			convert_estimate_memory(queued_file *entry);
+static void		convert_end_worker(conversion_worker *worker, osbool success);
+
+static osbool		convert_progress(conversion_worker *worker, conversion_params *params);
+static void		convert_start_worker_stats(conversion_worker *worker);
+static enum stats_stage	convert_get_stats_stage(enum conversion_state state);
+static osbool		convert_launch_conversion(conversion_worker *worker);
+static osbool		convert_start_child_task(conversion_worker *worker, char *command, char *name);
+static void		convert_kill_child_task(wimp_t task);
+static osbool		convert_split_document(conversion_worker *worker);
+static osbool		convert_launch_chunk(conversion_worker *worker);
+static void		convert_end_chunk(conversion_worker *owner, osbool success);
+static void		convert_stop_stalled_worker(conversion_worker *worker, char *token, int limit);
+static osbool		convert_retry_conversion(conversion_worker *worker);
+static void		convert_stitch_split_document(conversion_worker *worker);
+static void		convert_build_chunk_filename(char *buffer, size_t len, conversion_worker *owner, int chunk, osbool pdf);
+static void		convert_delete_chunks(conversion_worker *worker);
+static osbool		convert_build_cache_key(conversion_worker *worker);
+static osbool		convert_pdfmark_available(conversion_worker *worker);
+static osbool		convert_write_pdfmark(conversion_worker *worker, FILE *file);
+static osbool		convert_write_ps2ps_params(conversion_worker *worker, char *params_out, char *file_out);
+static osbool		convert_write_ps2pdf_params(conversion_worker *worker, char *file_in, char *file_out);
+static osbool		convert_submit_to_server(conversion_worker *worker);
+static void		convert_start_worker_progress(conversion_worker *worker);
+static int		convert_find_input_offset(conversion_worker *worker, int page);
+static void		convert_process_output_line(conversion_worker *worker, char *line);
+static void		convert_process_preprocess_line(conversion_worker *worker, char *line);
+static void		convert_report_progress(conversion_worker *worker);
+static void		convert_server_job_end(void *data, osbool success);
 static void		convert_cancel_conversion(void);
 
 static void		convert_save_click_handler(wimp_pointer *pointer);
@@ -189,14 +338,32 @@ static void		convert_process_encrypt_dialogue(void);
 static void		convert_process_optimize_dialogue(void);
 static void		convert_process_paper_dialogue(void);
 
-static void		convert_remove_current_conversion(void);
+static void		convert_remove_current_conversion(conversion_worker *worker);
+static void		convert_hold_failed_conversion(conversion_worker *worker);
 static void		convert_remove_deleted_files(void);
 static void		convert_remove_first_conversion(void);
 
+static osbool		convert_check_spool_file(char *check_file);
+static osbool		convert_stream_ps_file(char *filename);
+static osbool		convert_add_to_queue(char *filename, osbool consume, struct batch_job *job, char *profile);
+static queued_file	*convert_create_queue_entry(void);
+static void		convert_unlink_queue_entry(queued_file *entry);
+static osbool		convert_move_into_queue(char *filename, char *leaf, osbool consume);
+static char		*convert_build_job_filename(char *buffer, size_t len, char *queue_path, queued_file *entry);
+static void		convert_delete_queue_entry(queued_file *entry);
+static struct dsc_index	*convert_index_queue_entry(queued_file *entry);
+
+static queued_file	*convert_find_queued_file(char *leaf);
+static void		convert_replay_journal_entry(char *leaf, char *display_name, osbool held, osbool include);
+static void		convert_compact_journal(void);
+
 /* Defer queue manipulation. */
 
 static void		convert_close_queue_window(void);
 static void		convert_rebuild_queue_index(void);
+static osbool		convert_find_queue_progress(void);
+static void		convert_update_queue_progress(void);
+static void		convert_set_queue_pane_extent(void);
 static void		convert_reorder_queue_from_index(void);
 
 static void		convert_queue_pane_redraw_handler(wimp_draw *redraw);
@@ -207,6 +374,7 @@ static void		convert_terminate_queue_entry_drag(wimp_dragged *drag, void *data);
 
 static osbool		convert_check_for_conversion_start(wimp_message *message);
 static osbool		convert_check_for_conversion_end(wimp_message *message);
+static osbool		convert_check_for_conversion_output(wimp_message *message);
 
 static void		convert_decode_queue_pane_help(char *buffer, wimp_w w, wimp_i i, os_coord pos, wimp_mouse_state buttons);
 
@@ -215,13 +383,32 @@ static void		convert_decode_queue_pane_help(char *buffer, wimp_w w, wimp_i i, os
  */
 
 static queued_file	*queue = NULL;
-static osbool		conversion_in_progress = FALSE;
 static osbool		files_pending_attention = TRUE;
-static wimp_t		conversion_task = 0;
+
+/**
+ * The pool of conversion workers, each of which can run a conversion
+ * independently of the others.
+ */
+
+static conversion_worker	workers[CONVERT_MAX_WORKERS];
+
+/**
+ * The worker reserved for the files currently shown in the Save PDF
+ * dialogue, or NULL if the dialogue is not in use.
+ */
+
+static conversion_worker	*dialogue_worker = NULL;
 
 static queued_file	**queue_redraw_list = NULL;
 static int		queue_redraw_lines = 0;
 
+/**
+ * The workers whose progress is shown at the top of the queue pane.
+ */
+
+static conversion_worker	*queue_progress_list[CONVERT_MAX_WORKERS];
+static int		queue_progress_lines = 0;
+
 static osbool		dragging_sprite;
 static int		dragging_start_line;
 
@@ -256,8 +443,9 @@ static wimp_window	*convert_queue_pane_def = NULL;
 
 void convert_initialise(void)
 {
-	char			*queue_dir;
+	char			*queue_dir, number[16], journal_file[CONVERT_MAX_FILENAME];
 	fileswitch_object_type	type;
+	int			i;
 
 	/* Set up the queue directory */
 
@@ -270,6 +458,48 @@ void convert_initialise(void)
 	else if (type != fileswitch_IS_DIR)
 		error_msgs_report_error("NoQueueDir");
 
+	/* Set up the conversion workers, giving each its own files and child task name. */
+
+	for (i = 0; i < CONVERT_MAX_WORKERS; i++) {
+		workers[i].number = i;
+		workers[i].state = CONVERSION_STOPPED;
+		workers[i].task = 0;
+		workers[i].preprocess_task = 0;
+		workers[i].api_job = 0;
+		workers[i].batch_job = NULL;
+		workers[i].memory = 0;
+		workers[i].timed_out = FALSE;
+		workers[i].retry_pending = FALSE;
+		workers[i].retries = 0;
+		workers[i].server_job = FALSE;
+		workers[i].split_owner = NULL;
+		workers[i].split_helper = FALSE;
+		workers[i].split_chunks = 0;
+		workers[i].output_length = 0;
+		workers[i].output_done = FALSE;
+		*(workers[i].error_text) = '\0';
+		workers[i].failed = FALSE;
+		workers[i].cache_keyed = FALSE;
+		progress_start(&(workers[i].progress), 0, 0);
+
+		string_printf(number, sizeof(number), "%d", i);
+		msgs_param_lookup("ChildTaskName", workers[i].task_name, MAX_TASK_NAME, number, NULL, NULL, NULL);
+		msgs_param_lookup("PreTaskName", workers[i].preprocess_task_name, MAX_TASK_NAME, number, NULL, NULL, NULL);
+		string_printf(workers[i].param_file, CONVERT_MAX_FILENAME, "%s%d", config_str_read("ParamFile"), i);
+		string_printf(workers[i].pdfmark_file, CONVERT_MAX_FILENAME, "%s%d", config_str_read("PDFMarkFile"), i);
+		string_printf(workers[i].preprocess_file, CONVERT_MAX_FILENAME, "%s%dP", config_str_read("ParamFile"), i);
+		string_printf(workers[i].intermediate_file, CONVERT_MAX_FILENAME, "%s%d", config_str_read("PreProcessFile"), i);
+	}
+
+	/* Rebuild the queue from the journal left by any previous session, then compact it. */
+
+	journal_initialise(convert_build_queue_filename(journal_file, CONVERT_MAX_FILENAME, CONVERT_JOURNAL_LEAF));
+
+	if (journal_replay(convert_replay_journal_entry) > 0)
+		files_pending_attention = TRUE;
+
+	convert_compact_journal();
+
 	/* Create the windows and menus. */
 
 	popup_version = templates_get_menu("VersionMenu");
@@ -308,11 +538,13 @@ void convert_initialise(void)
 
 	event_add_message_handler(message_TASK_INITIALISE, EVENT_MESSAGE_INCOMING, convert_check_for_conversion_start);
 	event_add_message_handler(message_TASK_CLOSE_DOWN, EVENT_MESSAGE_INCOMING, convert_check_for_conversion_end);
+	event_add_message_handler(message_TASK_WINDOW_OUTPUT, EVENT_MESSAGE_INCOMING, convert_check_for_conversion_output);
 	event_add_message_handler(message_DATA_LOAD, EVENT_MESSAGE_INCOMING, convert_handle_save_icon_drop);
 
-	/* Initialise the control API. */
+	/* Initialise the control API and the resident Ghostscript server. */
 
 	api_initialise();
+	server_initialise();
 
 	/* Initialise the options. */
 
@@ -333,50 +565,140 @@ void convert_initialise(void)
  * Check the location of the 'print file' to see if one has appeared.  If it
  * has, add it to the file queue.
  *
- * Called from NULL poll events.
+ * Called from the spool watcher.
+ *
+ * \return			TRUE if a print file was taken into the queue;
+ *				else FALSE.
  */
 
-void convert_check_for_ps_file(void)
+osbool convert_check_for_ps_file(void)
 {
-	fileswitch_object_type		type;
+	static os_t			pdfmaker_check_time = 0;
+	static osbool			pdfmaker_present = FALSE;
+	os_t				now;
+	osbool				found = FALSE;
 	int				size;
 	char				check_file[CONVERT_MAX_FILENAME];
 
+	/* Print jobs are left alone during a batch, for the next desktop session to collect. */
+
+	if (batch_active())
+		return FALSE;
+
 	convert_build_queue_filename(check_file, CONVERT_MAX_FILENAME, CONVERT_QUEUE_FILENAME);
 
+	if (convert_check_spool_file(check_file))
+		found = TRUE;
+
+	/* Handle PDFMaker jobs, for compatibility with R-Comp's system.  If PDFMaker: is set up, check
+	 * to see if there is a job file called PS on the path.  The path variable is only looked up
+	 * every PDFMakerCheck centiseconds, as it rarely changes.
+	 */
+
+	now = os_read_monotonic_time();
+
+	if (now - pdfmaker_check_time >= 0) {
+		os_read_var_val_size("PDFMaker$Path", 0, 0, &size, NULL);
+		pdfmaker_present = (size != 0) ? TRUE : FALSE;
+		pdfmaker_check_time = now + config_int_read("PDFMakerCheck");
+	}
+
+	if (pdfmaker_present && convert_check_spool_file("PDFMaker:PS"))
+		found = TRUE;
+
+	return found;
+}
+
+
+/**
+ * Check a spool file location, and if a print file is there, either add it
+ * to the queue or -- if it is still being written and streaming is enabled
+ * -- start to follow it with a stream.
+ *
+ * \param *check_file		The spool file location to check.
+ * \return			TRUE if a print file was taken into the queue;
+ *				else FALSE.
+ */
+
+static osbool convert_check_spool_file(char *check_file)
+{
+	fileswitch_object_type		type;
+	int				size;
+
 	xosfile_read_stamped_no_path(check_file, &type, NULL, NULL, &size, NULL, NULL);
 
-	if (type == fileswitch_IS_FILE && size > 0 && convert_queue_ps_file(check_file))
-		xosfile_delete(check_file, NULL, NULL, NULL, NULL, NULL);
+	if (type != fileswitch_IS_FILE || size <= 0)
+		return FALSE;
 
-	/* Handle PDFMaker jobs, for compatibility with R-Comp's system.  If PDFMaker: is set up, check
-	 * to see if there is a job file called PS on the path.
+	/* If a stream is already following the file, it will be dealt with when the stream completes. */
+
+	if (stream_find(check_file) != NULL)
+		return FALSE;
+
+	/* A file which is still open can't be queued yet, so it only counts
+	 * once it has been taken.
 	 */
 
-	os_read_var_val_size("PDFMaker$Path", 0, 0, &size, NULL);
+	if (config_opt_read("StreamSpool") && stream_writer_active(check_file))
+		return convert_stream_ps_file(check_file);
+
+	return convert_queue_ps_file(check_file, TRUE);
+}
 
-	if (size != 0) {
-		string_copy(check_file, "PDFMaker:PS", CONVERT_MAX_FILENAME);
 
-		xosfile_read_stamped_no_path(check_file, &type, NULL, NULL, &size, NULL, NULL);
+/**
+ * Take the file specified, move or copy it into the queue directory with a
+ * timestamp and add it to the queue of files.
+ *
+ * If the file is to be consumed, it is renamed into the queue directory so
+ * that its contents don't have to be written out again; only if that fails,
+ * as it will if the file is on a different filing system, is it copied and
+ * then deleted.  Otherwise, the file is copied and the original left alone.
+ *
+ * \param *filename		The file to move or copy.
+ * \param consume		TRUE to move the file into the queue; FALSE to
+ *				leave the original in place.
+ * \return			TRUE if successful; else FALSE.
+ */
 
-		if (type == fileswitch_IS_FILE && size > 0 && convert_queue_ps_file(check_file))
-			xosfile_delete(check_file, NULL, NULL, NULL, NULL, NULL);
-	}
+osbool convert_queue_ps_file(char *filename, osbool consume)
+{
+	return convert_add_to_queue(filename, consume, NULL, NULL);
 }
 
 
 /**
- * Take the file specified, copy it with a timestamp and add it to the queue of files.
+ * Copy a file from a batch conversion into the queue directory and add it
+ * to the queue, to be converted without the Save PDF dialogue.
  *
  * \param *filename		The file to copy.
+ * \param *job			The batch file which it belongs to.
+ * \param *profile		The settings profile to convert it with, or
+ *				NULL to use the current settings.
  * \return			TRUE if successful; else FALSE.
  */
 
-osbool convert_queue_ps_file(char *filename)
+osbool convert_queue_batch_file(char *filename, struct batch_job *job, char *profile)
 {
-	queued_file		*new, **list = NULL;
-	char			queued_filename[CONVERT_MAX_FILENAME];
+	return convert_add_to_queue(filename, FALSE, job, profile);
+}
+
+
+/**
+ * Move or copy a file into the queue directory, and add it to the queue.
+ *
+ * \param *filename		The file to move or copy.
+ * \param consume		TRUE to move the file into the queue; FALSE to
+ *				leave the original in place.
+ * \param *job			The batch file being queued, or NULL.
+ * \param *profile		The settings profile to convert the file with,
+ *				or NULL.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool convert_add_to_queue(char *filename, osbool consume, struct batch_job *job, char *profile)
+{
+	queued_file		*new;
 	os_error		*error;
 	os_fw			file;
 
@@ -393,14 +715,182 @@ osbool convert_queue_ps_file(char *filename)
 
 	/* Allocate memory and copy the file on to the queue. */
 
-	new = malloc(sizeof(queued_file));
+	new = convert_create_queue_entry();
+
+	if (new == NULL)
+		return FALSE;
+
+	if (!convert_move_into_queue(filename, new->filename, consume)) {
+		convert_unlink_queue_entry(new);
+		free(new);
+		return FALSE;
+	}
+
+	new->batch_job = job;
+
+	if (profile != NULL)
+		string_copy(new->profile, profile, PROFILE_MAX_NAME);
+
+	journal_record_queued(new->filename);
+
+	files_pending_attention = TRUE;
+	watcher_notify_activity();
+
+	return TRUE;
+}
+
+
+/**
+ * Take a spool file which is still being written, and add it to the queue
+ * of files with a stream to follow it.  The file will be moved into the
+ * queue directory once the writer has finished with it, but a conversion
+ * can start before then by reading the data from the stream.
+ *
+ * \param *filename		The spool file to follow.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool convert_stream_ps_file(char *filename)
+{
+	queued_file		*new;
+
+	new = convert_create_queue_entry();
 
 	if (new == NULL)
 		return FALSE;
 
-	string_printf(new->filename, MAX_QUEUE_NAME, "%x", (int) os_read_monotonic_time());
+	new->stream = stream_create(filename);
+
+	if (new->stream == NULL) {
+		convert_unlink_queue_entry(new);
+		free(new);
+		return FALSE;
+	}
+
+	files_pending_attention = TRUE;
+	watcher_notify_activity();
+
+	return TRUE;
+}
+
+
+/**
+ * Pump any streams which are following spool files, passing data on to
+ * the conversions which are reading them, and move the files into the queue
+ * directory once their writers have finished.
+ *
+ * Called from NULL poll events.
+ */
+
+void convert_pump_streams(void)
+{
+	queued_file		*list, *next;
+	osbool			active = FALSE;
+
+	for (list = queue; list != NULL; list = next) {
+		next = list->next;
+
+		if (list->stream == NULL)
+			continue;
+
+		switch (stream_pump(list->stream)) {
+		case STREAM_COMPLETE:
+			/* If the file can't be moved into the queue yet, try again next time. */
+
+			if (!convert_move_into_queue(stream_get_source(list->stream), list->filename, TRUE)) {
+				active = TRUE;
+				break;
+			}
+
+			stream_destroy(list->stream);
+			list->stream = NULL;
+
+			journal_record_queued(list->filename);
+			if (list->object_type == HELD_IN_QUEUE)
+				journal_record_held(list->filename, list->display_name, list->include);
+			break;
+
+		case STREAM_FAILED:
+			/* If the stream was feeding a conversion, gs will see the end of its input as if the job
+			 * were complete, so the conversion is marked as failed to have it held; otherwise there
+			 * is nothing left to convert, so the entry goes.
+			 */
+
+			stream_abandon(list->stream);
+			list->stream = NULL;
+
+			if (list->worker != NULL) {
+				list->worker->failed = TRUE;
+
+				if (*(list->worker->error_text) == '\0')
+					msgs_lookup("StreamFailed", list->worker->error_text, CONVERT_OUTPUT_LINE);
+			} else {
+				convert_unlink_queue_entry(list);
+				convert_delete_queue_entry(list);
+				convert_rebuild_queue_index();
+
+				if (windows_get_open(convert_queue_window))
+					windows_redraw(convert_queue_pane);
+
+				error_msgs_report_error("StreamFailed");
+			}
+			break;
+
+		case STREAM_WAITING:
+		case STREAM_FLOWING:
+			active = TRUE;
+			break;
+		}
+	}
+
+	if (stream_tidy_abandoned())
+		active = TRUE;
+
+	/* Keep the watcher checking at its fastest rate while streams are live. */
+
+	if (active)
+		watcher_notify_busy();
+}
+
+
+/**
+ * Allocate a new entry at the end of the queue, with a unique leafname,
+ * awaiting attention.
+ *
+ * \return			Pointer to the new entry, or NULL on failure.
+ */
+
+static queued_file *convert_create_queue_entry(void)
+{
+	queued_file		*new, **list = NULL;
+	os_t			time;
+
+	new = malloc(sizeof(queued_file));
+
+	if (new == NULL)
+		return NULL;
+
+	/* Find a unique name for the file: the queue may hold files from before a restart, which were named
+	 * from a different run of the monotonic clock.
+	 */
+
+	time = os_read_monotonic_time();
+
+	do {
+		string_printf(new->filename, MAX_QUEUE_NAME, "%x", (int) time++);
+	} while (convert_find_queued_file(new->filename) != NULL);
+
 	*(new->display_name) = '\0';
 	new->object_type = PENDING_ATTENTION;
+	new->include = FALSE;
+	new->worker = NULL;
+	new->stream = NULL;
+	new->dsc = NULL;
+	new->dsc_failed = FALSE;
+	new->failed = FALSE;
+	new->queued = os_read_monotonic_time();
+	new->batch_job = NULL;
+	*(new->profile) = '\0';
 	new->next = NULL;
 
 	list = &queue;
@@ -410,58 +900,121 @@ osbool convert_queue_ps_file(char *filename)
 
 	*list = new;
 
-	convert_build_queue_filename(queued_filename, CONVERT_MAX_FILENAME, new->filename);
-	error = xosfscontrol_copy(filename, queued_filename, osfscontrol_COPY_FORCE, 0, 0, 0, 0, NULL);
+	return new;
+}
 
-	if (error != NULL) {
-		*list = NULL;
-		free(new);
-		return FALSE;
-	}
 
-	files_pending_attention = TRUE;
+/**
+ * Unlink an entry from the queue, without freeing it.
+ *
+ * \param *entry		The entry to unlink.
+ */
 
-	return TRUE;
+static void convert_unlink_queue_entry(queued_file *entry)
+{
+	queued_file		**list = &queue;
+
+	while (*list != NULL && *list != entry)
+		list = &((*list)->next);
+
+	if (*list != NULL)
+		*list = entry->next;
+}
+
+
+/**
+ * Move or copy a file into the queue directory.
+ *
+ * \param *filename		The file to move or copy.
+ * \param *leaf			The leafname to give the file in the queue.
+ * \param consume		TRUE to move the file; FALSE to copy it.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool convert_move_into_queue(char *filename, char *leaf, osbool consume)
+{
+	char			queued_filename[CONVERT_MAX_FILENAME];
+	os_error		*error;
+
+	convert_build_queue_filename(queued_filename, CONVERT_MAX_FILENAME, leaf);
+
+	error = (consume) ? xosfscontrol_rename(filename, queued_filename) : NULL;
+
+	if (!consume || error != NULL) {
+		error = xosfscontrol_copy(filename, queued_filename, osfscontrol_COPY_FORCE, 0, 0, 0, 0, NULL);
+
+		if (error == NULL && consume)
+			xosfile_delete(filename, NULL, NULL, NULL, NULL, NULL);
+	}
+
+	return (error == NULL) ? TRUE : FALSE;
 }
 
 
 /**
- * Test to see if there is a file queued and no conversion taking place.  If these are both true, select the next
- * pending file in the queue and open the Save PDF dialogue.
+ * Test to see if there is a file queued and a conversion worker free to take
+ * it.  If these are both true, select the next pending file in the queue and
+ * open the Save PDF dialogue.
  *
  * Called from NULL poll events.
  */
 
 void convert_check_for_pending_files(void)
 {
-	queued_file	*list;
-	char		*filename;
+	queued_file		*list, *chosen = NULL;
+	conversion_worker	*worker;
+	char			*filename, *profile;
+	int			memory;
 
 	/* We can't start a conversion if:
 	 *
 	 * - The Choices window is open (the options menus would get confused)
-	 * - There is a conversion in progress
+	 * - The Save PDF dialogue is already in use for another conversion
 	 * - There isn't anything to convert (Duh!)
+	 * - There are no conversion workers free
 	 */
 
-	if (choices_window_is_open() || conversion_in_progress || !files_pending_attention || queue == NULL)
+	if (choices_window_is_open() || dialogue_worker != NULL || !files_pending_attention || queue == NULL)
+		return;
+
+	/* Sizing the file can mean indexing it, so don't do so until there's a worker free to take it. */
+
+	if (convert_find_free_worker(0) == NULL)
+		return;
+
+	/* Size the file which will be chosen, so that it only starts if its memory will fit. */
+
+	for (list = queue; list != NULL; list = list->next) {
+		if (list->object_type == PENDING_ATTENTION && (list->batch_job != NULL || !batch_active()))
+			break;
+	}
+
+	memory = (list != NULL) ? convert_estimate_memory(list) : config_int_read("TaskMemory");
+
+	worker = convert_find_free_worker(memory);
+
+	if (worker == NULL)
 		return;
 
+	worker->memory = memory;
+
 	list = queue;
 
 	files_pending_attention = FALSE;
-	conversion_in_progress = FALSE;
 
-	/* Scan thtough the queue.  The first file PENDING_ATTENTION is turned into BEING_PROCESSED.  If there are
-	 * more files PENDING_ATTENTION, this is reflected in the files_pending_attention flag to save re-scanning
-	 * the queue each NULL Poll.
+	/* Scan thtough the queue.  The first file PENDING_ATTENTION is turned into BEING_PROCESSED and assigned
+	 * to the worker.  If there are more files PENDING_ATTENTION, this is reflected in the files_pending_attention
+	 * flag to save re-scanning the queue each NULL Poll.  While a batch is running,
+	 * only its own files are considered.
 	 */
 
 	while (list != NULL) {
-		if (list->object_type == PENDING_ATTENTION) {
-			if (!conversion_in_progress) {
+		if (list->object_type == PENDING_ATTENTION && (list->batch_job != NULL || !batch_active())) {
+			if (dialogue_worker == NULL) {
 				list->object_type = BEING_PROCESSED;
-				conversion_in_progress = TRUE;
+				list->worker = worker;
+				dialogue_worker = worker;
+				chosen = list;
 			} else {
 				files_pending_attention = TRUE;
 			}
@@ -470,15 +1023,72 @@ void convert_check_for_pending_files(void)
 		list = list->next;
 	}
 
-	/* If a file was found to convert, open the Save PDF dialogue. */
+	/* If a file was found to convert, open the Save PDF dialogue; files from
+	 * a batch or the API already know where their output is to go.
+	 */
 
-	if (conversion_in_progress) {
-		filename = api_get_filename();
+	if (chosen != NULL && chosen->batch_job != NULL) {
+		worker->batch_job = chosen->batch_job;
+		convert_save_dialogue_end(batch_get_output_filename(worker->batch_job), (*(chosen->profile) != '\0') ? chosen->profile : NULL);
+	} else if (dialogue_worker != NULL) {
+		worker->api_job = api_claim_job(&filename, &profile);
 
-		if (filename != NULL)
-			convert_save_dialogue_end(filename);
-		else
+		if (worker->api_job != 0) {
+			convert_save_dialogue_end(filename, profile);
+		} else {
 			convert_open_save_dialogue();
+		}
+	}
+}
+
+
+/**
+ * Watch over the conversions which are running.  A child task which has
+ * run for longer than JobTimeout, or which has output nothing for longer
+ * than StallTimeout, is killed -- as is the resident server, if the job
+ * is its own; conversions waiting to be retried after such a failure are
+ * restarted once their delay has passed.
+ *
+ * Called from NULL poll events.
+ */
+
+void convert_check_for_stalled_conversions(void)
+{
+	conversion_worker	*worker;
+	os_t			now;
+	int			i, job_limit, stall_limit;
+
+	now = os_read_monotonic_time();
+	job_limit = config_int_read("JobTimeout");
+	stall_limit = config_int_read("StallTimeout");
+
+	for (i = 0; i < CONVERT_MAX_WORKERS; i++) {
+		worker = &(workers[i]);
+
+		if (worker->state == CONVERSION_RETRY_WAIT && now - worker->retry_time >= 0) {
+			#ifdef DEBUG
+			debug_printf("Worker %d: retry %d", worker->number, worker->retries);
+			#endif
+
+			worker->state = CONVERSION_STARTING;
+			stats_enter_stage(&(worker->stats), STATS_STAGE_SETUP);
+
+			if (!convert_progress(worker, NULL))
+				convert_end_worker(worker, worker->output_done && !worker->failed);
+
+			continue;
+		}
+
+		if ((worker->task == 0 && worker->preprocess_task == 0 && !worker->server_job) || worker->timed_out)
+			continue;
+
+		if (worker->server_job && (int) (server_last_activity() - worker->last_output) > 0)
+			worker->last_output = server_last_activity();
+
+		if (job_limit > 0 && now - worker->attempt_started > job_limit)
+			convert_stop_stalled_worker(worker, "JobTimedOut", job_limit);
+		else if (stall_limit > 0 && now - worker->last_output > stall_limit)
+			convert_stop_stalled_worker(worker, "JobStalled", stall_limit);
 	}
 }
 
@@ -491,20 +1101,43 @@ void convert_check_for_pending_files(void)
 static void convert_start_held_conversion(void)
 {
 	queued_file		*list;
+	conversion_worker	*worker;
+	osbool			found = FALSE;
+	int			memory;
 
 	/* We can't start a conversion if:
 	 *
 	 * - The Choices window is open (the options menus would get confused)
-	 * - There is a conversion in progress
+	 * - The Save PDF dialogue is already in use for another conversion
 	 */
 
-	if (choices_window_is_open() || conversion_in_progress || queue == NULL)
+	if (choices_window_is_open() || dialogue_worker != NULL || queue == NULL)
+		return;
+
+	/* Check that there's something to convert, and that there's a worker free to convert it. */
+
+	for (list = queue; list != NULL && !found; list = list->next) {
+		if (list->object_type == HELD_IN_QUEUE && list->include == TRUE)
+			found = TRUE;
+	}
+
+	if (!found)
+		return;
+
+	memory = convert_estimate_memory(NULL);
+
+	worker = convert_find_free_worker(memory);
+
+	if (worker == NULL) {
+		error_msgs_report_info("WorkersBusy");
 		return;
+	}
+
+	worker->memory = memory;
 
 	list = queue;
 
 	files_pending_attention = FALSE;
-	conversion_in_progress = FALSE;
 
 	/* Scan thtough the queue.  The any files HELD_IN_QUEUE are turned into BEING_PROCESSED.  If there are
 	 * files PENDING_ATTENTION, this is reflected in the files_pending_attention flag to save re-scanning
@@ -517,21 +1150,102 @@ static void convert_start_held_conversion(void)
 
 		if (list->object_type == HELD_IN_QUEUE && list->include == TRUE) {
 			list->object_type = BEING_PROCESSED;
-			conversion_in_progress = TRUE;
+			list->worker = worker;
+			list->failed = FALSE;
 		}
 
 		list = list->next;
 	}
 
-	/* If a file or files were found to convert, open the Save PDF dialogue. */
+	/* Open the Save PDF dialogue for the files. */
 
-	if (conversion_in_progress)
-		convert_open_save_dialogue();
+	dialogue_worker = worker;
+	convert_open_save_dialogue();
 }
 
 
 /**
- * Open the Save PDF dialogue on screen, at the pointer.
+ * Find a conversion worker which is free to take on a new conversion.  No
+ * more than MaxConversions workers may be active at once and, beyond the
+ * first, a worker will only be offered if the memory for its child task
+ * fits alongside those already running.
+ *
+ * \param memory		The memory needed by the conversion, in Kbytes.
+ * \return			Pointer to a free worker, or NULL if none.
+ */
+
+static conversion_worker *convert_find_free_worker(int memory)
+{
+	conversion_worker	*free_worker = NULL;
+	int			i, limit, active = 0, reserved = 0;
+
+	limit = config_int_read("MaxConversions");
+
+	if (limit < 1)
+		limit = 1;
+	else if (limit > CONVERT_MAX_WORKERS)
+		limit = CONVERT_MAX_WORKERS;
+
+	for (i = 0; i < CONVERT_MAX_WORKERS; i++) {
+		if (workers[i].state != CONVERSION_STOPPED || &(workers[i]) == dialogue_worker) {
+			active++;
+			reserved += workers[i].memory;
+
+			/* The ps2ps stage of a preprocessed conversion runs alongside ps2pdf, in a task of the same size. */
+
+			if (workers[i].state == CONVERSION_PS2PS_PENDING || workers[i].preprocess_task != 0)
+				reserved += workers[i].memory;
+		} else if (free_worker == NULL)
+			free_worker = &(workers[i]);
+	}
+
+	if (free_worker == NULL || active >= limit)
+		return NULL;
+
+	if (active > 0 && !slot_fits(memory, reserved))
+		return NULL;
+
+	return free_worker;
+}
+
+
+/**
+ * Estimate the memory needed to convert a file in the queue, or all of the
+ * held files included in the next conversion, from their DSC indexes.
+ *
+ * \param *entry		The queue entry to size, or NULL to size the
+ *				included held files.
+ * \return			The memory needed, in Kbytes.
+ */
+
+static int convert_estimate_memory(queued_file *entry)
+{
+	queued_file		*list;
+	struct dsc_index	*index;
+	int			length = 0, pages = 0, fonts = 0, images = 0;
+
+	for (list = (entry != NULL) ? entry : queue; list != NULL; list = (entry != NULL) ? NULL : list->next) {
+		if (entry == NULL && (list->object_type != HELD_IN_QUEUE || list->include != TRUE))
+			continue;
+
+		/* A file which can't be indexed yet can't be sized. */
+
+		index = convert_index_queue_entry(list);
+		if (index == NULL)
+			return slot_estimate(0, 0, 0, 0);
+
+		length += dsc_get_length(index);
+		pages += dsc_get_pages(index);
+		fonts += dsc_get_fonts(index);
+		images += dsc_get_images(index);
+	}
+
+	return slot_estimate(length, pages, fonts, images);
+}
+
+
+/**
+ * Open the Save PDF dialogue on screen, at the pointer.
  */
 
 static void convert_open_save_dialogue(void)
@@ -569,11 +1283,21 @@ static void convert_open_save_dialogue(void)
  * The settings are retrieved, and a conversion process is started.
  *
  * \param *output_file		The file to save the PDF as.
+ * \param *profile		The settings profile to use, or NULL to use the
+ *				settings from the dialogue.
  */
 
-static void convert_save_dialogue_end(char *output_file)
+static void convert_save_dialogue_end(char *output_file, char *profile)
 {
 	conversion_params	params;
+	conversion_worker	*worker;
+
+	worker = dialogue_worker;
+
+	if (worker == NULL)
+		return;
+
+	dialogue_worker = NULL;
 
 	/* Sort out the filenames. */
 
@@ -582,19 +1306,14 @@ static void convert_save_dialogue_end(char *output_file)
 
 	/* Read and store the options from the window. */
 
+	params.profile = profile;
 	params.preprocess_in_ps2ps = icons_get_selected(convert_savepdf_window, SAVE_PDF_ICON_PREPROCESS);
 	string_ctrl_copy(params.pdfmark_userfile, icons_get_indirected_text_addr(convert_savepdf_window, SAVE_PDF_ICON_USERFILE), CONVERT_MAX_FILENAME);
 
 	/* Launch the conversion process. */
 
-	conversion_in_progress = convert_progress(&params);
-
-	if (!conversion_in_progress) {
-		conversion_task = 0;
-		conversion_in_progress = FALSE;
-		convert_remove_current_conversion();
-		api_notify_conversion_failure(API_FAILURE_CONVERSION);
-	}
+	if (!convert_progress(worker, &params))
+		convert_end_worker(worker, worker->output_done && !worker->failed);
 }
 
 
@@ -617,12 +1336,18 @@ static void convert_save_dialogue_queue(void)
 	list = queue;
 
 	while (list != NULL) {
-		if (list->object_type == BEING_PROCESSED) {
+		if (list->object_type == BEING_PROCESSED && list->worker == dialogue_worker) {
 			list->object_type = HELD_IN_QUEUE;
+			list->worker = NULL;
 
 			string_copy(list->display_name, leafname, MAX_DISPLAY_NAME);
 
 			list->include = TRUE;
+
+			/* Files still being streamed are journalled once they reach the queue directory. */
+
+			if (list->stream == NULL)
+				journal_record_held(list->filename, list->display_name, list->include);
 		}
 
 		list = list->next;
@@ -634,7 +1359,7 @@ static void convert_save_dialogue_queue(void)
 		windows_redraw(convert_queue_pane);
 	}
 
-	conversion_in_progress = FALSE;
+	dialogue_worker = NULL;
 }
 
 
@@ -690,332 +1415,1553 @@ static osbool convert_handle_save_icon_drop(wimp_message *message)
 /**
  * Start or progress a conversion.
  *
- * This function maintains state between calls, so it can be called to move
- * the conversion on from one stage to the next as the child tasks terminate.
+ * The state is held in the worker between calls, so this can be called to
+ * move the worker's conversion on from one stage to the next as its child
+ * tasks terminate.
  *
+ * \param *worker		The worker whose conversion is to be progressed.
  * \param *params		The parameters for the conversion to be launched,
  *				or NULL for none.
- * \return			TRUE if the conversion is complete; else FALSE.
+ * \return			TRUE if the conversion is still running; FALSE if
+ *				it has ended.
  */
 
-static osbool convert_progress(conversion_params *params)
+static osbool convert_progress(conversion_worker *worker, conversion_params *params)
 {
-	static enum conversion_state	conversion_state = CONVERSION_STOPPED;
-	static char			output_file[CONVERT_MAX_FILENAME];
-	static char			pdfmark_file[CONVERT_MAX_FILENAME];
-	static int			preprocess_in_ps2ps;
-
-	char				intermediate_file[CONVERT_MAX_FILENAME], *intermediate_leaf="inter";
-	queued_file			*list, *new, **end = NULL;
+	char				chunk_file[CONVERT_MAX_FILENAME], command[CONVERT_COMMAND_LENGTH];
+	conversion_worker		*owner;
+	struct profile_settings		*profile;
+	osbool				chunk_ok;
+	FILE				*pdfmark_file;
 	os_error			*err;
+	enum conversion_state		old_state;
 
-	/* If conversion parameters have been passed in and the conversion is stopped, reset and start a new process.
+	if (worker == NULL)
+		return FALSE;
+
+	/* If conversion parameters have been passed in and the worker is stopped, take a copy of the current
+	 * settings and start a new process.
 	 */
 
-	if (conversion_state == CONVERSION_STOPPED && params != NULL) {
-		string_copy(output_file, params->output_filename, CONVERT_MAX_FILENAME);
-		string_copy(pdfmark_file, params->pdfmark_userfile, CONVERT_MAX_FILENAME);
+	if (worker->state == CONVERSION_STOPPED && params != NULL) {
+		string_copy(worker->output_file, params->output_filename, CONVERT_MAX_FILENAME);
+		string_copy(worker->pdfmark_userfile, params->pdfmark_userfile, CONVERT_MAX_FILENAME);
+
+		worker->preprocess_in_ps2ps = params->preprocess_in_ps2ps;
+		worker->output_done = FALSE;
+		worker->failed = FALSE;
+		worker->timed_out = FALSE;
+		worker->retry_pending = FALSE;
+		worker->retries = 0;
+		worker->split_helper = FALSE;
+
+		/* A named profile has its switches compiled already; otherwise they are compiled from the
+		 * dialogue's settings, once for the whole conversion.
+		 */
+
+		if (params->profile != NULL) {
+			profile = profile_find(params->profile);
+
+			if (profile == NULL) {
+				msgs_param_lookup("ProfileMissing", worker->error_text, CONVERT_OUTPUT_LINE, params->profile, NULL, NULL, NULL);
+				worker->failed = TRUE;
+				convert_start_worker_stats(worker);
+				return FALSE;
+			}
+
+			worker->settings = *profile;
+			worker->preprocess_in_ps2ps = profile->preprocess;
+			*(worker->pdfmark_userfile) = '\0';
+		} else {
+			worker->settings.encryption = encryption;
+			worker->settings.optimization = optimization;
+			worker->settings.version = version;
+			worker->settings.paper = paper;
+			worker->settings.pdfmark = pdfmark;
+			worker->settings.preprocess = worker->preprocess_in_ps2ps;
+
+			/* The bookmarks chosen in the dialogue belong to the file being saved from it;
+			 * batch jobs, which never see the dialogue, don't get them.
+			 */
+
+			if (worker->batch_job == NULL)
+				worker->settings.bookmark = bookmark;
+			else
+				bookmark_initialise_settings(&(worker->settings.bookmark));
+
+			profile_compile(&(worker->settings));
+		}
+
+		worker->pdfmark_written = FALSE;
 
-		preprocess_in_ps2ps = params->preprocess_in_ps2ps;
+		convert_build_cache_key(worker);
 
-		conversion_state = CONVERSION_STARTING;
+		worker->state = CONVERSION_STARTING;
+		convert_start_worker_stats(worker);
 	}
 
+	old_state = worker->state;
+
 	/* The state machine to handle the steps in the process. */
 
-	switch (conversion_state) {
+	switch (worker->state) {
 	case CONVERSION_STARTING:
-		err = xosfile_create(output_file, 0xdeaddead, 0xdeaddead, 0);
+		worker->server_job = FALSE;
+		worker->preprocess_done = FALSE;
+
+		err = xosfile_create(worker->output_file, 0xdeaddead, 0xdeaddead, 0);
 
 		if (err == NULL) {
-			if (preprocess_in_ps2ps) {
-				convert_build_queue_filename(intermediate_file, CONVERT_MAX_FILENAME, intermediate_leaf);
-				conversion_state = (convert_launch_ps2ps(intermediate_file)) ? CONVERSION_PS2PS_PENDING : CONVERSION_STOPPED;
+			convert_start_worker_progress(worker);
+
+			/* If the same conversion has been done before, its result can be taken from the cache and
+			 * handled as if gs had just finished with it.
+			 */
+
+			if (worker->cache_keyed && cache_fetch(&(worker->cache_key), worker->output_file)) {
+				worker->cache_keyed = FALSE;
+				worker->output_done = TRUE;
+				worker->state = CONVERSION_PS2PDF;
+				return convert_progress(worker, NULL);
+			}
+
+			/* The PDFMark file is usually in PipeFS, so it is written afresh for every attempt: gs will have
+			 * emptied it on any earlier one.
+			 */
+
+			worker->pdfmark_written = FALSE;
+
+			if (convert_pdfmark_available(worker)) {
+				pdfmark_file = fopen(worker->pdfmark_file, "w");
+
+				if (pdfmark_file != NULL) {
+					worker->pdfmark_written = convert_write_pdfmark(worker, pdfmark_file);
+
+					if (fclose(pdfmark_file) != 0)
+						worker->pdfmark_written = FALSE;
+				}
+			}
+
+			if (convert_split_document(worker))
+				break;
+
+			if (convert_submit_to_server(worker)) {
+				worker->server_job = TRUE;
+				worker->attempt_started = os_read_monotonic_time();
+				worker->last_output = worker->attempt_started;
+				worker->state = CONVERSION_PS2PDF;
+			} else if (convert_launch_conversion(worker)) {
+				worker->state = (worker->preprocess_in_ps2ps) ? CONVERSION_PS2PS_PENDING : CONVERSION_PS2PDF_PENDING;
 			} else {
-				conversion_state = (convert_launch_ps2pdf(output_file, pdfmark_file)) ? CONVERSION_PS2PDF_PENDING : CONVERSION_STOPPED;
+				worker->state = CONVERSION_STOPPED;
 			}
 		} else {
-			error_msgs_report_error("FOpenFailed");
-			conversion_state = CONVERSION_STOPPED;
+			if (worker->batch_job == NULL)
+				error_msgs_report_error("FOpenFailed");
+			else
+				msgs_lookup("FOpenFailed", worker->error_text, CONVERT_OUTPUT_LINE);
+			worker->state = CONVERSION_STOPPED;
 		}
 		break;
 
 	case CONVERSION_PS2PS_PENDING:
-		conversion_state = CONVERSION_PS2PS;
-		break;
-
-	case CONVERSION_PS2PS:
-		list = queue;
+		/* Now that ps2ps is running, start ps2pdf to read its output.  If that fails, ps2ps is stopped and the
+		 * conversion ends once it has gone.
+		 */
 
-		while (list != NULL) {
-			if (list->object_type == BEING_PROCESSED)
-				list->object_type = DISCARDED;
+		string_printf(command, CONVERT_COMMAND_LENGTH, "gs @%s", worker->param_file);
 
-			end = &(list->next);
-			list = list->next;
+		if (convert_start_child_task(worker, command, worker->task_name)) {
+			worker->state = CONVERSION_PS2PDF_PENDING;
+		} else {
+			worker->failed = TRUE;
+			worker->state = CONVERSION_PS2PDF;
+			convert_kill_child_task(worker->preprocess_task);
 		}
+		break;
+
+	case CONVERSION_PS2PDF_PENDING:
+		worker->state = CONVERSION_PS2PDF;
+		break;
 
-		new = malloc(sizeof(queued_file));
+	case CONVERSION_CHUNK_PENDING:
+		worker->state = CONVERSION_CHUNK;
+		break;
+
+	case CONVERSION_CHUNK:
+		/* A helper hands its chunk back to the document's owner and stops; the owner waits for any chunks
+		 * which are still being converted, then stitches them all together.
+		 */
 
-		if (new != NULL) {
-			string_copy(new->filename, intermediate_leaf, MAX_QUEUE_NAME);
-			*(new->display_name) = '\0';
-			new->object_type = BEING_PROCESSED;
-			new->next = NULL;
+		convert_build_chunk_filename(chunk_file, CONVERT_MAX_FILENAME,
+				(worker->split_owner != NULL) ? worker->split_owner : worker, worker->split_chunk, TRUE);
+		chunk_ok = (worker->output_done && validate_pdf(chunk_file) == VALIDATE_OK) ? TRUE : FALSE;
 
-			if (end != NULL)
-				*end = new;
+		if (worker->split_owner != NULL) {
+			slot_record(worker->memory, chunk_ok, worker->error_text);
 
-			conversion_state = (convert_launch_ps2pdf(output_file, pdfmark_file)) ? CONVERSION_PS2PDF_PENDING : CONVERSION_STOPPED;
+			owner = worker->split_owner;
+			worker->split_owner = NULL;
+			worker->state = CONVERSION_STOPPED;
+			convert_end_chunk(owner, chunk_ok);
 		} else {
-			conversion_state = CONVERSION_STOPPED;
+			if (!chunk_ok)
+				worker->split_failed = TRUE;
+
+			worker->split_pending--;
+			worker->state = CONVERSION_SPLIT_WAIT;
+
+			if (worker->split_pending <= 0)
+				convert_stitch_split_document(worker);
 		}
 		break;
 
-	case CONVERSION_PS2PDF_PENDING:
-		conversion_state = CONVERSION_PS2PDF;
+	case CONVERSION_SPLIT_WAIT:
+		if (worker->split_pending <= 0)
+			convert_stitch_split_document(worker);
 		break;
 
 	case CONVERSION_PS2PDF:
-			osfile_set_type(output_file, dataxfer_TYPE_PDF);
+		/* Only type the output as a PDF if gs got to the end of its input -- and ps2ps to the end of its own,
+		 * if the files were preprocessed -- and what it wrote looks sound.
+		 */
+
+		if (!worker->failed && worker->output_done && (!worker->preprocess_in_ps2ps || worker->preprocess_done) &&
+				validate_pdf(worker->output_file) == VALIDATE_OK) {
+			if (worker->cache_keyed)
+				cache_store(&(worker->cache_key), worker->output_file);
 
-			if (config_opt_read("PopUpAfter"))
+			osfile_set_type(worker->output_file, dataxfer_TYPE_PDF);
+
+			if (worker->batch_job == NULL && config_opt_read("PopUpAfter"))
 				popup_open(config_int_read("PopUpTime"));
+		} else {
+			worker->failed = TRUE;
+		}
 
-			conversion_state = CONVERSION_STOPPED;
-			break;
+		worker->state = CONVERSION_STOPPED;
+		break;
+
+	case CONVERSION_RETRY_WAIT:
+		/* The retry is started by convert_check_for_stalled_conversions() once its delay has passed. */
+		break;
 
 	case CONVERSION_STOPPED:
 		break;
 	}
 
+	if (worker->state != old_state)
+		stats_enter_stage(&(worker->stats), convert_get_stats_stage(worker->state));
+
 	/* Exit, signalling FALSE if the process has ended. */
 
-	return (conversion_state != CONVERSION_STOPPED) ? TRUE : FALSE;
+	return (worker->state != CONVERSION_STOPPED) ? TRUE : FALSE;
+}
+
+
+/**
+ * Start timing a worker's conversion, from the time at which the first of
+ * its files was queued.
+ *
+ * \param *worker		The worker whose conversion is to be timed.
+ */
+
+static void convert_start_worker_stats(conversion_worker *worker)
+{
+	queued_file	*list;
+	os_t		queued, now;
+
+	queued = now = os_read_monotonic_time();
+
+	for (list = queue; list != NULL; list = list->next) {
+		if (list->object_type == BEING_PROCESSED && list->worker == worker && (int) (now - list->queued) > (int) (now - queued))
+			queued = list->queued;
+	}
+
+	stats_start_job(&(worker->stats), queued);
+}
+
+
+/**
+ * Find the statistics stage which corresponds to a conversion state.
+ *
+ * \param state			The conversion state.
+ * \return			The corresponding statistics stage.
+ */
+
+static enum stats_stage convert_get_stats_stage(enum conversion_state state)
+{
+	switch (state) {
+	case CONVERSION_STARTING:
+		return STATS_STAGE_SETUP;
+
+	case CONVERSION_PS2PS_PENDING:
+	case CONVERSION_PS2PDF_PENDING:
+	case CONVERSION_CHUNK_PENDING:
+		return STATS_STAGE_LAUNCH;
+
+	case CONVERSION_PS2PDF:
+	case CONVERSION_CHUNK:
+		return STATS_STAGE_CONVERT;
+
+	case CONVERSION_SPLIT_WAIT:
+		return STATS_STAGE_SPLIT_WAIT;
+
+	case CONVERSION_RETRY_WAIT:
+		return STATS_STAGE_QUEUE;
+
+	default:
+		return STATS_STAGE_NONE;
+	}
+}
+
+
+/**
+ * Build the result cache key for a worker's conversion, from the files in the
+ * queue and the settings which will be passed to gs.  The PDFMark data is
+ * written out again into a temporary file to be hashed, as the worker's own
+ * PDFMark file is usually in PipeFS.  Conversions of files which are still
+ * being streamed can't be cached.
+ *
+ * \param *worker		The worker to build the key for.
+ * \return			TRUE if the key was built; else FALSE.
+ */
+
+static osbool convert_build_cache_key(conversion_worker *worker)
+{
+	char		filename[CONVERT_MAX_FILENAME];
+	queued_file	*list;
+	FILE		*pdfmark_file;
+	osbool		success = TRUE;
+
+	worker->cache_keyed = FALSE;
+
+	if (!cache_enabled())
+		return FALSE;
+
+	cache_start_key(&(worker->cache_key));
+
+	cache_add_text(&(worker->cache_key), worker->settings.switches);
+	cache_add_text(&(worker->cache_key), (worker->preprocess_in_ps2ps) ? "ps2ps" : "");
+
+	for (list = queue; list != NULL && success; list = list->next) {
+		if (list->object_type != BEING_PROCESSED || list->worker != worker)
+			continue;
+
+		if (list->stream != NULL)
+			return FALSE;
+
+		convert_build_queue_filename(filename, CONVERT_MAX_FILENAME, list->filename);
+		success = cache_add_file(&(worker->cache_key), filename);
+	}
+
+	if (success && convert_pdfmark_available(worker)) {
+		pdfmark_file = tmpfile();
+
+		if (pdfmark_file != NULL) {
+			success = convert_write_pdfmark(worker, pdfmark_file);
+
+			rewind(pdfmark_file);
+			if (success)
+				success = cache_add_stream(&(worker->cache_key), pdfmark_file);
+			fclose(pdfmark_file);
+		} else {
+			success = FALSE;
+		}
+	}
+
+	if (success && *(worker->pdfmark_userfile) != '\0' &&
+			osfile_read_stamped_no_path(worker->pdfmark_userfile, NULL, NULL, NULL, NULL, NULL) == fileswitch_IS_FILE)
+		success = cache_add_file(&(worker->cache_key), worker->pdfmark_userfile);
+
+	worker->cache_keyed = success;
+
+	return success;
+}
+
+
+/**
+ * Test whether a worker's conversion has any PDFMark data to be written.
+ *
+ * \param *worker		The worker to test.
+ * \return			TRUE if there is data to write; else FALSE.
+ */
+
+static osbool convert_pdfmark_available(conversion_worker *worker)
+{
+	return (pdfmark_data_available(&(worker->settings.pdfmark)) || bookmark_data_available(&(worker->settings.bookmark))) ? TRUE : FALSE;
+}
+
+
+/**
+ * Write the PDFMark data for a worker's conversion, from its document info
+ * and the bookmarks, into a file.
+ *
+ * \param *worker		The worker to write the data for.
+ * \param *file			The file to write to.
+ * \return			TRUE if the data was written; else FALSE.
+ */
+
+static osbool convert_write_pdfmark(conversion_worker *worker, FILE *file)
+{
+	pdfmark_output	*output;
+
+	output = pdfmark_open_output(file);
+	if (output == NULL)
+		return FALSE;
+
+	pdfmark_write_docinfo(output, &(worker->settings.pdfmark));
+	bookmarks_write_pdfmark(output, &(worker->settings.bookmark));
+
+	return pdfmark_close_output(output);
+}
+
+
+/**
+ * Launch the child task for a worker's conversion.
+ *
+ * To get around command line length restrictions on RISC OS 3.x, we dump the bulk of the parameters into a file
+ * in PipeFS and pass this in to gs as a parameters file using the @ parameter.
+ *
+ * If the files are to be preprocessed, only the ps2ps stage is launched here: ps2pdf is started alongside it
+ * once it is running, reading its output through the worker's intermediate pipe as it is written, so that
+ * the document is never held in full between the two stages.
+ *
+ * \param *worker		The worker to launch the conversion for.
+ * \return			TRUE if the conversion started; else FALSE.
+ */
+
+static osbool convert_launch_conversion(conversion_worker *worker)
+{
+	char		command[CONVERT_COMMAND_LENGTH];
+
+	if (worker->preprocess_in_ps2ps) {
+		if (!convert_write_ps2ps_params(worker, worker->preprocess_file, worker->intermediate_file) ||
+				!convert_write_ps2pdf_params(worker, worker->intermediate_file, worker->output_file))
+			return FALSE;
+
+		/* Make sure that ps2pdf can't pick up anything left in the pipe by an earlier attempt. */
+
+		xosfile_delete(worker->intermediate_file, NULL, NULL, NULL, NULL, NULL);
+
+		string_printf(command, CONVERT_COMMAND_LENGTH, "gs @%s", worker->preprocess_file);
+	} else {
+		if (!convert_write_ps2pdf_params(worker, NULL, worker->output_file))
+			return FALSE;
+
+		string_printf(command, CONVERT_COMMAND_LENGTH, "gs @%s", worker->param_file);
+	}
+
+	return convert_start_child_task(worker, command, (worker->preprocess_in_ps2ps) ? worker->preprocess_task_name : worker->task_name);
+}
+
+
+/**
+ * Start a worker's child task in a TaskWindow.  The TaskWindow is given us
+ * as its parent, so that the task's output is passed back to be watched
+ * for progress reports instead of being shown in a window.
+ *
+ * \param *worker		The worker to start the task for.
+ * \param *command		The command to be run in the task.
+ * \param *name			The name to give the task.
+ * \return			TRUE if the task started; else FALSE.
+ */
+
+static osbool convert_start_child_task(conversion_worker *worker, char *command, char *name)
+{
+	char		taskwindow[CONVERT_COMMAND_LENGTH];
+	os_error	*error = NULL;
+	wimp_t		started_task = 0;
+
+	string_printf(taskwindow, CONVERT_COMMAND_LENGTH, "TaskWindow \"%s\" %dk -name \"%s\" -task &%08X -txt &%08X -quit",
+			command, (worker->memory > 0) ? worker->memory : config_int_read("TaskMemory"), name, (unsigned) main_task_handle, (unsigned) worker->number);
+
+	worker->output_length = 0;
+	worker->output_done = FALSE;
+
+	/* The ps2pdf stage of a preprocessed conversion joins an attempt which ps2ps has already started. */
+
+	if (worker->preprocess_task == 0) {
+		worker->preprocess_length = 0;
+		worker->preprocess_done = FALSE;
+		*(worker->error_text) = '\0';
+
+		worker->attempt_started = os_read_monotonic_time();
+		worker->last_output = worker->attempt_started;
+	}
+
+	#ifdef DEBUG
+	debug_printf("Command (length %d): '%s'", strlen(taskwindow), taskwindow);
+	#endif
+
+	/* Launch the conversion task. */
+
+	error = xwimp_start_task(taskwindow, &started_task);
+
+	return (error == NULL && started_task != 0) ? TRUE : FALSE;
 }
 
 
 /**
- * Launch ps2ps on the files listed in the file queue, outputting the resulting
- * PS file to the given filename.
+ * Write the gs parameters file to run ps2ps on the files assigned to a
+ * worker, outputting the resulting PS file to the given filename.
  *
+ * \param *worker		The worker to write the parameters for.
+ * \param *params_out		The name of the parameters file to write.
  * \param *file_out		The name of the output file to save to.
- * \return			TRUE if the conversion starts; else FALSE.
+ * \return			TRUE if the file was written; else FALSE.
  */
 
-static osbool convert_launch_ps2ps(char *file_out)
+static osbool convert_write_ps2ps_params(conversion_worker *worker, char *params_out, char *file_out)
 {
-	char		command[CONVERT_COMMAND_LENGTH], taskname[32];
+	char		filename[CONVERT_MAX_FILENAME];
 	queued_file	*list;
 	FILE		*param_file;
-	os_error	*error = NULL;
-	wimp_t		started_task;
 
-	msgs_lookup("ChildTaskName", taskname, sizeof(taskname));
+	param_file = fopen(params_out, "w");
+
+	if (param_file == NULL)
+		return FALSE;
+
+	/* Write all the conversion options and filename details to the gs parameters file. */
+
+	fprintf(param_file, "-dSAFER -q -dNOPAUSE -dBATCH -sDEVICE=pswrite -sOutputFile=%s -c %s -f", file_out, CONVERT_PREPROCESS_HOOK);
+
+	list = queue;
+
+	while (list != NULL) {
+		if (list->object_type == BEING_PROCESSED && list->worker == worker &&
+				convert_build_job_filename(filename, CONVERT_MAX_FILENAME, config_str_read("FileQueue"), list) != NULL)
+			fprintf(param_file, " %s", filename);
+
+		list = list->next;
+	}
+
+	/* ps2pdf will see the end of its input whether ps2ps finished or not, so ps2ps must report its own success. */
+
+	fprintf(param_file, " -c %s", CONVERT_DONE_HOOK);
+
+	return (fclose(param_file) == 0) ? TRUE : FALSE;
+}
+
+
+/**
+ * Write the gs parameters file to run ps2pdf for a worker, using the filename retrieved from the Save dialogue.
+ * This will either be at a drag end, or as a result of the user clicking 'OK' on a full filename.
+ *
+ * \param *worker		The worker to write the parameters for.
+ * \param *file_in		The file to convert, or NULL to convert the files
+ *				assigned to the worker in the queue -- or the
+ *				converted chunks, if the document was split.
+ * \param *file_out		The file to save the PDF as.
+ * \return			TRUE if the file was written; else FALSE.
+ */
+
+static osbool convert_write_ps2pdf_params(conversion_worker *worker, char *file_in, char *file_out)
+{
+	char		queue_path[4096], filename[CONVERT_MAX_FILENAME];
+	queued_file	*list;
+	FILE		*param_file;
+	int		i, queue_left;
+	os_error	*error;
+
+	/* Get a canonicalised version of the queue pathname. */
+
+	error = xosfscontrol_canonicalise_path(config_str_read("FileQueue"), queue_path, NULL, NULL, 4096, &queue_left);
+	if (error != NULL || queue_left < 0)
+		return FALSE;
+
+	/* Start to write the parameters file. */
 
-	param_file = fopen(config_str_read("ParamFile"), "w");
+	param_file = fopen(worker->param_file, "w");
+	if (param_file == NULL)
+		return FALSE;
 
-	if (param_file != NULL) {
-		/* Write all the conversion options and filename details to the gs parameters file. */
+	/* Write all the conversion options and filename details to the gs parameters file.  The pages are
+	 * reported as they are converted, except when stitching the chunks of a split document back together,
+	 * as they will already have been counted.
+	 */
 
-		fprintf(param_file, "-dSAFER -q -dNOPAUSE -dBATCH -sDEVICE=pswrite -sOutputFile=%s", file_out);
+	fprintf(param_file, "-dSAFER %s -q -dNOPAUSE -dBATCH -sDEVICE=pdfwrite "
+			"-sOutputFile=%s -c .setpdfwrite save pop %s -f",
+			worker->settings.switches, file_out, (file_in == NULL && worker->split_chunks > 0) ? "" : PROGRESS_PAGE_HOOK);
 
+	if (file_in != NULL) {
+		fprintf(param_file, " %s", file_in);
+	} else if (worker->split_chunks > 0) {
+		for (i = 0; i < worker->split_chunks; i++) {
+			convert_build_chunk_filename(filename, CONVERT_MAX_FILENAME, worker, i, TRUE);
+			fprintf(param_file, " %s", filename);
+		}
+	} else {
 		list = queue;
 
 		while (list != NULL) {
-			if (list->object_type == BEING_PROCESSED)
-				fprintf(param_file, " %s.%s", config_str_read("FileQueue"), list->filename);
+			if (list->object_type == BEING_PROCESSED && list->worker == worker &&
+					convert_build_job_filename(filename, CONVERT_MAX_FILENAME, queue_path, list) != NULL)
+				fprintf(param_file, " %s", filename);
 
 			list = list->next;
 		}
+	}
 
-		fclose(param_file);
+	/* If there is a PDFMark file, pass that in too. */
 
-		/* Write all the taskwindow command line details to the command string. */
+	if (worker->pdfmark_written)
+		fprintf(param_file, " %s", worker->pdfmark_file);
 
-		string_printf(command, CONVERT_COMMAND_LENGTH, "TaskWindow \"gs @%s\" %dk -name \"%s\" -quit",
-				config_str_read("ParamFile"), config_int_read("TaskMemory"), taskname);
+	/* If there is a PDFMark User File, pass that in too. */
+
+	if (*(worker->pdfmark_userfile) != '\0' &&
+			osfile_read_stamped_no_path(worker->pdfmark_userfile, NULL, NULL, NULL, NULL, NULL) == fileswitch_IS_FILE)
+		fprintf(param_file, " %s", worker->pdfmark_userfile);
+
+	/* gs stops at the first error, so only reports that it's done if all of the input was processed. */
+
+	fprintf(param_file, " -c %s", CONVERT_DONE_HOOK);
+
+	return (fclose(param_file) == 0) ? TRUE : FALSE;
+}
+
+
+/**
+ * Split a worker's document into chunks of pages, to be converted in
+ * parallel by as many free workers as are available.  Only documents made
+ * up of a single file which conforms to the DSC, with at least SplitPages
+ * pages per chunk, are split.
+ *
+ * If the document is split, the worker is left converting the first chunk
+ * and the other chunks are handed to helper workers; once all of the
+ * chunks have been converted, they are stitched together into the final
+ * PDF along with the document's PDFMark files.
+ *
+ * \param *worker		The worker whose document is to be split.
+ * \return			TRUE if the document was split; FALSE if it is to
+ *				be converted normally.
+ */
+
+static osbool convert_split_document(conversion_worker *worker)
+{
+	conversion_worker	*helpers[CONVERT_MAX_WORKERS], *helper;
+	queued_file		*list, *entry = NULL;
+	struct dsc_index	*index;
+	char			source[CONVERT_MAX_FILENAME], chunk_file[CONVERT_MAX_FILENAME];
+	int			i, pages, chunks, helper_count = 0, min_pages, memory = 0;
+
+	min_pages = config_int_read("SplitPages");
+
+	if (min_pages <= 0 || worker->preprocess_in_ps2ps)
+		return FALSE;
+
+	for (list = queue; list != NULL; list = list->next) {
+		if (list->object_type != BEING_PROCESSED || list->worker != worker)
+			continue;
+
+		if (entry != NULL || list->stream != NULL)
+			return FALSE;
+
+		entry = list;
+	}
+
+	if (entry == NULL)
+		return FALSE;
+
+	convert_build_queue_filename(source, CONVERT_MAX_FILENAME, entry->filename);
+
+	index = convert_index_queue_entry(entry);
+	pages = dsc_get_pages(index);
+
+	chunks = pages / min_pages;
+	if (chunks > CONVERT_MAX_WORKERS)
+		chunks = CONVERT_MAX_WORKERS;
+
+	if (chunks > 1)
+		memory = slot_estimate(dsc_get_length(index) / chunks, pages / chunks, dsc_get_fonts(index), dsc_get_images(index) / chunks);
+
+	/* Claim helpers for the extra chunks.  Each is marked as starting as it is claimed, so that it isn't
+	 * offered again and so that it counts against the limits on active workers and memory.
+	 */
+
+	while (helper_count < chunks - 1 && (helpers[helper_count] = convert_find_free_worker(memory)) != NULL) {
+		helpers[helper_count]->memory = memory;
+		helpers[helper_count++]->state = CONVERSION_STARTING;
+	}
+
+	chunks = helper_count + 1;
+
+	/* Write out the chunks, each with a copy of the document's prolog and trailer. */
+
+	worker->split_chunks = (chunks > 1) ? chunks : 0;
+
+	for (i = 0; i < worker->split_chunks; i++) {
+		convert_build_chunk_filename(chunk_file, CONVERT_MAX_FILENAME, worker, i, FALSE);
+
+		if (!dsc_write_pages(index, source, chunk_file, (i * pages) / chunks + 1, ((i + 1) * pages) / chunks))
+			break;
+	}
+
+	if (worker->split_chunks == 0 || i < worker->split_chunks) {
+		for (i = 0; i < helper_count; i++)
+			helpers[i]->state = CONVERSION_STOPPED;
+
+		convert_delete_chunks(worker);
+		return FALSE;
+	}
+
+	#ifdef DEBUG
+	debug_printf("Split %d pages into %d chunks", pages, chunks);
+	#endif
+
+	worker->split_pending = chunks;
+	worker->split_failed = FALSE;
+
+	/* Start the helpers off, then have the worker convert the first chunk itself. */
+
+	for (i = 0; i < helper_count; i++) {
+		helper = helpers[i];
+
+		helper->split_owner = worker;
+		helper->split_helper = TRUE;
+		helper->split_chunk = i + 1;
+		helper->timed_out = FALSE;
+		helper->retry_pending = FALSE;
+		helper->failed = FALSE;
+		helper->retries = 0;
+		helper->split_chunks = 0;
+		helper->api_job = 0;
+		helper->batch_job = NULL;
+		helper->preprocess_in_ps2ps = FALSE;
+		helper->pdfmark_written = FALSE;
+		*(helper->pdfmark_userfile) = '\0';
+		*(helper->output_file) = '\0';
+
+		helper->settings = worker->settings;
+
+		if (convert_launch_chunk(helper)) {
+			helper->state = CONVERSION_CHUNK_PENDING;
+		} else {
+			helper->state = CONVERSION_STOPPED;
+			helper->split_owner = NULL;
+			helper->split_helper = FALSE;
+			worker->split_failed = TRUE;
+			worker->split_pending--;
+		}
+	}
+
+	worker->split_chunk = 0;
+
+	if (convert_launch_chunk(worker)) {
+		worker->state = CONVERSION_CHUNK_PENDING;
+	} else {
+		worker->split_failed = TRUE;
+		worker->split_pending--;
+		worker->state = (worker->split_pending > 0) ? CONVERSION_SPLIT_WAIT : CONVERSION_STOPPED;
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Launch ps2pdf on a chunk of a split document.  The chunks are converted
+ * without encryption or PDFMarks, as these are applied when the chunks are
+ * stitched back together.
+ *
+ * \param *worker		The worker to launch the conversion for.
+ * \return			TRUE if the conversion started; else FALSE.
+ */
+
+static osbool convert_launch_chunk(conversion_worker *worker)
+{
+	char			chunk_in[CONVERT_MAX_FILENAME], chunk_out[CONVERT_MAX_FILENAME];
+	char			command[CONVERT_COMMAND_LENGTH];
+	conversion_worker	*owner;
+	FILE			*param_file;
+
+	owner = (worker->split_owner != NULL) ? worker->split_owner : worker;
+
+	convert_build_chunk_filename(chunk_in, CONVERT_MAX_FILENAME, owner, worker->split_chunk, FALSE);
+	convert_build_chunk_filename(chunk_out, CONVERT_MAX_FILENAME, owner, worker->split_chunk, TRUE);
+
+	param_file = fopen(worker->param_file, "w");
+	if (param_file == NULL)
+		return FALSE;
+
+	fprintf(param_file, "-dSAFER %s -q -dNOPAUSE -dBATCH -sDEVICE=pdfwrite "
+			"-sOutputFile=%s -c .setpdfwrite save pop %s -f %s -c %s",
+			worker->settings.chunk_switches, chunk_out, PROGRESS_PAGE_HOOK, chunk_in, CONVERT_DONE_HOOK);
+
+	if (fclose(param_file) != 0)
+		return FALSE;
+
+	string_printf(command, CONVERT_COMMAND_LENGTH, "gs @%s", worker->param_file);
+
+	return convert_start_child_task(worker, command, worker->task_name);
+}
+
+
+/**
+ * Called when a helper has finished converting a chunk of a split document,
+ * to pass the result back to the document's owner.  If the owner is waiting
+ * for the last of its chunks, it is moved on to the next stage.
+ *
+ * \param *owner		The worker which owns the split document.
+ * \param success		TRUE if the chunk was converted; else FALSE.
+ */
+
+static void convert_end_chunk(conversion_worker *owner, osbool success)
+{
+	if (owner == NULL)
+		return;
+
+	if (!success)
+		owner->split_failed = TRUE;
+
+	owner->split_pending--;
+
+	if (owner->state == CONVERSION_SPLIT_WAIT && owner->split_pending <= 0 && !convert_progress(owner, NULL))
+		convert_end_worker(owner, FALSE);
+}
+
+
+/**
+ * Launch ps2pdf to stitch the converted chunks of a worker's split document
+ * together into the final PDF.
+ *
+ * \param *worker		The worker whose chunks are to be stitched.
+ */
+
+static void convert_stitch_split_document(conversion_worker *worker)
+{
+	char		command[CONVERT_COMMAND_LENGTH];
+
+	if (worker->split_failed || !convert_write_ps2pdf_params(worker, NULL, worker->output_file)) {
+		worker->state = CONVERSION_STOPPED;
+		return;
+	}
+
+	string_printf(command, CONVERT_COMMAND_LENGTH, "gs @%s", worker->param_file);
+
+	worker->state = (convert_start_child_task(worker, command, worker->task_name)) ? CONVERSION_PS2PDF_PENDING : CONVERSION_STOPPED;
+}
+
+
+/**
+ * Build the filename of one of the chunks of a split document.  The name
+ * is canonicalised, so that it can be passed to gs.
+ *
+ * \param *buffer		Pointer to the buffer to hold the filename.
+ * \param len			The size of the supplied buffer.
+ * \param *owner		The worker which owns the split document.
+ * \param chunk			The number of the chunk.
+ * \param pdf			TRUE for the converted chunk; FALSE for the PostScript.
+ */
+
+static void convert_build_chunk_filename(char *buffer, size_t len, conversion_worker *owner, int chunk, osbool pdf)
+{
+	char		leaf[MAX_QUEUE_NAME], filename[CONVERT_MAX_FILENAME];
+	int		left;
+
+	string_printf(leaf, MAX_QUEUE_NAME, "%s%d_%d%s", CONVERT_CHUNK_LEAF, owner->number, chunk, (pdf) ? "P" : "");
+	convert_build_queue_filename(filename, CONVERT_MAX_FILENAME, leaf);
+
+	if (xosfscontrol_canonicalise_path(filename, buffer, NULL, NULL, len, &left) != NULL || left < 0)
+		string_copy(buffer, filename, len);
+}
+
+
+/**
+ * Delete the chunks of a worker's split document.
+ *
+ * \param *worker		The worker whose chunks are to be deleted.
+ */
+
+static void convert_delete_chunks(conversion_worker *worker)
+{
+	char		filename[CONVERT_MAX_FILENAME];
+	int		i;
+
+	for (i = 0; i < worker->split_chunks; i++) {
+		convert_build_chunk_filename(filename, CONVERT_MAX_FILENAME, worker, i, FALSE);
+		xosfile_delete(filename, NULL, NULL, NULL, NULL, NULL);
+		convert_build_chunk_filename(filename, CONVERT_MAX_FILENAME, worker, i, TRUE);
+		xosfile_delete(filename, NULL, NULL, NULL, NULL, NULL);
+	}
+
+	worker->split_chunks = 0;
+}
+
+
+/**
+ * Pass a worker's conversion to the resident Ghostscript server, if it is
+ * enabled and free.  Preprocessed conversions are always run as child
+ * tasks of their own.
+ *
+ * \param *worker		The worker whose conversion is to be passed on.
+ * \return			TRUE if the server accepted the conversion; else FALSE.
+ */
+
+static osbool convert_submit_to_server(conversion_worker *worker)
+{
+	char			queue_path[4096], filename[CONVERT_MAX_FILENAME], *job_file;
+	queued_file		*list;
+	FILE			*file;
+	int			queue_left, size, total = 0;
+	fileswitch_object_type	type;
+	os_error		*error;
+
+	if (worker->preprocess_in_ps2ps || !server_available())
+		return FALSE;
+
+	error = xosfscontrol_canonicalise_path(config_str_read("FileQueue"), queue_path, NULL, NULL, 4096, &queue_left);
+	if (error != NULL || queue_left < 0)
+		return FALSE;
+
+	job_file = config_str_read("ServerJobFile");
+
+	file = fopen(job_file, "w");
+	if (file == NULL)
+		return FALSE;
+
+	server_write_job_header(file, worker->output_file, worker->settings.switches);
+
+	/* Report each page, so that the watchdog can see that the server is still working. */
+
+	fprintf(file, "%s\n", PROGRESS_PAGE_HOOK);
+
+	for (list = queue; list != NULL; list = list->next) {
+		if (list->object_type != BEING_PROCESSED || list->worker != worker ||
+				convert_build_job_filename(filename, CONVERT_MAX_FILENAME, queue_path, list) == NULL)
+			continue;
+
+		server_write_job_input(file, filename);
+
+		if (list->stream == NULL && xosfile_read_no_path(filename, &type, NULL, NULL, &size, NULL) == NULL && type == fileswitch_IS_FILE)
+			total += size;
+	}
+
+	if (worker->pdfmark_written)
+		server_write_job_input(file, worker->pdfmark_file);
+
+	if (*(worker->pdfmark_userfile) != '\0' &&
+			osfile_read_stamped_no_path(worker->pdfmark_userfile, NULL, NULL, NULL, NULL, NULL) == fileswitch_IS_FILE)
+		server_write_job_input(file, worker->pdfmark_userfile);
+
+	server_write_job_footer(file);
+
+	if (fclose(file) != 0)
+		return FALSE;
+
+	return server_submit(job_file, total, convert_server_job_end, worker);
+}
+
+
+/**
+ * Called by the resident Ghostscript server when a worker's conversion
+ * has ended.
+ *
+ * \param *data			The worker whose conversion has ended.
+ * \param success		TRUE if the conversion succeeded; else FALSE.
+ */
+
+static void convert_server_job_end(void *data, osbool success)
+{
+	conversion_worker	*worker = data;
+
+	if (worker == NULL)
+		return;
+
+	worker->server_job = FALSE;
+
+	if (worker->state != CONVERSION_PS2PDF)
+		return;
+
+	/* The server reports success once the whole job has been run, in place of gs reporting it directly. */
+
+	worker->output_done = success;
+	convert_progress(worker, NULL);
+
+	convert_end_worker(worker, !worker->failed);
+}
+
+
+/**
+ * Start tracking the progress of a worker's conversion, taking the number
+ * of pages and the size of the input from the indexes of its files.  If
+ * any of the files couldn't be indexed, the number of pages is unknown.
+ *
+ * \param *worker		The worker whose conversion is starting.
+ */
+
+static void convert_start_worker_progress(conversion_worker *worker)
+{
+	queued_file		*list;
+	struct dsc_index	*index;
+	int			pages = 0, bytes = 0;
+	osbool			known = TRUE;
+
+	for (list = queue; list != NULL; list = list->next) {
+		if (list->object_type != BEING_PROCESSED || list->worker != worker)
+			continue;
+
+		index = convert_index_queue_entry(list);
+
+		if (index == NULL) {
+			known = FALSE;
+			continue;
+		}
+
+		pages += dsc_get_pages(index);
+		bytes += dsc_get_length(index);
+	}
+
+	progress_start(&(worker->progress), (known) ? pages : 0, bytes);
+	convert_update_queue_progress();
+}
+
+
+/**
+ * Find how much of a worker's input has been consumed once a given page
+ * has been converted, using the page offsets from the files' indexes.
+ *
+ * \param *worker		The worker to look up.
+ * \param page			The page which has been converted, counting from
+ *				1 across all of the worker's files.
+ * \return			The number of bytes consumed, or -1 if unknown.
+ */
+
+static int convert_find_input_offset(conversion_worker *worker, int page)
+{
+	queued_file		*list;
+	int			pages, base = 0;
+
+	for (list = queue; list != NULL; list = list->next) {
+		if (list->object_type != BEING_PROCESSED || list->worker != worker)
+			continue;
+
+		if (list->dsc == NULL)
+			return -1;
+
+		pages = dsc_get_pages(list->dsc);
+
+		if (page < pages)
+			return base + dsc_get_page_offset(list->dsc, page + 1);
+
+		page -= pages;
+		base += dsc_get_length(list->dsc);
+	}
+
+	return base;
+}
+
+
+/**
+ * Report the progress of a worker's conversion to the queue window and to
+ * any API client waiting for it, if a report is due.
+ *
+ * \param *worker		The worker to report on.
+ */
+
+static void convert_report_progress(conversion_worker *worker)
+{
+	struct progress_tracker	*progress = &(worker->progress);
+
+	if (!progress_report_due(progress))
+		return;
+
+	if (worker->api_job != 0)
+		api_notify_conversion_progress(worker->api_job, progress->pages_done, progress->pages_total,
+				progress->bytes_in, progress->bytes_total, progress_get_eta(progress));
+
+	convert_update_queue_progress();
+}
+
+
+/**
+ * Build the filename from which a conversion should read a queued file.
+ * Normally this is the file in the queue directory, but if the file is
+ * still being followed by a stream, the stream is attached to a pipe and
+ * the pipe is read instead.
+ *
+ * \param *buffer		Pointer to the buffer to hold the filename.
+ * \param len			The size of the supplied buffer.
+ * \param *queue_path		The pathname of the queue directory.
+ * \param *entry		The queue entry to build the filename for.
+ * \return			Pointer to the filename in the buffer, or NULL.
+ */
+
+static char *convert_build_job_filename(char *buffer, size_t len, char *queue_path, queued_file *entry)
+{
+	if (buffer == NULL || len == 0 || entry == NULL)
+		return NULL;
+
+	if (entry->stream == NULL) {
+		string_printf(buffer, len, "%s.%s", queue_path, entry->filename);
+		return buffer;
+	}
+
+	string_printf(buffer, len, "%s%s", config_str_read("StreamPipe"), entry->filename);
+
+	return (stream_attach(entry->stream, buffer)) ? buffer : NULL;
+}
+
+
+/**
+ * Process Message_TaskInitialise, to see if the task that has started has the name
+ * of our child task. If it has, make note of its handle and move the conversion
+ * state machine on a step.
+ *
+ * \param *message		The message data block.
+ * \return			FALSE to allow other claimants to see the message.
+ */
+
+static osbool convert_check_for_conversion_start(wimp_message *message)
+{
+	wimp_full_message_task_initialise	*task_initialise = (wimp_full_message_task_initialise *) message;
+	conversion_worker			*worker = NULL;
+	int					i;
+
+	if (task_initialise == NULL)
+		return FALSE;
+
+	/* Find the worker which is waiting for a child task of this name. */
+
+	for (i = 0; i < CONVERT_MAX_WORKERS && worker == NULL; i++) {
+		if (((workers[i].state == CONVERSION_PS2PDF_PENDING || workers[i].state == CONVERSION_CHUNK_PENDING) &&
+				strcmp(task_initialise->task_name, workers[i].task_name) == 0) ||
+				(workers[i].state == CONVERSION_PS2PS_PENDING &&
+				strcmp(task_initialise->task_name, workers[i].preprocess_task_name) == 0))
+			worker = &(workers[i]);
+	}
+
+	if (worker == NULL)
+		return FALSE;
+
+	if (worker->state == CONVERSION_PS2PS_PENDING)
+		worker->preprocess_task = task_initialise->sender;
+
+	/* From the pending states, the state machine only moves on to the running states; if it ever stops
+	 * here, no output can have been written, so the worker is always ended as having failed.
+	 */
+
+	if (convert_progress(worker, NULL)) {
+		if (worker->preprocess_task != task_initialise->sender)
+			worker->task = task_initialise->sender;
+	} else {
+		convert_end_worker(worker, FALSE);
+	}
+
+	return FALSE;
+}
+
+
+/**
+ * Process Message_TaskCloseDown, to see if the task that ended had the same task handle as one of the
+ * conversion workers.  If it did, reset the worker and remove its files from the queue.
+ *
+ * The ps2ps and ps2pdf tasks of a preprocessed conversion share the worker's intermediate pipe, so the
+ * conversion only ends once both have gone.  If ps2pdf fails, ps2ps is stopped so that it isn't left
+ * waiting to write to a pipe which nothing will read.
+ *
+ * \param *message		The message data block.
+ * \return			FALSE to allow other claimants to see the message.
+ */
+
+static osbool convert_check_for_conversion_end(wimp_message *message)
+{
+	conversion_worker	*worker = NULL;
+	int			i;
+
+	if (message == NULL || message->sender == 0)
+		return FALSE;
+
+	for (i = 0; i < CONVERT_MAX_WORKERS && worker == NULL; i++) {
+		if (workers[i].state != CONVERSION_STOPPED &&
+				(workers[i].task == message->sender || workers[i].preprocess_task == message->sender))
+			worker = &(workers[i]);
+	}
+
+	if (worker == NULL)
+		return FALSE;
+
+	if (worker->preprocess_task == message->sender) {
+		worker->preprocess_task = 0;
+
+		/* Unless ps2pdf has already ended, it will see the end of its input and finish on its own. */
+
+		if (worker->task != 0 || worker->state != CONVERSION_PS2PDF)
+			return FALSE;
+	} else {
+		worker->task = 0;
+
+		if (worker->preprocess_task != 0) {
+			if (!worker->output_done)
+				convert_kill_child_task(worker->preprocess_task);
+
+			return FALSE;
+		}
+	}
+
+	if (!convert_progress(worker, NULL))
+		convert_end_worker(worker, !worker->failed);
+
+	return FALSE;
+}
+
+
+/**
+ * Process Message_TaskWindow_Output, to see if it came from one of the
+ * conversion workers' child tasks.  If it did, assemble the output into
+ * lines and pass them on for processing.
+ *
+ * \param *message		The message data block.
+ * \return			TRUE if the message was handled; else FALSE.
+ */
+
+static osbool convert_check_for_conversion_output(wimp_message *message)
+{
+	convert_output_message	*output = (convert_output_message *) message;
+	conversion_worker	*worker = NULL;
+	int			i;
+	char			c;
+
+	if (output == NULL || output->sender == 0)
+		return FALSE;
+
+	for (i = 0; i < CONVERT_MAX_WORKERS && worker == NULL; i++) {
+		if (workers[i].state != CONVERSION_STOPPED &&
+				(workers[i].task == output->sender || workers[i].preprocess_task == output->sender))
+			worker = &(workers[i]);
+	}
+
+	if (worker == NULL)
+		return FALSE;
+
+	worker->last_output = os_read_monotonic_time();
+
+	/* The output of ps2ps is assembled separately, as it can arrive between lines from ps2pdf. */
+
+	if (worker->preprocess_task == output->sender) {
+		for (i = 0; i < output->bytes && i < sizeof(output->data); i++) {
+			c = output->data[i];
+
+			if (c == '\n' || c == '\r') {
+				worker->preprocess_line[worker->preprocess_length] = '\0';
+				convert_process_preprocess_line(worker, worker->preprocess_line);
+				worker->preprocess_length = 0;
+			} else if (worker->preprocess_length < CONVERT_OUTPUT_LINE - 1) {
+				worker->preprocess_line[worker->preprocess_length++] = c;
+			}
+		}
+
+		return TRUE;
+	}
+
+	for (i = 0; i < output->bytes && i < sizeof(output->data); i++) {
+		c = output->data[i];
+
+		if (c == '\n' || c == '\r') {
+			worker->output_line[worker->output_length] = '\0';
+			convert_process_output_line(worker, worker->output_line);
+			worker->output_length = 0;
+		} else if (worker->output_length < CONVERT_OUTPUT_LINE - 1) {
+			worker->output_line[worker->output_length++] = c;
+		}
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Process a line of output from a worker's child task.  Page marks are
+ * credited to the worker converting the document, which for the chunk
+ * of a split document is the document's owner.
+ *
+ * \param *worker		The worker whose task output the line.
+ * \param *line			The line to process.
+ */
+
+static void convert_process_output_line(conversion_worker *worker, char *line)
+{
+	conversion_worker	*owner;
+	int			bytes_in;
+
+	if (strcmp(line, CONVERT_DONE_MARK) == 0) {
+		worker->output_done = TRUE;
+		return;
+	}
+
+	/* Keep the first error reported, to explain any failure. */
+
+	if (strcmp(line, PROGRESS_PAGE_MARK) != 0) {
+		#ifdef DEBUG
+		debug_printf("Worker %d: %s", worker->number, line);
+		#endif
+
+		if (*(worker->error_text) == '\0' && (strncmp(line, "Error", 5) == 0 || strstr(line, "rror:") != NULL))
+			string_copy(worker->error_text, line, CONVERT_OUTPUT_LINE);
+
+		return;
+	}
+
+	owner = (worker->split_owner != NULL) ? worker->split_owner : worker;
+
+	/* The chunks of a split document are converted in parallel, so the input can only be estimated. */
+
+	bytes_in = (owner->split_chunks > 0) ? -1 : convert_find_input_offset(owner, owner->progress.pages_done + 1);
+
+	progress_add_page(&(owner->progress), bytes_in);
+	convert_report_progress(owner);
+}
+
+
+/**
+ * Process a line of output from a worker's ps2ps child task.  Its pages
+ * are converted again by ps2pdf, so are only counted then.
+ *
+ * \param *worker		The worker whose task output the line.
+ * \param *line			The line to process.
+ */
+
+static void convert_process_preprocess_line(conversion_worker *worker, char *line)
+{
+	if (strcmp(line, CONVERT_DONE_MARK) == 0) {
+		worker->preprocess_done = TRUE;
+		return;
+	}
 
-		/* Launch the conversion task. */
+	if (strcmp(line, CONVERT_PREPROCESS_MARK) == 0)
+		return;
 
-		error = xwimp_start_task(command, &started_task);
-	}
+	#ifdef DEBUG
+	debug_printf("Worker %d: ps2ps: %s", worker->number, line);
+	#endif
 
-	return (error == NULL && started_task != 0) ? TRUE : FALSE;
+	if (*(worker->error_text) == '\0' && (strncmp(line, "Error", 5) == 0 || strstr(line, "rror:") != NULL))
+		string_copy(worker->error_text, line, CONVERT_OUTPUT_LINE);
 }
 
 
 /**
- * Launch ps2pdf, using the file at the top of the queue and the filename retrieved from the Save dialogue.
- * This will either be at a drag end, or as a result of the user clicking 'OK' on a full filename.
- *
- * To get around command line length restrictions on RISC OS 3.x, we dump the bulk of the parameters into a file
- * in PipeFS and pass this in to gs as a parameters file using the @ parameter.
+ * Tidy up after a worker's conversion has ended, removing its files from
+ * the queue and notifying any API client of the outcome.
  *
- * \param *file_out		The file to save the PDF as.
- * \param *user_pdfmark_file	A user-supplied PDFMark file's pathname, if required.
- * \return			TRUE if the conversion started; else FALSE.
+ * \param *worker		The worker whose conversion has ended.
+ * \param success		TRUE if the conversion succeeded; else FALSE.
  */
 
-static osbool convert_launch_ps2pdf(char *file_out, char *user_pdfmark_file)
+static void convert_end_worker(conversion_worker *worker, osbool success)
 {
-	char		command[CONVERT_COMMAND_LENGTH], taskname[32], encrypt_buf[1024], optimize_buf[1024], version_buf[1024], paper_buf[1024], queue_path[4096];
-	queued_file	*list;
-	FILE		*param_file, *pdfmark_file;
-	int		queue_left;
-	os_error	*error = NULL;
-	wimp_t		started_task;
+	fileswitch_object_type	type;
+	int			size;
+	conversion_worker	*owner;
 
-	/* Get a canonicalised version of the queue pathname. */
+	if (worker == NULL)
+		return;
 
-	error = xosfscontrol_canonicalise_path(config_str_read("FileQueue"), queue_path, NULL, NULL, 4096, &queue_left);
-	if (error != NULL || queue_left < 0)
-		return FALSE;
+	/* A helper's chunk belongs to its owner, which keeps the stats and
+	 * handles the queue.  If the chunk wasn't handed back before the child
+	 * task went away, then it has failed.
+	 */
 
-	/* Find the name to use for the child task. */
+	if (worker->split_helper) {
+		worker->split_helper = FALSE;
+		worker->state = CONVERSION_STOPPED;
+		worker->task = 0;
 
-	msgs_lookup("ChildTaskName", taskname, sizeof(taskname));
+		if (worker->split_owner != NULL) {
+			owner = worker->split_owner;
+			worker->split_owner = NULL;
+			convert_end_chunk(owner, FALSE);
+		}
 
-	/* Start to write the parameters file. */
+		watcher_notify_activity();
+		return;
+	}
 
-	param_file = fopen(config_str_read("ParamFile"), "w");
-	if (param_file != NULL) {
-		/* Generate a PDFMark file if necessary. */
+	if (!success && worker->retry_pending && convert_retry_conversion(worker))
+		return;
 
-		if (pdfmark_data_available(&pdfmark) || bookmark_data_available(&bookmark)) {
-			pdfmark_file = fopen (config_str_read ("PDFMarkFile"), "w");
+	worker->state = CONVERSION_STOPPED;
+	worker->task = 0;
 
-			if (pdfmark_file != NULL) {
-				pdfmark_write_docinfo_file(pdfmark_file, &pdfmark);
-				bookmarks_write_pdfmark_out_file(pdfmark_file, &bookmark);
+	if (!success || xosfile_read_no_path(worker->output_file, &type, NULL, NULL, &size, NULL) != NULL || type != fileswitch_IS_FILE)
+		size = 0;
 
-				fclose(pdfmark_file);
-			}
-		}
+	stats_end_job(&(worker->stats), worker->progress.bytes_total, size, success);
+	slot_record(worker->memory, success, worker->error_text);
 
-		/* Write all the conversion options and filename details to the gs parameters file. */
+	/* Failed files from a batch are listed in its report, so they aren't held. */
 
-		version_build_params(version_buf, sizeof(version_buf), &version);
-		optimize_build_params(optimize_buf, sizeof(optimize_buf), &optimization);
-		encryption_build_params(encrypt_buf, sizeof(encrypt_buf), &encryption, version.standard_version >= 2);
-		paper_build_params(paper_buf, sizeof(paper_buf), &paper);
+	if (success) {
+		convert_remove_current_conversion(worker);
+	} else if (worker->batch_job != NULL) {
+		convert_remove_current_conversion(worker);
+		xosfile_delete(worker->output_file, NULL, NULL, NULL, NULL, NULL);
+	} else {
+		convert_hold_failed_conversion(worker);
+	}
 
-		fprintf(param_file, "-dSAFER %s%s%s%s -q -dNOPAUSE -dBATCH -sDEVICE=pdfwrite "
-				"-sOutputFile=%s -c .setpdfwrite save pop -f",
-				version_buf, optimize_buf, encrypt_buf, paper_buf, file_out);
+	if (worker->preprocess_in_ps2ps)
+		xosfile_delete(worker->intermediate_file, NULL, NULL, NULL, NULL, NULL);
 
-		list = queue;
+	if (worker->split_chunks > 0)
+		convert_delete_chunks(worker);
 
-		while (list != NULL) {
-			if (list->object_type == BEING_PROCESSED)
-				fprintf(param_file, " %s.%s", queue_path, list->filename);
+	if (worker->api_job != 0) {
+		if (success)
+			api_notify_conversion_success(worker->api_job);
+		else
+			api_notify_conversion_failure(worker->api_job, API_FAILURE_CONVERSION);
+	}
 
-			list = list->next;
-		}
+	worker->api_job = 0;
+
+	if (worker->batch_job != NULL) {
+		batch_notify_conversion_end(worker->batch_job, success, worker->error_text);
+		worker->batch_job = NULL;
+	}
+
+	convert_update_queue_progress();
 
-		/* If there is a PDFMark file, pass that in too. */
+	/* Make sure that any jobs waiting for a free worker are picked up promptly. */
+
+	watcher_notify_activity();
+}
 
-		if (osfile_read_stamped_no_path(config_str_read("PDFMarkFile"), NULL, NULL, NULL, NULL, NULL) == fileswitch_IS_FILE)
-			fprintf(param_file, " %s", config_str_read("PDFMarkFile"));
 
-		/* If there is a PDFMark User File, pass that in too. */
+/**
+ * Kill the child task of a conversion which has run for too long, so that
+ * the conversion fails and can be retried.  For the chunk of a split
+ * document, the whole document is retried; for a conversion being run by
+ * the resident server, the server is closed down.
+ *
+ * \param *worker		The worker whose task is to be killed.
+ * \param *token		The message token describing the timeout.
+ * \param limit			The limit which was exceeded, in centiseconds.
+ */
 
-		if (*user_pdfmark_file != '\0' &&
-				osfile_read_stamped_no_path(user_pdfmark_file, NULL, NULL, NULL, NULL, NULL) == fileswitch_IS_FILE)
-			fprintf(param_file, " %s", user_pdfmark_file);
+static void convert_stop_stalled_worker(conversion_worker *worker, char *token, int limit)
+{
+	char		seconds[16];
 
-		fclose(param_file);
+	if (worker == NULL || (worker->task == 0 && worker->preprocess_task == 0 && !worker->server_job))
+		return;
 
-		/* Write all the taskwindow command line details to the command string. */
+	if (worker->server_job && !server_abort())
+		return;
 
-		string_printf(command, CONVERT_COMMAND_LENGTH, "TaskWindow \"gs @%s\" %dk -name \"%s\" -quit",
-				config_str_read("ParamFile"), config_int_read("TaskMemory"), taskname);
+	string_printf(seconds, sizeof(seconds), "%d", limit / 100);
+	msgs_param_lookup(token, worker->error_text, CONVERT_OUTPUT_LINE, seconds, NULL, NULL, NULL);
 
-		#ifdef DEBUG
-		debug_printf("Command (length %d): '%s'", strlen(command), command);
-		#endif
+	#ifdef DEBUG
+	debug_printf("Worker %d: %s", worker->number, worker->error_text);
+	#endif
 
-		/* Launch the conversion task. */
+	worker->timed_out = TRUE;
+	worker->retry_pending = TRUE;
 
-		error = xwimp_start_task(command, &started_task);
+	/* The owner's own chunk is still watched, so only its retry is recorded. */
+
+	if (worker->split_owner != NULL) {
+		worker->split_owner->retry_pending = TRUE;
+
+		if (*(worker->split_owner->error_text) == '\0')
+			string_copy(worker->split_owner->error_text, worker->error_text, CONVERT_OUTPUT_LINE);
 	}
 
-	return (error == NULL && started_task != 0) ? TRUE : FALSE;
+	convert_kill_child_task(worker->task);
+	convert_kill_child_task(worker->preprocess_task);
 }
 
 
 /**
- * Process Message_TaskInitialise, to see if the task that has started has the name
- * of our child task. If it has, make note of its handle and move the conversion
- * state machine on a step.
+ * Kill a child task, by asking its TaskWindow to close down.
  *
- * \param *message		The message data block.
- * \return			FALSE to allow other claimants to see the message.
+ * \param task			The child task to kill, or 0 for none.
  */
 
-static osbool convert_check_for_conversion_start(wimp_message *message)
+static void convert_kill_child_task(wimp_t task)
 {
-	char	taskname[32];
-	wimp_full_message_task_initialise *task_initialise = (wimp_full_message_task_initialise *) message;
-
-	/* Find the name to use for the child task. */
+	wimp_message	message;
 
-	msgs_lookup("ChildTaskName", taskname, sizeof(taskname));
-
-	if (task_initialise == NULL || strcmp(task_initialise->task_name, taskname) != 0)
-		return FALSE;
+	if (task == 0)
+		return;
 
-	if (convert_progress(NULL)) {
-		conversion_task = task_initialise->sender;
-	} else {
-		conversion_task = 0;
-		conversion_in_progress = FALSE;
-		convert_remove_current_conversion();
-		api_notify_conversion_failure(API_FAILURE_CONVERSION);
-//FIXME - conversion failed? Or could it have completed here?
-	}
+	message.size = 20;
+	message.your_ref = 0;
+	message.action = message_TASK_WINDOW_MORITE;
 
-	return FALSE;
+	xwimp_send_message(wimp_USER_MESSAGE, &message, task);
 }
 
 
 /**
- * Process Message_TaskCloseDown, to see if the task that ended had the same task handle as the current
- * conversion task.  If it did, establish what kind of conversion was underway:
+ * Set a conversion which was stopped by the watchdog to be tried again,
+ * after a delay which doubles with each attempt.  Conversions which have
+ * run out of retries, or which were reading from a stream, fail as normal.
  *
- * - If it was *ps2ps, take the intermediate file and pass it on to *ps2pdf.
- * - If it was *ps2pdf, reset the flags and take the original queued object from the queue head.
- *
- * \param *message		The message data block.
- * \return			FALSE to allow other claimants to see the message.
+ * \param *worker		The worker whose conversion is to be retried.
+ * \return			TRUE if the conversion will be retried; else FALSE.
  */
 
-static osbool convert_check_for_conversion_end(wimp_message *message)
+static osbool convert_retry_conversion(conversion_worker *worker)
 {
-	if (message != NULL && message->sender == conversion_task && !convert_progress(NULL)) {
-		conversion_task = 0;
-		conversion_in_progress = FALSE;
-		convert_remove_current_conversion();
-		api_notify_conversion_success();
-//FIXME conversion finished. Is it successful? send message if necessary
+	queued_file	*list;
+	int		delay;
+
+	if (worker == NULL || worker->split_owner != NULL || worker->retries >= config_int_read("JobRetries"))
+		return FALSE;
+
+	for (list = queue; list != NULL; list = list->next) {
+		if (list->object_type == BEING_PROCESSED && list->worker == worker && list->stream != NULL)
+			return FALSE;
 	}
 
-	return FALSE;
+	if (worker->split_chunks > 0) {
+		convert_delete_chunks(worker);
+		worker->split_chunks = 0;
+	}
+
+	delay = config_int_read("RetryDelay");
+
+	if (worker->retries < 16)
+		delay <<= worker->retries;
+
+	worker->retries++;
+	worker->retry_time = os_read_monotonic_time() + delay;
+	worker->timed_out = FALSE;
+	worker->retry_pending = FALSE;
+	worker->failed = FALSE;
+	worker->task = 0;
+	worker->state = CONVERSION_RETRY_WAIT;
+
+	stats_enter_stage(&(worker->stats), STATS_STAGE_QUEUE);
+
+	#ifdef DEBUG
+	debug_printf("Worker %d: retrying in %d cs (%s)", worker->number, delay, worker->error_text);
+	#endif
+
+	return TRUE;
 }
 
 
 /**
- * Called to cancel the conversion that is being set up.  Reset the flags,
- * close the window and remove the item from the queue.
+ * Called to cancel the conversion that is being set up.  Release the
+ * dialogue's worker, close the window and remove the item from the queue.
  */
 
 static void convert_cancel_conversion(void)
 {
 	wimp_close_window(convert_savepdf_window);
-	conversion_task = 0;
-	conversion_in_progress = FALSE;
 
-	convert_remove_current_conversion();
+	if (dialogue_worker == NULL)
+		return;
+
+	convert_remove_current_conversion(dialogue_worker);
+	dialogue_worker->api_job = 0;
+	dialogue_worker = NULL;
 }
 
 
@@ -1221,7 +3167,7 @@ static osbool convert_immediate_window_save(void)
 		return FALSE;
 	}
 
-	convert_save_dialogue_end(filename);
+	convert_save_dialogue_end(filename, NULL);
 
 	wimp_close_window(convert_savepdf_window);
 
@@ -1257,7 +3203,7 @@ static void convert_drag_end_handler(wimp_pointer *pointer, void *data)
 
 static osbool convert_drag_end_save_handler(char *filename, void *data)
 {
-	convert_save_dialogue_end(filename);
+	convert_save_dialogue_end(filename, NULL);
 	wimp_close_window(convert_savepdf_window);
 
 	return TRUE;
@@ -1313,30 +3259,90 @@ static void convert_process_paper_dialogue(void)
 
 
 /**
- * Remove the current item or items from the queue, deleting them from the
- * Scrap directory.
+ * Remove the items belonging to a worker from the queue, deleting them from
+ * the Scrap directory.
+ *
+ * \param *worker		The worker whose items are to be removed.
  */
 
-static void convert_remove_current_conversion(void)
+static void convert_remove_current_conversion(conversion_worker *worker)
 {
 	queued_file		**list, *old;
-	char			old_file[CONVERT_MAX_FILENAME];
 
 	list = &queue;
 
 	while (*list != NULL) {
-		if ((*list)->object_type == BEING_PROCESSED || (*list)->object_type == DISCARDED) {
+		if (((*list)->object_type == BEING_PROCESSED || (*list)->object_type == DISCARDED) && (*list)->worker == worker) {
 			old = (*list);
-			convert_build_queue_filename(old_file, CONVERT_MAX_FILENAME, old->filename);
-			xosfile_delete(old_file, NULL, NULL, NULL, NULL, NULL);
+			*list = ((*list)->next);
+
+			convert_delete_queue_entry(old);
+		} else {
+			list = &((*list)->next);
+		}
+	}
+
+	if (journal_needs_compaction())
+		convert_compact_journal();
+}
+
+
+/**
+ * Return the items belonging to a worker whose conversion has failed to the
+ * queue as held files, so that they can be converted again, and report the
+ * failure to the user.  Any incomplete output is deleted.
+ *
+ * \param *worker		The worker whose items are to be held.
+ */
+
+static void convert_hold_failed_conversion(conversion_worker *worker)
+{
+	char			*leafname;
+	queued_file		**list, *old;
+
+	leafname = string_find_leafname(worker->output_file);
+
+	list = &queue;
 
+	while (*list != NULL) {
+		if ((*list)->object_type == DISCARDED && (*list)->worker == worker) {
+			old = (*list);
 			*list = ((*list)->next);
 
-			free(old);
+			convert_delete_queue_entry(old);
 		} else {
+			if ((*list)->object_type == BEING_PROCESSED && (*list)->worker == worker) {
+				(*list)->object_type = HELD_IN_QUEUE;
+				(*list)->worker = NULL;
+				(*list)->include = TRUE;
+				(*list)->failed = TRUE;
+
+				string_copy((*list)->display_name, leafname, MAX_DISPLAY_NAME);
+
+				/* A stream's data is no longer wanted by the conversion, but the file is kept
+				 * once the writer has finished with it.
+				 */
+
+				if ((*list)->stream == NULL)
+					journal_record_held((*list)->filename, (*list)->display_name, (*list)->include);
+				else
+					stream_detach((*list)->stream);
+			}
+
 			list = &((*list)->next);
 		}
 	}
+
+	if (worker->api_job == 0)
+		error_msgs_param_report_error("ConvertFailed", leafname, worker->error_text, NULL, NULL);
+
+	xosfile_delete(worker->output_file, NULL, NULL, NULL, NULL, NULL);
+
+	if (windows_get_open(convert_queue_window)) {
+		convert_reorder_queue_from_index();
+		convert_rebuild_queue_index();
+		windows_redraw(convert_queue_pane);
+	}
 }
 
 
@@ -1347,19 +3353,15 @@ static void convert_remove_current_conversion(void)
 static void convert_remove_deleted_files(void)
 {
 	queued_file	**list, *old;
-	char		old_file[CONVERT_MAX_FILENAME];
 
 	list = &queue;
 
 	while (*list != NULL) {
 		if ((*list)->object_type == DELETED) {
 			old = (*list);
-			convert_build_queue_filename(old_file, CONVERT_MAX_FILENAME, old->filename);
-			xosfile_delete(old_file, NULL, NULL, NULL, NULL, NULL);
-
 			*list = ((*list)->next);
 
-			free(old);
+			convert_delete_queue_entry(old);
 		} else {
 			list = &((*list)->next);
 		}
@@ -1374,14 +3376,11 @@ static void convert_remove_deleted_files(void)
 void convert_remove_first_conversion(void)
 {
 	queued_file	*old;
-	char		old_file[CONVERT_MAX_FILENAME];
 
 	old = queue;
-	convert_build_queue_filename(old_file, CONVERT_MAX_FILENAME, old->filename);
-	xosfile_delete(old_file, NULL, NULL, NULL, NULL, NULL);
-
 	queue = old->next;
-	free(old);
+
+	convert_delete_queue_entry(old);
 }
 
 
@@ -1393,6 +3392,158 @@ void convert_remove_all_remaining_conversions(void)
 {
 	while (queue != NULL)
 		convert_remove_first_conversion();
+
+	convert_compact_journal();
+}
+
+
+/**
+ * Delete an entry which has been unlinked from the queue, along with its
+ * file in the Scrap directory.  If the entry's file is still being followed
+ * by a stream, the stream is abandoned so that the spool file is deleted
+ * once its writer has finished.
+ *
+ * \param *entry		The entry to delete.
+ */
+
+static void convert_delete_queue_entry(queued_file *entry)
+{
+	char		old_file[CONVERT_MAX_FILENAME];
+
+	if (entry == NULL)
+		return;
+
+	if (entry->stream != NULL) {
+		stream_abandon(entry->stream);
+	} else {
+		convert_build_queue_filename(old_file, CONVERT_MAX_FILENAME, entry->filename);
+		xosfile_delete(old_file, NULL, NULL, NULL, NULL, NULL);
+		dsc_delete_cache(old_file);
+		journal_record_removed(entry->filename);
+	}
+
+	dsc_free(entry->dsc);
+	free(entry);
+}
+
+
+/**
+ * Return the DSC index of a file in the queue, loading it from the index
+ * cache beside the file, or indexing the file and creating the cache, if
+ * this hasn't already been done.  Files still being followed by a stream
+ * can't be indexed until their writers have finished, and files which
+ * couldn't be indexed aren't tried again.
+ *
+ * \param *entry		The queue entry to index.
+ * \return			Pointer to the index, or NULL if the file
+ *				couldn't be indexed.
+ */
+
+static struct dsc_index *convert_index_queue_entry(queued_file *entry)
+{
+	char		filename[CONVERT_MAX_FILENAME];
+
+	if (entry == NULL || entry->stream != NULL || entry->dsc_failed)
+		return NULL;
+
+	if (entry->dsc == NULL) {
+		convert_build_queue_filename(filename, CONVERT_MAX_FILENAME, entry->filename);
+		entry->dsc = dsc_load(filename);
+
+		if (entry->dsc == NULL)
+			entry->dsc_failed = TRUE;
+	}
+
+	return entry->dsc;
+}
+
+
+/**
+ * Find a file in the queue.
+ *
+ * \param *leaf			The leafname of the file to find.
+ * \return			Pointer to the queue entry, or NULL if not found.
+ */
+
+static queued_file *convert_find_queued_file(char *leaf)
+{
+	queued_file	*list = queue;
+
+	while (list != NULL && strcmp(list->filename, leaf) != 0)
+		list = list->next;
+
+	return list;
+}
+
+
+/**
+ * Callback to receive entries from the queue journal on startup, and add
+ * them to the end of the queue.
+ *
+ * \param *leaf			The leafname of the queued file.
+ * \param *display_name		The name shown in the queue, or "" if none.
+ * \param held			TRUE if the file was held in the queue.
+ * \param include		TRUE if a held file was selected for conversion.
+ */
+
+static void convert_replay_journal_entry(char *leaf, char *display_name, osbool held, osbool include)
+{
+	queued_file	*new, **list;
+
+	if (leaf == NULL || convert_find_queued_file(leaf) != NULL)
+		return;
+
+	new = malloc(sizeof(queued_file));
+	if (new == NULL)
+		return;
+
+	string_copy(new->filename, leaf, MAX_QUEUE_NAME);
+	string_copy(new->display_name, (display_name != NULL) ? display_name : "", MAX_DISPLAY_NAME);
+	new->object_type = (held) ? HELD_IN_QUEUE : PENDING_ATTENTION;
+	new->include = include;
+	new->worker = NULL;
+	new->stream = NULL;
+	new->dsc = NULL;
+	new->dsc_failed = FALSE;
+	new->failed = FALSE;
+	new->queued = os_read_monotonic_time();
+	new->batch_job = NULL;
+	*(new->profile) = '\0';
+	new->next = NULL;
+
+	list = &queue;
+
+	while (*list != NULL)
+		list = &((*list)->next);
+
+	*list = new;
+}
+
+
+/**
+ * Compact the queue journal, replacing it with a snapshot of the files
+ * currently in the queue.  Files which were being converted are recorded as
+ * awaiting attention, so that they will be offered again after a restart;
+ * files still being followed by streams aren't in the queue directory yet,
+ * so are left out.
+ */
+
+static void convert_compact_journal(void)
+{
+	queued_file	*list;
+
+	if (!journal_start_compaction())
+		return;
+
+	for (list = queue; list != NULL; list = list->next) {
+		if (list->stream != NULL)
+			continue;
+
+		journal_compact_entry(list->filename, list->display_name,
+				(list->object_type == HELD_IN_QUEUE || list->object_type == DELETED) ? TRUE : FALSE, list->include);
+	}
+
+	journal_end_compaction();
 }
 
 
@@ -1404,7 +3555,17 @@ void convert_remove_all_remaining_conversions(void)
 
 osbool convert_pdf_conversion_in_progress(void)
 {
-	return conversion_in_progress;
+	int	i;
+
+	if (dialogue_worker != NULL)
+		return TRUE;
+
+	for (i = 0; i < CONVERT_MAX_WORKERS; i++) {
+		if (workers[i].state != CONVERSION_STOPPED)
+			return TRUE;
+	}
+
+	return FALSE;
 }
 
 
@@ -1446,6 +3607,7 @@ static void convert_close_queue_window(void)
 {
 	convert_reorder_queue_from_index();
 	convert_remove_deleted_files();
+	convert_compact_journal();
 	wimp_close_window(convert_queue_window);
 }
 
@@ -1460,10 +3622,8 @@ static void convert_close_queue_window(void)
 
 static void convert_rebuild_queue_index(void)
 {
-	wimp_window_state	state;
-	os_box			extent;
 	queued_file		*list;
-	int			length, visible_extent, new_extent, new_scroll;
+	int			length;
 
 	/* Get the length of the queue. */
 
@@ -1496,14 +3656,91 @@ static void convert_rebuild_queue_index(void)
 		list = list->next;
 	}
 
-	/* Set the window extent. */
+	/* Find the conversions in progress, and set the window extent to suit. */
+
+	convert_find_queue_progress();
+	convert_set_queue_pane_extent();
+}
+
+
+/**
+ * Update the list of conversions whose progress is shown at the top of the
+ * queue pane.
+ *
+ * \return			TRUE if the list has changed; else FALSE.
+ */
+
+static osbool convert_find_queue_progress(void)
+{
+	conversion_worker	*worker;
+	osbool			changed = FALSE;
+	int			i, lines = 0;
+
+	for (i = 0; i < CONVERT_MAX_WORKERS; i++) {
+		worker = &(workers[i]);
+
+		/* Helpers converting chunks of a split document are shown through the document's owner. */
+
+		if (worker->state == CONVERSION_STOPPED || worker->state == CONVERSION_STARTING || worker->split_owner != NULL)
+			continue;
+
+		if (lines >= queue_progress_lines || queue_progress_list[lines] != worker)
+			changed = TRUE;
+
+		queue_progress_list[lines++] = worker;
+	}
+
+	if (lines != queue_progress_lines)
+		changed = TRUE;
+
+	queue_progress_lines = lines;
+
+	return changed;
+}
+
+
+/**
+ * Bring the progress lines in the queue pane up to date, if the queue
+ * window is open.
+ */
+
+static void convert_update_queue_progress(void)
+{
+	wimp_icon	*icon;
+	osbool		changed;
+
+	changed = convert_find_queue_progress();
+
+	if (!windows_get_open(convert_queue_window) || (!changed && queue_progress_lines == 0))
+		return;
+
+	if (changed) {
+		convert_set_queue_pane_extent();
+		windows_redraw(convert_queue_pane);
+	} else {
+		icon = convert_queue_pane_def->icons;
+		wimp_force_redraw(convert_queue_pane, icon[QUEUE_PANE_FILE].extent.x0, -(queue_progress_lines * QUEUE_ICON_HEIGHT),
+				icon[QUEUE_PANE_FILE].extent.x1, 0);
+	}
+}
+
+
+/**
+ * Set the extent of the queue pane to suit the lines that it contains.
+ */
+
+static void convert_set_queue_pane_extent(void)
+{
+	wimp_window_state	state;
+	os_box			extent;
+	int			visible_extent, new_extent, new_scroll;
 
 	state.w = convert_queue_pane;
 	wimp_get_window_state(&state);
 
 	visible_extent = state.yscroll + (state.visible.y0 - state.visible.y1);
 
-	new_extent = -QUEUE_ICON_HEIGHT * length;
+	new_extent = -QUEUE_ICON_HEIGHT * (queue_progress_lines + queue_redraw_lines);
 
 	if (new_extent > (state.visible.y0 - state.visible.y1))
 		new_extent = state.visible.y0 - state.visible.y1;
@@ -1570,9 +3807,12 @@ static void convert_reorder_queue_from_index(void)
 
 static void convert_queue_pane_redraw_handler(wimp_draw *redraw)
 {
-	int			ox, oy, top, base, y;
+	int			oy, top, base, y;
 	osbool			more;
 	wimp_icon		*icon;
+	queued_file		*entry;
+	conversion_worker	*worker;
+	char			description[CONVERT_PROGRESS_LENGTH], *leaf;
 
 	/* Perform the redraw if a window was found. */
 
@@ -1581,7 +3821,6 @@ static void convert_queue_pane_redraw_handler(wimp_draw *redraw)
 
 	more = wimp_redraw_window(redraw);
 
-	ox = redraw->box.x0 - redraw->xscroll;
 	oy = redraw->box.y1 - redraw->yscroll;
 
 	icon = convert_queue_pane_def->icons;
@@ -1593,11 +3832,31 @@ static void convert_queue_pane_redraw_handler(wimp_draw *redraw)
 
 		base = (QUEUE_ICON_HEIGHT + (QUEUE_ICON_HEIGHT / 2) + oy - redraw->clip.y0) / QUEUE_ICON_HEIGHT;
 
-		for (y = top; y < queue_redraw_lines && y <= base; y++) {
+		for (y = top; y < queue_progress_lines + queue_redraw_lines && y <= base; y++) {
+			/* The conversions in progress are listed first, with just a description of their progress. */
+
+			if (y < queue_progress_lines) {
+				worker = queue_progress_list[y];
+
+				leaf = strrchr(worker->output_file, '.');
+				leaf = (leaf != NULL) ? leaf + 1 : worker->output_file;
+
+				icon[QUEUE_PANE_FILE].extent.y1 = -(y * QUEUE_ICON_HEIGHT);
+				icon[QUEUE_PANE_FILE].extent.y0 = icon[QUEUE_PANE_FILE].extent.y1 - QUEUE_ICON_HEIGHT;
+				icon[QUEUE_PANE_FILE].data.indirected_text_and_sprite.text =
+						progress_describe(&(worker->progress), leaf, description, CONVERT_PROGRESS_LENGTH);
+				icon[QUEUE_PANE_FILE].data.indirected_text_and_sprite.size = CONVERT_PROGRESS_LENGTH;
+
+				wimp_plot_icon(&(icon[QUEUE_PANE_FILE]));
+				continue;
+			}
+
+			entry = queue_redraw_list[y - queue_progress_lines];
+
 			icon[QUEUE_PANE_INCLUDE].extent.y1 = -(y * QUEUE_ICON_HEIGHT);
 			icon[QUEUE_PANE_INCLUDE].extent.y0 = icon[QUEUE_PANE_INCLUDE].extent.y1 - QUEUE_ICON_HEIGHT;
 			icon[QUEUE_PANE_INCLUDE].data.indirected_sprite.id =
-					(osspriteop_id) (((queue_redraw_list[y])->include) ? "opton" : "optoff");
+					(osspriteop_id) ((entry->include) ? "opton" : "optoff");
 			icon[QUEUE_PANE_INCLUDE].data.indirected_sprite.area = (osspriteop_area *) 1;
 			icon[QUEUE_PANE_INCLUDE].data.indirected_sprite.size = 12;
 
@@ -1605,15 +3864,21 @@ static void convert_queue_pane_redraw_handler(wimp_draw *redraw)
 
 			icon[QUEUE_PANE_FILE].extent.y1 = -(y * QUEUE_ICON_HEIGHT);
 			icon[QUEUE_PANE_FILE].extent.y0 = icon[QUEUE_PANE_FILE].extent.y1 - QUEUE_ICON_HEIGHT;
-			icon[QUEUE_PANE_FILE].data.indirected_text_and_sprite.text = (queue_redraw_list[y])->display_name;
-			icon[QUEUE_PANE_FILE].data.indirected_text_and_sprite.size = MAX_DISPLAY_NAME;
+			if (entry->failed) {
+				icon[QUEUE_PANE_FILE].data.indirected_text_and_sprite.text =
+						msgs_param_lookup("QueueFailed", description, CONVERT_PROGRESS_LENGTH, entry->display_name, NULL, NULL, NULL);
+				icon[QUEUE_PANE_FILE].data.indirected_text_and_sprite.size = CONVERT_PROGRESS_LENGTH;
+			} else {
+				icon[QUEUE_PANE_FILE].data.indirected_text_and_sprite.text = entry->display_name;
+				icon[QUEUE_PANE_FILE].data.indirected_text_and_sprite.size = MAX_DISPLAY_NAME;
+			}
 
 			wimp_plot_icon(&(icon[QUEUE_PANE_FILE]));
 
 			icon[QUEUE_PANE_DELETE].extent.y1 = -(y * QUEUE_ICON_HEIGHT);
 			icon[QUEUE_PANE_DELETE].extent.y0 = icon[QUEUE_PANE_DELETE].extent.y1 - QUEUE_ICON_HEIGHT;
 			icon[QUEUE_PANE_DELETE].data.indirected_sprite.id =
-					(osspriteop_id) (((queue_redraw_list[y])->object_type == DELETED) ? "del1" : "del0");
+					(osspriteop_id) ((entry->object_type == DELETED) ? "del1" : "del0");
 			icon[QUEUE_PANE_DELETE].data.indirected_sprite.area = main_wimp_sprites;
 			icon[QUEUE_PANE_DELETE].data.indirected_sprite.size = 12;
 
@@ -1657,7 +3922,7 @@ static void convert_queue_click_handler(wimp_pointer *pointer)
 
 static void convert_queue_pane_click_handler(wimp_pointer *pointer)
 {
-	int			line, column, xpos;
+	int			row, line, column, xpos;
 	wimp_window_state	window;
 	wimp_icon		*icon;
 
@@ -1666,9 +3931,12 @@ static void convert_queue_pane_click_handler(wimp_pointer *pointer)
 
 	icon = convert_queue_pane_def->icons;
 
-	line = ((window.visible.y1 - pointer->pos.y) - window.yscroll) / QUEUE_ICON_HEIGHT;
+	/* The lines of the queue follow the progress of any conversions, which can't be clicked on. */
+
+	row = ((window.visible.y1 - pointer->pos.y) - window.yscroll) / QUEUE_ICON_HEIGHT;
+	line = row - queue_progress_lines;
 
-	if (line < 0 || line >= queue_redraw_lines)
+	if (row < 0 || line < 0 || line >= queue_redraw_lines)
 		line = -1;
 
 	column = -1;
@@ -1687,16 +3955,16 @@ static void convert_queue_pane_click_handler(wimp_pointer *pointer)
 	if (pointer->buttons == wimp_CLICK_SELECT && column == QUEUE_PANE_INCLUDE && line != -1) {
 		(queue_redraw_list[line])->include = !(queue_redraw_list[line])->include;
 		wimp_force_redraw(pointer->w,
-				icon[QUEUE_PANE_INCLUDE].extent.x0, -((line + 1)* QUEUE_ICON_HEIGHT),
-				icon[QUEUE_PANE_INCLUDE].extent.x1, -(line * QUEUE_ICON_HEIGHT));
+				icon[QUEUE_PANE_INCLUDE].extent.x0, -((row + 1)* QUEUE_ICON_HEIGHT),
+				icon[QUEUE_PANE_INCLUDE].extent.x1, -(row * QUEUE_ICON_HEIGHT));
 	} else if (pointer->buttons == wimp_CLICK_SELECT && column == QUEUE_PANE_DELETE && line != -1) {
 		if ((queue_redraw_list[line])->object_type == HELD_IN_QUEUE)
 			(queue_redraw_list[line])->object_type = DELETED;
 		else
 			(queue_redraw_list[line])->object_type = HELD_IN_QUEUE;
 		 wimp_force_redraw (pointer->w,
-				icon[QUEUE_PANE_DELETE].extent.x0, -((line + 1)* QUEUE_ICON_HEIGHT),
-				icon[QUEUE_PANE_DELETE].extent.x1, -(line * QUEUE_ICON_HEIGHT));
+				icon[QUEUE_PANE_DELETE].extent.x0, -((row + 1)* QUEUE_ICON_HEIGHT),
+				icon[QUEUE_PANE_DELETE].extent.x1, -(row * QUEUE_ICON_HEIGHT));
 	} else if (pointer->buttons == wimp_DRAG_SELECT && column == QUEUE_PANE_FILE && line != -1) {
 		convert_start_queue_entry_drag(line);
 	}
@@ -1730,9 +3998,9 @@ static void convert_start_queue_entry_drag(int line)
 	drag.type = wimp_DRAG_USER_FIXED;
 
 	drag.initial.x0 = ox;
-	drag.initial.y0 = oy + -(line * QUEUE_ICON_HEIGHT + QUEUE_ICON_HEIGHT);
+	drag.initial.y0 = oy + -((line + queue_progress_lines) * QUEUE_ICON_HEIGHT + QUEUE_ICON_HEIGHT);
 	drag.initial.x1 = ox + (window.visible.x1 - window.visible.x0);
-	drag.initial.y1 = oy + -(line * QUEUE_ICON_HEIGHT);
+	drag.initial.y1 = oy + -((line + queue_progress_lines) * QUEUE_ICON_HEIGHT);
 
 	drag.bbox.x0 = window.visible.x0;
 	drag.bbox.y0 = window.visible.y0;
@@ -1798,7 +4066,7 @@ static void convert_terminate_queue_entry_drag(wimp_dragged *drag, void *data)
 	window.w = convert_queue_pane;
 	wimp_get_window_state (&window);
 
-	line = ((window.visible.y1 - pointer.pos.y) - window.yscroll) / QUEUE_ICON_HEIGHT;
+	line = ((window.visible.y1 - pointer.pos.y) - window.yscroll) / QUEUE_ICON_HEIGHT - queue_progress_lines;
 
 	if (line < 0)
 		line = 0;
@@ -1847,7 +4115,7 @@ static void convert_decode_queue_pane_help(char *buffer, wimp_w w, wimp_i i, os_
 	xpos = (pos.x - window.visible.x0) + window.xscroll;
 	ypos = (window.visible.y1 - pos.y) - window.yscroll;
 
-	if (ypos / QUEUE_ICON_HEIGHT < queue_redraw_lines) {
+	if (ypos / QUEUE_ICON_HEIGHT >= queue_progress_lines && ypos / QUEUE_ICON_HEIGHT < queue_progress_lines + queue_redraw_lines) {
 		if (icon[QUEUE_PANE_INCLUDE].extent.x0 <= xpos && icon[QUEUE_PANE_INCLUDE].extent.x1 >= xpos)
 			column = QUEUE_PANE_INCLUDE;
 		else if (icon[QUEUE_PANE_FILE].extent.x0 <= xpos && icon[QUEUE_PANE_FILE].extent.x1 >= xpos)
@@ -33,6 +33,8 @@
 #include <stddef.h>
 #include "oslib/wimp.h"
 
+#include "batch.h"
+
 /* ==================================================================================================================
  * Static constants
  */
@@ -43,7 +45,16 @@
 
 #define CONVERT_MAX_FILENAME 512
 
+/**
+ * The leafname of the spool file in the queue directory.  Hosted builds
+ * use the RISC OS filenames as they stand, so can't have a '/' in a leaf.
+ */
+
+#ifdef HOSTED
+#define CONVERT_QUEUE_FILENAME "printout_ps"
+#else
 #define CONVERT_QUEUE_FILENAME "printout/ps"
+#endif
 
 #define AUTO_SCROLL_MARGIN 100
 
@@ -85,25 +96,57 @@ void convert_initialise(void);
  * Check the location of the 'print file' to see if one has appeared.  If it
  * has, add it to the file queue.
  *
- * Called from NULL poll events.
+ * Called from the spool watcher.
+ *
+ * \return			TRUE if a print file was taken into the queue;
+ *				else FALSE.
+ */
+
+osbool convert_check_for_ps_file(void);
+
+
+/**
+ * Take the file specified, move or copy it into the queue directory with a
+ * timestamp and add it to the queue of files.
+ *
+ * \param *filename		The file to move or copy.
+ * \param consume		TRUE to move the file into the queue; FALSE to
+ *				leave the original in place.
+ * \return			TRUE if successful; else FALSE.
  */
 
-void convert_check_for_ps_file(void);
+osbool convert_queue_ps_file(char *filename, osbool consume);
 
 
 /**
- * Take the file specified, copy it with a timestamp and add it to the queue of files.
+ * Copy a file from a batch conversion into the queue directory and add it
+ * to the queue, to be converted without the Save PDF dialogue.
  *
  * \param *filename		The file to copy.
+ * \param *job			The batch file which it belongs to.
+ * \param *profile		The settings profile to convert it with, or
+ *				NULL to use the current settings.
  * \return			TRUE if successful; else FALSE.
  */
 
-osbool convert_queue_ps_file(char *filename);
+osbool convert_queue_batch_file(char *filename, struct batch_job *job, char *profile);
 
 
 /**
- * Test to see if there is a file queued and no conversion taking place.  If these are both true, select the next
- * pending file in the queue and open the Save PDF dialogue.
+ * Pump any streams which are following spool files, passing data on to
+ * the conversions which are reading them, and move the files into the queue
+ * directory once their writers have finished.
+ *
+ * Called from NULL poll events.
+ */
+
+void convert_pump_streams(void);
+
+
+/**
+ * Test to see if there is a file queued and a conversion worker free to take
+ * it.  If these are both true, select the next pending file in the queue and
+ * open the Save PDF dialogue.
  *
  * Called from NULL poll events.
  */
@@ -111,6 +154,19 @@ osbool convert_queue_ps_file(char *filename);
 void convert_check_for_pending_files(void);
 
 
+/**
+ * Watch over the conversions which are running.  A child task which has
+ * run for longer than JobTimeout, or which has output nothing for longer
+ * than StallTimeout, is killed -- as is the resident server, if the job
+ * is its own; conversions waiting to be retried after such a failure are
+ * restarted once their delay has passed.
+ *
+ * Called from NULL poll events.
+ */
+
+void convert_check_for_stalled_conversions(void);
+
+
 /**
  * Create a full pathname for a file in the processing queue folder.
  *
@@ -138,7 +194,8 @@ void convert_remove_all_remaining_conversions(void);
 
 
 /**
- * Return an indication that a conversion is underway.
+ * Return an indication that a conversion is underway, either in one of the
+ * conversion workers or being set up in the Save PDF dialogue.
  *
  * \return		TRUE if a conversion is in progress; else FALSE.
  */
@@ -0,0 +1,708 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: dsc.c
+ *
+ * PostScript Document Structuring Conventions implementation.
+ *
+ * A conforming PostScript file consists of a prolog and setup section,
+ * followed by a series of independent pages and then a trailer.  Indexing
+ * the offsets of the %%Page: and %%Trailer comments allows any range of
+ * pages to be extracted into a file of its own, sharing the original
+ * prolog and trailer.
+ *
+ * While the file is being read, the embedded fonts and image operators are
+ * counted.  The document's title, creator and bounding boxes are left for
+ * gs, which reads them from the comments itself.  The index is cached in a
+ * text file alongside the PostScript, so that the file only has to be read
+ * once:
+ *
+ *   PrintPDF DSC <version> <length> <load> <exec> <pages> <trailer> <fonts> <images>
+ *   P <offset>				Page offset.
+ */
+
+/* ANSI C header files */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/fileswitch.h"
+#include "oslib/osfile.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/debug.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "dsc.h"
+
+
+/**
+ * The size of the buffer used when reading and copying files.
+ */
+
+#define DSC_BUFFER_SIZE 32768
+
+/**
+ * The number of characters of each comment line which are examined.
+ */
+
+#define DSC_COMMENT_LENGTH 128
+
+/**
+ * The number of characters of each PostScript word which are examined.
+ */
+
+#define DSC_WORD_LENGTH 16
+
+/**
+ * The suffix added to a filename to give the name of its index cache.
+ */
+
+#ifdef HOSTED
+#define DSC_CACHE_SUFFIX "_dsc"
+#else
+#define DSC_CACHE_SUFFIX "/dsc"
+#endif
+
+/**
+ * The version of the index cache file format.
+ */
+
+#define DSC_CACHE_VERSION 2
+
+/**
+ * The length of the buffer used to hold the name of an index cache.
+ */
+
+#define DSC_CACHE_FILENAME_LENGTH 1024
+
+/**
+ * The number of page offsets to allocate space for at a time.
+ */
+
+#define DSC_PAGE_BLOCK 64
+
+/**
+ * A page in an indexed PostScript file.
+ */
+
+struct dsc_page {
+	int		offset;			/**< The offset of the page's %%Page: comment.			*/
+};
+
+/**
+ * An index of the structure of a PostScript file.
+ */
+
+struct dsc_index {
+	int		pages;			/**< The number of pages in the file.				*/
+	int		size;			/**< The allocated size of the page array.			*/
+	struct dsc_page	*page;			/**< The pages in the file.					*/
+	int		trailer;		/**< The offset of the %%Trailer comment, or the file length.	*/
+	int		length;			/**< The length of the file.					*/
+	int		fonts;			/**< The number of fonts embedded in the document.		*/
+	int		images;			/**< The number of image operators in the document.		*/
+};
+
+/* Function Prototypes. */
+
+static struct dsc_index *dsc_create_index(void);
+static void dsc_process_comment(struct dsc_index *index, char *comment, int offset, int *depth);
+static void dsc_process_word(struct dsc_index *index, char *word, int length);
+static osbool dsc_add_page(struct dsc_index *index, int offset);
+static struct dsc_index *dsc_read_cache(char *filename, int length, bits load, bits exec);
+static void dsc_write_cache(struct dsc_index *index, char *filename, bits load, bits exec);
+static char *dsc_build_cache_filename(char *buffer, size_t len, char *filename);
+static osbool dsc_copy_range(FILE *in, FILE *out, int start, int end);
+
+
+/**
+ * The buffer used when reading and copying files.
+ */
+
+static char dsc_buffer[DSC_BUFFER_SIZE];
+
+
+/**
+ * Scan a PostScript file and index its structure.
+ *
+ * \param *filename		The file to scan.
+ * \return			Pointer to the index, or NULL if the file
+ *				doesn't conform to the DSC or couldn't be read.
+ */
+
+struct dsc_index *dsc_scan(char *filename)
+{
+	struct dsc_index	*index;
+	FILE			*file;
+	char			comment[DSC_COMMENT_LENGTH + 1], word[DSC_WORD_LENGTH + 1], c;
+	int			i, read, offset = 0, line_start = 0, comment_length = -1, word_length = 0, depth = 0;
+	osbool			at_line_start = TRUE, failed = FALSE;
+
+	if (filename == NULL)
+		return NULL;
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+		return NULL;
+
+	/* The file must declare itself to be conforming. */
+
+	if (fread(comment, 1, 11, file) != 11 || strncmp(comment, "%!PS-Adobe-", 11) != 0) {
+		fclose(file);
+		return NULL;
+	}
+
+	rewind(file);
+
+	index = dsc_create_index();
+	if (index == NULL) {
+		fclose(file);
+		return NULL;
+	}
+
+	/* Read the file a block at a time, collecting the start of every line which begins with a '%' and
+	 * passing every word in the PostScript outside those lines on for counting.
+	 */
+
+	while ((read = fread(dsc_buffer, 1, DSC_BUFFER_SIZE, file)) > 0) {
+		for (i = 0; i < read; i++, offset++) {
+			c = dsc_buffer[i];
+
+			if (c == '\n' || c == '\r') {
+				if (comment_length >= 0) {
+					comment[comment_length] = '\0';
+					dsc_process_comment(index, comment, line_start, &depth);
+				}
+
+				if (word_length > 0)
+					dsc_process_word(index, word, word_length);
+
+				at_line_start = TRUE;
+				comment_length = -1;
+				word_length = 0;
+				continue;
+			}
+
+			if (at_line_start) {
+				at_line_start = FALSE;
+				line_start = offset;
+				comment_length = (c == '%') ? 0 : -1;
+			}
+
+			if (comment_length >= 0) {
+				if (comment_length < DSC_COMMENT_LENGTH)
+					comment[comment_length++] = c;
+			} else if (isalpha((unsigned char) c)) {
+				if (word_length < DSC_WORD_LENGTH)
+					word[word_length] = c;
+				word_length++;
+			} else if (word_length > 0) {
+				dsc_process_word(index, word, word_length);
+				word_length = 0;
+			}
+		}
+	}
+
+	if (comment_length >= 0) {
+		comment[comment_length] = '\0';
+		dsc_process_comment(index, comment, line_start, &depth);
+	}
+
+	if (word_length > 0)
+		dsc_process_word(index, word, word_length);
+
+	if (ferror(file) || index->pages == -1)
+		failed = TRUE;
+
+	fclose(file);
+
+	index->length = offset;
+
+	if (index->trailer < 0)
+		index->trailer = offset;
+
+	/* There must be at least one page, and the trailer must follow them. */
+
+	if (failed || index->pages == 0 || index->trailer < index->page[index->pages - 1].offset) {
+		dsc_free(index);
+		return NULL;
+	}
+
+	#ifdef DEBUG
+	debug_printf("Indexed %d pages in %s", index->pages, filename);
+	#endif
+
+	return index;
+}
+
+
+/**
+ * Load the index of a PostScript file, from its cache if there is a valid
+ * one; otherwise, the file is scanned and the index cached for next time.
+ *
+ * \param *filename		The file to index.
+ * \return			Pointer to the index, or NULL if the file
+ *				doesn't conform to the DSC or couldn't be read.
+ */
+
+struct dsc_index *dsc_load(char *filename)
+{
+	struct dsc_index	*index;
+	fileswitch_object_type	type;
+	bits			load, exec;
+	int			length;
+
+	if (filename == NULL || xosfile_read_no_path(filename, &type, &load, &exec, &length, NULL) != NULL ||
+			type != fileswitch_IS_FILE)
+		return NULL;
+
+	index = dsc_read_cache(filename, length, load, exec);
+
+	if (index == NULL) {
+		index = dsc_scan(filename);
+
+		if (index != NULL)
+			dsc_write_cache(index, filename, load, exec);
+	}
+
+	return index;
+}
+
+
+/**
+ * Delete the index cache of a PostScript file, if there is one.
+ *
+ * \param *filename		The file whose cache is to be deleted.
+ */
+
+void dsc_delete_cache(char *filename)
+{
+	char		cache[DSC_CACHE_FILENAME_LENGTH];
+
+	if (dsc_build_cache_filename(cache, DSC_CACHE_FILENAME_LENGTH, filename) != NULL)
+		xosfile_delete(cache, NULL, NULL, NULL, NULL, NULL);
+}
+
+
+/**
+ * Free an index.
+ *
+ * \param *index		The index to free.
+ */
+
+void dsc_free(struct dsc_index *index)
+{
+	if (index == NULL)
+		return;
+
+	if (index->page != NULL)
+		free(index->page);
+
+	free(index);
+}
+
+
+/**
+ * Return the number of pages in an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \return			The number of pages.
+ */
+
+int dsc_get_pages(struct dsc_index *index)
+{
+	return (index != NULL && index->pages > 0) ? index->pages : 0;
+}
+
+
+/**
+ * Return the length of an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \return			The length of the file, in bytes.
+ */
+
+int dsc_get_length(struct dsc_index *index)
+{
+	return (index != NULL) ? index->length : 0;
+}
+
+
+/**
+ * Return the number of fonts embedded in an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \return			The number of fonts.
+ */
+
+int dsc_get_fonts(struct dsc_index *index)
+{
+	return (index != NULL) ? index->fonts : 0;
+}
+
+
+/**
+ * Return the number of image operators in an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \return			The number of image operators.
+ */
+
+int dsc_get_images(struct dsc_index *index)
+{
+	return (index != NULL) ? index->images : 0;
+}
+
+
+/**
+ * Return the offset of a page within an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \param page			The page to return, counting from 1.
+ * \return			The offset of the page, or -1 if not found.
+ */
+
+int dsc_get_page_offset(struct dsc_index *index, int page)
+{
+	if (index == NULL || page < 1 || page > index->pages)
+		return -1;
+
+	return index->page[page - 1].offset;
+}
+
+
+/**
+ * Extract a range of pages from an indexed file into a file of their own,
+ * along with the prolog and trailer of the original.
+ *
+ * \param *index		The index of the file.
+ * \param *source		The indexed file.
+ * \param *dest			The file to write the pages to.
+ * \param first			The first page to extract, counting from 1.
+ * \param last			The last page to extract, counting from 1.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+osbool dsc_write_pages(struct dsc_index *index, char *source, char *dest, int first, int last)
+{
+	FILE		*in, *out;
+	osbool		success;
+	int		end;
+
+	if (index == NULL || source == NULL || dest == NULL || first < 1 || last > index->pages || first > last)
+		return FALSE;
+
+	in = fopen(source, "rb");
+	if (in == NULL)
+		return FALSE;
+
+	out = fopen(dest, "wb");
+	if (out == NULL) {
+		fclose(in);
+		return FALSE;
+	}
+
+	end = (last < index->pages) ? index->page[last].offset : index->trailer;
+
+	success = dsc_copy_range(in, out, 0, index->page[0].offset) &&
+			dsc_copy_range(in, out, index->page[first - 1].offset, end) &&
+			dsc_copy_range(in, out, index->trailer, index->length);
+
+	fclose(in);
+
+	if (fclose(out) != 0)
+		success = FALSE;
+
+	return success;
+}
+
+
+/**
+ * Process a comment line from a file being indexed.  Pages within embedded
+ * documents are ignored.
+ *
+ * \param *index		The index being built.
+ * \param *comment		The start of the comment line.
+ * \param offset		The offset of the line into the file.
+ * \param *depth		Pointer to the current embedded document depth.
+ */
+
+static void dsc_process_comment(struct dsc_index *index, char *comment, int offset, int *depth)
+{
+	if (strncmp(comment, "%%BeginDocument", 15) == 0) {
+		(*depth)++;
+	} else if (strncmp(comment, "%%EndDocument", 13) == 0) {
+		if (*depth > 0)
+			(*depth)--;
+	} else if (*depth == 0 && strncmp(comment, "%%Page:", 7) == 0) {
+		if (index->trailer >= 0 || !dsc_add_page(index, offset))
+			index->pages = -1;
+	} else if (*depth == 0 && strncmp(comment, "%%Trailer", 9) == 0) {
+		index->trailer = offset;
+	} else if (strncmp(comment, "%%BeginFont:", 12) == 0 || strncmp(comment, "%%BeginResource: font", 21) == 0) {
+		index->fonts++;
+	}
+}
+
+
+/**
+ * Process a word from the PostScript in a file being indexed, counting
+ * any image operators.
+ *
+ * \param *index		The index being built.
+ * \param *word			The start of the word.
+ * \param length		The full length of the word.
+ */
+
+static void dsc_process_word(struct dsc_index *index, char *word, int length)
+{
+	if ((length == 5 && strncmp(word, "image", 5) == 0) ||
+			(length == 9 && strncmp(word, "imagemask", 9) == 0) ||
+			(length == 10 && strncmp(word, "colorimage", 10) == 0))
+		index->images++;
+}
+
+
+/**
+ * Add a page to an index, extending the page offset array if required.
+ *
+ * \param *index		The index to add the page to.
+ * \param offset		The offset of the page's %%Page: comment.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool dsc_add_page(struct dsc_index *index, int offset)
+{
+	struct dsc_page		*page;
+
+	if (index->pages < 0)
+		return FALSE;
+
+	if (index->pages >= index->size) {
+		page = realloc(index->page, (index->size + DSC_PAGE_BLOCK) * sizeof(struct dsc_page));
+		if (page == NULL)
+			return FALSE;
+
+		index->page = page;
+		index->size += DSC_PAGE_BLOCK;
+	}
+
+	index->page[index->pages].offset = offset;
+	index->pages++;
+
+	return TRUE;
+}
+
+
+/**
+ * Create a new, empty, index.
+ *
+ * \return			Pointer to the index, or NULL on failure.
+ */
+
+static struct dsc_index *dsc_create_index(void)
+{
+	struct dsc_index	*index;
+
+	index = malloc(sizeof(struct dsc_index));
+	if (index == NULL)
+		return NULL;
+
+	index->pages = 0;
+	index->size = 0;
+	index->page = NULL;
+	index->trailer = -1;
+	index->length = 0;
+	index->fonts = 0;
+	index->images = 0;
+
+	return index;
+}
+
+
+/**
+ * Read the cached index of a PostScript file.  The cache is only used if
+ * it was made from a file of the same length and datestamp.
+ *
+ * \param *filename		The file whose index is to be read.
+ * \param length		The length of the file.
+ * \param load			The load address of the file.
+ * \param exec			The execution address of the file.
+ * \return			Pointer to the index, or NULL if there was no
+ *				valid cache.
+ */
+
+static struct dsc_index *dsc_read_cache(char *filename, int length, bits load, bits exec)
+{
+	char			cache[DSC_CACHE_FILENAME_LENGTH], line[DSC_COMMENT_LENGTH + 8], *end;
+	struct dsc_index	*index;
+	FILE			*file;
+	unsigned		cache_load, cache_exec;
+	int			version, pages, offset;
+	osbool			failed = FALSE;
+
+	if (dsc_build_cache_filename(cache, DSC_CACHE_FILENAME_LENGTH, filename) == NULL)
+		return NULL;
+
+	file = fopen(cache, "r");
+	if (file == NULL)
+		return NULL;
+
+	index = dsc_create_index();
+
+	if (index == NULL || fgets(line, sizeof(line), file) == NULL ||
+			sscanf(line, "PrintPDF DSC %d %d %x %x %d %d %d %d", &version, &(index->length), &cache_load, &cache_exec,
+			&pages, &(index->trailer), &(index->fonts), &(index->images)) != 8 ||
+			version != DSC_CACHE_VERSION || index->length != length || cache_load != load || cache_exec != exec) {
+		fclose(file);
+		dsc_free(index);
+		return NULL;
+	}
+
+	while (!failed && fgets(line, sizeof(line), file) != NULL) {
+		end = strpbrk(line, "\r\n");
+		if (end != NULL)
+			*end = '\0';
+
+		if (line[0] == '\0' || line[1] != ' ')
+			continue;
+
+		switch (line[0]) {
+		case 'P':
+			if (sscanf(line + 2, "%d", &offset) != 1 || !dsc_add_page(index, offset))
+				failed = TRUE;
+			break;
+		}
+	}
+
+	fclose(file);
+
+	if (failed || index->pages != pages || pages == 0) {
+		dsc_free(index);
+		return NULL;
+	}
+
+	return index;
+}
+
+
+/**
+ * Write the index of a PostScript file to its cache.
+ *
+ * \param *index		The index to write.
+ * \param *filename		The file to which the index belongs.
+ * \param load			The load address of the file.
+ * \param exec			The execution address of the file.
+ */
+
+static void dsc_write_cache(struct dsc_index *index, char *filename, bits load, bits exec)
+{
+	char			cache[DSC_CACHE_FILENAME_LENGTH];
+	FILE			*file;
+	int			i;
+
+	if (dsc_build_cache_filename(cache, DSC_CACHE_FILENAME_LENGTH, filename) == NULL)
+		return;
+
+	file = fopen(cache, "w");
+	if (file == NULL)
+		return;
+
+	fprintf(file, "PrintPDF DSC %d %d %x %x %d %d %d %d\n", DSC_CACHE_VERSION, index->length, (unsigned) load, (unsigned) exec,
+			index->pages, index->trailer, index->fonts, index->images);
+
+	for (i = 0; i < index->pages; i++)
+		fprintf(file, "P %d\n", index->page[i].offset);
+
+	/* If the cache couldn't be written completely, don't leave a damaged copy behind. */
+
+	if (fclose(file) != 0)
+		xosfile_delete(cache, NULL, NULL, NULL, NULL, NULL);
+}
+
+
+/**
+ * Build the name of the index cache for a PostScript file.
+ *
+ * \param *buffer		Pointer to the buffer to hold the filename.
+ * \param len			The size of the supplied buffer.
+ * \param *filename		The file whose cache name is required.
+ * \return			Pointer to the filename, or NULL on failure.
+ */
+
+static char *dsc_build_cache_filename(char *buffer, size_t len, char *filename)
+{
+	if (buffer == NULL || filename == NULL || strlen(filename) + strlen(DSC_CACHE_SUFFIX) >= len)
+		return NULL;
+
+	string_printf(buffer, len, "%s%s", filename, DSC_CACHE_SUFFIX);
+
+	return buffer;
+}
+
+
+/**
+ * Copy a range of bytes from one file to another.
+ *
+ * \param *in			The file to copy from.
+ * \param *out			The file to copy to.
+ * \param start			The offset of the first byte to copy.
+ * \param end			The offset of the byte after the last to copy.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+static osbool dsc_copy_range(FILE *in, FILE *out, int start, int end)
+{
+	int		size;
+
+	if (end <= start)
+		return TRUE;
+
+	if (fseek(in, start, SEEK_SET) != 0)
+		return FALSE;
+
+	while (start < end) {
+		size = end - start;
+		if (size > DSC_BUFFER_SIZE)
+			size = DSC_BUFFER_SIZE;
+
+		if (fread(dsc_buffer, 1, size, in) != size || fwrite(dsc_buffer, 1, size, out) != size)
+			return FALSE;
+
+		start += size;
+	}
+
+	return TRUE;
+}
+
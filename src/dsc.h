@@ -0,0 +1,149 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: dsc.h
+ *
+ * PostScript Document Structuring Conventions implementation.
+ */
+
+#ifndef PRINTPDF_DSC
+#define PRINTPDF_DSC
+
+#include "oslib/types.h"
+
+/**
+ * An index of the structure of a PostScript file.
+ */
+
+struct dsc_index;
+
+
+/**
+ * Scan a PostScript file and index its structure.
+ *
+ * \param *filename		The file to scan.
+ * \return			Pointer to the index, or NULL if the file
+ *				doesn't conform to the DSC or couldn't be read.
+ */
+
+struct dsc_index *dsc_scan(char *filename);
+
+
+/**
+ * Load the index of a PostScript file, from its cache if there is a valid
+ * one; otherwise, the file is scanned and the index cached for next time.
+ *
+ * \param *filename		The file to index.
+ * \return			Pointer to the index, or NULL if the file
+ *				doesn't conform to the DSC or couldn't be read.
+ */
+
+struct dsc_index *dsc_load(char *filename);
+
+
+/**
+ * Delete the index cache of a PostScript file, if there is one.
+ *
+ * \param *filename		The file whose cache is to be deleted.
+ */
+
+void dsc_delete_cache(char *filename);
+
+
+/**
+ * Free an index.
+ *
+ * \param *index		The index to free.
+ */
+
+void dsc_free(struct dsc_index *index);
+
+
+/**
+ * Return the number of pages in an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \return			The number of pages.
+ */
+
+int dsc_get_pages(struct dsc_index *index);
+
+
+/**
+ * Return the length of an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \return			The length of the file, in bytes.
+ */
+
+int dsc_get_length(struct dsc_index *index);
+
+
+/**
+ * Return the number of fonts embedded in an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \return			The number of fonts.
+ */
+
+int dsc_get_fonts(struct dsc_index *index);
+
+
+/**
+ * Return the number of image operators in an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \return			The number of image operators.
+ */
+
+int dsc_get_images(struct dsc_index *index);
+
+
+/**
+ * Return the offset of a page within an indexed file.
+ *
+ * \param *index		The index to interrogate.
+ * \param page			The page to return, counting from 1.
+ * \return			The offset of the page, or -1 if not found.
+ */
+
+int dsc_get_page_offset(struct dsc_index *index, int page);
+
+
+/**
+ * Extract a range of pages from an indexed file into a file of their own,
+ * along with the prolog and trailer of the original.
+ *
+ * \param *index		The index of the file.
+ * \param *source		The indexed file.
+ * \param *dest			The file to write the pages to.
+ * \param first			The first page to extract, counting from 1.
+ * \param last			The last page to extract, counting from 1.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+osbool dsc_write_pages(struct dsc_index *index, char *source, char *dest, int first, int last);
+
+#endif
+
@@ -302,7 +302,7 @@ static osbool iconbar_load_postscript_file(wimp_w w, wimp_i i, unsigned filetype
 	debug_printf("Created queue file: '%s'", queue_file);
 
 	if (strcmp(queue_file, filename) != 0)
-		convert_queue_ps_file(filename);
+		convert_queue_ps_file(filename, FALSE);
 
 	return TRUE;
 }
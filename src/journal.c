@@ -0,0 +1,488 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: journal.c
+ *
+ * Persistent queue journal implementation.
+ *
+ * The journal is a text file in the queue directory, to which a line is
+ * appended for each change to the queue:
+ *
+ *   Q <leaf>				File added, awaiting attention.
+ *   H <leaf> <include> <display name>	File held in the queue.
+ *   R <leaf>				File removed from the queue.
+ *
+ * Each line is only acted upon if it is complete, so a record which was
+ * being written when the machine went down is ignored on replay.  The
+ * journal is compacted by writing a snapshot of the queue into a new file
+ * and then swapping it into place.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/fileswitch.h"
+#include "oslib/osfile.h"
+#include "oslib/osfscontrol.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/debug.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "journal.h"
+
+#include "convert.h"
+
+
+/**
+ * The maximum length of a line in the journal.
+ */
+
+#define JOURNAL_LINE_LENGTH 256
+
+/**
+ * The maximum length of a queue leafname in the journal.
+ */
+
+#define JOURNAL_MAX_LEAF 32
+
+/**
+ * The maximum length of a display name in the journal.
+ */
+
+#define JOURNAL_MAX_DISPLAY 64
+
+/**
+ * The number of records which may be appended before compaction is
+ * requested.
+ */
+
+#define JOURNAL_COMPACT_THRESHOLD 64
+
+/**
+ * The suffix added to the journal filename while a new copy is written.
+ */
+
+#define JOURNAL_NEW_SUFFIX "New"
+
+/**
+ * An entry in the queue, as rebuilt during replay.
+ */
+
+struct journal_entry {
+	char			leaf[JOURNAL_MAX_LEAF];			/**< The leafname of the queued file.		*/
+	char			display_name[JOURNAL_MAX_DISPLAY];	/**< The display name of a held file.		*/
+	osbool			held;					/**< TRUE if the file is held in the queue.	*/
+	osbool			include;				/**< TRUE if a held file is to be included.	*/
+
+	struct journal_entry	*next;
+};
+
+/* Function Prototypes. */
+
+static void journal_append(char *format, char *leaf, char *display_name, int include);
+static struct journal_entry *journal_find_entry(struct journal_entry *list, char *leaf);
+static osbool journal_file_exists(char *filename);
+
+
+/**
+ * The pathname of the journal file.
+ */
+
+static char journal_filename[CONVERT_MAX_FILENAME];
+
+/**
+ * The pathname used while a new copy of the journal is being written.
+ */
+
+static char journal_new_filename[CONVERT_MAX_FILENAME];
+
+/**
+ * The number of records appended since the journal was last compacted.
+ */
+
+static int journal_records = 0;
+
+/**
+ * The file handle of a journal being compacted, or NULL.
+ */
+
+static FILE *journal_compact_file = NULL;
+
+/**
+ * The number of entries written to a journal being compacted.
+ */
+
+static int journal_compact_entries = 0;
+
+
+/**
+ * Initialise the journal, setting the name of the file in which it is held.
+ *
+ * \param *filename		The pathname of the journal file.
+ */
+
+void journal_initialise(char *filename)
+{
+	string_copy(journal_filename, filename, CONVERT_MAX_FILENAME);
+	string_printf(journal_new_filename, CONVERT_MAX_FILENAME, "%s%s", filename, JOURNAL_NEW_SUFFIX);
+
+	journal_records = 0;
+}
+
+
+/**
+ * Replay the journal from disc, passing each of the files which were still
+ * in the queue back to the caller in queue order.
+ *
+ * \param callback		The function to receive the queue entries.
+ * \return			The number of entries replayed.
+ */
+
+int journal_replay(journal_replay_callback callback)
+{
+	char			line[JOURNAL_LINE_LENGTH], *leaf, *include, *display_name, *end;
+	struct journal_entry	*list = NULL, **tail = &list, *entry, *old;
+	FILE			*file;
+	osbool			partial = FALSE;
+	int			entries = 0;
+
+	/* If the machine went down while the journal was being swapped over, the new copy will be the only
+	 * one left.  Otherwise, any new copy is incomplete and can be discarded.
+	 */
+
+	if (!journal_file_exists(journal_filename) && journal_file_exists(journal_new_filename))
+		xosfscontrol_rename(journal_new_filename, journal_filename);
+	else
+		xosfile_delete(journal_new_filename, NULL, NULL, NULL, NULL, NULL);
+
+	file = fopen(journal_filename, "r");
+	if (file == NULL)
+		return 0;
+
+	while (fgets(line, JOURNAL_LINE_LENGTH, file) != NULL) {
+		/* Only act on complete lines: the tail of an overlong line, or a final line without a terminator,
+		 * is ignored.
+		 */
+
+		end = strchr(line, '\n');
+
+		if (end == NULL || partial) {
+			partial = (end == NULL) ? TRUE : FALSE;
+			continue;
+		}
+
+		*end = '\0';
+
+		if (line[0] == '\0' || line[1] != ' ')
+			continue;
+
+		leaf = line + 2;
+		include = NULL;
+		display_name = "";
+
+		if (line[0] == 'H') {
+			include = strchr(leaf, ' ');
+			if (include == NULL)
+				continue;
+
+			*include++ = '\0';
+
+			display_name = strchr(include, ' ');
+			if (display_name == NULL)
+				display_name = "";
+			else
+				*display_name++ = '\0';
+		}
+
+		if (*leaf == '\0')
+			continue;
+
+		entry = journal_find_entry(list, leaf);
+
+		switch (line[0]) {
+		case 'Q':
+			if (entry != NULL)
+				break;
+
+			entry = malloc(sizeof(struct journal_entry));
+			if (entry == NULL)
+				break;
+
+			string_copy(entry->leaf, leaf, JOURNAL_MAX_LEAF);
+			*(entry->display_name) = '\0';
+			entry->held = FALSE;
+			entry->include = FALSE;
+			entry->next = NULL;
+
+			*tail = entry;
+			tail = &(entry->next);
+			break;
+
+		case 'H':
+			if (entry == NULL)
+				break;
+
+			string_copy(entry->display_name, display_name, JOURNAL_MAX_DISPLAY);
+			entry->held = TRUE;
+			entry->include = (*include == '1') ? TRUE : FALSE;
+			break;
+
+		case 'R':
+			if (entry != NULL)
+				*(entry->leaf) = '\0';
+			break;
+		}
+	}
+
+	fclose(file);
+
+	/* Pass the surviving entries back to the caller, freeing the list as we go.  Any whose files have
+	 * gone missing are dropped.
+	 */
+
+	while (list != NULL) {
+		old = list;
+		list = list->next;
+
+		if (*(old->leaf) != '\0' && journal_file_exists(convert_build_queue_filename(line, JOURNAL_LINE_LENGTH, old->leaf))) {
+			callback(old->leaf, old->display_name, old->held, old->include);
+			entries++;
+		}
+
+		free(old);
+	}
+
+	#ifdef DEBUG
+	debug_printf("Replayed %d entries from queue journal", entries);
+	#endif
+
+	return entries;
+}
+
+
+/**
+ * Record that a new file has been added to the queue, awaiting attention.
+ *
+ * \param *leaf			The leafname of the file.
+ */
+
+void journal_record_queued(char *leaf)
+{
+	journal_append("Q %s\n", leaf, NULL, 0);
+}
+
+
+/**
+ * Record that a file has been placed on hold in the queue.
+ *
+ * \param *leaf			The leafname of the file.
+ * \param *display_name		The name to show for the file in the queue.
+ * \param include		TRUE if the file is selected for conversion.
+ */
+
+void journal_record_held(char *leaf, char *display_name, osbool include)
+{
+	journal_append("H %s %d %s\n", leaf, display_name, (include) ? 1 : 0);
+}
+
+
+/**
+ * Record that a file has been removed from the queue.
+ *
+ * \param *leaf			The leafname of the file.
+ */
+
+void journal_record_removed(char *leaf)
+{
+	journal_append("R %s\n", leaf, NULL, 0);
+}
+
+
+/**
+ * Test whether enough records have been appended to the journal since it
+ * was last compacted for it to be worth compacting again.
+ *
+ * \return			TRUE if the journal should be compacted; else FALSE.
+ */
+
+osbool journal_needs_compaction(void)
+{
+	return (journal_records >= JOURNAL_COMPACT_THRESHOLD) ? TRUE : FALSE;
+}
+
+
+/**
+ * Start to compact the journal, by writing a fresh copy containing only the
+ * entries currently in the queue.  The entries should be supplied in queue
+ * order by calling journal_compact_entry(), followed by a call to
+ * journal_end_compaction().
+ *
+ * \return			TRUE if compaction started; else FALSE.
+ */
+
+osbool journal_start_compaction(void)
+{
+	if (journal_compact_file != NULL)
+		fclose(journal_compact_file);
+
+	journal_compact_entries = 0;
+	journal_compact_file = fopen(journal_new_filename, "w");
+
+	return (journal_compact_file != NULL) ? TRUE : FALSE;
+}
+
+
+/**
+ * Write an entry into a journal being compacted.
+ *
+ * \param *leaf			The leafname of the file.
+ * \param *display_name		The name shown in the queue, or "" if none.
+ * \param held			TRUE if the file is held in the queue.
+ * \param include		TRUE if a held file is selected for conversion.
+ */
+
+void journal_compact_entry(char *leaf, char *display_name, osbool held, osbool include)
+{
+	if (journal_compact_file == NULL || leaf == NULL)
+		return;
+
+	fprintf(journal_compact_file, "Q %s\n", leaf);
+
+	if (held)
+		fprintf(journal_compact_file, "H %s %d %s\n", leaf, (include) ? 1 : 0, (display_name != NULL) ? display_name : "");
+
+	journal_compact_entries++;
+}
+
+
+/**
+ * Complete the compaction of the journal, replacing the old copy on disc
+ * with the new one.  If the new journal is empty, it is deleted.
+ */
+
+void journal_end_compaction(void)
+{
+	int	result;
+
+	if (journal_compact_file == NULL)
+		return;
+
+	result = fclose(journal_compact_file);
+	journal_compact_file = NULL;
+
+	/* If the new copy couldn't be written, leave the old one in place: it is still valid. */
+
+	if (result != 0) {
+		xosfile_delete(journal_new_filename, NULL, NULL, NULL, NULL, NULL);
+		return;
+	}
+
+	xosfile_delete(journal_filename, NULL, NULL, NULL, NULL, NULL);
+
+	if (journal_compact_entries > 0)
+		xosfscontrol_rename(journal_new_filename, journal_filename);
+	else
+		xosfile_delete(journal_new_filename, NULL, NULL, NULL, NULL, NULL);
+
+	journal_records = 0;
+}
+
+
+/**
+ * Append a record to the journal.  The file is closed after each record,
+ * so that it is on disc before the queue moves on.
+ *
+ * \param *format		The format of the record.
+ * \param *leaf			The leafname to include in the record.
+ * \param *display_name		The display name to include in the record, or NULL.
+ * \param include		The include flag to include in the record.
+ */
+
+static void journal_append(char *format, char *leaf, char *display_name, int include)
+{
+	FILE	*file;
+
+	if (leaf == NULL || *journal_filename == '\0')
+		return;
+
+	file = fopen(journal_filename, "a");
+	if (file == NULL)
+		return;
+
+	if (display_name != NULL)
+		fprintf(file, format, leaf, include, display_name);
+	else
+		fprintf(file, format, leaf);
+
+	fclose(file);
+
+	journal_records++;
+}
+
+
+/**
+ * Find an entry in a replay list.
+ *
+ * \param *list			The list to search.
+ * \param *leaf			The leafname to search for.
+ * \return			Pointer to the entry, or NULL if not found.
+ */
+
+static struct journal_entry *journal_find_entry(struct journal_entry *list, char *leaf)
+{
+	while (list != NULL && strcmp(list->leaf, leaf) != 0)
+		list = list->next;
+
+	return list;
+}
+
+
+/**
+ * Test whether a file exists.
+ *
+ * \param *filename		The pathname of the file to test.
+ * \return			TRUE if the file exists; else FALSE.
+ */
+
+static osbool journal_file_exists(char *filename)
+{
+	fileswitch_object_type	type;
+
+	if (filename == NULL || xosfile_read_no_path(filename, &type, NULL, NULL, NULL, NULL) != NULL)
+		return FALSE;
+
+	return (type == fileswitch_IS_FILE) ? TRUE : FALSE;
+}
+
@@ -0,0 +1,140 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: journal.h
+ *
+ * Persistent queue journal implementation.
+ */
+
+#ifndef PRINTPDF_JOURNAL
+#define PRINTPDF_JOURNAL
+
+#include "oslib/types.h"
+
+/**
+ * Callback function type used to return the surviving entries from the
+ * journal on replay.
+ *
+ * \param *leaf			The leafname of the queued file.
+ * \param *display_name		The name shown in the queue, or "" if none.
+ * \param held			TRUE if the file was held in the queue; FALSE
+ *				if it was still awaiting attention.
+ * \param include		TRUE if a held file was selected for conversion.
+ */
+
+typedef void (*journal_replay_callback)(char *leaf, char *display_name, osbool held, osbool include);
+
+
+/**
+ * Initialise the journal, setting the name of the file in which it is held.
+ *
+ * \param *filename		The pathname of the journal file.
+ */
+
+void journal_initialise(char *filename);
+
+
+/**
+ * Replay the journal from disc, passing each of the files which were still
+ * in the queue back to the caller in queue order.
+ *
+ * \param callback		The function to receive the queue entries.
+ * \return			The number of entries replayed.
+ */
+
+int journal_replay(journal_replay_callback callback);
+
+
+/**
+ * Record that a new file has been added to the queue, awaiting attention.
+ *
+ * \param *leaf			The leafname of the file.
+ */
+
+void journal_record_queued(char *leaf);
+
+
+/**
+ * Record that a file has been placed on hold in the queue.
+ *
+ * \param *leaf			The leafname of the file.
+ * \param *display_name		The name to show for the file in the queue.
+ * \param include		TRUE if the file is selected for conversion.
+ */
+
+void journal_record_held(char *leaf, char *display_name, osbool include);
+
+
+/**
+ * Record that a file has been removed from the queue.
+ *
+ * \param *leaf			The leafname of the file.
+ */
+
+void journal_record_removed(char *leaf);
+
+
+/**
+ * Test whether enough records have been appended to the journal since it
+ * was last compacted for it to be worth compacting again.
+ *
+ * \return			TRUE if the journal should be compacted; else FALSE.
+ */
+
+osbool journal_needs_compaction(void);
+
+
+/**
+ * Start to compact the journal, by writing a fresh copy containing only the
+ * entries currently in the queue.  The entries should be supplied in queue
+ * order by calling journal_compact_entry(), followed by a call to
+ * journal_end_compaction().
+ *
+ * \return			TRUE if compaction started; else FALSE.
+ */
+
+osbool journal_start_compaction(void);
+
+
+/**
+ * Write an entry into a journal being compacted.
+ *
+ * \param *leaf			The leafname of the file.
+ * \param *display_name		The name shown in the queue, or "" if none.
+ * \param held			TRUE if the file is held in the queue.
+ * \param include		TRUE if a held file is selected for conversion.
+ */
+
+void journal_compact_entry(char *leaf, char *display_name, osbool held, osbool include);
+
+
+/**
+ * Complete the compaction of the journal, replacing the old copy on disc
+ * with the new one.  If the new journal is empty, it is deleted.
+ */
+
+void journal_end_compaction(void);
+
+#endif
+
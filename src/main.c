@@ -71,7 +71,10 @@
 
 #include "main.h"
 
+#include "api.h"
+#include "batch.h"
 #include "bookmark.h"
+#include "cache.h"
 #include "choices.h"
 #include "convert.h"
 #include "encrypt.h"
@@ -81,8 +84,10 @@
 #include "pdfmark.h"
 #include "pmenu.h"
 #include "popup.h"
+#include "server.h"
 #include "taskman.h"
 #include "version.h"
+#include "watcher.h"
 
 /**
  * The size of buffer allocated to resource filename processing.
@@ -126,12 +131,14 @@ int main(int argc, char *argv[])
 
 	main_poll_loop();
 
+	watcher_terminate();
+	server_terminate();
 	bookmarks_terminate();
 	msgs_terminate();
 	wimp_close_down(main_task_handle);
 	convert_remove_all_remaining_conversions();
 
-	return 0;
+	return (batch_failed()) ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 
@@ -146,10 +153,8 @@ static void main_poll_loop(void)
 	wimp_block		blk;
 
 
-	poll_time = os_read_monotonic_time();
-
 	while (!main_quit_flag) {
-		reason = wimp_poll_idle(0, &blk, poll_time, 0);
+		reason = wimp_poll_idle(0, &blk, watcher_next_poll_time(), 0);
 
 		/* Events are passed to Event Lib first; only if this fails
 		 * to handle them do they get passed on to the internal
@@ -162,10 +167,13 @@ static void main_poll_loop(void)
 		if (!event_process_event(reason, &blk, 0, NULL)) {
 			switch (reason) {
 			case wimp_NULL_REASON_CODE:
+				poll_time = os_read_monotonic_time();
 				popup_test_and_close(poll_time);
-				convert_check_for_ps_file();
+				convert_pump_streams();
+				watcher_poll(poll_time);
 				convert_check_for_pending_files();
-				poll_time += config_int_read("PollDelay");
+				convert_check_for_stalled_conversions();
+				api_send_notifications();
 				break;
 
 			case wimp_OPEN_WINDOW_REQUEST:
@@ -237,10 +245,40 @@ static void main_initialise(void)
 	config_str_init("FileQueue", "<Wimp$ScrapDir>.PrintPDF");
 	config_str_init("ParamFile", "Pipe:$.PrintPDF");
 	config_str_init("PDFMarkFile", "Pipe:$.PrintPDFMark");
+	config_str_init("PreProcessFile", "Pipe:$.PrintPDFInter");
 	config_str_init("FileName", msgs_lookup("FileName", filename, MAIN_FILENAME_BUFFER_LEN));
 	config_int_init("PollDelay", 500);
+	config_int_init("PollMinDelay", 10);
+	config_int_init("PDFMakerCheck", 3000);
+	config_opt_init("StreamSpool", FALSE);
+	config_str_init("StreamPipe", "Pipe:$.PrintPDFStream");
+	config_int_init("StreamChunk", 1024);
+	config_int_init("StreamBuffer", 2048);
 	config_int_init("PopUpTime", 200);
 	config_int_init("TaskMemory", 8192);
+	config_int_init("MaxConversions", 4);
+	config_opt_init("AdaptiveMemory", TRUE);
+	config_int_init("TaskMemoryMin", 4096);
+	config_int_init("TaskMemoryMax", 32768);
+	config_int_init("MemoryBudget", 0);
+	config_int_init("JobTimeout", 0);
+	config_int_init("StallTimeout", 0);
+	config_int_init("JobRetries", 2);
+	config_int_init("RetryDelay", 1000);
+	config_int_init("SplitPages", 0);
+	config_int_init("ProgressReport", 50);
+	config_str_init("CacheDir", "<Wimp$ScrapDir>.PrintPDFCache");
+	config_int_init("CacheSize", 8192);
+
+	/* The resident server runs jobs without -dSAFER, so it is only for trusted print jobs. */
+
+	config_opt_init("ServerMode", FALSE);
+	config_str_init("ServerJobFile", "Pipe:$.PrintPDFJob");
+	config_int_init("ServerJobs", 50);
+	config_int_init("ServerData", 64);
+
+	config_str_init("ProfileDir", "Choices:PrintPDF.Profiles");
+	config_str_init("BatchReport", "<Wimp$ScrapDir>.PrintPDFReport");
 	config_int_init("PDFVersion", 0);
 	config_int_init("Optimization", 0);
 	config_opt_init("DownsampleMono", FALSE);
@@ -326,7 +364,9 @@ static void main_initialise(void)
 	pdfmark_initialise();
 	paper_initialise();
 	iconbar_initialise();
+	cache_initialise();
 	convert_initialise();
+	watcher_initialise();
 	bookmarks_initialise();
 	url_initialise();
 
@@ -341,19 +381,35 @@ static void main_initialise(void)
 
 
 /**
- * Take the command line and parse it for useful arguments.
+ * Take the command line and parse it for useful arguments.  If a batch is
+ * requested, it is started without an iconbar icon and the application
+ * quits once it has been converted.
  */
 
 static void main_parse_command_line(int argc, char *argv[])
 {
 	int	i;
+	char	*batch = NULL, *profile = NULL, *output = NULL, *report = NULL;
 
 	if (argc > 1) {
 		for (i=1; i<argc; i++) {
 			if (strcmp (argv[i], "-file") == 0 && i+1 < argc)
 				bookmarks_load_file(argv[i+1]);
+			else if (strcmp(argv[i], "-batch") == 0 && i+1 < argc)
+				batch = argv[++i];
+			else if (strcmp(argv[i], "-profile") == 0 && i+1 < argc)
+				profile = argv[++i];
+			else if (strcmp(argv[i], "-output") == 0 && i+1 < argc)
+				output = argv[++i];
+			else if (strcmp(argv[i], "-report") == 0 && i+1 < argc)
+				report = argv[++i];
 		}
 	}
+
+	if (batch != NULL) {
+		iconbar_set_icon(FALSE);
+		batch_start(batch, profile, output, report);
+	}
 }
 
 
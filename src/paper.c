@@ -29,6 +29,8 @@
 
 /* ANSI C header files */
 
+#include <stdlib.h>
+
 /* Acorn C header files */
 
 /* OSLib header files */
@@ -31,6 +31,8 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
 
 /* Acorn C header files */
 
@@ -69,6 +71,15 @@
 #define PDFMARK_ICON_SUBJECT 9
 #define PDFMARK_ICON_KEYWORDS 11
 
+/* Not a typedef, as that is done in the header file. */
+
+struct pdfmark_output {
+	FILE		*file;					/**< The file being written to.				*/
+	size_t		used;					/**< The number of bytes held in the buffer.		*/
+	osbool		error;					/**< TRUE if a write to the file has failed.		*/
+	char		buffer[PDFMARK_OUTPUT_BUFFER];		/**< The output waiting to be written.			*/
+};
+
 
 /* Lookup table to convert Acorn Latin1 into PDFDocEncoding. */
 
@@ -111,12 +122,25 @@ static wimp_w	pdfmark_window = NULL;
 
 static void	(*pdfmark_dialogue_close_callback)(void) = NULL;
 
+/* The escapes for each character of the alphabet which they were last built
+ * for, each as a length followed by the PDFDocEncoding bytes, and a note of
+ * those characters which go through unchanged.
+ */
+
+static int	pdfmark_escape_alphabet = -1;
+static char	pdfmark_escapes[256][PDFMARK_ESCAPE_LEN];
+static osbool	pdfmark_escape_copy[256];
+
 
 static void		pdfmark_click_handler(wimp_pointer *pointer);
 static osbool		pdfmark_keypress_handler(wimp_key *key);
 
 static void		pdfmark_shade_dialogue(void);
 
+static void		pdfmark_build_escapes(int alphabet);
+static void		pdfmark_output_bytes(pdfmark_output *output, char *bytes, size_t length);
+static void		pdfmark_flush_output(pdfmark_output *output);
+
 
 /**
  * Initialise the PDFMark dialogue.
@@ -302,36 +326,41 @@ void pdfmark_fill_field(wimp_w window, wimp_i icon, pdfmark_params *params)
 
 
 /**
- * Write document info to a PSDMark file, reflecting the data in the supplied
- * PDFMark parameter block.
+ * Write document info to a PDFMark output stream, reflecting the data in the
+ * supplied PDFMark parameter block.
  *
- * \param *file			The file handle to write to.
- * \param *params		The PRDMark parameter block to translate.
+ * \param *output		The output stream to write to.
+ * \param *params		The PDFMark parameter block to translate.
  */
 
-void pdfmark_write_docinfo_file(FILE *pdfmark_file, pdfmark_params *params)
+void pdfmark_write_docinfo(pdfmark_output *output, pdfmark_params *params)
 {
-	char buffer[MAX_INFO_FIELD * 4];
-
-	if (pdfmark_file == NULL || params == NULL || !pdfmark_data_available(params))
+	if (output == NULL || params == NULL || !pdfmark_data_available(params))
 		return;
 
+	pdfmark_output_text(output, "[");
 
-	fprintf(pdfmark_file, "[");
-
-	if (*(params->title) != '\0')
-		fprintf(pdfmark_file, " /Title (%s)", convert_to_pdf_doc_encoding(buffer, params->title, MAX_INFO_FIELD * 4));
+	if (*(params->title) != '\0') {
+		pdfmark_output_text(output, " /Title ");
+		pdfmark_output_string(output, params->title);
+	}
 
-	if (*(params->author) != '\0')
-		fprintf(pdfmark_file, " /Author (%s)", convert_to_pdf_doc_encoding(buffer, params->author, MAX_INFO_FIELD * 4));
+	if (*(params->author) != '\0') {
+		pdfmark_output_text(output, " /Author ");
+		pdfmark_output_string(output, params->author);
+	}
 
-	if (*(params->subject) != '\0')
-		fprintf(pdfmark_file, " /Subject (%s)", convert_to_pdf_doc_encoding(buffer, params->subject, MAX_INFO_FIELD * 4));
+	if (*(params->subject) != '\0') {
+		pdfmark_output_text(output, " /Subject ");
+		pdfmark_output_string(output, params->subject);
+	}
 
-	if (*(params->keywords) != '\0')
-		fprintf(pdfmark_file, " /Keywords (%s)", convert_to_pdf_doc_encoding(buffer, params->keywords, MAX_INFO_FIELD * 4));
+	if (*(params->keywords) != '\0') {
+		pdfmark_output_text(output, " /Keywords ");
+		pdfmark_output_string(output, params->keywords);
+	}
 
-	fprintf(pdfmark_file, " /DOCINFO pdfmark\n");
+	pdfmark_output_text(output, " /DOCINFO pdfmark\n");
 }
 
 
@@ -350,44 +379,260 @@ osbool pdfmark_data_available(pdfmark_params *params)
 
 
 /**
- * Convert a string from the current RISC OS system alphabet into PDFDocEncoding.
+ * Open a buffered PDFMark output stream on a file, taking the current system
+ * alphabet as the one which strings are in.
  *
- * \param *out			A buffer to accept the converted string.
- * \param *in			A buffer containing the string to convert.
- * \param len			The size of the output buffer.
- * \return			A pointer to the output buffer.
+ * \param *file			The file to write to.
+ * \return			The new output stream; NULL on failure.
  */
 
-char *convert_to_pdf_doc_encoding(char *out, char *in, size_t len)
+pdfmark_output *pdfmark_open_output(FILE *file)
 {
+	pdfmark_output	*output;
 	int		alphabet;
-	char		c, *ci, *co;
+
+	if (file == NULL)
+		return NULL;
+
+	output = malloc(sizeof(pdfmark_output));
+	if (output == NULL)
+		return NULL;
+
+	output->file = file;
+	output->used = 0;
+	output->error = FALSE;
+
+	/* The escapes only need to be rebuilt if the alphabet has changed. */
 
 	alphabet = osbyte1(osbyte_ALPHABET_NUMBER, 127, 0);
 
-	ci = in;
-	co = out;
+	if (alphabet != pdfmark_escape_alphabet)
+		pdfmark_build_escapes(alphabet);
+
+	return output;
+}
+
+
+/**
+ * Close a PDFMark output stream, writing out anything which remains in its
+ * buffer.  The file itself is left open.
+ *
+ * \param *output		The output stream to close.
+ * \return			TRUE if all of the output was written; else FALSE.
+ */
+
+osbool pdfmark_close_output(pdfmark_output *output)
+{
+	osbool		success;
+
+	if (output == NULL)
+		return FALSE;
+
+	pdfmark_flush_output(output);
+
+	success = !output->error;
 
-	while ((*ci != '\0') && ((co - out) < len)) {
-		switch (alphabet) {
-		case 101: /* Latin 1, or catch-all defualt. */
-		default:
-			c = latin1_to_pdfdocencoding[(*ci++) % 256];
-			break;
+	free(output);
+
+	return success;
+}
+
+
+/**
+ * Write some text to a PDFMark output stream as it stands.
+ *
+ * \param *output		The output stream to write to.
+ * \param *text			The text to write.
+ */
+
+void pdfmark_output_text(pdfmark_output *output, char *text)
+{
+	if (output != NULL && text != NULL)
+		pdfmark_output_bytes(output, text, strlen(text));
+}
+
+
+/**
+ * Write a decimal integer to a PDFMark output stream.
+ *
+ * \param *output		The output stream to write to.
+ * \param number		The number to write.
+ */
+
+void pdfmark_output_number(pdfmark_output *output, int number)
+{
+	char		digits[16], *c;
+	unsigned	value;
+
+	if (output == NULL)
+		return;
+
+	/* Build the digits backwards from the end of the buffer. */
+
+	c = digits + sizeof(digits);
+	value = (number < 0) ? 0u - (unsigned) number : (unsigned) number;
+
+	do {
+		*--c = '0' + value % 10;
+		value /= 10;
+	} while (value > 0);
+
+	if (number < 0)
+		*--c = '-';
+
+	pdfmark_output_bytes(output, c, digits + sizeof(digits) - c);
+}
+
+
+/**
+ * Write formatted text to a PDFMark output stream.  The text must come to
+ * less than PDFMARK_OUTPUT_FORMAT bytes.
+ *
+ * \param *output		The output stream to write to.
+ * \param *format		The printf() format string.
+ * \param ...			The values to format.
+ */
+
+void pdfmark_output_printf(pdfmark_output *output, char *format, ...)
+{
+	va_list		ap;
+	int		length;
+
+	if (output == NULL || format == NULL)
+		return;
+
+	if (PDFMARK_OUTPUT_BUFFER - output->used < PDFMARK_OUTPUT_FORMAT)
+		pdfmark_flush_output(output);
+
+	va_start(ap, format);
+	length = vsnprintf(output->buffer + output->used, PDFMARK_OUTPUT_FORMAT, format, ap);
+	va_end(ap);
+
+	if (length >= 0 && length < PDFMARK_OUTPUT_FORMAT)
+		output->used += length;
+	else
+		output->error = TRUE;
+}
+
+
+/**
+ * Write a string from the system alphabet to a PDFMark output stream as a
+ * PDF string in PDFDocEncoding, complete with its enclosing brackets.  Runs
+ * of characters which need no escaping are copied across in one go.
+ *
+ * \param *output		The output stream to write to.
+ * \param *text			The string to write.
+ */
+
+void pdfmark_output_string(pdfmark_output *output, char *text)
+{
+	unsigned char	*c, *run;
+	char		*escape;
+
+	if (output == NULL || text == NULL)
+		return;
+
+	pdfmark_output_bytes(output, "(", 1);
+
+	c = (unsigned char *) text;
+
+	while (*c != '\0') {
+		for (run = c; pdfmark_escape_copy[*c]; c++);
+
+		if (c > run)
+			pdfmark_output_bytes(output, (char *) run, c - run);
+
+		if (*c != '\0') {
+			escape = pdfmark_escapes[*c++];
+			pdfmark_output_bytes(output, escape + 1, escape[0]);
 		}
+	}
+
+	pdfmark_output_bytes(output, ")", 1);
+}
+
 
-		/* 'Standard' characters in range 32 to 126 go through as a single byte;
-		 * anything else is escaped in octal.
-		 */
+/**
+ * Build the escapes used to write strings from a system alphabet into
+ * PDFDocEncoding.  'Standard' characters in the range 32 to 126 go through
+ * as a single byte; anything else, along with the brackets and backslash,
+ * is escaped in octal.
+ *
+ * \param alphabet		The alphabet to build the escapes for.
+ */
 
-		if (c >= 32 && c < 127 && c != '(' && c != ')')
-			*co++ = c;
-		else
-			co += snprintf(co, (len - (co - out + 1)), "\\%03o", (unsigned int) c);
+static void pdfmark_build_escapes(int alphabet)
+{
+	char		*encoding, *escape;
+	unsigned char	c;
+	int		i;
+
+	switch (alphabet) {
+	case 101: /* Latin 1, or catch-all default. */
+	default:
+		encoding = latin1_to_pdfdocencoding;
+		break;
 	}
 
-	*co = '\0';
+	for (i = 0; i < 256; i++) {
+		c = encoding[i];
+		escape = pdfmark_escapes[i];
+
+		if (c >= 32 && c < 127 && c != '(' && c != ')' && c != '\\') {
+			escape[0] = 1;
+			escape[1] = c;
+		} else {
+			escape[0] = 4;
+			escape[1] = '\\';
+			escape[2] = '0' + ((c >> 6) & 7);
+			escape[3] = '0' + ((c >> 3) & 7);
+			escape[4] = '0' + (c & 7);
+		}
+
+		/* The terminator must never be copied, as it ends the runs. */
+
+		pdfmark_escape_copy[i] = (i != 0 && escape[0] == 1 && c == i) ? TRUE : FALSE;
+	}
+
+	pdfmark_escape_alphabet = alphabet;
+}
+
+
+/**
+ * Write bytes to a PDFMark output stream, through its buffer.
+ *
+ * \param *output		The output stream to write to.
+ * \param *bytes		The bytes to write.
+ * \param length		The number of bytes to write.
+ */
+
+static void pdfmark_output_bytes(pdfmark_output *output, char *bytes, size_t length)
+{
+	if (output->used + length > PDFMARK_OUTPUT_BUFFER)
+		pdfmark_flush_output(output);
+
+	if (length > PDFMARK_OUTPUT_BUFFER) {
+		if (!output->error && fwrite(bytes, 1, length, output->file) != length)
+			output->error = TRUE;
+		return;
+	}
+
+	memcpy(output->buffer + output->used, bytes, length);
+	output->used += length;
+}
+
+
+/**
+ * Write out the contents of a PDFMark output stream's buffer.
+ *
+ * \param *output		The output stream to flush.
+ */
+
+static void pdfmark_flush_output(pdfmark_output *output)
+{
+	if (output->used > 0 && !output->error && fwrite(output->buffer, 1, output->used, output->file) != output->used)
+		output->error = TRUE;
 
-	return out;
+	output->used = 0;
 }
 
@@ -30,10 +30,16 @@
 #ifndef PRINTPDF_PDFMARK
 #define PRINTPDF_PDFMARK
 
+#include <stdio.h>
+#include "oslib/wimp.h"
 
 #define MAX_INFO_FIELD 255
 #define MAX_PDFMARK_FILENAME 256
 
+#define PDFMARK_OUTPUT_BUFFER 32768
+#define PDFMARK_OUTPUT_FORMAT 256
+#define PDFMARK_ESCAPE_LEN 5
+
 
 typedef struct pdfmark_params {
 	char		title[MAX_INFO_FIELD];
@@ -42,6 +48,12 @@ typedef struct pdfmark_params {
 	char		keywords[MAX_INFO_FIELD];
 } pdfmark_params;
 
+/**
+ * A buffered PDFMark output stream.
+ */
+
+typedef struct pdfmark_output pdfmark_output;
+
 
 /**
  * Initialise the PDFMark dialogue.
@@ -112,14 +124,14 @@ void pdfmark_fill_field(wimp_w window, wimp_i icon, pdfmark_params *params);
 
 
 /**
- * Write document info to a PDFMark file, reflecting the data in the supplied
- * PDFMark parameter block.
+ * Write document info to a PDFMark output stream, reflecting the data in the
+ * supplied PDFMark parameter block.
  *
- * \param *file			The file handle to write to.
- * \param *params		The PRDMark parameter block to translate.
+ * \param *output		The output stream to write to.
+ * \param *params		The PDFMark parameter block to translate.
  */
 
-void pdfmark_write_docinfo_file(FILE *pdfmark_file, pdfmark_params *params);
+void pdfmark_write_docinfo(pdfmark_output *output, pdfmark_params *params);
 
 
 /**
@@ -133,15 +145,68 @@ osbool pdfmark_data_available(pdfmark_params *params);
 
 
 /**
- * Convert a string from the current RISC OS system alphabet into PDFDocEncoding.
+ * Open a buffered PDFMark output stream on a file, taking the current system
+ * alphabet as the one which strings are in.
+ *
+ * \param *file			The file to write to.
+ * \return			The new output stream; NULL on failure.
+ */
+
+pdfmark_output *pdfmark_open_output(FILE *file);
+
+
+/**
+ * Close a PDFMark output stream, writing out anything which remains in its
+ * buffer.  The file itself is left open.
+ *
+ * \param *output		The output stream to close.
+ * \return			TRUE if all of the output was written; else FALSE.
+ */
+
+osbool pdfmark_close_output(pdfmark_output *output);
+
+
+/**
+ * Write some text to a PDFMark output stream as it stands.
+ *
+ * \param *output		The output stream to write to.
+ * \param *text			The text to write.
+ */
+
+void pdfmark_output_text(pdfmark_output *output, char *text);
+
+
+/**
+ * Write a decimal integer to a PDFMark output stream.
+ *
+ * \param *output		The output stream to write to.
+ * \param number		The number to write.
+ */
+
+void pdfmark_output_number(pdfmark_output *output, int number);
+
+
+/**
+ * Write formatted text to a PDFMark output stream.  The text must come to
+ * less than PDFMARK_OUTPUT_FORMAT bytes.
+ *
+ * \param *output		The output stream to write to.
+ * \param *format		The printf() format string.
+ * \param ...			The values to format.
+ */
+
+void pdfmark_output_printf(pdfmark_output *output, char *format, ...);
+
+
+/**
+ * Write a string from the system alphabet to a PDFMark output stream as a
+ * PDF string in PDFDocEncoding, complete with its enclosing brackets.
  *
- * \param *out			A buffer to accept the converted string.
- * \param *in			A buffer containing the string to convert.
- * \param len			The size of the output buffer.
- * \return			A pointer to the output buffer.
+ * \param *output		The output stream to write to.
+ * \param *text			The string to write.
  */
 
-char *convert_to_pdf_doc_encoding(char *out, char *in, size_t len);
+void pdfmark_output_string(pdfmark_output *output, char *text);
 
 #endif
 
@@ -0,0 +1,458 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: profile.c
+ *
+ * Conversion settings profile implementation.
+ *
+ * A profile is a text file in the ProfileDir folder, holding settings in
+ * the same format as the Choices file.  Only the settings used by
+ * conversions -- the PDF version, optimization, encryption, PDFMark, paper
+ * and preprocessing settings -- can be given; any others are ignored.
+ *
+ * Each profile is compiled when it is first used: the settings are read
+ * into the parameter blocks used by the conversion, and the gs switches
+ * are built from them, so that a conversion using the profile only has to
+ * copy them.  If the profile's file changes, it is compiled afresh.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/types.h"
+#include "oslib/osfile.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/debug.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "profile.h"
+
+
+/**
+ * The maximum length of a profile filename.
+ */
+
+#define PROFILE_MAX_FILENAME 256
+
+/**
+ * The maximum length of a line in a profile.
+ */
+
+#define PROFILE_LINE_LEN 1024
+
+/**
+ * The size of the buffers used to build each group of switches.
+ */
+
+#define PROFILE_PARAM_LEN 1024
+
+/**
+ * The types of setting which can appear in a profile.
+ */
+
+enum profile_type {
+	PROFILE_TYPE_OPT,				/**< A boolean option.					*/
+	PROFILE_TYPE_INT,				/**< An integer option.					*/
+	PROFILE_TYPE_STR				/**< A string option.					*/
+};
+
+/**
+ * A setting which can appear in a profile.
+ */
+
+struct profile_setting {
+	char			*name;			/**< The name of the setting in the Choices.		*/
+	enum profile_type	type;			/**< The type of the setting.				*/
+};
+
+/**
+ * A compiled profile.
+ */
+
+struct profile {
+	char			name[PROFILE_MAX_NAME];	/**< The name of the profile.				*/
+	bits			load_addr;		/**< The load address of the file when compiled.	*/
+	bits			exec_addr;		/**< The exec address of the file when compiled.	*/
+	int			size;			/**< The size of the file when compiled.		*/
+	struct profile_settings	settings;		/**< The compiled settings.				*/
+
+	struct profile		*next;			/**< The next profile in the list.			*/
+};
+
+/**
+ * The value of a setting, saved while a profile is being compiled.
+ */
+
+union profile_value {
+	int			number;			/**< The value of an integer or boolean setting.	*/
+	char			*text;			/**< A copy of the value of a string setting.		*/
+};
+
+/* Function Prototypes. */
+
+static struct profile *profile_load(char *name, char *filename);
+static osbool profile_read_file(char *filename, char *name);
+static int profile_find_setting(char *name);
+
+
+/**
+ * The settings which can be given in a profile.
+ */
+
+static struct profile_setting profile_settings_list[] = {
+	{"PDFVersion", PROFILE_TYPE_INT},
+	{"Optimization", PROFILE_TYPE_INT},
+	{"DownsampleMono", PROFILE_TYPE_OPT},
+	{"DownsampleMonoType", PROFILE_TYPE_INT},
+	{"DownsampleMonoResolution", PROFILE_TYPE_INT},
+	{"DownsampleMonoThreshold", PROFILE_TYPE_INT},
+	{"DownsampleMonoDepth", PROFILE_TYPE_INT},
+	{"DownsampleGrey", PROFILE_TYPE_OPT},
+	{"DownsampleGreyType", PROFILE_TYPE_INT},
+	{"DownsampleGreyResolution", PROFILE_TYPE_INT},
+	{"DownsampleGreyThreshold", PROFILE_TYPE_INT},
+	{"DownsampleGreyDepth", PROFILE_TYPE_INT},
+	{"DownsampleColour", PROFILE_TYPE_OPT},
+	{"DownsampleColourType", PROFILE_TYPE_INT},
+	{"DownsampleColourResolution", PROFILE_TYPE_INT},
+	{"DownsampleColourThreshold", PROFILE_TYPE_INT},
+	{"DownsampleColourDepth", PROFILE_TYPE_INT},
+	{"EncodeMono", PROFILE_TYPE_OPT},
+	{"EncodeMonoType", PROFILE_TYPE_INT},
+	{"EncodeGrey", PROFILE_TYPE_OPT},
+	{"EncodeGreyType", PROFILE_TYPE_INT},
+	{"EncodeColour", PROFILE_TYPE_OPT},
+	{"EncodeColourType", PROFILE_TYPE_INT},
+	{"AutoPageRotation", PROFILE_TYPE_INT},
+	{"CompressPages", PROFILE_TYPE_OPT},
+	{"OwnerPasswd", PROFILE_TYPE_STR},
+	{"UserPasswd", PROFILE_TYPE_STR},
+	{"AllowPrint", PROFILE_TYPE_OPT},
+	{"AllowFullPrint", PROFILE_TYPE_OPT},
+	{"AllowExtraction", PROFILE_TYPE_OPT},
+	{"AllowFullExtraction", PROFILE_TYPE_OPT},
+	{"AllowForms", PROFILE_TYPE_OPT},
+	{"AllowAnnotation", PROFILE_TYPE_OPT},
+	{"AllowModifications", PROFILE_TYPE_OPT},
+	{"AllowAssembly", PROFILE_TYPE_OPT},
+	{"PDFMarkTitle", PROFILE_TYPE_STR},
+	{"PDFMarkAuthor", PROFILE_TYPE_STR},
+	{"PDFMarkSubject", PROFILE_TYPE_STR},
+	{"PDFMarkKeywords", PROFILE_TYPE_STR},
+	{"PaperOverride", PROFILE_TYPE_OPT},
+	{"PaperPreset", PROFILE_TYPE_INT},
+	{"PaperWidth", PROFILE_TYPE_INT},
+	{"PaperHeight", PROFILE_TYPE_INT},
+	{"PaperUnits", PROFILE_TYPE_INT},
+	{"PreProcess", PROFILE_TYPE_OPT},
+	{NULL, PROFILE_TYPE_OPT}
+};
+
+/**
+ * The number of settings in the list.
+ */
+
+#define PROFILE_SETTINGS ((int) (sizeof(profile_settings_list) / sizeof(struct profile_setting)) - 1)
+
+/**
+ * The profiles which have been compiled.
+ */
+
+static struct profile *profile_list = NULL;
+
+
+/**
+ * Compile the gs switches for a set of conversion settings, so that they
+ * don't need to be rebuilt each time that they are used.
+ *
+ * \param *settings		The settings to compile.
+ */
+
+void profile_compile(struct profile_settings *settings)
+{
+	char	encrypt_buf[PROFILE_PARAM_LEN], optimize_buf[PROFILE_PARAM_LEN];
+	char	version_buf[PROFILE_PARAM_LEN], paper_buf[PROFILE_PARAM_LEN];
+
+	if (settings == NULL)
+		return;
+
+	version_build_params(version_buf, PROFILE_PARAM_LEN, &(settings->version));
+	optimize_build_params(optimize_buf, PROFILE_PARAM_LEN, &(settings->optimization));
+	paper_build_params(paper_buf, PROFILE_PARAM_LEN, &(settings->paper));
+	encryption_build_params(encrypt_buf, PROFILE_PARAM_LEN, &(settings->encryption), settings->version.standard_version >= 2);
+
+	string_printf(settings->switches, PROFILE_MAX_SWITCHES, "%s%s%s%s", version_buf, optimize_buf, encrypt_buf, paper_buf);
+	string_printf(settings->chunk_switches, PROFILE_MAX_SWITCHES, "%s%s%s", version_buf, optimize_buf, paper_buf);
+}
+
+
+/**
+ * Test whether a profile name is valid, so that it can't lead outside of
+ * the ProfileDir folder.
+ *
+ * \param *name			The name to test.
+ * \return			TRUE if the name is valid; else FALSE.
+ */
+
+osbool profile_valid_name(char *name)
+{
+	int	i;
+
+	if (name == NULL || *name == '\0' || strlen(name) >= PROFILE_MAX_NAME)
+		return FALSE;
+
+	for (i = 0; name[i] != '\0'; i++) {
+		if (!((name[i] >= 'a' && name[i] <= 'z') || (name[i] >= 'A' && name[i] <= 'Z') ||
+				(name[i] >= '0' && name[i] <= '9') || name[i] == '-' || name[i] == '_'))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Find a named settings profile, loading and compiling it if it hasn't
+ * been used before or if its file has changed since it was compiled.
+ *
+ * The settings are taken from the Choices, with any which are given in
+ * the profile replacing them.  The pointer returned is only valid until
+ * the next call.
+ *
+ * \param *name			The name of the profile to find.
+ * \return			Pointer to the profile, or NULL if it can't
+ *				be found.
+ */
+
+struct profile_settings *profile_find(char *name)
+{
+	char		filename[PROFILE_MAX_FILENAME];
+	struct profile	**list, *profile;
+	bits		load_addr, exec_addr;
+	int		size;
+
+	if (!profile_valid_name(name))
+		return NULL;
+
+	string_printf(filename, PROFILE_MAX_FILENAME, "%s.%s", config_str_read("ProfileDir"), name);
+
+	if (osfile_read_stamped_no_path(filename, &load_addr, &exec_addr, &size, NULL, NULL) != fileswitch_IS_FILE)
+		return NULL;
+
+	for (list = &profile_list; *list != NULL; list = &((*list)->next)) {
+		if (string_nocase_strcmp((*list)->name, name) == 0)
+			break;
+	}
+
+	/* A profile which hasn't changed can be used as it stands; one which has is replaced. */
+
+	if (*list != NULL && (*list)->load_addr == load_addr && (*list)->exec_addr == exec_addr && (*list)->size == size)
+		return &((*list)->settings);
+
+	profile = profile_load(name, filename);
+	if (profile == NULL)
+		return NULL;
+
+	profile->load_addr = load_addr;
+	profile->exec_addr = exec_addr;
+	profile->size = size;
+
+	if (*list != NULL) {
+		profile->next = (*list)->next;
+		free(*list);
+	} else {
+		profile->next = NULL;
+	}
+
+	*list = profile;
+
+	return &(profile->settings);
+}
+
+
+/**
+ * Load and compile a profile.  The settings in the profile are written
+ * into the configuration while the parameter blocks are initialised from
+ * it, and then the original values are put back.
+ *
+ * \param *name			The name of the profile.
+ * \param *filename		The profile's file.
+ * \return			Pointer to the new profile, or NULL on failure.
+ */
+
+static struct profile *profile_load(char *name, char *filename)
+{
+	struct profile		*profile;
+	union profile_value	saved[PROFILE_SETTINGS];
+	osbool			success = TRUE;
+	int			i;
+
+	profile = malloc(sizeof(struct profile));
+	if (profile == NULL)
+		return NULL;
+
+	string_copy(profile->name, name, PROFILE_MAX_NAME);
+
+	/* Save the current values of all of the settings which a profile can change. */
+
+	for (i = 0; i < PROFILE_SETTINGS; i++) {
+		switch (profile_settings_list[i].type) {
+		case PROFILE_TYPE_OPT:
+			saved[i].number = config_opt_read(profile_settings_list[i].name);
+			break;
+		case PROFILE_TYPE_INT:
+			saved[i].number = config_int_read(profile_settings_list[i].name);
+			break;
+		case PROFILE_TYPE_STR:
+			saved[i].text = strdup(config_str_read(profile_settings_list[i].name));
+			if (saved[i].text == NULL)
+				success = FALSE;
+			break;
+		}
+	}
+
+	/* Apply the profile and read the settings back from the configuration. */
+
+	if (success && profile_read_file(filename, name)) {
+		encrypt_initialise_settings(&(profile->settings.encryption));
+		optimize_initialise_settings(&(profile->settings.optimization));
+		version_initialise_settings(&(profile->settings.version));
+		paper_initialise_settings(&(profile->settings.paper));
+		pdfmark_initialise_settings(&(profile->settings.pdfmark));
+		bookmark_initialise_settings(&(profile->settings.bookmark));
+		profile->settings.preprocess = config_opt_read("PreProcess");
+
+		profile_compile(&(profile->settings));
+	} else {
+		success = FALSE;
+	}
+
+	/* Put the original settings back. */
+
+	for (i = 0; i < PROFILE_SETTINGS; i++) {
+		switch (profile_settings_list[i].type) {
+		case PROFILE_TYPE_OPT:
+			config_opt_set(profile_settings_list[i].name, saved[i].number);
+			break;
+		case PROFILE_TYPE_INT:
+			config_int_set(profile_settings_list[i].name, saved[i].number);
+			break;
+		case PROFILE_TYPE_STR:
+			if (saved[i].text != NULL)
+				config_str_set(profile_settings_list[i].name, saved[i].text);
+			free(saved[i].text);
+			break;
+		}
+	}
+
+	if (!success) {
+		free(profile);
+		return NULL;
+	}
+
+	#ifdef DEBUG
+	debug_printf("Compiled profile %s: %s", name, profile->settings.switches);
+	#endif
+
+	return profile;
+}
+
+
+/**
+ * Read the settings from a profile file into the configuration.
+ *
+ * \param *filename		The file to read.
+ * \param *name			The name of the profile, for reporting.
+ * \return			TRUE if the file was read; else FALSE.
+ */
+
+static osbool profile_read_file(char *filename, char *name)
+{
+	char	section[PROFILE_LINE_LEN], token[PROFILE_LINE_LEN], value[PROFILE_LINE_LEN];
+	FILE	*in;
+	int	setting;
+
+	in = fopen(filename, "r");
+	if (in == NULL)
+		return FALSE;
+
+	while (config_read_token_pair(in, token, value, section) != sf_CONFIG_READ_EOF) {
+		setting = profile_find_setting(token);
+
+		if (setting == -1) {
+			#ifdef DEBUG
+			debug_printf("Unknown setting %s in profile %s", token, name);
+			#endif
+			continue;
+		}
+
+		switch (profile_settings_list[setting].type) {
+		case PROFILE_TYPE_OPT:
+			config_opt_set(profile_settings_list[setting].name, config_read_opt_string(value));
+			break;
+		case PROFILE_TYPE_INT:
+			config_int_set(profile_settings_list[setting].name, atoi(value));
+			break;
+		case PROFILE_TYPE_STR:
+			config_str_set(profile_settings_list[setting].name, value);
+			break;
+		}
+	}
+
+	fclose(in);
+
+	return TRUE;
+}
+
+
+/**
+ * Find a setting in the list of those which a profile can change.
+ *
+ * \param *name			The name of the setting.
+ * \return			The index of the setting, or -1 if not found.
+ */
+
+static int profile_find_setting(char *name)
+{
+	int	i;
+
+	for (i = 0; i < PROFILE_SETTINGS; i++) {
+		if (string_nocase_strcmp(profile_settings_list[i].name, name) == 0)
+			return i;
+	}
+
+	return -1;
+}
@@ -0,0 +1,112 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: profile.h
+ *
+ * Conversion settings profile implementation.
+ */
+
+#ifndef PRINTPDF_PROFILE
+#define PRINTPDF_PROFILE
+
+#include <stdio.h>
+#include "oslib/types.h"
+#include "oslib/wimp.h"
+
+#include "bookmark.h"
+#include "encrypt.h"
+#include "optimize.h"
+#include "paper.h"
+#include "pdfmark.h"
+#include "version.h"
+
+/**
+ * The maximum length of a profile name.
+ */
+
+#define PROFILE_MAX_NAME 32
+
+/**
+ * The size of the buffers holding the compiled gs switches.
+ */
+
+#define PROFILE_MAX_SWITCHES 4096
+
+/**
+ * A set of conversion settings, along with the gs switches compiled from
+ * them.  Once compiled, a named profile is never changed: if its file is
+ * edited, a new one is compiled in its place.
+ */
+
+struct profile_settings {
+	encrypt_params		encryption;				/**< The encryption settings.				*/
+	optimize_params		optimization;				/**< The optimization settings.				*/
+	version_params		version;				/**< The PDF version settings.				*/
+	paper_params		paper;					/**< The paper settings.				*/
+	pdfmark_params		pdfmark;				/**< The document information settings.			*/
+	bookmark_params		bookmark;				/**< The bookmarks to add, which profiles never have.	*/
+	osbool			preprocess;				/**< TRUE to pass files through ps2ps first.		*/
+
+	char			switches[PROFILE_MAX_SWITCHES];		/**< The gs switches for the settings.			*/
+	char			chunk_switches[PROFILE_MAX_SWITCHES];	/**< The switches for a chunk, without encryption.	*/
+};
+
+
+/**
+ * Compile the gs switches for a set of conversion settings, so that they
+ * don't need to be rebuilt each time that they are used.
+ *
+ * \param *settings		The settings to compile.
+ */
+
+void profile_compile(struct profile_settings *settings);
+
+
+/**
+ * Test whether a profile name is valid, so that it can't lead outside of
+ * the ProfileDir folder.
+ *
+ * \param *name			The name to test.
+ * \return			TRUE if the name is valid; else FALSE.
+ */
+
+osbool profile_valid_name(char *name);
+
+
+/**
+ * Find a named settings profile, loading and compiling it if it hasn't
+ * been used before or if its file has changed since it was compiled.
+ *
+ * The settings are taken from the Choices, with any which are given in
+ * the profile replacing them.  The pointer returned is only valid until
+ * the next call.
+ *
+ * \param *name			The name of the profile to find.
+ * \return			Pointer to the profile, or NULL if it can't
+ *				be found.
+ */
+
+struct profile_settings *profile_find(char *name);
+
+#endif
@@ -0,0 +1,227 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: progress.c
+ *
+ * Conversion progress tracking implementation.
+ *
+ * Conversions report the end of each page on their output, and the tracker
+ * keeps a note of the times at which the most recent pages ended.  The time
+ * left is estimated from the rate at which those pages were converted, so
+ * that it follows changes in the complexity of the document.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/msgs.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "progress.h"
+
+
+/**
+ * The length of the buffers used to build parameters for descriptions.
+ */
+
+#define PROGRESS_PARAM_LENGTH 16
+
+
+/**
+ * Start tracking the progress of a conversion.
+ *
+ * \param *progress		The tracker to start.
+ * \param pages_total		The number of pages expected, or 0 if unknown.
+ * \param bytes_total		The total number of bytes of input.
+ */
+
+void progress_start(struct progress_tracker *progress, int pages_total, int bytes_total)
+{
+	if (progress == NULL)
+		return;
+
+	progress->pages_done = 0;
+	progress->pages_total = (pages_total > 0) ? pages_total : 0;
+	progress->bytes_in = 0;
+	progress->bytes_total = (bytes_total > 0) ? bytes_total : 0;
+	progress->started = os_read_monotonic_time();
+	progress->reported = progress->started;
+}
+
+
+/**
+ * Record the end of a page in a conversion.
+ *
+ * \param *progress		The tracker to update.
+ * \param bytes_in		The number of bytes of input now consumed, or
+ *				-1 to estimate it from the pages.
+ */
+
+void progress_add_page(struct progress_tracker *progress, int bytes_in)
+{
+	if (progress == NULL)
+		return;
+
+	progress->page_time[progress->pages_done % PROGRESS_WINDOW] = os_read_monotonic_time();
+	progress->pages_done++;
+
+	/* Documents can have more pages than their comments admit to. */
+
+	if (progress->pages_total > 0 && progress->pages_done > progress->pages_total)
+		progress->pages_total = progress->pages_done;
+
+	if (bytes_in < 0 && progress->pages_total > 0)
+		bytes_in = (int) (((long long) progress->bytes_total * progress->pages_done) / progress->pages_total);
+
+	if (bytes_in > progress->bytes_total)
+		bytes_in = progress->bytes_total;
+
+	if (bytes_in > progress->bytes_in)
+		progress->bytes_in = bytes_in;
+}
+
+
+/**
+ * Estimate the time left before a conversion completes, from the rate at
+ * which its most recent pages were converted.
+ *
+ * \param *progress		The tracker to interrogate.
+ * \return			The time left in centiseconds, or -1 if unknown.
+ */
+
+int progress_get_eta(struct progress_tracker *progress)
+{
+	int	pages;
+	os_t	start, elapsed;
+
+	if (progress == NULL || progress->pages_total == 0 || progress->pages_done == 0)
+		return -1;
+
+	/* Measure the rate over the pages in the window, or from the start of the conversion if the window
+	 * hasn't filled yet.
+	 */
+
+	if (progress->pages_done > PROGRESS_WINDOW) {
+		pages = PROGRESS_WINDOW - 1;
+		start = progress->page_time[progress->pages_done % PROGRESS_WINDOW];
+	} else {
+		pages = progress->pages_done;
+		start = progress->started;
+	}
+
+	elapsed = progress->page_time[(progress->pages_done - 1) % PROGRESS_WINDOW] - start;
+
+	if (pages <= 0 || elapsed <= 0)
+		return -1;
+
+	return (int) (((long long) elapsed * (progress->pages_total - progress->pages_done)) / pages);
+}
+
+
+/**
+ * Test whether a conversion's progress should be reported again, limiting
+ * the reports to one every ProgressReport centiseconds.  If TRUE is
+ * returned, the report is assumed to have been made.
+ *
+ * \param *progress		The tracker to test.
+ * \return			TRUE if progress should be reported; else FALSE.
+ */
+
+osbool progress_report_due(struct progress_tracker *progress)
+{
+	os_t	now;
+
+	if (progress == NULL)
+		return FALSE;
+
+	now = os_read_monotonic_time();
+
+	if (now - progress->reported < config_int_read("ProgressReport") &&
+			(progress->pages_total == 0 || progress->pages_done < progress->pages_total))
+		return FALSE;
+
+	progress->reported = now;
+
+	return TRUE;
+}
+
+
+/**
+ * Describe the progress of a conversion in a buffer, for display.
+ *
+ * \param *progress		The tracker to describe.
+ * \param *name			The name of the conversion.
+ * \param *buffer		Pointer to the buffer to take the description.
+ * \param len			The size of the buffer.
+ * \return			Pointer to the description in the buffer.
+ */
+
+char *progress_describe(struct progress_tracker *progress, char *name, char *buffer, size_t len)
+{
+	char	done[PROGRESS_PARAM_LENGTH], total[PROGRESS_PARAM_LENGTH], left[PROGRESS_PARAM_LENGTH];
+	int	eta;
+
+	if (buffer == NULL || len == 0)
+		return NULL;
+
+	if (progress == NULL || progress->pages_done == 0) {
+		msgs_param_lookup("Progress0", buffer, len, name, NULL, NULL, NULL);
+		return buffer;
+	}
+
+	string_printf(done, PROGRESS_PARAM_LENGTH, "%d", progress->pages_done);
+
+	if (progress->pages_total == 0) {
+		msgs_param_lookup("Progress1", buffer, len, name, done, NULL, NULL);
+		return buffer;
+	}
+
+	string_printf(total, PROGRESS_PARAM_LENGTH, "%d", progress->pages_total);
+
+	eta = progress_get_eta(progress);
+
+	if (eta < 0) {
+		msgs_param_lookup("Progress2", buffer, len, name, done, total, NULL);
+		return buffer;
+	}
+
+	eta = (eta + 99) / 100;
+	string_printf(left, PROGRESS_PARAM_LENGTH, "%d:%02d", eta / 60, eta % 60);
+	msgs_param_lookup("Progress3", buffer, len, name, done, total, left);
+
+	return buffer;
+}
+
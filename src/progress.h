@@ -0,0 +1,131 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: progress.h
+ *
+ * Conversion progress tracking implementation.
+ */
+
+#ifndef PRINTPDF_PROGRESS
+#define PRINTPDF_PROGRESS
+
+#include <stddef.h>
+
+#include "oslib/os.h"
+
+/**
+ * The number of recent pages over which the conversion rate is measured.
+ */
+
+#define PROGRESS_WINDOW 8
+
+/**
+ * The text used by a conversion to mark the end of each page on its
+ * output, which is set up by PROGRESS_PAGE_HOOK.
+ */
+
+#define PROGRESS_PAGE_MARK "PrintPDF:Page"
+
+/**
+ * PostScript to be run by gs -c before a document, installing an EndPage
+ * procedure which writes PROGRESS_PAGE_MARK on a line of its own after
+ * every page is output.
+ */
+
+#define PROGRESS_PAGE_HOOK "<< /EndPage { exch pop dup 2 ne { (" PROGRESS_PAGE_MARK ") = flush } if 2 ne } >> setpagedevice"
+
+/**
+ * The progress of a conversion.
+ */
+
+struct progress_tracker {
+	int		pages_done;				/**< The number of pages converted.			*/
+	int		pages_total;				/**< The number of pages expected, or 0 if unknown.	*/
+	int		bytes_in;				/**< The number of bytes of input consumed.		*/
+	int		bytes_total;				/**< The total number of bytes of input.		*/
+	os_t		started;				/**< The time at which the conversion started.		*/
+	os_t		page_time[PROGRESS_WINDOW];		/**< The times at which the most recent pages ended.	*/
+	os_t		reported;				/**< The time at which progress was last reported.	*/
+};
+
+
+/**
+ * Start tracking the progress of a conversion.
+ *
+ * \param *progress		The tracker to start.
+ * \param pages_total		The number of pages expected, or 0 if unknown.
+ * \param bytes_total		The total number of bytes of input.
+ */
+
+void progress_start(struct progress_tracker *progress, int pages_total, int bytes_total);
+
+
+/**
+ * Record the end of a page in a conversion.
+ *
+ * \param *progress		The tracker to update.
+ * \param bytes_in		The number of bytes of input now consumed, or
+ *				-1 to estimate it from the pages.
+ */
+
+void progress_add_page(struct progress_tracker *progress, int bytes_in);
+
+
+/**
+ * Estimate the time left before a conversion completes, from the rate at
+ * which its most recent pages were converted.
+ *
+ * \param *progress		The tracker to interrogate.
+ * \return			The time left in centiseconds, or -1 if unknown.
+ */
+
+int progress_get_eta(struct progress_tracker *progress);
+
+
+/**
+ * Test whether a conversion's progress should be reported again, limiting
+ * the reports to one every ProgressReport centiseconds.  If TRUE is
+ * returned, the report is assumed to have been made.
+ *
+ * \param *progress		The tracker to test.
+ * \return			TRUE if progress should be reported; else FALSE.
+ */
+
+osbool progress_report_due(struct progress_tracker *progress);
+
+
+/**
+ * Describe the progress of a conversion in a buffer, for display.
+ *
+ * \param *progress		The tracker to describe.
+ * \param *name			The name of the conversion.
+ * \param *buffer		Pointer to the buffer to take the description.
+ * \param len			The size of the buffer.
+ * \return			Pointer to the description in the buffer.
+ */
+
+char *progress_describe(struct progress_tracker *progress, char *name, char *buffer, size_t len);
+
+#endif
+
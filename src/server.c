@@ -0,0 +1,754 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: server.c
+ *
+ * Resident Ghostscript server implementation.
+ *
+ * The server is a copy of gs, running in job server mode in a TaskWindow
+ * of which PrintPDF is the parent.  Each job is written out as a PostScript
+ * file, and the server told to run it by sending a command through
+ * Message_TaskWindow_Input; gs wraps every job in its own save and restore,
+ * so nothing leaks from one job to the next.  When a job completes, the
+ * server reports back through Message_TaskWindow_Output.
+ *
+ * After ServerJobs jobs, or ServerData megabytes of print data, the server
+ * is closed down and a fresh one started for the next job.
+ *
+ * Changing the output file between jobs isn't permitted by gs while SAFER
+ * is in force, so the server has to run without it.  A job can therefore
+ * reach any file on the system, which is why the server is only used if
+ * enabled by the ServerMode option and the risk is set out in the manual.
+ * A job which overruns is stopped by closing the whole server down.
+ */
+
+/* ANSI C header files */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+#include "oslib/taskwindow.h"
+#include "oslib/wimp.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/debug.h"
+#include "sflib/event.h"
+#include "sflib/msgs.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "server.h"
+
+#include "convert.h"
+#include "main.h"
+
+
+/**
+ * The length of the buffer used to build the server command line.
+ */
+
+#define SERVER_COMMAND_LENGTH 1024
+
+/**
+ * The length of the buffer used to assemble lines of server output.
+ */
+
+#define SERVER_LINE_LENGTH 64
+
+/**
+ * The length of a switch name or value read from a gs parameter string.
+ */
+
+#define SERVER_SWITCH_LENGTH 256
+
+/**
+ * The line output by a job which ran to completion.
+ */
+
+#define SERVER_JOB_OK "PrintPDF:OK"
+
+/**
+ * The line output once a job has ended, whether it succeeded or not.
+ */
+
+#define SERVER_JOB_END "PrintPDF:End"
+
+/**
+ * The output file selected while the server is idle.
+ */
+
+#define SERVER_IDLE_OUTPUT "Null:"
+
+/**
+ * The states which the server can be in.
+ */
+
+enum server_state {
+	SERVER_STOPPED,		/**< No server is running.					*/
+	SERVER_STARTING,	/**< The server has been launched, but hasn't reported in.	*/
+	SERVER_IDLE,		/**< The server is waiting for a job.				*/
+	SERVER_BUSY,		/**< The server is running a job.				*/
+	SERVER_STOPPING		/**< The server has been told to close down.			*/
+};
+
+/**
+ * A TaskWindow message, passing data to or from the server or reporting
+ * its TaskWindow handle.
+ */
+
+typedef struct {
+	wimp_MESSAGE_HEADER_MEMBERS
+	union {
+		struct {
+			int		size;
+			char		data[232];
+		} io;
+		int			txt;
+	};
+} server_message;
+
+/* Function Prototypes. */
+
+static osbool server_launch(void);
+static osbool server_send_job(void);
+static void server_end_job(osbool success);
+static osbool server_message_ego(wimp_message *message);
+static osbool server_message_morio(wimp_message *message);
+static osbool server_message_output(wimp_message *message);
+static void server_process_line(char *line);
+static void server_write_string(FILE *file, char *string);
+static char *server_read_switch(char *switches, char *name, char *value, osbool *is_string);
+
+
+/**
+ * The current state of the server.
+ */
+
+static enum server_state server_state = SERVER_STOPPED;
+
+/**
+ * The task handle of the server, or 0 if not known.
+ */
+
+static wimp_t server_task = 0;
+
+/**
+ * The TaskWindow handle given to the current server.
+ */
+
+static int server_txt = 0;
+
+/**
+ * The job file waiting to be sent to the server, or being run.
+ */
+
+static char server_job_file[CONVERT_MAX_FILENAME];
+
+/**
+ * The callback to be made when the current job ends.
+ */
+
+static server_callback server_job_callback = NULL;
+
+/**
+ * The data to be passed to the current job's callback.
+ */
+
+static void *server_job_data = NULL;
+
+/**
+ * TRUE if the current job has reported success.
+ */
+
+static osbool server_job_ok = FALSE;
+
+/**
+ * The number of jobs run by the current server.
+ */
+
+static int server_jobs = 0;
+
+/**
+ * The amount of print data, in bytes, passed to the current server.
+ */
+
+static unsigned server_data = 0;
+
+/**
+ * The time at which the server last produced any output.
+ */
+
+static os_t server_activity = 0;
+
+/**
+ * The buffer used to assemble lines of output from the server.
+ */
+
+static char server_line[SERVER_LINE_LENGTH];
+
+/**
+ * The number of characters in the output line buffer.
+ */
+
+static int server_line_length = 0;
+
+
+/**
+ * Initialise the server module.
+ */
+
+void server_initialise(void)
+{
+	event_add_message_handler(message_TASK_WINDOW_EGO, EVENT_MESSAGE_INCOMING, server_message_ego);
+	event_add_message_handler(message_TASK_WINDOW_MORIO, EVENT_MESSAGE_INCOMING, server_message_morio);
+	event_add_message_handler(message_TASK_WINDOW_OUTPUT, EVENT_MESSAGE_INCOMING, server_message_output);
+}
+
+
+/**
+ * Close the server down, if it is running.
+ */
+
+void server_terminate(void)
+{
+	server_message		message;
+
+	if (server_task == 0 || server_state == SERVER_STOPPED)
+		return;
+
+	message.size = 20;
+	message.your_ref = 0;
+	message.action = message_TASK_WINDOW_MORITE;
+
+	xwimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &message, server_task);
+
+	server_state = SERVER_STOPPING;
+}
+
+
+/**
+ * Stop the job being run by the server, by closing the server down.  The
+ * job's callback is made, reporting failure, once the server has exited.
+ *
+ * \return			TRUE if the server is being closed down; else FALSE.
+ */
+
+osbool server_abort(void)
+{
+	if (server_job_callback == NULL || server_task == 0 || server_state != SERVER_BUSY)
+		return FALSE;
+
+	server_terminate();
+
+	return TRUE;
+}
+
+
+/**
+ * Find the time at which the server last produced any output.
+ *
+ * \return			The time of the server's most recent output.
+ */
+
+os_t server_last_activity(void)
+{
+	return server_activity;
+}
+
+
+/**
+ * Test whether the server can accept a job.
+ *
+ * \return			TRUE if a job can be submitted; else FALSE.
+ */
+
+osbool server_available(void)
+{
+	if (!config_opt_read("ServerMode"))
+		return FALSE;
+
+	return (server_state == SERVER_STOPPED || server_state == SERVER_IDLE) ? TRUE : FALSE;
+}
+
+
+/**
+ * Submit a job to the server, starting it first if necessary.
+ *
+ * \param *job_file		The PostScript file containing the job.
+ * \param size			The size of the print data in the job, in bytes.
+ * \param callback		The function to call when the job ends.
+ * \param *data			Data to pass to the callback function.
+ * \return			TRUE if the job was accepted; else FALSE.
+ */
+
+osbool server_submit(char *job_file, int size, server_callback callback, void *data)
+{
+	if (job_file == NULL || !server_available())
+		return FALSE;
+
+	if (server_state == SERVER_STOPPED && !server_launch())
+		return FALSE;
+
+	string_copy(server_job_file, job_file, CONVERT_MAX_FILENAME);
+	server_job_callback = callback;
+	server_job_data = data;
+	server_job_ok = FALSE;
+
+	server_jobs++;
+	server_data += (size > 0) ? size : 0;
+
+	/* If the server is still starting, the job will be sent when it reports in. */
+
+	if (server_state == SERVER_STARTING)
+		return TRUE;
+
+	if (!server_send_job()) {
+		server_job_callback = NULL;
+		server_job_data = NULL;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Write the start of a server job file, setting up the output file and the
+ * conversion options.
+ *
+ * The options are supplied as gs command line switches, in the form used
+ * for a parameters file, and are turned into the equivalent setpagedevice
+ * and setdistillerparams calls.
+ *
+ * \param *file			The job file to write to.
+ * \param *output		The name of the PDF file to create.
+ * \param *switches		The gs command line switches for the job.
+ */
+
+void server_write_job_header(FILE *file, char *output, char *switches)
+{
+	char		name[SERVER_SWITCH_LENGTH], value[SERVER_SWITCH_LENGTH], *next;
+	osbool		is_string, fixed_media = FALSE;
+	int		width = 0, height = 0;
+
+	if (file == NULL || output == NULL)
+		return;
+
+	fprintf(file, "%%!\n");
+
+	/* A PDFSETTINGS preset must be applied before any individual distiller parameters. */
+
+	for (next = switches; (next = server_read_switch(next, name, value, &is_string)) != NULL; ) {
+		if (strcmp(name, "PDFSETTINGS") == 0)
+			fprintf(file, ".distillersettings %s get setdistillerparams\n", value);
+	}
+
+	/* Encryption settings belong to the device; the rest are distiller parameters. */
+
+	fprintf(file, "<< /OutputFile ");
+	server_write_string(file, output);
+
+	for (next = switches; (next = server_read_switch(next, name, value, &is_string)) != NULL; ) {
+		if (strcmp(name, "DEVICEWIDTHPOINTS") == 0) {
+			width = atoi(value);
+		} else if (strcmp(name, "DEVICEHEIGHTPOINTS") == 0) {
+			height = atoi(value);
+		} else if (strcmp(name, "FIXEDMEDIA") == 0) {
+			fixed_media = TRUE;
+		} else if (strcmp(name, "OwnerPassword") == 0 || strcmp(name, "UserPassword") == 0 ||
+				strcmp(name, "EncryptionR") == 0 || strcmp(name, "KeyLength") == 0 ||
+				strcmp(name, "Permissions") == 0) {
+			fprintf(file, " /%s ", name);
+			if (is_string)
+				server_write_string(file, value);
+			else
+				fprintf(file, "%s", value);
+		}
+	}
+
+	if (width > 0 && height > 0)
+		fprintf(file, " /PageSize [%d %d]", width, height);
+
+	fprintf(file, " >> setpagedevice\n<<");
+
+	for (next = switches; (next = server_read_switch(next, name, value, &is_string)) != NULL; ) {
+		if (strcmp(name, "PDFSETTINGS") == 0 || strcmp(name, "PAPERSIZE") == 0 ||
+				strcmp(name, "DEVICEWIDTHPOINTS") == 0 || strcmp(name, "DEVICEHEIGHTPOINTS") == 0 ||
+				strcmp(name, "FIXEDMEDIA") == 0 || strcmp(name, "OwnerPassword") == 0 ||
+				strcmp(name, "UserPassword") == 0 || strcmp(name, "EncryptionR") == 0 ||
+				strcmp(name, "KeyLength") == 0 || strcmp(name, "Permissions") == 0)
+			continue;
+
+		fprintf(file, " /%s ", name);
+		if (is_string)
+			server_write_string(file, value);
+		else
+			fprintf(file, "%s", value);
+	}
+
+	fprintf(file, " >> setdistillerparams\n");
+
+	/* Named paper sizes are selected by running the procedure of the same name. */
+
+	for (next = switches; (next = server_read_switch(next, name, value, &is_string)) != NULL; ) {
+		if (strcmp(name, "PAPERSIZE") == 0)
+			fprintf(file, "/%s where { pop %s } if\n", value, value);
+	}
+
+	/* Fix the media, so that the document's own page size requests are ignored. */
+
+	if (fixed_media)
+		fprintf(file, "<< /Policies << /PageSize 7 >> >> setpagedevice\n");
+}
+
+
+/**
+ * Write a command to a server job file to run one of the job's input files.
+ *
+ * \param *file			The job file to write to.
+ * \param *input		The name of the file to be run.
+ */
+
+void server_write_job_input(FILE *file, char *input)
+{
+	if (file == NULL || input == NULL)
+		return;
+
+	server_write_string(file, input);
+	fprintf(file, " run\n");
+}
+
+
+/**
+ * Write the end of a server job file, closing the PDF and reporting that
+ * the job has been successful.
+ *
+ * \param *file			The job file to write to.
+ */
+
+void server_write_job_footer(FILE *file)
+{
+	if (file == NULL)
+		return;
+
+	fprintf(file, "<< /OutputFile (%s) >> setpagedevice\n", SERVER_IDLE_OUTPUT);
+	fprintf(file, "(%s) = flush\n", SERVER_JOB_OK);
+}
+
+
+/**
+ * Launch a new server task.
+ *
+ * \return			TRUE if the server was launched; else FALSE.
+ */
+
+static osbool server_launch(void)
+{
+	char		command[SERVER_COMMAND_LENGTH], task_name[CONVERT_MAX_FILENAME];
+	os_error	*error;
+	wimp_t		started_task = 0;
+
+	msgs_lookup("ServerTaskName", task_name, sizeof(task_name));
+
+	server_txt = (int) os_read_monotonic_time();
+
+	string_printf(command, SERVER_COMMAND_LENGTH,
+			"TaskWindow \"gs -q -dNOPAUSE -dNOPROMPT -dJOBSERVER -sDEVICE=pdfwrite -sOutputFile=%s -c .setpdfwrite -f -\" "
+			"%dk -name \"%s\" -task &%08X -txt &%08X -quit",
+			SERVER_IDLE_OUTPUT, config_int_read("TaskMemory"), task_name, (unsigned) main_task_handle, (unsigned) server_txt);
+
+	#ifdef DEBUG
+	debug_printf("Server command (length %d): '%s'", strlen(command), command);
+	#endif
+
+	error = xwimp_start_task(command, &started_task);
+
+	if (error != NULL || started_task == 0)
+		return FALSE;
+
+	server_state = SERVER_STARTING;
+	server_task = 0;
+	server_jobs = 0;
+	server_data = 0;
+	server_line_length = 0;
+
+	return TRUE;
+}
+
+
+/**
+ * Send the current job to the server.  Each job is run in its own
+ * encapsulated gs job, with a second job following it to report that it
+ * has ended: if the first job fails, gs flushes the rest of it, so that it
+ * can't report its own end reliably.
+ *
+ * \return			TRUE if the job was sent; else FALSE.
+ */
+
+static osbool server_send_job(void)
+{
+	server_message		message;
+	char			command[sizeof(message.io.data)];
+	int			length;
+
+	if (server_task == 0 || server_state != SERVER_IDLE)
+		return FALSE;
+
+	string_printf(command, sizeof(command), "(%s) run\n\004(%s) = flush\n\004", server_job_file, SERVER_JOB_END);
+
+	length = strlen(command);
+
+	message.size = (24 + length + 3) & ~3;
+	message.your_ref = 0;
+	message.action = message_TASK_WINDOW_INPUT;
+	message.io.size = length;
+	memcpy(message.io.data, command, length);
+
+	if (xwimp_send_message(wimp_USER_MESSAGE, (wimp_message *) &message, server_task) != NULL)
+		return FALSE;
+
+	server_state = SERVER_BUSY;
+	server_activity = os_read_monotonic_time();
+
+	return TRUE;
+}
+
+
+/**
+ * End the current job, passing the result to the job's owner.  If the
+ * server has done enough work, it is closed down so that a fresh one will
+ * be started for the next job.
+ *
+ * \param success		TRUE if the job succeeded; else FALSE.
+ */
+
+static void server_end_job(osbool success)
+{
+	server_callback		callback = server_job_callback;
+	void			*data = server_job_data;
+
+	server_job_callback = NULL;
+	server_job_data = NULL;
+
+	if (server_state == SERVER_BUSY) {
+		server_state = SERVER_IDLE;
+
+		if (server_jobs >= config_int_read("ServerJobs") || server_data / (1024 * 1024) >= config_int_read("ServerData"))
+			server_terminate();
+	}
+
+	if (callback != NULL)
+		callback(data, success);
+}
+
+
+/**
+ * Process Message_TaskWindow_Ego, to see if the server has started.
+ *
+ * \param *message		The message data block.
+ * \return			TRUE if the message was handled; else FALSE.
+ */
+
+static osbool server_message_ego(wimp_message *message)
+{
+	server_message		*ego = (server_message *) message;
+
+	if (ego == NULL || server_state != SERVER_STARTING || ego->txt != server_txt)
+		return FALSE;
+
+	server_task = ego->sender;
+	server_state = SERVER_IDLE;
+
+	/* If there's a job waiting, send it on; if that fails, the job has failed. */
+
+	if (server_job_callback != NULL && !server_send_job())
+		server_end_job(FALSE);
+
+	return TRUE;
+}
+
+
+/**
+ * Process Message_TaskWindow_Morio, to see if the server has exited.  Any
+ * job which was in progress has failed.
+ *
+ * \param *message		The message data block.
+ * \return			TRUE if the message was handled; else FALSE.
+ */
+
+static osbool server_message_morio(wimp_message *message)
+{
+	if (message == NULL || server_task == 0 || message->sender != server_task)
+		return FALSE;
+
+	server_state = SERVER_STOPPED;
+	server_task = 0;
+
+	if (server_job_callback != NULL)
+		server_end_job(FALSE);
+
+	return TRUE;
+}
+
+
+/**
+ * Process Message_TaskWindow_Output, assembling the server's output into
+ * lines and passing them on for processing.
+ *
+ * \param *message		The message data block.
+ * \return			TRUE if the message was handled; else FALSE.
+ */
+
+static osbool server_message_output(wimp_message *message)
+{
+	server_message		*output = (server_message *) message;
+	int			i;
+	char			c;
+
+	if (output == NULL || server_task == 0 || output->sender != server_task)
+		return FALSE;
+
+	server_activity = os_read_monotonic_time();
+
+	for (i = 0; i < output->io.size && i < sizeof(output->io.data); i++) {
+		c = output->io.data[i];
+
+		if (c == '\n' || c == '\r') {
+			server_line[server_line_length] = '\0';
+			server_process_line(server_line);
+			server_line_length = 0;
+		} else if (server_line_length < SERVER_LINE_LENGTH - 1) {
+			server_line[server_line_length++] = c;
+		}
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Process a line of output from the server.
+ *
+ * \param *line			The line to process.
+ */
+
+static void server_process_line(char *line)
+{
+	if (server_state != SERVER_BUSY)
+		return;
+
+	if (strcmp(line, SERVER_JOB_OK) == 0)
+		server_job_ok = TRUE;
+	else if (strcmp(line, SERVER_JOB_END) == 0)
+		server_end_job(server_job_ok);
+}
+
+
+/**
+ * Write a string to a job file as a PostScript string, escaping any
+ * characters which need it.
+ *
+ * \param *file			The file to write to.
+ * \param *string		The string to write.
+ */
+
+static void server_write_string(FILE *file, char *string)
+{
+	fputc('(', file);
+
+	while (*string != '\0') {
+		if (*string == '(' || *string == ')' || *string == '\\')
+			fputc('\\', file);
+
+		fputc(*string++, file);
+	}
+
+	fputc(')', file);
+}
+
+
+/**
+ * Read the next -d or -s switch from a string of gs command line switches.
+ * A -d switch with no value is given the value "true".
+ *
+ * \param *switches		The switches to read from.
+ * \param *name			Pointer to a buffer to take the switch name.
+ * \param *value		Pointer to a buffer to take the switch value.
+ * \param *is_string		Pointer to a variable to be set TRUE if the switch
+ *				was a string (-s) switch.
+ * \return			Pointer to the rest of the switches, or NULL if
+ *				there were no more to be found.
+ */
+
+static char *server_read_switch(char *switches, char *name, char *value, osbool *is_string)
+{
+	int		length;
+	char		*end, *equals;
+
+	if (switches == NULL)
+		return NULL;
+
+	while (*switches != '\0') {
+		while (*switches == ' ')
+			switches++;
+
+		end = switches;
+		while (*end != '\0' && *end != ' ')
+			end++;
+
+		length = end - switches;
+
+		if (length > 2 && switches[0] == '-' && (switches[1] == 'd' || switches[1] == 's') && length < SERVER_SWITCH_LENGTH) {
+			*is_string = (switches[1] == 's') ? TRUE : FALSE;
+
+			string_copy(name, switches + 2, length - 1);
+
+			equals = strchr(name, '=');
+
+			if (equals != NULL) {
+				*equals++ = '\0';
+				string_copy(value, equals, SERVER_SWITCH_LENGTH);
+			} else {
+				string_copy(value, "true", SERVER_SWITCH_LENGTH);
+				*is_string = FALSE;
+			}
+
+			return end;
+		}
+
+		switches = end;
+	}
+
+	return NULL;
+}
+
@@ -0,0 +1,139 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: server.h
+ *
+ * Resident Ghostscript server implementation.
+ */
+
+#ifndef PRINTPDF_SERVER
+#define PRINTPDF_SERVER
+
+#include <stdio.h>
+
+#include "oslib/os.h"
+#include "oslib/types.h"
+
+/**
+ * A function to be called when a server job ends.
+ *
+ * \param *data			The data supplied when the job was submitted.
+ * \param success		TRUE if the job succeeded; else FALSE.
+ */
+
+typedef void (*server_callback)(void *data, osbool success);
+
+
+/**
+ * Initialise the server module.
+ */
+
+void server_initialise(void);
+
+
+/**
+ * Close the server down, if it is running.
+ */
+
+void server_terminate(void);
+
+
+/**
+ * Stop the job being run by the server, by closing the server down.  The
+ * job's callback is made, reporting failure, once the server has exited.
+ *
+ * \return			TRUE if the server is being closed down; else FALSE.
+ */
+
+osbool server_abort(void);
+
+
+/**
+ * Find the time at which the server last produced any output.
+ *
+ * \return			The time of the server's most recent output.
+ */
+
+os_t server_last_activity(void);
+
+
+/**
+ * Test whether the server can accept a job.
+ *
+ * \return			TRUE if a job can be submitted; else FALSE.
+ */
+
+osbool server_available(void);
+
+
+/**
+ * Submit a job to the server, starting it first if necessary.
+ *
+ * \param *job_file		The PostScript file containing the job.
+ * \param size			The size of the print data in the job, in bytes.
+ * \param callback		The function to call when the job ends.
+ * \param *data			Data to pass to the callback function.
+ * \return			TRUE if the job was accepted; else FALSE.
+ */
+
+osbool server_submit(char *job_file, int size, server_callback callback, void *data);
+
+
+/**
+ * Write the start of a server job file, setting up the output file and the
+ * conversion options.
+ *
+ * The options are supplied as gs command line switches, in the form used
+ * for a parameters file, and are turned into the equivalent setpagedevice
+ * and setdistillerparams calls.
+ *
+ * \param *file			The job file to write to.
+ * \param *output		The name of the PDF file to create.
+ * \param *switches		The gs command line switches for the job.
+ */
+
+void server_write_job_header(FILE *file, char *output, char *switches);
+
+
+/**
+ * Write a command to a server job file to run one of the job's input files.
+ *
+ * \param *file			The job file to write to.
+ * \param *input		The name of the file to be run.
+ */
+
+void server_write_job_input(FILE *file, char *input);
+
+
+/**
+ * Write the end of a server job file, closing the PDF and reporting that
+ * the job has been successful.
+ *
+ * \param *file			The job file to write to.
+ */
+
+void server_write_job_footer(FILE *file);
+
+#endif
+
@@ -0,0 +1,210 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: slot.c
+ *
+ * Conversion memory sizing implementation.
+ *
+ * Instead of giving every conversion the same TaskWindow slot, the memory
+ * for each is estimated from its DSC index: a base amount for gs itself,
+ * with more for the input, the pages, the embedded fonts and the images.
+ * The estimate is scaled by a factor learned from past conversions, and
+ * then kept within the TaskMemoryMin and TaskMemoryMax limits.
+ *
+ * Conversions are admitted while they fit in the memory budget: the
+ * MemoryBudget setting if it is given, or the Wimp's free memory if not.
+ */
+
+/* ANSI C header files */
+
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/types.h"
+#include "oslib/wimp.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/debug.h"
+
+/* Application header files */
+
+#include "slot.h"
+
+
+/**
+ * The memory needed by gs before it reads any input, in Kbytes.
+ */
+
+#define SLOT_BASE_SIZE 3072
+
+/**
+ * The number of bytes of input which need a Kbyte of memory.
+ */
+
+#define SLOT_INPUT_RATIO 4096
+
+/**
+ * The memory needed for each page, in Kbytes.
+ */
+
+#define SLOT_PAGE_SIZE 4
+
+/**
+ * The memory needed for each embedded font, in Kbytes.
+ */
+
+#define SLOT_FONT_SIZE 96
+
+/**
+ * The memory needed for each image, in Kbytes.
+ */
+
+#define SLOT_IMAGE_SIZE 32
+
+/**
+ * The granularity of the estimates, in Kbytes.
+ */
+
+#define SLOT_GRANULARITY 256
+
+/**
+ * The limits on the learned scale factor, in percent.
+ */
+
+#define SLOT_MIN_SCALE 100
+#define SLOT_MAX_SCALE 400
+
+/**
+ * The scale factor applied to the estimates, in percent.
+ */
+
+static int slot_scale = SLOT_MIN_SCALE;
+
+
+/**
+ * Estimate the memory which gs will need to convert a document, from the
+ * details found when its files were indexed.
+ *
+ * \param length		The length of the document, in bytes, or 0
+ *				if it isn't known.
+ * \param pages			The number of pages in the document.
+ * \param fonts			The number of fonts embedded in the document.
+ * \param images		The number of images in the document.
+ * \return			The memory to give the conversion, in Kbytes.
+ */
+
+int slot_estimate(int length, int pages, int fonts, int images)
+{
+	int	size, min, max;
+
+	/* Without an index, fall back to the fixed TaskMemory slot. */
+
+	if (length <= 0 || !config_opt_read("AdaptiveMemory"))
+		return config_int_read("TaskMemory");
+
+	size = SLOT_BASE_SIZE + (length / SLOT_INPUT_RATIO) + (pages * SLOT_PAGE_SIZE) +
+			(fonts * SLOT_FONT_SIZE) + (images * SLOT_IMAGE_SIZE);
+
+	size = (size * slot_scale) / 100;
+	size = ((size + SLOT_GRANULARITY - 1) / SLOT_GRANULARITY) * SLOT_GRANULARITY;
+
+	min = config_int_read("TaskMemoryMin");
+	max = config_int_read("TaskMemoryMax");
+
+	if (size > max)
+		size = max;
+
+	if (size < min)
+		size = min;
+
+	#ifdef DEBUG
+	debug_printf("Estimated %dK for %d bytes, %d pages, %d fonts and %d images at %d%%",
+			size, length, pages, fonts, images, slot_scale);
+	#endif
+
+	return size;
+}
+
+
+/**
+ * Test whether a conversion needing a given amount of memory can be
+ * started alongside those which are already running.
+ *
+ * \param size			The memory needed by the new conversion, in
+ *				Kbytes.
+ * \param reserved		The memory given to the conversions which are
+ *				already running, in Kbytes.
+ * \return			TRUE if the conversion will fit; else FALSE.
+ */
+
+osbool slot_fits(int size, int reserved)
+{
+	int	budget, free_slot;
+
+	budget = config_int_read("MemoryBudget");
+
+	if (budget > 0)
+		return (reserved + size <= budget) ? TRUE : FALSE;
+
+	/* The running conversions' slots have already been taken from the free memory. */
+
+	if (xwimp_slot_size(-1, -1, NULL, NULL, &free_slot) != NULL)
+		return FALSE;
+
+	return (free_slot / 1024 >= size) ? TRUE : FALSE;
+}
+
+
+/**
+ * Record the outcome of a conversion, so that future estimates can learn
+ * from it: running out of memory increases them, while successes slowly
+ * bring them back down.
+ *
+ * \param size			The memory which the conversion was given, in
+ *				Kbytes.
+ * \param success		TRUE if the conversion succeeded; else FALSE.
+ * \param *error		The error reported by the conversion, or NULL.
+ */
+
+void slot_record(int size, osbool success, char *error)
+{
+	if (!success && error != NULL && strstr(error, "VMerror") != NULL) {
+		slot_scale += slot_scale / 2;
+
+		if (slot_scale > SLOT_MAX_SCALE)
+			slot_scale = SLOT_MAX_SCALE;
+	} else if (success && slot_scale > SLOT_MIN_SCALE) {
+		slot_scale -= (slot_scale - SLOT_MIN_SCALE + 15) / 16;
+	}
+
+	#ifdef DEBUG
+	debug_printf("Conversion in %dK %s; memory scale now %d%%", size, (success) ? "succeeded" : "failed", slot_scale);
+	#endif
+}
+
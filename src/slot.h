@@ -0,0 +1,79 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: slot.h
+ *
+ * Conversion memory sizing implementation.
+ */
+
+#ifndef PRINTPDF_SLOT
+#define PRINTPDF_SLOT
+
+#include "oslib/types.h"
+
+
+/**
+ * Estimate the memory which gs will need to convert a document, from the
+ * details found when its files were indexed.
+ *
+ * \param length		The length of the document, in bytes, or 0
+ *				if it isn't known.
+ * \param pages			The number of pages in the document.
+ * \param fonts			The number of fonts embedded in the document.
+ * \param images		The number of images in the document.
+ * \return			The memory to give the conversion, in Kbytes.
+ */
+
+int slot_estimate(int length, int pages, int fonts, int images);
+
+
+/**
+ * Test whether a conversion needing a given amount of memory can be
+ * started alongside those which are already running.
+ *
+ * \param size			The memory needed by the new conversion, in
+ *				Kbytes.
+ * \param reserved		The memory given to the conversions which are
+ *				already running, in Kbytes.
+ * \return			TRUE if the conversion will fit; else FALSE.
+ */
+
+osbool slot_fits(int size, int reserved);
+
+
+/**
+ * Record the outcome of a conversion, so that future estimates can learn
+ * from it: running out of memory increases them, while successes slowly
+ * bring them back down.
+ *
+ * \param size			The memory which the conversion was given, in
+ *				Kbytes.
+ * \param success		TRUE if the conversion succeeded; else FALSE.
+ * \param *error		The error reported by the conversion, or NULL.
+ */
+
+void slot_record(int size, osbool success, char *error);
+
+#endif
+
@@ -0,0 +1,338 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: stats.c
+ *
+ * Conversion statistics implementation.
+ *
+ * Each conversion is timed through the stages of the conversion state
+ * machine, from the point that its input was queued.  The most recent
+ * conversions are kept in a ring of records, which also serves as the
+ * window over which the summaries are calculated, so that the summaries
+ * follow changes in the workload.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/debug.h"
+
+/* Application header files */
+
+#include "stats.h"
+
+#include "cache.h"
+
+
+/**
+ * The number of conversions held in the records.
+ */
+
+#define STATS_MAX_RECORDS 64
+
+/**
+ * The record of a completed conversion.
+ */
+
+struct stats_record {
+	os_t			ended;				/**< The time at which the conversion ended.		*/
+	osbool			success;			/**< TRUE if the conversion succeeded.			*/
+	int			values[STATS_METRICS];		/**< The values of the metrics for the conversion.	*/
+};
+
+/* Function Prototypes. */
+
+static int stats_compare_values(const void *a, const void *b);
+
+
+/**
+ * The names of the metrics, for the dump.
+ */
+
+static char *stats_metric_names[STATS_METRICS] = {
+	"Queue", "Setup", "Launch", "Convert", "SplitWait", "Total", "Input", "Output"
+};
+
+/**
+ * The records of the most recent conversions.
+ */
+
+static struct stats_record stats_records[STATS_MAX_RECORDS];
+
+/**
+ * The number of conversions recorded since the application started.
+ */
+
+static int stats_recorded = 0;
+
+
+/**
+ * Start timing a conversion, which enters the setup stage.
+ *
+ * \param *job			The job timings to start.
+ * \param queued		The time at which the job's input was queued.
+ */
+
+void stats_start_job(struct stats_job *job, os_t queued)
+{
+	int	i;
+
+	if (job == NULL)
+		return;
+
+	for (i = 0; i < STATS_STAGES; i++)
+		job->times[i] = 0;
+
+	job->entered = os_read_monotonic_time();
+	job->queued = queued;
+	job->times[STATS_STAGE_QUEUE] = job->entered - queued;
+	job->stage = STATS_STAGE_SETUP;
+}
+
+
+/**
+ * Record that a conversion has moved into a new stage, charging the time
+ * since the last transition to the stage being left.
+ *
+ * \param *job			The job timings to update.
+ * \param stage			The stage being entered.
+ */
+
+void stats_enter_stage(struct stats_job *job, enum stats_stage stage)
+{
+	os_t	now;
+
+	if (job == NULL || stage == job->stage)
+		return;
+
+	now = os_read_monotonic_time();
+
+	if (job->stage < STATS_STAGES)
+		job->times[job->stage] += now - job->entered;
+
+	job->stage = stage;
+	job->entered = now;
+}
+
+
+/**
+ * Record the end of a conversion, adding it to the records.
+ *
+ * \param *job			The job timings to record.
+ * \param input_size		The size of the input, in bytes.
+ * \param output_size		The size of the output, in bytes.
+ * \param success		TRUE if the conversion succeeded; else FALSE.
+ */
+
+void stats_end_job(struct stats_job *job, int input_size, int output_size, osbool success)
+{
+	struct stats_record	*record;
+	int			i;
+
+	if (job == NULL)
+		return;
+
+	stats_enter_stage(job, STATS_STAGE_NONE);
+
+	record = &(stats_records[stats_recorded % STATS_MAX_RECORDS]);
+
+	record->ended = job->entered;
+	record->success = success;
+
+	for (i = 0; i < STATS_STAGES; i++)
+		record->values[i] = job->times[i];
+
+	record->values[STATS_METRIC_TOTAL] = job->entered - job->queued;
+	record->values[STATS_METRIC_INPUT] = input_size;
+	record->values[STATS_METRIC_OUTPUT] = output_size;
+
+	stats_recorded++;
+
+	#ifdef DEBUG
+	debug_printf("Conversion took %d cs (queue %d, setup %d, launch %d, convert %d, split %d), %d bytes in, %d out",
+			record->values[STATS_METRIC_TOTAL], job->times[STATS_STAGE_QUEUE], job->times[STATS_STAGE_SETUP],
+			job->times[STATS_STAGE_LAUNCH], job->times[STATS_STAGE_CONVERT], job->times[STATS_STAGE_SPLIT_WAIT],
+			input_size, output_size);
+	#endif
+}
+
+
+/**
+ * Return the number of conversions in the records, and how many of them
+ * failed.
+ *
+ * \param *failures		Pointer to a variable to take the number of
+ *				failed conversions, or NULL.
+ * \return			The number of conversions recorded.
+ */
+
+int stats_get_count(int *failures)
+{
+	int	i, count, failed = 0;
+
+	count = (stats_recorded < STATS_MAX_RECORDS) ? stats_recorded : STATS_MAX_RECORDS;
+
+	for (i = 0; i < count; i++) {
+		if (!stats_records[i].success)
+			failed++;
+	}
+
+	if (failures != NULL)
+		*failures = failed;
+
+	return count;
+}
+
+
+/**
+ * Summarise one of the metrics over the successful conversions in the
+ * records.
+ *
+ * \param metric		The metric to summarise.
+ * \param *summary		Pointer to a block to take the summary.
+ */
+
+void stats_get_summary(enum stats_metric metric, struct stats_summary *summary)
+{
+	int	values[STATS_MAX_RECORDS];
+	int	i, count, samples = 0;
+
+	if (summary == NULL)
+		return;
+
+	summary->p50 = 0;
+	summary->p95 = 0;
+	summary->max = 0;
+
+	if (metric < 0 || metric >= STATS_METRICS)
+		return;
+
+	count = (stats_recorded < STATS_MAX_RECORDS) ? stats_recorded : STATS_MAX_RECORDS;
+
+	for (i = 0; i < count; i++) {
+		if (stats_records[i].success)
+			values[samples++] = stats_records[i].values[metric];
+	}
+
+	if (samples == 0)
+		return;
+
+	/* Use the nearest rank for the percentiles. */
+
+	qsort(values, samples, sizeof(int), stats_compare_values);
+
+	summary->p50 = values[(samples * 50 + 99) / 100 - 1];
+	summary->p95 = values[(samples * 95 + 99) / 100 - 1];
+	summary->max = values[samples - 1];
+}
+
+
+/**
+ * Write the records and their summary to a text file.
+ *
+ * \param *filename		The name of the file to write.
+ * \return			TRUE if the file was written; else FALSE.
+ */
+
+osbool stats_dump(char *filename)
+{
+	struct stats_summary	summary;
+	struct stats_record	*record;
+	FILE			*file;
+	int			i, j, count, failures, hits, misses, first;
+
+	if (filename == NULL)
+		return FALSE;
+
+	file = fopen(filename, "w");
+	if (file == NULL)
+		return FALSE;
+
+	count = stats_get_count(&failures);
+	cache_get_counters(&hits, &misses);
+
+	fprintf(file, "# PrintPDF conversion statistics\n");
+	fprintf(file, "# Conversions %d (recorded %d, failed %d), cache hits %d, misses %d\n",
+			stats_recorded, count, failures, hits, misses);
+	fprintf(file, "# Times are in centiseconds, and sizes in bytes.\n\n");
+
+	fprintf(file, "Metric\tp50\tp95\tmax\n");
+
+	for (i = 0; i < STATS_METRICS; i++) {
+		stats_get_summary(i, &summary);
+		fprintf(file, "%s\t%d\t%d\t%d\n", stats_metric_names[i], summary.p50, summary.p95, summary.max);
+	}
+
+	/* List the records oldest first. */
+
+	fprintf(file, "\nEnded\tResult");
+
+	for (i = 0; i < STATS_METRICS; i++)
+		fprintf(file, "\t%s", stats_metric_names[i]);
+
+	fprintf(file, "\n");
+
+	first = (stats_recorded < STATS_MAX_RECORDS) ? 0 : stats_recorded % STATS_MAX_RECORDS;
+
+	for (i = 0; i < count; i++) {
+		record = &(stats_records[(first + i) % STATS_MAX_RECORDS]);
+
+		fprintf(file, "%u\t%s", (unsigned) record->ended, (record->success) ? "OK" : "Failed");
+
+		for (j = 0; j < STATS_METRICS; j++)
+			fprintf(file, "\t%d", record->values[j]);
+
+		fprintf(file, "\n");
+	}
+
+	return (fclose(file) == 0) ? TRUE : FALSE;
+}
+
+
+/**
+ * Compare two metric values, for qsort().
+ *
+ * \param *a			Pointer to the first value.
+ * \param *b			Pointer to the second value.
+ * \return			The result of the comparison.
+ */
+
+static int stats_compare_values(const void *a, const void *b)
+{
+	int	x = *((const int *) a), y = *((const int *) b);
+
+	return (x > y) - (x < y);
+}
+
@@ -0,0 +1,153 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: stats.h
+ *
+ * Conversion statistics implementation.
+ */
+
+#ifndef PRINTPDF_STATS
+#define PRINTPDF_STATS
+
+#include "oslib/os.h"
+
+/**
+ * The stages through which a conversion passes, which are timed.
+ */
+
+enum stats_stage {
+	STATS_STAGE_QUEUE = 0,		/**< Waiting in the queue for the conversion to start.		*/
+	STATS_STAGE_SETUP = 1,		/**< Writing the parameters and preparing the input.		*/
+	STATS_STAGE_LAUNCH = 2,		/**< Waiting for the child task to start.			*/
+	STATS_STAGE_CONVERT = 3,	/**< Running gs on the input.					*/
+	STATS_STAGE_SPLIT_WAIT = 4,	/**< Waiting for the chunks of a split document.		*/
+	STATS_STAGES = 5,		/**< The number of timed stages.				*/
+	STATS_STAGE_NONE = STATS_STAGES	/**< Not in a timed stage.					*/
+};
+
+/**
+ * The quantities recorded for each conversion, which are summarised.
+ */
+
+enum stats_metric {
+	STATS_METRIC_QUEUE = 0,		/**< The time spent in the queue, in centiseconds.		*/
+	STATS_METRIC_SETUP = 1,		/**< The time spent setting up, in centiseconds.		*/
+	STATS_METRIC_LAUNCH = 2,	/**< The time spent starting tasks, in centiseconds.		*/
+	STATS_METRIC_CONVERT = 3,	/**< The time spent running gs, in centiseconds.		*/
+	STATS_METRIC_SPLIT_WAIT = 4,	/**< The time spent waiting for chunks, in centiseconds.	*/
+	STATS_METRIC_TOTAL = 5,		/**< The time from queueing to completion, in centiseconds.	*/
+	STATS_METRIC_INPUT = 6,		/**< The size of the input, in bytes.				*/
+	STATS_METRIC_OUTPUT = 7,	/**< The size of the output, in bytes.				*/
+	STATS_METRICS = 8		/**< The number of metrics.					*/
+};
+
+/**
+ * The timings of a conversion in progress.
+ */
+
+struct stats_job {
+	os_t			queued;				/**< The time at which the input was queued.		*/
+	os_t			entered;			/**< The time at which the current stage was entered.	*/
+	enum stats_stage	stage;				/**< The current stage.					*/
+	int			times[STATS_STAGES];		/**< The time spent in each stage so far.		*/
+};
+
+/**
+ * A summary of one of the metrics over the recent conversions.
+ */
+
+struct stats_summary {
+	int			p50;				/**< The median value.					*/
+	int			p95;				/**< The 95th percentile value.				*/
+	int			max;				/**< The maximum value.					*/
+};
+
+
+/**
+ * Start timing a conversion, which enters the setup stage.
+ *
+ * \param *job			The job timings to start.
+ * \param queued		The time at which the job's input was queued.
+ */
+
+void stats_start_job(struct stats_job *job, os_t queued);
+
+
+/**
+ * Record that a conversion has moved into a new stage, charging the time
+ * since the last transition to the stage being left.
+ *
+ * \param *job			The job timings to update.
+ * \param stage			The stage being entered.
+ */
+
+void stats_enter_stage(struct stats_job *job, enum stats_stage stage);
+
+
+/**
+ * Record the end of a conversion, adding it to the records.
+ *
+ * \param *job			The job timings to record.
+ * \param input_size		The size of the input, in bytes.
+ * \param output_size		The size of the output, in bytes.
+ * \param success		TRUE if the conversion succeeded; else FALSE.
+ */
+
+void stats_end_job(struct stats_job *job, int input_size, int output_size, osbool success);
+
+
+/**
+ * Return the number of conversions in the records, and how many of them
+ * failed.
+ *
+ * \param *failures		Pointer to a variable to take the number of
+ *				failed conversions, or NULL.
+ * \return			The number of conversions recorded.
+ */
+
+int stats_get_count(int *failures);
+
+
+/**
+ * Summarise one of the metrics over the successful conversions in the
+ * records.
+ *
+ * \param metric		The metric to summarise.
+ * \param *summary		Pointer to a block to take the summary.
+ */
+
+void stats_get_summary(enum stats_metric metric, struct stats_summary *summary);
+
+
+/**
+ * Write the records and their summary to a text file.
+ *
+ * \param *filename		The name of the file to write.
+ * \return			TRUE if the file was written; else FALSE.
+ */
+
+osbool stats_dump(char *filename);
+
+#endif
+
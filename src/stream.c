@@ -0,0 +1,456 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: stream.c
+ *
+ * Spool file streaming implementation.
+ *
+ * A stream follows a spool file while the printer driver is still writing
+ * it, passing the data on into a pipe from which Ghostscript can read.  The
+ * stream is pumped on NULL polls: each time, any new data is copied across
+ * until the writer closes the file and everything has been passed on, at
+ * which point the pipe is closed to give the reader its end of file.
+ *
+ * Not all filing systems allow a file to be read while another task has it
+ * open for writing; on those, the stream simply waits until the writer has
+ * finished and then passes the whole file on.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/fileswitch.h"
+#include "oslib/osargs.h"
+#include "oslib/osfile.h"
+#include "oslib/osfind.h"
+#include "oslib/osgbpb.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/debug.h"
+#include "sflib/string.h"
+
+/* Application header files */
+
+#include "stream.h"
+
+#include "convert.h"
+
+
+/**
+ * The size of the buffer used to copy data between files.
+ */
+
+#define STREAM_BUFFER_SIZE 32768
+
+/**
+ * A stream, which follows a spool file as it is written.
+ */
+
+struct stream_pump {
+	char			source[CONVERT_MAX_FILENAME];	/**< The pathname of the spool file.			*/
+	char			pipe[CONVERT_MAX_FILENAME];	/**< The pathname of the pipe, or "" if none.		*/
+	os_fw			pipe_handle;			/**< The handle of the open pipe, or 0 if none.		*/
+	int			offset;				/**< The number of bytes passed on into the pipe.	*/
+	osbool			failed;				/**< TRUE if the stream has failed.			*/
+	osbool			abandoned;			/**< TRUE if the stream's job has been cancelled.	*/
+
+	struct stream_pump	*next;				/**< The next stream in the list.			*/
+};
+
+/* Function Prototypes. */
+
+static void stream_close_pipe(struct stream_pump *stream);
+static void stream_unlink(struct stream_pump *stream);
+
+
+/**
+ * The list of live streams.
+ */
+
+static struct stream_pump *stream_list = NULL;
+
+/**
+ * The buffer used to copy data from spool files to pipes.
+ */
+
+static byte stream_buffer[STREAM_BUFFER_SIZE];
+
+
+/**
+ * Test whether a file is still being written to by another task.
+ *
+ * \param *filename		The file to test.
+ * \return			TRUE if the file is open for writing; else FALSE.
+ */
+
+osbool stream_writer_active(char *filename)
+{
+	fileswitch_object_type	type;
+	os_fw			file = 0;
+
+	if (xosfile_read_no_path(filename, &type, NULL, NULL, NULL, NULL) != NULL || type != fileswitch_IS_FILE)
+		return FALSE;
+
+	if (xosfind_openupw(osfind_NO_PATH, filename, NULL, &file) != NULL || file == 0)
+		return TRUE;
+
+	xosfind_closew(file);
+
+	return FALSE;
+}
+
+
+/**
+ * Create a new stream to follow a spool file.
+ *
+ * \param *source		The pathname of the spool file.
+ * \return			Pointer to the new stream, or NULL on failure.
+ */
+
+struct stream_pump *stream_create(char *source)
+{
+	struct stream_pump	*stream;
+
+	if (source == NULL)
+		return NULL;
+
+	stream = malloc(sizeof(struct stream_pump));
+	if (stream == NULL)
+		return NULL;
+
+	string_copy(stream->source, source, CONVERT_MAX_FILENAME);
+	*(stream->pipe) = '\0';
+	stream->pipe_handle = 0;
+	stream->offset = 0;
+	stream->failed = FALSE;
+	stream->abandoned = FALSE;
+
+	stream->next = stream_list;
+	stream_list = stream;
+
+	return stream;
+}
+
+
+/**
+ * Find a live stream which is following a given spool file, including
+ * any which have been abandoned but whose writer has not yet finished.
+ *
+ * \param *source		The pathname of the spool file.
+ * \return			Pointer to the stream, or NULL if none.
+ */
+
+struct stream_pump *stream_find(char *source)
+{
+	struct stream_pump	*stream = stream_list;
+
+	while (stream != NULL && strcmp(stream->source, source) != 0)
+		stream = stream->next;
+
+	return stream;
+}
+
+
+/**
+ * Return the pathname of the spool file being followed by a stream.
+ *
+ * \param *stream		The stream to interrogate.
+ * \return			Pointer to the pathname.
+ */
+
+char *stream_get_source(struct stream_pump *stream)
+{
+	return (stream != NULL) ? stream->source : "";
+}
+
+
+/**
+ * Attach a pipe to a stream, so that data from the spool file is passed
+ * into it as it arrives.
+ *
+ * \param *stream		The stream to attach to.
+ * \param *pipe			The pathname of the pipe.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+osbool stream_attach(struct stream_pump *stream, char *pipe)
+{
+	if (stream == NULL || pipe == NULL || stream->failed || stream->pipe_handle != 0 || stream->offset != 0)
+		return FALSE;
+
+	if (xosfind_openoutw(osfind_NO_PATH, pipe, NULL, &(stream->pipe_handle)) != NULL || stream->pipe_handle == 0) {
+		stream->pipe_handle = 0;
+		return FALSE;
+	}
+
+	string_copy(stream->pipe, pipe, CONVERT_MAX_FILENAME);
+
+	return TRUE;
+}
+
+
+/**
+ * Test whether a stream has a pipe attached.
+ *
+ * \param *stream		The stream to test.
+ * \return			TRUE if a pipe is attached; else FALSE.
+ */
+
+osbool stream_is_attached(struct stream_pump *stream)
+{
+	return (stream != NULL && *(stream->pipe) != '\0') ? TRUE : FALSE;
+}
+
+
+/**
+ * Pass any new data from a stream's spool file into its pipe, up to the
+ * StreamChunk limit for a single call.  If the stream has no pipe, its
+ * spool file is just checked to see whether the writer has finished.
+ *
+ * \param *stream		The stream to pump.
+ * \return			The state of the stream.
+ */
+
+enum stream_state stream_pump(struct stream_pump *stream)
+{
+	fileswitch_object_type	type;
+	os_fw			source = 0;
+	os_error		*error = NULL;
+	osbool			writer_closed;
+	int			extent = 0, buffered, budget, size, unread, unwritten;
+
+	if (stream == NULL || stream->failed)
+		return STREAM_FAILED;
+
+	/* If the spool file has vanished, there's nothing more to come. */
+
+	if (xosfile_read_no_path(stream->source, &type, NULL, NULL, NULL, NULL) != NULL || type != fileswitch_IS_FILE) {
+		stream->failed = TRUE;
+		stream_close_pipe(stream);
+		return STREAM_FAILED;
+	}
+
+	/* If the file can be opened for update, the writer has finished with it; otherwise, try to open
+	 * it for reading alongside the writer.
+	 */
+
+	if (xosfind_openupw(osfind_NO_PATH, stream->source, NULL, &source) == NULL && source != 0) {
+		writer_closed = TRUE;
+	} else {
+		writer_closed = FALSE;
+		source = 0;
+
+		if (stream->pipe_handle == 0 || xosfind_openinw(osfind_NO_PATH, stream->source, NULL, &source) != NULL || source == 0)
+			return STREAM_WAITING;
+	}
+
+	/* With no pipe attached, all that is needed is to know whether the writer has finished. */
+
+	if (stream->pipe_handle == 0) {
+		xosfind_closew(source);
+		return (writer_closed) ? STREAM_COMPLETE : STREAM_WAITING;
+	}
+
+	/* Work out how much data can be passed on this time.  If too much is already sitting in the pipe
+	 * waiting for the reader, hold off until it has caught up.
+	 */
+
+	budget = config_int_read("StreamChunk") * 1024;
+
+	if (xosargs_read_extw(stream->pipe_handle, &buffered) == NULL && buffered >= config_int_read("StreamBuffer") * 1024)
+		budget = 0;
+
+	error = xosargs_read_extw(source, &extent);
+
+	if (error == NULL && stream->offset < extent && budget > 0)
+		error = xosargs_set_ptrw(source, stream->offset);
+
+	while (error == NULL && budget > 0 && stream->offset < extent) {
+		size = extent - stream->offset;
+		if (size > STREAM_BUFFER_SIZE)
+			size = STREAM_BUFFER_SIZE;
+		if (size > budget)
+			size = budget;
+
+		error = xosgbpb_readw(source, stream_buffer, size, &unread);
+		if (error != NULL)
+			break;
+
+		size -= unread;
+		if (size <= 0)
+			break;
+
+		error = xosgbpb_writew(stream->pipe_handle, stream_buffer, size, &unwritten);
+		if (error == NULL && unwritten != 0)
+			stream->failed = TRUE;
+
+		stream->offset += size;
+		budget -= size;
+	}
+
+	xosfind_closew(source);
+
+	if (error != NULL || stream->failed) {
+		stream->failed = TRUE;
+		stream_close_pipe(stream);
+		return STREAM_FAILED;
+	}
+
+	/* Once the writer has finished and everything has been passed on, close the pipe so that the
+	 * reader sees the end of the file.
+	 */
+
+	if (writer_closed && stream->offset >= extent) {
+		stream_close_pipe(stream);
+		return STREAM_COMPLETE;
+	}
+
+	return STREAM_FLOWING;
+}
+
+
+/**
+ * Destroy a stream, closing its pipe.
+ *
+ * \param *stream		The stream to destroy.
+ */
+
+void stream_destroy(struct stream_pump *stream)
+{
+	if (stream == NULL)
+		return;
+
+	stream_close_pipe(stream);
+	stream_unlink(stream);
+	free(stream);
+}
+
+
+/**
+ * Detach a stream from its pipe, after the conversion reading the pipe has
+ * ended.  The stream continues to follow its spool file until the writer
+ * has finished with it, but the data is no longer passed on.
+ *
+ * \param *stream		The stream to detach.
+ */
+
+void stream_detach(struct stream_pump *stream)
+{
+	if (stream == NULL)
+		return;
+
+	stream_close_pipe(stream);
+	*(stream->pipe) = '\0';
+}
+
+
+/**
+ * Abandon a stream whose job has been cancelled.  The stream's pipe is
+ * closed, and its spool file will be deleted once the writer has finished
+ * with it.
+ *
+ * \param *stream		The stream to abandon.
+ */
+
+void stream_abandon(struct stream_pump *stream)
+{
+	if (stream == NULL)
+		return;
+
+	stream_close_pipe(stream);
+	stream->abandoned = TRUE;
+}
+
+
+/**
+ * Tidy up any abandoned streams whose writers have finished.
+ *
+ * \return			TRUE if any abandoned streams remain; else FALSE.
+ */
+
+osbool stream_tidy_abandoned(void)
+{
+	struct stream_pump	*stream, *next;
+	osbool			remaining = FALSE;
+
+	for (stream = stream_list; stream != NULL; stream = next) {
+		next = stream->next;
+
+		if (!stream->abandoned)
+			continue;
+
+		if (stream_writer_active(stream->source)) {
+			remaining = TRUE;
+			continue;
+		}
+
+		xosfile_delete(stream->source, NULL, NULL, NULL, NULL, NULL);
+		stream_destroy(stream);
+	}
+
+	return remaining;
+}
+
+
+/**
+ * Close a stream's pipe, if it is open.
+ *
+ * \param *stream		The stream whose pipe is to be closed.
+ */
+
+static void stream_close_pipe(struct stream_pump *stream)
+{
+	if (stream == NULL || stream->pipe_handle == 0)
+		return;
+
+	xosfind_closew(stream->pipe_handle);
+	stream->pipe_handle = 0;
+}
+
+
+/**
+ * Remove a stream from the list of live streams.
+ *
+ * \param *stream		The stream to remove.
+ */
+
+static void stream_unlink(struct stream_pump *stream)
+{
+	struct stream_pump	**list = &stream_list;
+
+	while (*list != NULL && *list != stream)
+		list = &((*list)->next);
+
+	if (*list != NULL)
+		*list = stream->next;
+}
+
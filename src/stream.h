@@ -0,0 +1,169 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: stream.h
+ *
+ * Spool file streaming implementation.
+ */
+
+#ifndef PRINTPDF_STREAM
+#define PRINTPDF_STREAM
+
+#include "oslib/types.h"
+
+/**
+ * A stream, which follows a spool file as it is written.
+ */
+
+struct stream_pump;
+
+
+/**
+ * The states which a stream can report after being pumped.
+ */
+
+enum stream_state {
+	STREAM_WAITING,		/**< The writer is still active, and the data can't be read yet.	*/
+	STREAM_FLOWING,		/**< Data is being passed from the spool file to the pipe.		*/
+	STREAM_COMPLETE,	/**< The writer has finished, and all of the data has been passed on.	*/
+	STREAM_FAILED		/**< The stream has failed, and no more data will be passed on.		*/
+};
+
+
+/**
+ * Test whether a file is still being written to by another task.
+ *
+ * \param *filename		The file to test.
+ * \return			TRUE if the file is open for writing; else FALSE.
+ */
+
+osbool stream_writer_active(char *filename);
+
+
+/**
+ * Create a new stream to follow a spool file.
+ *
+ * \param *source		The pathname of the spool file.
+ * \return			Pointer to the new stream, or NULL on failure.
+ */
+
+struct stream_pump *stream_create(char *source);
+
+
+/**
+ * Find a live stream which is following a given spool file, including
+ * any which have been abandoned but whose writer has not yet finished.
+ *
+ * \param *source		The pathname of the spool file.
+ * \return			Pointer to the stream, or NULL if none.
+ */
+
+struct stream_pump *stream_find(char *source);
+
+
+/**
+ * Return the pathname of the spool file being followed by a stream.
+ *
+ * \param *stream		The stream to interrogate.
+ * \return			Pointer to the pathname.
+ */
+
+char *stream_get_source(struct stream_pump *stream);
+
+
+/**
+ * Attach a pipe to a stream, so that data from the spool file is passed
+ * into it as it arrives.
+ *
+ * \param *stream		The stream to attach to.
+ * \param *pipe			The pathname of the pipe.
+ * \return			TRUE if successful; else FALSE.
+ */
+
+osbool stream_attach(struct stream_pump *stream, char *pipe);
+
+
+/**
+ * Test whether a stream has a pipe attached.
+ *
+ * \param *stream		The stream to test.
+ * \return			TRUE if a pipe is attached; else FALSE.
+ */
+
+osbool stream_is_attached(struct stream_pump *stream);
+
+
+/**
+ * Pass any new data from a stream's spool file into its pipe, up to the
+ * StreamChunk limit for a single call.  If the stream has no pipe, its
+ * spool file is just checked to see whether the writer has finished.
+ *
+ * \param *stream		The stream to pump.
+ * \return			The state of the stream.
+ */
+
+enum stream_state stream_pump(struct stream_pump *stream);
+
+
+/**
+ * Destroy a stream, closing its pipe.
+ *
+ * \param *stream		The stream to destroy.
+ */
+
+void stream_destroy(struct stream_pump *stream);
+
+
+/**
+ * Detach a stream from its pipe, after the conversion reading the pipe has
+ * ended.  The stream continues to follow its spool file until the writer
+ * has finished with it, but the data is no longer passed on.
+ *
+ * \param *stream		The stream to detach.
+ */
+
+void stream_detach(struct stream_pump *stream);
+
+
+/**
+ * Abandon a stream whose job has been cancelled.  The stream's pipe is
+ * closed, and its spool file will be deleted once the writer has finished
+ * with it.
+ *
+ * \param *stream		The stream to abandon.
+ */
+
+void stream_abandon(struct stream_pump *stream);
+
+
+/**
+ * Tidy up any abandoned streams whose writers have finished.
+ *
+ * \return			TRUE if any abandoned streams remain; else FALSE.
+ */
+
+osbool stream_tidy_abandoned(void);
+
+#endif
+
@@ -0,0 +1,365 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: validate.c
+ *
+ * PDF output validation implementation.
+ *
+ * A PDF which Ghostscript failed to finish will usually be truncated, so
+ * the check reads only the ends of the file and the cross-reference table:
+ * the header, the startxref and %%EOF at the end, the table itself and its
+ * trailer.  A handful of the objects are then looked up, to make sure that
+ * the table's offsets agree with the file.  The content of the pages is not
+ * examined.
+ */
+
+/* ANSI C header files */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/types.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/debug.h"
+
+/* Application header files */
+
+#include "validate.h"
+
+
+/**
+ * The number of bytes read from each end of the file.
+ */
+
+#define VALIDATE_BUFFER_SIZE 1024
+
+/**
+ * The length of a cross-reference table entry.
+ */
+
+#define VALIDATE_XREF_ENTRY 20
+
+/**
+ * The number of objects whose offsets are checked against the file.
+ */
+
+#define VALIDATE_SAMPLES 8
+
+/**
+ * The smallest file which could be a PDF.
+ */
+
+#define VALIDATE_MIN_LENGTH 64
+
+/**
+ * An object to be looked up in the file.
+ */
+
+struct validate_sample {
+	int		number;			/**< The object number.		*/
+	long		offset;			/**< The offset of the object.	*/
+};
+
+/* Function Prototypes. */
+
+static enum validate_result validate_xref_table(FILE *file, long xref, long length);
+static osbool validate_sample_objects(FILE *file, struct validate_sample *samples, int count);
+static int validate_read_block(FILE *file, long offset);
+static char *validate_find(char *buffer, int length, char *text, osbool last);
+static void validate_skip_space(FILE *file);
+
+
+/**
+ * The buffer used to read blocks from the file.
+ */
+
+static char validate_buffer[VALIDATE_BUFFER_SIZE + 1];
+
+
+/**
+ * Perform a fast structural check of a PDF file: that it has a header, that
+ * it ends with a startxref pointing at a cross-reference table, that the
+ * table is well formed and matches its trailer, and that a sample of the
+ * objects are where the table says they are.
+ *
+ * \param *filename		The file to check.
+ * \return			The outcome of the check.
+ */
+
+enum validate_result validate_pdf(char *filename)
+{
+	FILE			*file;
+	enum validate_result	result;
+	char			*startxref;
+	long			length, xref;
+	int			read;
+
+	if (filename == NULL)
+		return VALIDATE_NO_FILE;
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+		return VALIDATE_NO_FILE;
+
+	if (fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < VALIDATE_MIN_LENGTH) {
+		fclose(file);
+		return VALIDATE_NO_FILE;
+	}
+
+	/* The header should be at the start of the file, although readers allow some junk before it. */
+
+	read = validate_read_block(file, 0);
+
+	if (validate_find(validate_buffer, read, "%PDF-", FALSE) == NULL) {
+		fclose(file);
+		return VALIDATE_NO_HEADER;
+	}
+
+	/* The file should end with the offset of the cross-reference table, and an end of file marker. */
+
+	read = validate_read_block(file, (length > VALIDATE_BUFFER_SIZE) ? length - VALIDATE_BUFFER_SIZE : 0);
+	startxref = validate_find(validate_buffer, read, "startxref", TRUE);
+
+	if (startxref == NULL || validate_find(startxref, read - (startxref - validate_buffer), "%%EOF", FALSE) == NULL ||
+			sscanf(startxref + 9, "%ld", &xref) != 1 || xref <= 0 || xref >= length) {
+		fclose(file);
+		return VALIDATE_NO_STARTXREF;
+	}
+
+	result = validate_xref_table(file, xref, length);
+
+	fclose(file);
+
+	#ifdef DEBUG
+	debug_printf("Validated %s with result %d", filename, result);
+	#endif
+
+	return result;
+}
+
+
+/**
+ * Check the cross-reference table of a PDF file, along with its trailer and
+ * a sample of the objects that it refers to.
+ *
+ * \param *file			The file to check.
+ * \param xref			The offset of the cross-reference table.
+ * \param length		The length of the file.
+ * \return			The outcome of the check.
+ */
+
+static enum validate_result validate_xref_table(FILE *file, long xref, long length)
+{
+	struct validate_sample	samples[VALIDATE_SAMPLES];
+	char			entry[VALIDATE_XREF_ENTRY + 1], *size;
+	int			c, i, start, count, step, objects = 0, sample_count = 0, trailer_size, read;
+	long			offset;
+
+	/* PDF 1.5 and later files may use a cross-reference stream in place of a table; the stream itself
+	 * is compressed, so only check that it's there.
+	 */
+
+	read = validate_read_block(file, xref);
+
+	if (read > 0 && isdigit(validate_buffer[0]))
+		return (validate_find(validate_buffer, read, "/XRef", FALSE) != NULL) ? VALIDATE_OK : VALIDATE_BAD_XREF;
+
+	if (read < 4 || strncmp(validate_buffer, "xref", 4) != 0 || fseek(file, xref + 4, SEEK_SET) != 0)
+		return VALIDATE_BAD_XREF;
+
+	/* Read each subsection of the table in turn, until the trailer is reached. */
+
+	while (TRUE) {
+		validate_skip_space(file);
+
+		c = fgetc(file);
+		if (c == 't')
+			break;
+
+		if (c == EOF || !isdigit(c) || ungetc(c, file) == EOF || fscanf(file, "%d %d", &start, &count) != 2 ||
+				start < 0 || count <= 0)
+			return VALIDATE_BAD_XREF;
+
+		validate_skip_space(file);
+
+		step = count / VALIDATE_SAMPLES + 1;
+
+		for (i = 0; i < count; i++) {
+			if (fread(entry, 1, VALIDATE_XREF_ENTRY, file) != VALIDATE_XREF_ENTRY)
+				return VALIDATE_BAD_XREF;
+
+			entry[VALIDATE_XREF_ENTRY] = '\0';
+
+			if (entry[10] != ' ' || entry[16] != ' ' || (entry[17] != 'n' && entry[17] != 'f') ||
+					sscanf(entry, "%ld", &offset) != 1)
+				return VALIDATE_BAD_XREF;
+
+			if (entry[17] == 'f')
+				continue;
+
+			if (offset <= 0 || offset >= length)
+				return VALIDATE_BAD_XREF;
+
+			if (i % step == 0 && sample_count < VALIDATE_SAMPLES) {
+				samples[sample_count].number = start + i;
+				samples[sample_count].offset = offset;
+				sample_count++;
+			}
+		}
+
+		if (start + count > objects)
+			objects = start + count;
+	}
+
+	/* The trailer must name the document catalogue, and have a size covering all of the objects. */
+
+	offset = ftell(file) - 1;
+	read = validate_read_block(file, offset);
+
+	if (read < 7 || strncmp(validate_buffer, "trailer", 7) != 0 || validate_find(validate_buffer, read, "/Root", FALSE) == NULL)
+		return VALIDATE_BAD_TRAILER;
+
+	size = validate_find(validate_buffer, read, "/Size", FALSE);
+
+	if (size == NULL || sscanf(size + 5, "%d", &trailer_size) != 1 || trailer_size < objects)
+		return VALIDATE_BAD_TRAILER;
+
+	return (validate_sample_objects(file, samples, sample_count)) ? VALIDATE_OK : VALIDATE_BAD_XREF;
+}
+
+
+/**
+ * Check that a sample of objects are found at the offsets given for them
+ * in the cross-reference table.
+ *
+ * \param *file			The file to check.
+ * \param *samples		The objects to look up.
+ * \param count			The number of objects to look up.
+ * \return			TRUE if all of the objects were found; else FALSE.
+ */
+
+static osbool validate_sample_objects(FILE *file, struct validate_sample *samples, int count)
+{
+	char		keyword[4];
+	int		i, number, generation;
+
+	for (i = 0; i < count; i++) {
+		if (validate_read_block(file, samples[i].offset) <= 0)
+			return FALSE;
+
+		if (sscanf(validate_buffer, "%d %d %3s", &number, &generation, keyword) != 3 ||
+				number != samples[i].number || strcmp(keyword, "obj") != 0)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+/**
+ * Read a block of the file into the buffer, terminating it so that it can
+ * be scanned.  Any zero bytes in the block are replaced, so that the block
+ * can be treated as a string.
+ *
+ * \param *file			The file to read from.
+ * \param offset		The offset to read from.
+ * \return			The number of bytes read.
+ */
+
+static int validate_read_block(FILE *file, long offset)
+{
+	int		i, read;
+
+	if (fseek(file, offset, SEEK_SET) != 0)
+		return 0;
+
+	read = fread(validate_buffer, 1, VALIDATE_BUFFER_SIZE, file);
+
+	for (i = 0; i < read; i++) {
+		if (validate_buffer[i] == '\0')
+			validate_buffer[i] = ' ';
+	}
+
+	validate_buffer[read] = '\0';
+
+	return read;
+}
+
+
+/**
+ * Find a piece of text in a buffer.
+ *
+ * \param *buffer		The buffer to search.
+ * \param length		The length of the buffer.
+ * \param *text			The text to find.
+ * \param last			TRUE to find the last occurrence; FALSE for the first.
+ * \return			Pointer to the text in the buffer, or NULL.
+ */
+
+static char *validate_find(char *buffer, int length, char *text, osbool last)
+{
+	char		*found = NULL;
+	int		i, text_length;
+
+	text_length = strlen(text);
+
+	for (i = 0; i + text_length <= length; i++) {
+		if (buffer[i] == *text && strncmp(buffer + i, text, text_length) == 0) {
+			found = buffer + i;
+
+			if (!last)
+				break;
+		}
+	}
+
+	return found;
+}
+
+
+/**
+ * Skip over any whitespace in a file.
+ *
+ * \param *file			The file to read from.
+ */
+
+static void validate_skip_space(FILE *file)
+{
+	int		c;
+
+	do {
+		c = fgetc(file);
+	} while (c != EOF && isspace(c));
+
+	if (c != EOF)
+		ungetc(c, file);
+}
+
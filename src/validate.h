@@ -0,0 +1,60 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: validate.h
+ *
+ * PDF output validation implementation.
+ */
+
+#ifndef PRINTPDF_VALIDATE
+#define PRINTPDF_VALIDATE
+
+/**
+ * The outcomes of validating a PDF file.
+ */
+
+enum validate_result {
+	VALIDATE_OK = 0,		/**< The file appears to be a complete PDF.				*/
+	VALIDATE_NO_FILE,		/**< The file could not be opened, or is too short to be a PDF.	*/
+	VALIDATE_NO_HEADER,		/**< The file does not start with a %PDF- header.			*/
+	VALIDATE_NO_STARTXREF,		/**< The file does not end with startxref and %%EOF.			*/
+	VALIDATE_BAD_XREF,		/**< The cross-reference table is missing or damaged.		*/
+	VALIDATE_BAD_TRAILER		/**< The trailer is missing or does not match the table.		*/
+};
+
+
+/**
+ * Perform a fast structural check of a PDF file: that it has a header, that
+ * it ends with a startxref pointing at a cross-reference table, that the
+ * table is well formed and matches its trailer, and that a sample of the
+ * objects are where the table says they are.
+ *
+ * \param *filename		The file to check.
+ * \return			The outcome of the check.
+ */
+
+enum validate_result validate_pdf(char *filename);
+
+#endif
+
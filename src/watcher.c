@@ -0,0 +1,307 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: watcher.c
+ *
+ * Spool file watcher implementation.
+ *
+ * The watcher decides when the spool locations need to be checked for new
+ * print jobs.  With a polling backend they are checked at an adaptive
+ * interval: quickly after a job has been seen, backing off while the
+ * machine is idle.  A notifying backend can tell the watcher when something
+ * may have changed, in which case the locations are checked then and,
+ * as the backend may not see every location, once every PollDelay too.
+ */
+
+/* ANSI C header files */
+
+#include <stdlib.h>
+
+/* Acorn C header files */
+
+/* OSLib header files */
+
+#include "oslib/os.h"
+
+/* SF-Lib header files. */
+
+#include "sflib/config.h"
+#include "sflib/debug.h"
+
+/* Application header files */
+
+#include "watcher.h"
+
+#include "convert.h"
+
+#ifdef HOSTED
+#include "notify.h"
+#endif
+
+
+/**
+ * The shortest interval allowed between checks, in centiseconds.
+ */
+
+#define WATCHER_MIN_INTERVAL 1
+
+
+/* Function Prototypes. */
+
+static os_t watcher_limit_interval(int interval);
+
+
+/**
+ * The polling backend, which is always available.
+ */
+
+static struct watcher_backend watcher_backend_poll = {
+	"Poll",
+	NULL,
+	NULL,
+	NULL
+};
+
+/**
+ * The backends available on this platform, in order of preference.  The
+ * polling backend must be last.
+ */
+
+static struct watcher_backend *watcher_backends[] = {
+#ifdef HOSTED
+	&notify_backend,
+#endif
+	&watcher_backend_poll
+};
+
+/**
+ * The backend in use.
+ */
+
+static struct watcher_backend *watcher_backend = &watcher_backend_poll;
+
+/**
+ * The time of the next scheduled check of the spool locations.
+ */
+
+static os_t watcher_next_check = 0;
+
+/**
+ * The time of the last check of the spool locations.
+ */
+
+static os_t watcher_last_check = 0;
+
+/**
+ * TRUE if there has been activity since the last check.
+ */
+
+static osbool watcher_activity = TRUE;
+
+/**
+ * The statistics gathered by the watcher.
+ */
+
+static struct watcher_stats watcher_stats;
+
+
+/**
+ * Initialise the spool watcher, selecting the best backend available.
+ */
+
+void watcher_initialise(void)
+{
+	int	i, count;
+
+	count = sizeof(watcher_backends) / sizeof(struct watcher_backend *);
+
+	for (i = 0; i < count; i++) {
+		watcher_backend = watcher_backends[i];
+
+		if (watcher_backend->initialise == NULL || watcher_backend->initialise())
+			break;
+	}
+
+	watcher_stats.wakeups = 0;
+	watcher_stats.checks = 0;
+	watcher_stats.idle_checks = 0;
+	watcher_stats.files = 0;
+	watcher_stats.total_latency = 0;
+	watcher_stats.max_latency = 0;
+	watcher_stats.interval = watcher_limit_interval(config_int_read("PollMinDelay"));
+
+	watcher_last_check = os_read_monotonic_time();
+	watcher_next_check = watcher_last_check;
+	watcher_activity = TRUE;
+
+	#ifdef DEBUG
+	debug_printf("Spool watcher using %s backend", watcher_backend->name);
+	#endif
+}
+
+
+/**
+ * Close the spool watcher down.
+ */
+
+void watcher_terminate(void)
+{
+	if (watcher_backend->terminate != NULL)
+		watcher_backend->terminate();
+}
+
+
+/**
+ * Called on NULL polls to check the spool locations if it is time to do
+ * so, and calculate when the watcher next needs to be polled.
+ *
+ * Following activity the spool locations are checked every PollMinDelay;
+ * while they are idle, the interval doubles up to a maximum of PollDelay.
+ *
+ * \param now			The current OS Monotonic Time.
+ */
+
+void watcher_poll(os_t now)
+{
+	os_t	min_interval, max_interval, latency;
+	osbool	check;
+
+	watcher_stats.wakeups++;
+
+	min_interval = watcher_limit_interval(config_int_read("PollMinDelay"));
+	max_interval = watcher_limit_interval(config_int_read("PollDelay"));
+
+	if (min_interval > max_interval)
+		min_interval = max_interval;
+
+	/* Check when the interval has expired, or when a notifying backend says so.  The backend is asked
+	 * on every poll, so that its events don't build up.
+	 */
+
+	check = (now - watcher_next_check >= 0) || watcher_activity;
+
+	if (watcher_backend->changed != NULL && watcher_backend->changed())
+		check = TRUE;
+
+	if (check) {
+		watcher_stats.checks++;
+
+		if (convert_check_for_ps_file()) {
+			latency = now - watcher_last_check;
+
+			watcher_stats.files++;
+			watcher_stats.total_latency += latency;
+			if (latency > watcher_stats.max_latency)
+				watcher_stats.max_latency = latency;
+
+			watcher_stats.interval = min_interval;
+		} else {
+			watcher_stats.idle_checks++;
+
+			if (watcher_activity)
+				watcher_stats.interval = min_interval;
+			else if (watcher_stats.interval < max_interval)
+				watcher_stats.interval *= 2;
+		}
+
+		if (watcher_stats.interval > max_interval)
+			watcher_stats.interval = max_interval;
+		else if (watcher_stats.interval < min_interval)
+			watcher_stats.interval = min_interval;
+
+		watcher_activity = FALSE;
+		watcher_last_check = now;
+
+		/* With a notifying backend, there's no need to wake up for anything other than the
+		 * longest poll interval, to pick up anything which the backend can't see.
+		 */
+
+		if (watcher_backend->changed != NULL)
+			watcher_next_check = now + max_interval;
+		else
+			watcher_next_check = now + watcher_stats.interval;
+	}
+}
+
+
+/**
+ * Return the time at which the watcher next needs to be polled.
+ *
+ * \return			The OS Monotonic Time of the next poll.
+ */
+
+os_t watcher_next_poll_time(void)
+{
+	return watcher_next_check;
+}
+
+
+/**
+ * Tell the watcher that there has been activity from outside, so that it
+ * is polled again straight away and returns to checking at the fastest rate.
+ */
+
+void watcher_notify_activity(void)
+{
+	watcher_activity = TRUE;
+	watcher_next_check = os_read_monotonic_time();
+}
+
+
+/**
+ * Tell the watcher that there is ongoing activity, such as a stream being
+ * followed, so that it keeps checking at the fastest rate.
+ */
+
+void watcher_notify_busy(void)
+{
+	watcher_activity = TRUE;
+}
+
+
+/**
+ * Read the statistics gathered by the watcher.
+ *
+ * \param *stats		Pointer to a block to take the statistics.
+ */
+
+void watcher_get_stats(struct watcher_stats *stats)
+{
+	if (stats != NULL)
+		*stats = watcher_stats;
+}
+
+
+/**
+ * Limit a poll interval read from the configuration to a sensible value.
+ *
+ * \param interval		The interval to limit.
+ * \return			The limited interval.
+ */
+
+static os_t watcher_limit_interval(int interval)
+{
+	return (interval < WATCHER_MIN_INTERVAL) ? WATCHER_MIN_INTERVAL : interval;
+}
+
@@ -0,0 +1,146 @@
+/* Copyright 2026, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of PrintPDF:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os/
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file: watcher.h
+ *
+ * Spool file watcher implementation.
+ */
+
+#ifndef PRINTPDF_WATCHER
+#define PRINTPDF_WATCHER
+
+#include "oslib/os.h"
+
+/**
+ * A spool watcher backend, which can tell the watcher when the spool
+ * locations may have changed.
+ */
+
+struct watcher_backend {
+	char	*name;				/**< The name of the backend, for reporting.				*/
+
+	/**
+	 * Initialise the backend.
+	 *
+	 * \return		TRUE if the backend is available; else FALSE.
+	 */
+
+	osbool	(*initialise)(void);
+
+	/**
+	 * Test whether the spool locations may have changed since the last
+	 * call.  This is only called for notifying backends: polling backends
+	 * are assumed to always need a check.  The locations are also checked
+	 * every PollDelay, in case the backend can't see all of them.
+	 *
+	 * \return		TRUE if the spool locations should be checked.
+	 */
+
+	osbool	(*changed)(void);
+
+	/**
+	 * Close the backend down.
+	 */
+
+	void	(*terminate)(void);
+};
+
+
+/**
+ * Statistics gathered by the spool watcher.
+ */
+
+struct watcher_stats {
+	unsigned	wakeups;		/**< The number of times that the watcher was polled.			*/
+	unsigned	checks;			/**< The number of times that the spool locations were checked.		*/
+	unsigned	idle_checks;		/**< The number of checks which found nothing.				*/
+	unsigned	files;			/**< The number of times that a spool file was found.			*/
+	os_t		total_latency;		/**< The total of the detection windows for the files found.		*/
+	os_t		max_latency;		/**< The longest detection window for a file found.			*/
+	os_t		interval;		/**< The current interval between checks.				*/
+};
+
+
+/**
+ * Initialise the spool watcher, selecting the best backend available.
+ */
+
+void watcher_initialise(void);
+
+
+/**
+ * Close the spool watcher down.
+ */
+
+void watcher_terminate(void);
+
+
+/**
+ * Called on NULL polls to check the spool locations if it is time to do
+ * so, and calculate when the watcher next needs to be polled.
+ *
+ * Following activity the spool locations are checked every PollMinDelay;
+ * while they are idle, the interval doubles up to a maximum of PollDelay.
+ *
+ * \param now			The current OS Monotonic Time.
+ */
+
+void watcher_poll(os_t now);
+
+
+/**
+ * Return the time at which the watcher next needs to be polled.
+ *
+ * \return			The OS Monotonic Time of the next poll.
+ */
+
+os_t watcher_next_poll_time(void);
+
+
+/**
+ * Tell the watcher that there has been activity from outside, so that it
+ * is polled again straight away and returns to checking at the fastest rate.
+ */
+
+void watcher_notify_activity(void);
+
+
+/**
+ * Tell the watcher that there is ongoing activity, such as a stream being
+ * followed, so that it keeps checking at the fastest rate.
+ */
+
+void watcher_notify_busy(void);
+
+
+/**
+ * Read the statistics gathered by the watcher.
+ *
+ * \param *stats		Pointer to a block to take the statistics.
+ */
+
+void watcher_get_stats(struct watcher_stats *stats);
+
+#endif
+